@@ -0,0 +1,125 @@
+// include/analytics/activity_rules.hpp
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <unordered_map>
+#include <cstdint>
+#include "analytics/movement_store.hpp"
+#include "analytics/zone_map.hpp"
+
+namespace hms {
+
+struct ActivityRule {
+    enum class Type {
+        INACTIVITY,   // No movement for durationMs (optionally inside zoneId)
+        ZONE_ENTER,   // Someone entered zoneId
+        ZONE_EXIT     // Someone left zoneId and stayed out for durationMs
+    };
+    
+    std::string name;
+    Type type = Type::INACTIVITY;
+    int userId = -1;              // -1 applies to everyone, identified or not
+    int zoneId = -1;              // Required for the zone rules
+    int64_t durationMs = 0;
+    int64_t cooldownMs = 15 * 60 * 1000;
+    
+    // Active window in local minutes of the day; start > end wraps midnight
+    int startMinute = 0;
+    int endMinute = 24 * 60;
+};
+
+struct ActivityAlert {
+    std::string ruleName;
+    ActivityRule::Type type;
+    int userId;
+    size_t cameraIndex;
+    int personId;
+    std::string zoneName;
+    std::chrono::system_clock::time_point timestamp;
+    std::string description;
+};
+
+// Evaluates inactivity and wandering rules against the live movement
+// stream. Each observation updates its track's zone bits (one ZoneMap read)
+// and movement anchor, and touches only the rules watching a zone it entered
+// or left, so the cost per record does not depend on how much history
+// exists. Time-based conditions are checked by evaluate(), which the caller
+// runs on its own cadence.
+//
+// Exits are tracked per track: someone else entering a zone does not cancel
+// a pending exit alert, while the same person coming back does (the same
+// track, or the same identified user under a new one). A track that is lost
+// is not known to have left anything, so a detector dropout raises nothing.
+class ActivityRuleEngine {
+public:
+    static const int ANY_USER = -1;
+    
+    struct Options {
+        double movementThresholdPx = 20.0;  // Smaller shifts are detector jitter
+        int64_t trackTimeoutMs = 5000;      // A track not seen for this long is forgotten
+        int64_t utcOffsetMs = 0;            // Schedules are in local time
+    };
+    
+    ActivityRuleEngine(const ZoneMap& zones, const Options& options);
+    ~ActivityRuleEngine();
+    
+    // Returns the rule index, or -1 if the rule is incomplete
+    int addRule(const ActivityRule& rule);
+    size_t getRuleCount() const;
+    
+    void addObservation(size_t cameraIndex, const MovementSample& sample);
+    void evaluate(int64_t nowMs);
+    
+    // Alerts raised since the last call
+    std::vector<ActivityAlert> getNewAlerts();
+    
+    static const char* typeToString(ActivityRule::Type type);
+    static bool typeFromString(const std::string& name, ActivityRule::Type& type);
+    
+    // Parses "HH:MM" into minutes of the day; -1 if malformed
+    static int parseTimeOfDay(const std::string& text);
+    
+private:
+    struct PendingExit {
+        int64_t startMs;
+        int userId;
+    };
+    
+    struct RuleState {
+        ActivityRule rule;
+        int64_t lastActivityMs = -1;
+        bool inactivityAlerted = false;
+        std::unordered_map<uint64_t, PendingExit> exits;   // Tracks out of the zone, by track key
+        int64_t lastAlertMs = INT64_MIN / 2;
+    };
+    
+    struct TrackState {
+        cv::Point anchor;
+        uint32_t zones;
+        int userId;
+        int64_t lastSeenMs;
+    };
+    
+    const ZoneMap& m_zones;
+    Options m_options;
+    std::vector<RuleState> m_rules;
+    std::vector<size_t> m_inactivityRules;
+    std::vector<std::vector<size_t>> m_zoneRules;   // Zone rules by the zone they watch
+    std::unordered_map<uint64_t, TrackState> m_tracks;
+    std::vector<ActivityAlert> m_newAlerts;
+    mutable std::mutex m_mutex;
+    
+    void applyTransitions(uint64_t trackKey, int userId, uint32_t entered, uint32_t exited,
+                          int64_t timestampMs);
+    void raiseAlert(RuleState& state, size_t cameraIndex, int personId, int64_t timestampMs,
+                    const std::string& description);
+    
+    bool isInSchedule(const ActivityRule& rule, int64_t timestampMs) const;
+    // Epoch ms at which the window containing timestampMs opened
+    int64_t windowStartMs(const ActivityRule& rule, int64_t timestampMs) const;
+};
+
+} // namespace hms
@@ -0,0 +1,94 @@
+// include/analytics/movement_store.hpp
+#pragma once
+
+#include <array>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+
+namespace hms {
+
+struct MovementSample {
+    int64_t timestampMs;
+    int trackId;
+    int userId;     // -1 until the person is identified
+    cv::Rect box;
+};
+
+// Per-camera movement history stored as time-partitioned chunks of columns
+// (timestamp, track ID, user ID, box). Each chunk covers one partition of
+// wall-clock time; once the partition is over its columns are delta + varint
+// encoded. Expiry drops whole chunks from the front of a camera's queue, so
+// the cost does not depend on how much history is kept.
+class MovementStore {
+public:
+    struct Options {
+        int64_t chunkDurationMs = 60 * 1000;  // Time partition covered by one chunk
+        size_t maxChunkSamples = 4096;        // Seal early in busy rooms
+    };
+    
+    MovementStore();
+    explicit MovementStore(const Options& options);
+    ~MovementStore();
+    
+    void append(size_t cameraIndex, const MovementSample& sample);
+    
+    // Drops every chunk that ends before cutoffMs. Retention is therefore
+    // rounded up to a chunk boundary.
+    void expireBefore(int64_t cutoffMs);
+    void clear();
+    
+    // Samples with fromMs <= timestamp < toMs, in insertion order
+    std::vector<MovementSample> query(size_t cameraIndex, int64_t fromMs, int64_t toMs) const;
+    std::vector<MovementSample> queryTrack(size_t cameraIndex, int trackId,
+                                           int64_t fromMs, int64_t toMs) const;
+    
+    size_t getSampleCount() const;
+    size_t getChunkCount() const;
+    size_t getMemoryUsage() const;  // Approximate bytes held by column data
+    
+private:
+    enum Column {
+        COLUMN_TIMESTAMP,
+        COLUMN_TRACK_ID,
+        COLUMN_USER_ID,
+        COLUMN_X,
+        COLUMN_Y,
+        COLUMN_WIDTH,
+        COLUMN_HEIGHT,
+        COLUMN_COUNT
+    };
+    
+    struct Chunk {
+        int64_t partitionStartMs;
+        int64_t minTimestampMs;
+        int64_t maxTimestampMs;
+        size_t count;
+        bool sealed;
+        
+        // Raw values while the chunk is open, encoded bytes once sealed
+        std::array<std::vector<int64_t>, COLUMN_COUNT> raw;
+        std::array<std::vector<uint8_t>, COLUMN_COUNT> encoded;
+    };
+    
+    struct Partition {
+        std::deque<Chunk> chunks;  // Oldest first; only the back may be open
+    };
+    
+    Options m_options;
+    std::vector<Partition> m_partitions;
+    size_t m_sampleCount;
+    mutable std::mutex m_mutex;
+    
+    Chunk& openChunk(Partition& partition, int64_t timestampMs);
+    void sealChunk(Chunk& chunk);
+    void decodeChunk(const Chunk& chunk, std::array<std::vector<int64_t>, COLUMN_COUNT>& columns) const;
+    
+    template <typename Predicate>
+    std::vector<MovementSample> collect(size_t cameraIndex, int64_t fromMs, int64_t toMs,
+                                        Predicate predicate) const;
+};
+
+} // namespace hms
@@ -0,0 +1,110 @@
+// include/analytics/occupancy_aggregator.hpp
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+#include "analytics/movement_store.hpp"
+#include "analytics/zone_map.hpp"
+
+namespace hms {
+
+// A fixed ring of time buckets at one granularity. Each bucket holds `width`
+// 64-bit millisecond counters, since a day bucket summing every resident
+// passes 2^32 ms (49.7 days) with a few dozen people. A slot is recycled the
+// first time a newer bucket maps onto it, so memory never grows and adding
+// an interval no longer than a bucket is O(1).
+class RollupRing {
+public:
+    RollupRing(int64_t bucketMs, size_t bucketCount, size_t width);
+    
+    // Credits amountMs starting at timeMs, split across the buckets it spans
+    void add(int64_t timeMs, size_t index, uint64_t amountMs);
+    
+    // Counters of the bucket, or nullptr if it is no longer (or not yet) held
+    const uint64_t* get(int64_t bucket) const;
+    int64_t getBucketMs() const;
+    
+private:
+    int64_t m_bucketMs;
+    size_t m_width;
+    std::vector<int64_t> m_bucketIds;
+    std::vector<uint64_t> m_values;
+    
+    size_t slotOf(int64_t bucket) const;
+};
+
+// Incrementally aggregates live person observations into an occupancy
+// heatmap per camera and dwell time per zone and user, rolled up by minute,
+// hour and day. Each observation credits the time since the track's previous
+// observation to the cell and zones it was in, so the work per record is
+// constant and queries read pre-aggregated buckets instead of raw history.
+//
+// Retention is fixed by the bucket counts: by default minutes cover the last
+// day, hours the last week and days the last 90 days.
+class OccupancyAggregator {
+public:
+    // Dwell of every person, identified or not
+    static const int ALL_USERS = -2;
+    
+    struct Options {
+        int gridCols = 32;
+        int gridRows = 18;
+        int64_t maxGapMs = 2000;       // Longer gaps between sightings count as absence
+        int64_t utcOffsetMs = 0;       // Buckets are aligned to local time
+        size_t minuteBuckets = 24 * 60;
+        size_t hourBuckets = 7 * 24;
+        size_t dayBuckets = 90;
+        size_t heatmapMinuteBuckets = 60;
+    };
+    
+    OccupancyAggregator(const ZoneMap& zones, const Options& options);
+    ~OccupancyAggregator();
+    
+    void addObservation(size_t cameraIndex, const MovementSample& sample, const cv::Size& frameSize);
+    void closeIdleTracks(int64_t nowMs);
+    
+    // Time spent in the zone between fromMs and toMs, at minute resolution
+    int64_t getDwellMs(int userId, int zoneId, int64_t fromMs, int64_t toMs) const;
+    
+    // gridRows x gridCols CV_32F of seconds spent in each cell
+    cv::Mat getHeatmap(size_t cameraIndex, int64_t fromMs, int64_t toMs) const;
+    
+    const Options& getOptions() const;
+    
+private:
+    struct Rollup {
+        RollupRing minutes;
+        RollupRing hours;
+        RollupRing days;
+        
+        Rollup(const Options& options, size_t minuteBuckets, size_t width);
+        void add(int64_t localMs, size_t index, uint64_t amountMs);
+    };
+    
+    struct TrackState {
+        int64_t lastMs;
+        int userId;
+        int cell;
+        uint32_t zones;
+    };
+    
+    const ZoneMap& m_zones;
+    Options m_options;
+    std::vector<std::unique_ptr<Rollup>> m_heatmaps;
+    std::unordered_map<int, std::unique_ptr<Rollup>> m_dwell;
+    std::unordered_map<uint64_t, TrackState> m_tracks;
+    mutable std::mutex m_mutex;
+    
+    void creditDwell(int userId, uint32_t zones, int64_t localMs, uint64_t amountMs);
+    
+    // Adds counters [firstIndex, firstIndex + count) of the largest buckets
+    // that tile [fromMs, toMs) into sum
+    void sumRange(const Rollup& rollup, int64_t fromMs, int64_t toMs,
+                  size_t firstIndex, size_t count, std::vector<uint64_t>& sum) const;
+};
+
+} // namespace hms
@@ -0,0 +1,86 @@
+// include/analytics/trajectory_simplifier.hpp
+#pragma once
+
+#include <map>
+#include <vector>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+#include "analytics/movement_store.hpp"
+
+namespace hms {
+
+// Reduces per-frame track positions to the points needed to reconstruct the
+// trajectory within a configured error.
+//
+// A sample is kept only when the box has moved or resized by at least
+// minDisplacementPx since the last kept sample, or maxIntervalMs has passed.
+// When a track closes (or its buffers fill up) the kept samples are compacted
+// with Douglas-Peucker using the synchronized (time-interpolated) distance, so
+// the stored track stays within epsilonPx of every sample that passed the
+// threshold. A sample the threshold dropped can be further off: it is within
+// minDisplacementPx of the last kept sample, but the stored track may already
+// be heading for the next one. Stats::maxErrorPx is therefore measured rather
+// than derived. Surviving samples are handed to the sink.
+class TrajectorySimplifier {
+public:
+    struct Options {
+        double minDisplacementPx = 8.0;
+        int64_t maxIntervalMs = 5000;
+        double epsilonPx = 4.0;
+        int64_t trackTimeoutMs = 2000;    // A track not seen for this long is closed
+        size_t maxPendingSamples = 512;   // Compact and flush long tracks early, counting dropped samples
+    };
+    
+    struct Stats {
+        uint64_t inputSamples = 0;
+        uint64_t thresholdSamples = 0;  // Left after the threshold/interval stage
+        uint64_t storedSamples = 0;     // Left after Douglas-Peucker
+        double maxErrorPx = 0.0;        // Largest deviation of any input sample from the stored track
+        
+        double getReductionRatio() const;
+    };
+    
+    using SampleSink = std::function<void(size_t cameraIndex, const std::vector<MovementSample>& samples)>;
+    
+    TrajectorySimplifier(const Options& options, SampleSink sink);
+    ~TrajectorySimplifier();
+    
+    void addSample(size_t cameraIndex, const MovementSample& sample);
+    void closeIdleTracks(int64_t nowMs);
+    void closeAllTracks();
+    
+    Stats getStats() const;
+    const Options& getOptions() const;
+    
+    // Douglas-Peucker over synchronized distance; endpoints are always kept
+    static std::vector<MovementSample> compact(const std::vector<MovementSample>& samples,
+                                               double epsilonPx, double* maxErrorPx = nullptr);
+    
+    // Distance between a sample and where the a-b segment puts the track at
+    // the same time: box centre offset or size change, whichever is larger
+    static double synchronizedDistance(const MovementSample& sample,
+                                       const MovementSample& a, const MovementSample& b);
+    
+private:
+    struct TrackState {
+        std::vector<MovementSample> pending;
+        std::vector<MovementSample> dropped;   // Left out by the threshold, kept to measure the error
+        bool anchorStored = false;   // pending.front() was already sent to the sink
+        MovementSample lastKept;
+        MovementSample lastSeen;
+        bool lastSeenKept = true;
+    };
+    
+    Options m_options;
+    SampleSink m_sink;
+    std::map<std::pair<size_t, int>, TrackState> m_tracks;
+    Stats m_stats;
+    mutable std::mutex m_mutex;
+    
+    void flushTrack(size_t cameraIndex, TrackState& state, bool closing);
+    void closeTrack(size_t cameraIndex, TrackState& state);
+    void measureError(TrackState& state, const std::vector<MovementSample>& stored);
+};
+
+} // namespace hms
@@ -0,0 +1,51 @@
+// include/analytics/zone_map.hpp
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+
+namespace hms {
+
+// Named zones (bed, chair, door, ...) drawn as polygons in a camera's pixel
+// coordinates. Each camera's polygons are rasterized once into a coarse grid
+// of zone bitmasks, so looking up the zones containing a point is a single
+// array read instead of a point-in-polygon test per zone. Zones may overlap.
+//
+// Zones are configured at startup; lookups are not synchronized with
+// addZone().
+class ZoneMap {
+public:
+    static const int MAX_ZONES = 32;
+    
+    explicit ZoneMap(int cellSize = 8);
+    ~ZoneMap();
+    
+    // Returns the zone ID, or -1 if the polygon is invalid or MAX_ZONES is
+    // reached. A name used on several cameras maps to the same zone ID.
+    int addZone(size_t cameraIndex, const std::string& name, const std::vector<cv::Point>& polygon);
+    
+    // Bitmask of the zone IDs containing the point
+    uint32_t lookup(size_t cameraIndex, const cv::Point& point) const;
+    
+    int getZoneId(const std::string& name) const;
+    std::string getZoneName(int zoneId) const;
+    size_t getZoneCount() const;
+    
+    // The point of a person's box used for zone membership
+    static cv::Point referencePoint(const cv::Rect& box);
+    
+private:
+    struct CameraMask {
+        int cols = 0;
+        int rows = 0;
+        std::vector<uint32_t> cells;
+    };
+    
+    int m_cellSize;
+    std::vector<std::string> m_zoneNames;
+    std::vector<CameraMask> m_masks;
+};
+
+} // namespace hms
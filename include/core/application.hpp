@@ -3,6 +3,8 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <functional>
 #include <memory>
 #include <thread>
 #include <atomic>
@@ -12,11 +14,22 @@
 #include <opencv2/opencv.hpp>
 
 #include "core/camera.hpp"
+#include "core/video_recorder.hpp"
+#include "core/recording_catalog.hpp"
+#include "core/frame_pool.hpp"
+#include "analytics/activity_rules.hpp"
+#include "analytics/movement_store.hpp"
+#include "analytics/occupancy_aggregator.hpp"
+#include "analytics/trajectory_simplifier.hpp"
+#include "analytics/zone_map.hpp"
+#include "database/movement_database.hpp"
+#include "database/event_log.hpp"
 #include "database/user_database.hpp"
 #include "detection/human_detector.hpp"
 #include "detection/fall_detector.hpp"
 #include "detection/privacy_protector.hpp"
 #include "network/notification_manager.hpp"
+#include "network/response_webhook.hpp"
 
 namespace hms {
 
@@ -47,6 +60,15 @@ public:
     
     CameraInfo getCameraInfo(size_t index) const;
     cv::Mat getProcessedFrame(size_t cameraIndex);
+    // The latest processed frame without copying it; null before the first
+    FrameHandle getLatestFrame(size_t cameraIndex);
+    
+    // Called on the processing thread when a camera's processed frame
+    // visibly differs from the last one announced, so a viewer of a still
+    // scene is not woken at all. Must not block; hand the frame to another
+    // thread and return.
+    using FrameCallback = std::function<void(size_t cameraIndex, const FrameHandle& frame)>;
+    void registerFrameCallback(FrameCallback callback);
     
     // User database management
     bool addUser(User& user);
@@ -74,6 +96,19 @@ public:
     bool isRecordingEnabled() const;
     std::string getRecordingDirectory() const;
     void setRecordingDirectory(const std::string& directory);
+    RecordingCatalog& getRecordingCatalog();
+    
+    // Movement history
+    TrajectorySimplifier::Stats getMovementHistoryStats() const;
+    MovementDatabase& getMovementDatabase();
+    
+    // Alert and notification history
+    EventLog& getEventLog();
+    
+    // Occupancy analytics
+    const ZoneMap& getZoneMap() const;
+    OccupancyAggregator& getOccupancyAggregator();
+    ActivityRuleEngine& getActivityRuleEngine();
     
 private:
     // Core components
@@ -100,23 +135,66 @@ private:
     std::thread m_processingThread;
     std::thread m_uiThread;
     
-    // Frame buffers
-    std::vector<cv::Mat> m_cameraFrames;
+    // Frame buffers; processed frames are published in pooled buffers
+    FramePool m_framePool;
+    std::vector<FrameHandle> m_cameraFrames;
+    std::vector<cv::Mat> m_cameraThumbnails;
+    std::vector<cv::Mat> m_announcedThumbnails;   // As of the last frame callback
     std::mutex m_framesMutex;
+    std::vector<FrameCallback> m_frameCallbacks;
+    std::mutex m_frameCallbacksMutex;
     
     // Recording
-    std::vector<cv::VideoWriter> m_videoWriters;
+    std::vector<std::unique_ptr<VideoRecorder>> m_videoRecorders;
+    VideoRecorder::Options m_recordingOptions;
+    std::unique_ptr<RecordingCatalog> m_recordingCatalog;
     std::chrono::system_clock::time_point m_recordingStartTime;
     
-    // Historical data (last 24 hours)
-    struct MovementRecord {
-        int userId;
-        int personId;
-        std::chrono::system_clock::time_point timestamp;
-        cv::Rect position;
-    };
-    std::vector<MovementRecord> m_movementHistory;
-    std::mutex m_historyMutex;
+    // Low-resolution proxy rendition for fast review
+    std::vector<std::unique_ptr<VideoRecorder>> m_proxyRecorders;
+    std::vector<std::chrono::steady_clock::time_point> m_lastProxyFrameTimes;
+    bool m_proxyRecordingEnabled;
+    double m_proxyFps;
+    
+    // Historical data (last 24 hours), downsampled per track before storage
+    MovementStore m_movementStore;
+    std::string m_movementDatabasePath;
+    MovementDatabase::Options m_movementDatabaseOptions;
+    std::unique_ptr<MovementDatabase> m_movementDatabase;
+    
+    // Alerts, notification sends and responses, kept across restarts
+    std::string m_eventLogPath;
+    EventLog::Options m_eventLogOptions;
+    std::unique_ptr<EventLog> m_eventLog;
+    
+    // Notifications not yet delivered, kept across restarts
+    std::string m_outboxPath;
+    NotificationOutbox::Options m_outboxOptions;
+    NotificationCoalescer::Options m_coalescerOptions;
+    EscalationEngine::Options m_escalationOptions;
+    std::map<OutboxChannel, ChannelConfig> m_channelConfigs;   // From config; an empty type disables one
+    
+    // Privacy-filtered fall snapshots attached to alert emails
+    bool m_alertSnapshotsEnabled;
+    SnapshotEncoder::Options m_snapshotOptions;
+    
+    // Replies and delivery reports called back by the SMS provider
+    bool m_responseWebhookEnabled;
+    ResponseWebhook::Options m_responseWebhookOptions;
+    std::unique_ptr<ResponseWebhook> m_responseWebhook;
+    
+    TrajectorySimplifier::Options m_trajectoryOptions;
+    std::unique_ptr<TrajectorySimplifier> m_trajectorySimplifier;
+    
+    // Zones and live occupancy rollups
+    ZoneMap m_zoneMap;
+    OccupancyAggregator::Options m_occupancyOptions;
+    std::unique_ptr<OccupancyAggregator> m_occupancyAggregator;
+    
+    // Inactivity and wandering rules over the same observations
+    ActivityRuleEngine::Options m_activityRuleOptions;
+    std::vector<ActivityRule> m_activityRules;
+    std::unique_ptr<ActivityRuleEngine> m_activityRuleEngine;
     
     // Methods
     void processingThreadFunc();
@@ -124,8 +202,13 @@ private:
     void processFrame(size_t cameraIndex, cv::Mat& frame);
     void updateUI();
     void handleFallEvents();
+    void handleActivityAlerts();
     void cleanupOldRecordings();
-    void saveMovementRecord(int userId, int personId, const cv::Rect& position);
+    void openRecorders(size_t cameraIndex);
+    void closeRecorders();
+    std::unique_ptr<VideoRecorder> openVideoRecorder(size_t cameraIndex, const std::string& rendition);
+    void saveMovementRecord(size_t cameraIndex, int userId, int personId, const cv::Rect& position,
+                            const cv::Size& frameSize);
     void cleanupOldMovementRecords();
     
     // UI helper methods
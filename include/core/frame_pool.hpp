@@ -0,0 +1,46 @@
+// include/core/frame_pool.hpp
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+
+namespace hms {
+
+// A processed frame shared with whoever displays it; read-only once published
+using FrameHandle = std::shared_ptr<const cv::Mat>;
+
+// Recycles frame buffers, so publishing a frame per camera per tick does not
+// allocate once the pool is warm. A buffer goes back to the pool when the
+// last handle to it is dropped, on whatever thread that happens; handles
+// may outlive the pool, in which case their buffer is simply freed.
+// Thread-safe.
+class FramePool {
+public:
+    using Handle = std::shared_ptr<cv::Mat>;
+    
+    explicit FramePool(size_t maxIdle = 8);
+    
+    // A buffer of this size and type, reused when an idle one is available.
+    // Its contents are undefined.
+    Handle acquire(int rows, int cols, int type);
+    
+    size_t getIdleCount() const;
+    uint64_t getAllocationCount() const;    // Buffers that had to be created
+    
+private:
+    struct State {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<cv::Mat>> idle;
+        size_t maxIdle;
+        uint64_t allocations = 0;
+    };
+    
+    std::shared_ptr<State> m_state;
+    
+    static void release(const std::weak_ptr<State>& weakState, cv::Mat* mat);
+};
+
+} // namespace hms
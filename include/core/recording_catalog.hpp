@@ -0,0 +1,58 @@
+// include/core/recording_catalog.hpp
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <optional>
+#include <cstdint>
+
+namespace hms {
+
+struct RecordingEntry {
+    size_t cameraIndex;
+    std::string rendition;  // RecordingCatalog::MAIN_RENDITION or PROXY_RENDITION
+    std::string path;
+    int64_t startTimeMs;
+    int64_t endTimeMs;      // 0 while the segment is still being written
+    int width;
+    int height;
+    double fps;
+};
+
+// Index of recorded segments, stored next to the footage as an append-only
+// JSON lines file (catalog.jsonl) so review tools can find the right segment
+// and rendition without probing every video file.
+class RecordingCatalog {
+public:
+    static constexpr const char* MAIN_RENDITION = "main";
+    static constexpr const char* PROXY_RENDITION = "proxy";
+    
+    explicit RecordingCatalog(const std::string& directory);
+    ~RecordingCatalog();
+    
+    // Replays and compacts the catalog file, closing segments left open by
+    // a crash
+    bool load();
+    
+    void addSegment(const RecordingEntry& entry);
+    void closeSegment(const std::string& path, int64_t endTimeMs);
+    void removeSegment(const std::string& path);
+    
+    std::vector<RecordingEntry> getSegments(size_t cameraIndex, int64_t fromMs, int64_t toMs) const;
+    
+    // Segment to use for timeline scrubbing: the proxy rendition when one
+    // covers the requested time, otherwise the main rendition
+    std::optional<RecordingEntry> findScrubbingSegment(size_t cameraIndex, int64_t timeMs) const;
+    
+    std::string getCatalogPath() const;
+    
+private:
+    std::string m_catalogPath;
+    std::vector<RecordingEntry> m_entries;
+    mutable std::mutex m_mutex;
+    
+    void appendLine(const std::string& line);
+};
+
+} // namespace hms
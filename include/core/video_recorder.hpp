@@ -0,0 +1,74 @@
+// include/core/video_recorder.hpp
+#pragma once
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+
+namespace hms {
+
+// Records one camera stream to disk.
+//
+// The legacy MP4 container only becomes playable once the moov atom is written
+// on release(), so a crash loses the whole segment. The streaming containers
+// (MPEG-TS, Matroska) need no trailer: the encoder muxes into a FIFO and a
+// writer thread drains it into large sequential writes, fsyncing on a fixed
+// cadence. Everything up to the last sync survives kill -9 or power loss.
+class VideoRecorder {
+public:
+    enum class Container {
+        MP4,
+        MPEG_TS,
+        MATROSKA
+    };
+    
+    struct Options {
+        Container container = Container::MPEG_TS;
+        int fourcc = cv::VideoWriter::fourcc('a', 'v', 'c', '1');
+        double fps = 30.0;
+        cv::Size frameSize = cv::Size(1280, 720);
+        int fsyncIntervalMs = 1000;          // Upper bound on footage lost on a crash
+        size_t writeBufferBytes = 4 << 20;   // Size of each sequential write to disk
+    };
+    
+    explicit VideoRecorder(const Options& options);
+    ~VideoRecorder();
+    
+    // basePath is the output path without extension; the container's
+    // extension is appended.
+    bool open(const std::string& basePath);
+    void write(const cv::Mat& frame);
+    void release();
+    bool isOpened() const;
+    
+    std::string getFilePath() const;
+    uint64_t getFramesWritten() const;
+    uint64_t getSyncedBytes() const;  // Bytes known to be durable on disk
+    
+    static std::string getExtension(Container container);
+    static Container containerFromString(const std::string& format);
+    static bool isRecordingFile(const std::string& path);
+    
+private:
+    Options m_options;
+    cv::VideoWriter m_writer;
+    std::string m_filePath;
+    std::string m_fifoPath;
+    int m_fifoFd;
+    int m_fileFd;
+    bool m_opened;
+    
+    std::thread m_drainThread;
+    std::atomic<uint64_t> m_framesWritten;
+    std::atomic<uint64_t> m_syncedBytes;
+    
+    bool openStreaming();
+    void drainThreadFunc();
+    bool writeFully(const char* data, size_t size);
+    void closeDescriptors();
+};
+
+} // namespace hms
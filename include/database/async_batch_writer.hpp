@@ -0,0 +1,161 @@
+// include/database/async_batch_writer.hpp
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+
+namespace hms {
+
+// Queues items in memory and hands them to a write function on a background
+// thread, either every flushIntervalMs or as soon as batchSize items are
+// waiting. Producers never wait on the write itself; when more than
+// maxQueued items are waiting, new items are dropped and counted.
+template <typename T>
+class AsyncBatchWriter {
+public:
+    // Writes the whole batch, typically inside one transaction
+    using WriteBatch = std::function<bool(const std::vector<T>& batch)>;
+    
+    AsyncBatchWriter(WriteBatch writeBatch, int flushIntervalMs, size_t batchSize, size_t maxQueued)
+        : m_writeBatch(std::move(writeBatch)),
+          m_flushInterval(flushIntervalMs > 0 ? flushIntervalMs : 1000),
+          m_batchSize(batchSize > 0 ? batchSize : 1),
+          m_maxQueued(maxQueued),
+          m_running(false), m_writing(false), m_flushRequested(false),
+          m_writtenCount(0), m_droppedCount(0), m_failedCount(0) {}
+    
+    ~AsyncBatchWriter() {
+        stop();
+    }
+    
+    void start() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_running) {
+            return;
+        }
+        m_running = true;
+        m_thread = std::thread(&AsyncBatchWriter::writerThreadFunc, this);
+    }
+    
+    // Writes everything still queued, then stops the thread
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_running) {
+                return;
+            }
+            m_running = false;
+        }
+        m_cv.notify_all();
+        
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+    
+    bool enqueue(const T& item) {
+        return enqueue(std::vector<T>{item});
+    }
+    
+    bool enqueue(const std::vector<T>& items) {
+        bool wakeWriter = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_maxQueued > 0 && m_queue.size() + items.size() > m_maxQueued) {
+                m_droppedCount += items.size();
+                return false;
+            }
+            m_queue.insert(m_queue.end(), items.begin(), items.end());
+            wakeWriter = m_queue.size() >= m_batchSize;
+        }
+        
+        if (wakeWriter) {
+            m_cv.notify_all();
+        }
+        return true;
+    }
+    
+    // Blocks until everything queued so far has been written
+    void flush() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_flushRequested = true;
+        m_cv.notify_all();
+        m_drainedCv.wait(lock, [this] {
+            return (m_queue.empty() && !m_writing) || !m_running;
+        });
+    }
+    
+    size_t getPendingCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_queue.size();
+    }
+    
+    uint64_t getWrittenCount() const { return m_writtenCount; }
+    uint64_t getDroppedCount() const { return m_droppedCount; }
+    uint64_t getFailedCount() const { return m_failedCount; }
+    
+private:
+    WriteBatch m_writeBatch;
+    std::chrono::milliseconds m_flushInterval;
+    size_t m_batchSize;
+    size_t m_maxQueued;
+    
+    std::vector<T> m_queue;
+    bool m_running;
+    bool m_writing;
+    bool m_flushRequested;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_drainedCv;
+    std::thread m_thread;
+    
+    std::atomic<uint64_t> m_writtenCount;
+    std::atomic<uint64_t> m_droppedCount;
+    std::atomic<uint64_t> m_failedCount;
+    
+    void writerThreadFunc() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        
+        while (true) {
+            m_cv.wait_for(lock, m_flushInterval, [this] {
+                return !m_running || m_flushRequested || m_queue.size() >= m_batchSize;
+            });
+            
+            if (!m_queue.empty()) {
+                std::vector<T> batch;
+                batch.swap(m_queue);
+                m_writing = true;
+                
+                lock.unlock();
+                bool written = m_writeBatch(batch);
+                lock.lock();
+                
+                m_writing = false;
+                if (written) {
+                    m_writtenCount += batch.size();
+                } else {
+                    m_failedCount += batch.size();
+                }
+            }
+            
+            if (m_queue.empty()) {
+                m_flushRequested = false;
+                m_drainedCv.notify_all();
+                
+                if (!m_running) {
+                    break;
+                }
+            }
+        }
+    }
+};
+
+} // namespace hms
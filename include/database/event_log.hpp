@@ -0,0 +1,99 @@
+// include/database/event_log.hpp
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <ostream>
+#include <sqlite3.h>
+#include "database/async_batch_writer.hpp"
+
+namespace hms {
+
+enum class EventType {
+    FALL_DETECTED,
+    ACTIVITY_ALERT,
+    NOTIFICATION_QUEUED,
+    NOTIFICATION_SENT,
+    NOTIFICATION_FAILED,
+    RESPONSE_RECEIVED,
+    ALERT_ESCALATED
+};
+
+const char* eventTypeToString(EventType type);
+bool eventTypeFromString(const std::string& text, EventType& type);
+
+struct EventRecord {
+    int64_t id = -1;            // Assigned when the event is stored
+    EventType type = EventType::FALL_DETECTED;
+    int64_t timestampMs = 0;
+    int cameraIndex = -1;       // -1 when the alert is not tied to one camera
+    int trackId = -1;
+    int userId = -1;
+    std::string status;         // Notification status after this event
+    std::string recipient;      // Phone number or email address
+    std::string subject;
+    std::string detail;         // Alert text, or the response text for a response
+};
+
+// Writes events as CSV with a header row, oldest first
+void writeEventsCsv(std::ostream& out, const std::vector<EventRecord>& events);
+
+// Persistent record of alerts, notification sends and responses. Events are
+// queued in memory and written by a background thread in one transaction per
+// batch, so logging never waits on disk on the alert path. Like the movement
+// history, writes and queries use separate connections over a WAL database.
+class EventLog {
+public:
+    struct Options {
+        int flushIntervalMs = 500;
+        size_t batchSize = 256;
+        size_t maxQueuedEvents = 10000;  // Beyond this, new events are dropped
+        int retentionDays = 365;         // 0 keeps everything
+    };
+    
+    EventLog(const std::string& dbPath);
+    EventLog(const std::string& dbPath, const Options& options);
+    ~EventLog();
+    
+    bool initialize();
+    bool isInitialized() const;
+    void shutdown();
+    
+    // Asynchronous; returns false if the queue is full and the event was dropped
+    bool log(const EventRecord& event);
+    
+    // Blocks until every queued event is on disk
+    void flush();
+    
+    // Time ranges are [fromMs, toMs); results are ordered by time
+    std::vector<EventRecord> getEventsByUser(int userId, int64_t fromMs, int64_t toMs);
+    std::vector<EventRecord> getEvents(int64_t fromMs, int64_t toMs);
+    
+    uint64_t getWrittenCount() const;
+    uint64_t getDroppedCount() const;
+    
+private:
+    std::string m_dbPath;
+    Options m_options;
+    sqlite3* m_writeDb;
+    sqlite3* m_readDb;
+    sqlite3_stmt* m_insertStmt;
+    std::mutex m_readMutex;
+    bool m_initialized;
+    int64_t m_lastPurgeMs;
+    
+    std::unique_ptr<AsyncBatchWriter<EventRecord>> m_writer;
+    
+    // Helper methods
+    bool executeSql(sqlite3* db, const std::string& sql);
+    bool migrateSchema();
+    bool writeBatch(const std::vector<EventRecord>& batch);
+    void purgeExpired();
+    std::vector<EventRecord> runQuery(const std::string& sql,
+                                      const std::function<void(sqlite3_stmt*)>& bind);
+};
+
+} // namespace hms
@@ -0,0 +1,80 @@
+// include/database/movement_database.hpp
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <sqlite3.h>
+#include "analytics/movement_store.hpp"
+#include "database/async_batch_writer.hpp"
+
+namespace hms {
+
+struct MovementRecord {
+    size_t cameraIndex;
+    MovementSample sample;
+};
+
+// On-disk movement history. Samples are queued in memory and written by a
+// background thread in one transaction per batch, so callers on the analysis
+// path never wait on disk. Writes and queries use separate connections; the
+// database runs in WAL mode so queries are not blocked by a batch in progress.
+class MovementDatabase {
+public:
+    struct Options {
+        int flushIntervalMs = 1000;
+        size_t batchSize = 4096;          // Write early once this many are queued
+        size_t maxQueuedSamples = 200000; // Beyond this, new samples are dropped
+        int retentionDays = 30;           // 0 keeps everything
+    };
+    
+    MovementDatabase(const std::string& dbPath);
+    MovementDatabase(const std::string& dbPath, const Options& options);
+    ~MovementDatabase();
+    
+    bool initialize();
+    bool isInitialized() const;
+    void shutdown();
+    
+    // Asynchronous; returns false if the queue is full and the samples were dropped
+    bool addSamples(size_t cameraIndex, const std::vector<MovementSample>& samples);
+    
+    // Blocks until every queued sample is on disk
+    void flush();
+    
+    // Time ranges are [fromMs, toMs); results are ordered by time
+    std::vector<MovementRecord> getMovementsByCamera(size_t cameraIndex, int64_t fromMs, int64_t toMs);
+    std::vector<MovementRecord> getMovementsByTrack(size_t cameraIndex, int trackId,
+                                                    int64_t fromMs, int64_t toMs);
+    std::vector<MovementRecord> getMovementsByUser(int userId, int64_t fromMs, int64_t toMs);
+    
+    // Everything since fromMs in time order, cameras interleaved
+    std::vector<MovementRecord> getMovementsSince(int64_t fromMs);
+    
+    uint64_t getWrittenCount() const;
+    uint64_t getDroppedCount() const;
+    
+private:
+    std::string m_dbPath;
+    Options m_options;
+    sqlite3* m_writeDb;
+    sqlite3* m_readDb;
+    sqlite3_stmt* m_insertStmt;
+    std::mutex m_readMutex;
+    bool m_initialized;
+    int64_t m_lastPurgeMs;
+    
+    std::unique_ptr<AsyncBatchWriter<MovementRecord>> m_writer;
+    
+    // Helper methods
+    bool executeSql(sqlite3* db, const std::string& sql);
+    void createTables();
+    bool writeBatch(const std::vector<MovementRecord>& batch);
+    void purgeExpired();
+    std::vector<MovementRecord> runQuery(const std::string& sql,
+                                         const std::function<void(sqlite3_stmt*)>& bind);
+};
+
+} // namespace hms
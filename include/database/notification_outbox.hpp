@@ -0,0 +1,120 @@
+// include/database/notification_outbox.hpp
+#pragma once
+
+#include <string>
+#include <vector>
+#include <sqlite3.h>
+
+namespace hms {
+
+enum class OutboxChannel {
+    SMS,
+    EMAIL
+};
+
+// One message to one recipient over one channel
+struct OutboxEntry {
+    int64_t id = -1;            // Assigned when the entry is added
+    int userId = -1;
+    int personId = -1;
+    OutboxChannel channel = OutboxChannel::SMS;
+    std::string recipient;      // Phone number or email address
+    std::string subject;        // Email only
+    std::string message;
+    bool countsAsSent = true;   // False for sends that do not settle the alert, e.g. the doctor's
+    int attempts = 0;           // Failed attempts so far
+    int64_t createdMs = 0;
+    int64_t nextAttemptMs = 0;
+};
+
+struct OutboxResult {
+    int64_t id;
+    int attempts;               // The entry's attempts when it was claimed
+    bool success;
+    std::string error;
+};
+
+enum class OutboxOutcome {
+    SENT,
+    RETRY,                      // Rescheduled with backoff
+    GAVE_UP                     // Out of attempts; kept with status 'failed'
+};
+
+// Persistent queue of notification sends. Every message is on disk before
+// it is sent and stays there until it succeeds or runs out of attempts, so
+// a crash or shutdown loses nothing: initialize() makes whatever was left
+// due again. Claimed entries are leased rather than locked, so a send lost
+// with the process is retried once its lease expires or on the next start.
+// Delivery is therefore at least once.
+//
+// Each entry is one channel and recipient, so a failing gateway or mailbox
+// backs off on its own without holding up the other sends of an alert.
+// Not thread-safe; the notification thread is its only user.
+class NotificationOutbox {
+public:
+    struct Options {
+        int maxAttempts = 10;
+        int64_t baseBackoffMs = 2000;     // Before the first retry, doubling after each failure
+        int64_t maxBackoffMs = 300000;
+        int64_t leaseMs = 60000;          // Longer than any send can take
+    };
+    
+    NotificationOutbox(const std::string& dbPath);
+    NotificationOutbox(const std::string& dbPath, const Options& options);
+    ~NotificationOutbox();
+    
+    bool initialize();
+    bool isInitialized() const;
+    void shutdown();
+    
+    // Adds entries in one transaction and sets their ids; each is due at its
+    // nextAttemptMs, or at once if that has passed
+    bool add(std::vector<OutboxEntry>& entries, int64_t nowMs);
+    
+    // Returns up to limit due entries, oldest first, and leases them
+    std::vector<OutboxEntry> claimDue(int64_t nowMs, size_t limit);
+    
+    // The same, for one channel only
+    std::vector<OutboxEntry> claimDue(int64_t nowMs, size_t limit, OutboxChannel channel);
+    
+    // Moves claimed entries to their nextAttemptMs without counting an attempt
+    bool reschedule(const std::vector<OutboxEntry>& entries);
+    
+    // Records send outcomes in one transaction; outcomes are in result order.
+    // Sent entries are deleted, as the event log keeps the history.
+    std::vector<OutboxOutcome> recordResults(const std::vector<OutboxResult>& results, int64_t nowMs);
+    
+    // When the next pending entry is due, or -1 if there is none
+    int64_t getNextDueMs();
+    int64_t getNextDueMs(OutboxChannel channel);
+    
+    size_t getPendingCount();
+    size_t getFailedCount();
+    
+    // Delay before retry number attempts (1 for the first), with jitter
+    int64_t backoffMs(int attempts) const;
+    
+private:
+    std::string m_dbPath;
+    Options m_options;
+    sqlite3* m_db;
+    sqlite3_stmt* m_insertStmt;
+    sqlite3_stmt* m_claimStmt;
+    sqlite3_stmt* m_claimChannelStmt;
+    sqlite3_stmt* m_leaseStmt;
+    sqlite3_stmt* m_deleteStmt;
+    sqlite3_stmt* m_retryStmt;
+    sqlite3_stmt* m_failStmt;
+    bool m_initialized;
+    
+    // Helper methods
+    bool executeSql(const std::string& sql);
+    bool migrateSchema();
+    bool prepare(const char* sql, sqlite3_stmt** stmt);
+    bool stepAndReset(sqlite3_stmt* stmt);
+    std::vector<OutboxEntry> claim(sqlite3_stmt* stmt, int64_t nowMs);
+    int64_t queryNextDueMs(const char* sql, const char* channel);
+    size_t countWithStatus(const char* status);
+};
+
+} // namespace hms
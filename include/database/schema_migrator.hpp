@@ -0,0 +1,45 @@
+// include/database/schema_migrator.hpp
+#pragma once
+
+#include <string>
+#include <vector>
+#include <sqlite3.h>
+
+namespace hms {
+
+// Brings a database schema up to date using PRAGMA user_version as the
+// version number. Each migration is a batch of SQL that moves the schema
+// from version - 1 to version; pending ones run in order, each in its own
+// transaction together with the version bump, so an interrupted upgrade
+// resumes from the last step that committed.
+//
+// Version 0 is a database that predates versioning (or a new file), so the
+// first migration should use IF NOT EXISTS to adopt tables created before.
+class SchemaMigrator {
+public:
+    struct Migration {
+        int version;
+        std::string description;
+        std::string sql;
+    };
+    
+    explicit SchemaMigrator(const std::string& name);
+    
+    // Versions must be added in order: 1, 2, 3, ...
+    bool addMigration(int version, const std::string& description, const std::string& sql);
+    int getLatestVersion() const;
+    
+    // Applies every pending migration; false if one fails or the database
+    // is newer than the latest known version
+    bool migrate(sqlite3* db);
+    
+    static int getVersion(sqlite3* db);
+    
+private:
+    std::string m_name;
+    std::vector<Migration> m_migrations;
+    
+    bool execute(sqlite3* db, const std::string& sql);
+};
+
+} // namespace hms
@@ -0,0 +1,71 @@
+// include/database/statement_cache.hpp
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <sqlite3.h>
+
+namespace hms {
+
+// Prepared statements for one connection, compiled on first use and kept
+// until the cache is destroyed. Each statement is identified by a small
+// integer query ID chosen by the owner.
+//
+// acquire() hands out a Handle that resets the statement and clears its
+// bindings when it goes out of scope, so early returns cannot leave a
+// statement half-stepped. If the cached statement is already held (a nested
+// or concurrent use of the same query), a one-off statement is prepared and
+// finalized by the handle instead.
+class StatementCache {
+public:
+    class Handle {
+    public:
+        Handle();
+        Handle(Handle&& other) noexcept;
+        Handle& operator=(Handle&& other) noexcept;
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+        ~Handle();
+        
+        operator sqlite3_stmt*() const { return m_stmt; }
+        
+    private:
+        friend class StatementCache;
+        Handle(StatementCache* cache, int queryId, sqlite3_stmt* stmt);
+        
+        void release();
+        
+        StatementCache* m_cache;
+        int m_queryId;          // -1 for a one-off statement
+        sqlite3_stmt* m_stmt;
+    };
+    
+    StatementCache();
+    ~StatementCache();
+    
+    void setDatabase(sqlite3* db);
+    
+    // Null handle if the statement does not compile
+    Handle acquire(int queryId, const char* sql);
+    
+    // Finalizes every cached statement; no handle may be outstanding
+    void clear();
+    
+    uint64_t getPrepareCount() const;
+    
+private:
+    struct Entry {
+        sqlite3_stmt* stmt = nullptr;
+        bool inUse = false;
+    };
+    
+    sqlite3* m_db;
+    std::vector<Entry> m_entries;
+    uint64_t m_prepareCount;
+    mutable std::mutex m_mutex;
+    
+    void giveBack(int queryId);
+};
+
+} // namespace hms
@@ -0,0 +1,35 @@
+// include/database/user.hpp
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace hms {
+
+struct EmergencyContact {
+    int id = -1;  // Primary key, assigned when the contact is stored
+    std::string name;
+    std::string phone;
+    std::string email;
+    std::string address;
+    std::string relationship;
+};
+
+struct Doctor {
+    std::string name;
+    std::string phone;
+    std::string email;
+    std::string address;
+    std::string specialization;
+};
+
+struct User {
+    int id;
+    std::string name;
+    std::vector<EmergencyContact> emergencyContacts;
+    Doctor familyDoctor;
+    std::string notes;
+    std::string imageReference;  // Path to user's reference image for facial recognition
+};
+
+} // namespace hms
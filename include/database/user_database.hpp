@@ -4,38 +4,34 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <sqlite3.h>
+#include "database/user.hpp"
+#include "database/user_directory.hpp"
+#include "database/statement_cache.hpp"
 
 namespace hms {
 
-struct EmergencyContact {
-    std::string name;
-    std::string phone;
-    std::string email;
-    std::string address;
-    std::string relationship;
-};
-
-struct Doctor {
-    std::string name;
-    std::string phone;
-    std::string email;
-    std::string address;
-    std::string specialization;
-};
-
-struct User {
-    int id;
-    std::string name;
-    std::vector<EmergencyContact> emergencyContacts;
-    Doctor familyDoctor;
-    std::string notes;
-    std::string imageReference;  // Path to user's reference image for facial recognition
-};
-
+// Resident records. All writes go through one connection, serialized by a
+// mutex; reads check out one of a small pool of read-only connections, so
+// alerting and UI lookups run concurrently and, with the database in WAL
+// mode, are not blocked by a write in progress. An in-memory database has no
+// pool and reads through the writer.
+//
+// Every committed write is also applied to an in-memory UserDirectory, which
+// is loaded at startup; hot paths read that instead of the database.
 class UserDatabase {
 public:
+    struct Options {
+        int readerCount = 4;
+        int64_t mmapSizeBytes = 64 * 1024 * 1024;
+        int busyTimeoutMs = 5000;
+    };
+    
     UserDatabase(const std::string& dbPath);
+    UserDatabase(const std::string& dbPath, const Options& options);
     ~UserDatabase();
     
     bool initialize();
@@ -43,13 +39,29 @@ public:
     
     // User management
     bool addUser(User& user);  // Updates user.id if successful
+    
+    // Adds every user in one transaction; on failure none are added
+    bool addUsers(std::vector<User>& users);
+    // Loads residents from a .csv or .json file (see user_import.hpp) with
+    // addUsers; returns the number imported, or -1 on error
+    int importUsers(const std::string& filePath);
     bool updateUser(const User& user);
     bool deleteUser(int userId);
     User getUserById(int userId);
     std::vector<User> getAllUsers();
     
+    // Users whose name, notes, contact names and phone numbers or doctor
+    // match every word of the query as a prefix, best match first. An empty
+    // query pages through everyone by name.
+    std::vector<User> searchUsers(const std::string& query, int limit, int offset = 0);
+    
     // Emergency contact management
-    bool addEmergencyContact(int userId, const EmergencyContact& contact);
+    bool addEmergencyContact(int userId, EmergencyContact& contact);  // Updates contact.id if successful
+    bool updateEmergencyContact(const EmergencyContact& contact);     // Matched by contact.id
+    bool deleteEmergencyContact(int contactId);
+    
+    // Address a contact by its position in getEmergencyContacts; the ID-based
+    // forms above are preferred, as positions shift when contacts change
     bool updateEmergencyContact(int userId, int contactIndex, const EmergencyContact& contact);
     bool deleteEmergencyContact(int userId, int contactIndex);
     std::vector<EmergencyContact> getEmergencyContacts(int userId);
@@ -58,14 +70,110 @@ public:
     bool setFamilyDoctor(int userId, const Doctor& doctor);
     Doctor getFamilyDoctor(int userId);
     
+    // Always reflects the last committed state of the database
+    UserDirectory& getDirectory();
+    
+    // Number of SQL statements run and compiled on all connections, for diagnostics
+    uint64_t getStatementCount() const;
+    uint64_t getPrepareCount() const;
+    size_t getReaderCount() const;
+    
 private:
+    // Keys into the statement cache, one per SQL string
+    enum QueryId {
+        QUERY_INSERT_USER,
+        QUERY_UPDATE_USER,
+        QUERY_DELETE_USER,
+        QUERY_SELECT_USER,
+        QUERY_SELECT_ALL_USERS,
+        QUERY_SELECT_ALL_CONTACTS,
+        QUERY_SELECT_ALL_DOCTORS,
+        QUERY_INSERT_CONTACT,
+        QUERY_SELECT_CONTACT_ID_AT,
+        QUERY_UPDATE_CONTACT,
+        QUERY_DELETE_CONTACT,
+        QUERY_SELECT_CONTACTS,
+        QUERY_SELECT_DOCTOR_ID,
+        QUERY_UPDATE_DOCTOR,
+        QUERY_INSERT_DOCTOR,
+        QUERY_SELECT_DOCTOR,
+        QUERY_SEARCH_USERS,
+        QUERY_SELECT_USER_PAGE
+    };
+    
+    struct Connection {
+        sqlite3* db = nullptr;
+        StatementCache statements;
+    };
+    
+    // A reader checked out of the pool for the duration of one call, or the
+    // locked writer when there is no pool
+    class ReadLease {
+    public:
+        explicit ReadLease(UserDatabase& owner);
+        ~ReadLease();
+        
+        Connection& operator*() const { return *m_connection; }
+        Connection* operator->() const { return m_connection; }
+        
+    private:
+        UserDatabase& m_owner;
+        Connection* m_connection;
+        std::unique_lock<std::recursive_mutex> m_writeLock;
+    };
+    
+    // Holds the write lock inside BEGIN IMMEDIATE ... COMMIT, rolling back
+    // unless commit() is reached. A transaction opened while another is
+    // active joins it, and its failure rolls back the outer one too.
+    // Writers must check ok() before executing anything: if BEGIN failed,
+    // their statements would otherwise run and commit one by one.
+    class WriteTransaction {
+    public:
+        explicit WriteTransaction(UserDatabase& owner);
+        ~WriteTransaction();
+        
+        // False once BEGIN or a joined transaction has failed
+        bool ok() const;
+        bool commit();
+        
+    private:
+        UserDatabase& m_owner;
+        std::unique_lock<std::recursive_mutex> m_lock;
+        bool m_done;
+        
+        bool finish();
+    };
+    
     std::string m_dbPath;
-    sqlite3* m_db;
-    bool m_initialized;
+    Options m_options;
+    std::atomic<bool> m_initialized;
+    std::atomic<uint64_t> m_statementCount;
+    
+    // Recursive so compound writes can call the single-row ones
+    Connection m_writer;
+    std::recursive_mutex m_writeMutex;
+    int m_transactionDepth;       // Guarded by m_writeMutex
+    bool m_transactionFailed;
+    std::vector<UserDirectory::Change> m_pendingChanges;  // Applied to m_directory on commit
+    
+    UserDirectory m_directory;
+    
+    std::vector<std::unique_ptr<Connection>> m_readers;
+    std::vector<Connection*> m_idleReaders;
+    std::mutex m_poolMutex;
+    std::condition_variable m_poolCondition;
     
     // Helper methods
     bool executeSql(const std::string& sql);
-    void createTables();
+    bool migrateSchema();
+    bool openReader();
+    bool insertUser(User& user);
+    bool insertFamilyDoctor(int userId, const Doctor& doctor);
+    void closeConnections();
+    int getContactIdAt(int userId, int contactIndex);
+    std::vector<User> readAllUsers(Connection& connection);
+    std::vector<EmergencyContact> readEmergencyContacts(Connection& connection, int userId);
+    Doctor readFamilyDoctor(Connection& connection, int userId);
 };
 
 } // namespace hms
@@ -0,0 +1,70 @@
+// include/database/user_directory.hpp
+#pragma once
+
+#include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+#include "database/user.hpp"
+
+namespace hms {
+
+// Read-mostly in-memory copy of every resident with their contacts and
+// doctor, for the alert path and the UI. Readers take an immutable snapshot
+// with one atomic load and never lock or touch the database. Writers build
+// the next snapshot from the current one, sharing every unchanged User, and
+// publish it with an atomic swap; a snapshot already handed out never
+// changes. Each publish copies the map of pointers, so writes cost
+// O(residents), which suits a list that changes a few times a day.
+class UserDirectory {
+public:
+    using UserMap = std::map<int, std::shared_ptr<const User>>;
+    
+    struct Snapshot {
+        UserMap users;         // Ordered by user ID
+        uint64_t version = 0;  // Bumped on every published change
+        
+        // Null if there is no such user
+        std::shared_ptr<const User> find(int userId) const;
+        std::vector<User> toVector() const;
+    };
+    
+    // Edits one snapshot under construction; see UserDatabase for the producers
+    using Change = std::function<void(UserMap& users)>;
+    using ChangeCallback = std::function<void(uint64_t version)>;
+    
+    UserDirectory();
+    ~UserDirectory();
+    
+    std::shared_ptr<const Snapshot> getSnapshot() const;
+    std::shared_ptr<const User> findUser(int userId) const;
+    
+    // Replaces the whole directory
+    void reset(const std::vector<User>& users);
+    // Applies the changes in order and publishes them as one snapshot
+    void apply(const std::vector<Change>& changes);
+    
+    // Called after each published snapshot, on the writer's thread
+    void registerChangeCallback(ChangeCallback callback);
+    
+    // Change helpers
+    static Change upsertUser(const User& user);
+    static Change removeUser(int userId);
+    static Change modifyUser(int userId, std::function<void(User& user)> edit);
+    // Find the owner by contact ID
+    static Change updateContact(const EmergencyContact& contact);
+    static Change removeContact(int contactId);
+    
+private:
+    std::shared_ptr<const Snapshot> m_snapshot;  // Accessed only through std::atomic_load/store
+    std::mutex m_writeMutex;
+    
+    std::vector<ChangeCallback> m_callbacks;
+    std::mutex m_callbackMutex;
+    
+    void publish(std::shared_ptr<Snapshot> snapshot);
+};
+
+} // namespace hms
@@ -0,0 +1,31 @@
+// include/database/user_import.hpp
+#pragma once
+
+#include <string>
+#include <vector>
+#include <istream>
+#include "database/user.hpp"
+
+namespace hms {
+
+// Resident lists for bulk onboarding, in one of two layouts.
+//
+// JSON: an array of residents (or an object with a "users" array), each
+//   { "name", "notes", "image_reference",
+//     "emergency_contacts": [ { "name", "phone", "email", "address", "relationship" } ],
+//     "family_doctor": { "name", "phone", "email", "address", "specialization" } }
+//
+// CSV: a header row naming the columns, in any order, from name, notes,
+// image_reference, contact_name, contact_phone, contact_email,
+// contact_address, contact_relationship, doctor_name, doctor_phone,
+// doctor_email, doctor_address and doctor_specialization. Each row with a
+// name starts a resident; a row with an empty name adds another contact to
+// the resident above it. Fields may be quoted, with "" for a quote.
+
+// Picks the parser by extension (.json or .csv)
+bool loadUsersFromFile(const std::string& filePath, std::vector<User>& users);
+
+bool parseUsersJson(const std::string& text, std::vector<User>& users);
+bool parseUsersCsv(std::istream& in, std::vector<User>& users);
+
+} // namespace hms
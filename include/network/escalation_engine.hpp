@@ -0,0 +1,92 @@
+// include/network/escalation_engine.hpp
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include "network/timer_wheel.hpp"
+
+namespace hms {
+
+// Widens an alert tier by tier until somebody responds. Each resident
+// (userId, personId) has at most one open escalation; its first tier is
+// notified when it opens, and each tier gets a timeout after which the
+// next one is notified. A response cancels the pending timeout.
+//
+// Timeouts live on a timer wheel, so opening, escalating and cancelling are
+// O(1) however many escalations are open, and the engine's thread wakes
+// once a tick only while a timeout is pending. Open escalations are kept in
+// memory only; the sends they queue go through the outbox.
+class EscalationEngine {
+public:
+    struct Options {
+        // How long each tier has to respond before the next is notified; the
+        // number of entries is the number of tiers
+        std::vector<int64_t> tierTimeoutsMs = {120000, 300000, 600000};
+        int64_t tickMs = 250;
+    };
+    
+    struct Escalation {
+        int userId = -1;
+        int personId = -1;
+        size_t tier = 0;
+        int64_t openedMs = 0;
+    };
+    
+    // Notifies a tier; false when the tier has nobody to notify, which moves
+    // on to the next at once. Called without the engine's lock held.
+    using TierCallback = std::function<bool(const Escalation&)>;
+    // The last tier timed out without a response
+    using ExhaustedCallback = std::function<void(const Escalation&)>;
+    
+    EscalationEngine(TierCallback notifyTier, ExhaustedCallback exhausted);
+    EscalationEngine(const Options& options, TierCallback notifyTier, ExhaustedCallback exhausted);
+    ~EscalationEngine();
+    
+    void start();
+    void stop();
+    
+    // Opens an escalation and notifies its first tier. False, leaving it as
+    // it is, when the resident already has one open.
+    bool open(int userId, int personId, int64_t nowMs);
+    
+    // A response came in: nothing more is escalated. False when no
+    // escalation was open.
+    bool acknowledge(int userId, int personId);
+    
+    // Tier reached by the resident's open escalation; -1 when none is open
+    int getTier(int userId, int personId) const;
+    size_t getOpenCount() const;
+    
+    // Escalates whatever has timed out by nowMs; the engine's thread calls
+    // this every tick, tests may call it directly instead of start()
+    void advance(int64_t nowMs);
+    
+private:
+    struct OpenEscalation {
+        Escalation escalation;
+        TimerWheel::TimerId timer = TimerWheel::kInvalidTimer;
+    };
+    
+    Options m_options;
+    TierCallback m_notifyTier;
+    ExhaustedCallback m_exhausted;
+    
+    TimerWheel m_wheel;
+    std::unordered_map<uint64_t, OpenEscalation> m_open;   // Keyed by resident
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+    bool m_running;
+    
+    static uint64_t residentKey(int userId, int personId);
+    void threadFunc();
+    // Notifies escalation's tier, and the ones after while they are empty,
+    // then sets the timeout of the tier that was notified
+    void notify(Escalation escalation, int64_t nowMs);
+};
+
+} // namespace hms
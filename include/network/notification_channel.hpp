@@ -0,0 +1,169 @@
+// include/network/notification_channel.hpp
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include "network/notification_transport.hpp"
+
+namespace hms {
+
+// A file sent along with a message, shared by every recipient's copy
+struct MessageAttachment {
+    std::string filename;
+    std::string contentType;
+    std::vector<unsigned char> data;
+};
+
+// One message to one recipient, whatever the channel
+struct ChannelMessage {
+    std::string recipient;     // Phone number or email address
+    std::string subject;
+    std::string body;
+    std::vector<std::shared_ptr<const MessageAttachment>> attachments;   // Sent by email only
+};
+
+struct ChannelMetrics {
+    std::string name;
+    uint64_t sent = 0;
+    uint64_t failed = 0;
+    size_t inFlight = 0;
+    size_t queued = 0;             // Waiting for one of the channel's send slots
+    double averageLatencyMs = 0.0; // From send() to the result, including the wait for a slot
+    double maxLatencyMs = 0.0;
+};
+
+// How to build a channel; which fields matter depends on the type:
+//  "sms_http"  form POST of apikey, to, from, message to url
+//  "twilio"    Twilio Messages API; username is the account SID, password the auth token
+//  "smtp"      mail through the server at url, logging in with username and
+//              password; attachments make it a multipart MIME message
+//  "webhook"   JSON POST of channel, recipient, subject and message to url,
+//              with token as a bearer token when set
+//  "capture"   keeps messages in memory, for tests and benchmarks
+struct ChannelConfig {
+    std::string type;
+    std::string url;
+    std::string username;
+    std::string password;
+    std::string from;          // Sender number or address
+    std::string token;         // Gateway API key, or the webhook's bearer token
+    size_t maxConcurrent = 8;
+};
+
+// A way of delivering messages. Each channel has its own limit on sends in
+// flight, with the rest queued behind it, and its own metrics, so a slow
+// SMTP relay only ever holds the email channel's slots and SMS keeps going.
+// Thread-safe; results come back on whatever thread the channel completes
+// on and must not block.
+class NotificationChannel {
+public:
+    using Callback = NotificationTransport::Callback;
+    
+    NotificationChannel(const std::string& name, size_t maxConcurrent);
+    virtual ~NotificationChannel() = default;
+    
+    const std::string& getName() const;
+    
+    void send(const ChannelMessage& message, Callback callback);
+    ChannelMetrics getMetrics() const;
+    
+    // Sends that would start at once rather than queue for a slot
+    size_t getFreeSlots() const;
+    
+protected:
+    // Starts one send, calling done exactly once when it has finished
+    virtual void deliver(const ChannelMessage& message, Callback done) = 0;
+    
+private:
+    struct Pending {
+        ChannelMessage message;
+        Callback callback;
+        std::chrono::steady_clock::time_point submitted;
+    };
+    
+    std::string m_name;
+    size_t m_maxConcurrent;
+    
+    mutable std::mutex m_mutex;
+    std::deque<Pending> m_pending;
+    size_t m_inFlight;
+    uint64_t m_sent;
+    uint64_t m_failed;
+    double m_totalLatencyMs;
+    double m_maxLatencyMs;
+    
+    void start(Pending pending);
+    void finish(std::chrono::steady_clock::time_point submitted, bool success);
+};
+
+// Creates a channel from its configuration; null, with a message, when the
+// type is unknown or a required field is missing
+std::unique_ptr<NotificationChannel> createNotificationChannel(const std::string& name, const ChannelConfig& config,
+                                                               NotificationTransport& transport);
+
+// The message an SMTP channel sends: plain text, or multipart MIME with the
+// attachments base64-encoded after the text
+std::string buildMailPayload(const std::string& from, const ChannelMessage& message);
+
+class SmsHttpChannel : public NotificationChannel {
+public:
+    SmsHttpChannel(const std::string& name, const ChannelConfig& config, NotificationTransport& transport);
+    
+protected:
+    void deliver(const ChannelMessage& message, Callback done) override;
+    
+private:
+    ChannelConfig m_config;
+    NotificationTransport& m_transport;
+    bool m_twilio;
+};
+
+class SmtpChannel : public NotificationChannel {
+public:
+    SmtpChannel(const std::string& name, const ChannelConfig& config, NotificationTransport& transport);
+    
+protected:
+    void deliver(const ChannelMessage& message, Callback done) override;
+    
+private:
+    ChannelConfig m_config;
+    NotificationTransport& m_transport;
+};
+
+class WebhookChannel : public NotificationChannel {
+public:
+    WebhookChannel(const std::string& name, const ChannelConfig& config, NotificationTransport& transport);
+    
+protected:
+    void deliver(const ChannelMessage& message, Callback done) override;
+    
+private:
+    ChannelConfig m_config;
+    NotificationTransport& m_transport;
+};
+
+// Sends nothing: keeps each message and reports success at once, or
+// failure while set to fail
+class CaptureChannel : public NotificationChannel {
+public:
+    CaptureChannel(const std::string& name, size_t maxConcurrent = 8);
+    
+    std::vector<ChannelMessage> getMessages() const;
+    void clear();
+    void setFailing(bool failing);
+    
+protected:
+    void deliver(const ChannelMessage& message, Callback done) override;
+    
+private:
+    mutable std::mutex m_messagesMutex;
+    std::vector<ChannelMessage> m_messages;
+    bool m_failing;
+};
+
+} // namespace hms
@@ -0,0 +1,118 @@
+// include/network/notification_coalescer.hpp
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <atomic>
+#include "database/notification_outbox.hpp"
+
+namespace hms {
+
+// Classic token bucket: holds up to burst tokens, refilled at a steady rate
+class TokenBucket {
+public:
+    TokenBucket(double perMinute, double burst);
+    
+    bool tryTake(int64_t nowMs);
+    // When a token will be available with ahead others already waiting for
+    // one; nowMs if it is available now
+    int64_t nextTokenMs(int64_t nowMs, size_t ahead = 0);
+    
+private:
+    double m_perMs;
+    double m_capacity;
+    double m_tokens;
+    int64_t m_lastRefillMs;
+    
+    void refill(int64_t nowMs);
+};
+
+// Turns claimed outbox entries into the sends actually made. A recipient
+// shared by several residents (a nurse, a facility desk) would otherwise get
+// one message per resident for a single event, so sends are keyed by
+// channel and recipient address:
+//  - every alert goes out as soon as it is due; alerts due together for the
+//    same recipient go out merged into one message, but nothing is held
+//    back to wait for more,
+//  - a message identical to one the recipient got within the window is
+//    suppressed; while that message is still being sent, the repeat is held
+//    and only settled once the send succeeds, or sent again if it fails,
+//  - each channel has a token bucket; sends beyond it are deferred, never
+//    dropped, so a gateway's rate limit is not tripped during a burst.
+// Deferral happens through the outbox, so nothing waiting is lost on a
+// crash. Not thread-safe apart from getStats(); the notification thread is
+// its only user.
+class NotificationCoalescer {
+public:
+    struct Options {
+        int64_t windowMs = 30000;    // How long a message suppresses its repeats
+        double smsPerMinute = 60;
+        double smsBurst = 30;
+        double emailPerMinute = 120;
+        double emailBurst = 60;
+    };
+    
+    struct Stats {
+        uint64_t sends = 0;          // Messages handed to the transport
+        uint64_t merged = 0;         // Alerts folded into another alert's message
+        uint64_t suppressed = 0;     // Duplicates settled by another send of the same message
+        uint64_t rateLimited = 0;    // Sends deferred by a token bucket
+    };
+    
+    // One message to one recipient, carrying one or more outbox entries
+    struct Send {
+        OutboxEntry message;             // Merged subject and text; id of the first part
+        std::vector<OutboxEntry> parts;
+    };
+    
+    struct Plan {
+        std::vector<Send> sends;
+        std::vector<OutboxEntry> suppressed;   // Repeats of a delivered message; settle as delivered
+        std::vector<OutboxEntry> deferred;     // Reschedule at their nextAttemptMs
+    };
+    
+    NotificationCoalescer();
+    NotificationCoalescer(const Options& options);
+    
+    // Groups due entries by recipient and applies suppression and rate limits
+    Plan plan(const std::vector<OutboxEntry>& due, int64_t nowMs);
+    
+    // The send of one part finished. Returns the repeats held for it: on
+    // success they are delivered too; on failure the message no longer counts
+    // as received, and they must go out again.
+    std::vector<OutboxEntry> complete(const OutboxEntry& part, bool success);
+    
+    Stats getStats() const;
+    
+private:
+    struct RecentMessage {
+        size_t hash;                     // Of subject and text
+        int64_t sentMs;
+        bool delivered;                  // False while the send is in flight
+        std::vector<OutboxEntry> held;   // Repeats waiting for the send's result
+    };
+    
+    struct RecipientState {
+        std::vector<RecentMessage> recentMessages;
+    };
+    
+    Options m_options;
+    TokenBucket m_smsBucket;
+    TokenBucket m_emailBucket;
+    std::map<std::string, RecipientState> m_recipients;
+    int64_t m_lastPruneMs;
+    
+    std::atomic<uint64_t> m_sends;
+    std::atomic<uint64_t> m_merged;
+    std::atomic<uint64_t> m_suppressed;
+    std::atomic<uint64_t> m_rateLimited;
+    
+    static std::string recipientKey(OutboxChannel channel, const std::string& recipient);
+    static size_t contentHash(const OutboxEntry& entry);
+    static OutboxEntry mergeParts(const std::vector<OutboxEntry>& parts);
+    static void hold(RecentMessage& message, const OutboxEntry& entry);
+    void prune(int64_t nowMs);
+};
+
+} // namespace hms
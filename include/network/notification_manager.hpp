@@ -4,15 +4,24 @@
 #include <string>
 #include <vector>
 #include <map>
-#include <queue>
+#include <set>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
 #include <atomic>
 #include <chrono>
 #include <functional>
+#include <memory>
 #include "database/user_database.hpp"
+#include "database/event_log.hpp"
+#include "database/notification_outbox.hpp"
+#include "network/notification_transport.hpp"
+#include "network/notification_channel.hpp"
+#include "network/snapshot_encoder.hpp"
+#include "network/notification_coalescer.hpp"
+#include "network/escalation_engine.hpp"
 #include "detection/fall_detector.hpp"
+#include "analytics/activity_rules.hpp"
 
 namespace hms {
 
@@ -28,6 +37,7 @@ enum class NotificationStatus {
 struct NotificationMessage {
     int userId;
     int personId;
+    std::string subject;
     std::string message;
     std::chrono::system_clock::time_point timestamp;
     NotificationStatus status;
@@ -35,17 +45,48 @@ struct NotificationMessage {
     std::chrono::system_clock::time_point responseTimestamp;
 };
 
+// Alerts escalate through these tiers until somebody responds
+enum class EscalationTier {
+    PRIMARY_CONTACT,      // First emergency contact
+    SECONDARY_CONTACTS,   // The other emergency contacts
+    FAMILY_DOCTOR
+};
+
 class NotificationManager {
 public:
-    NotificationManager(UserDatabase* userDb);
+    // Unsent notifications are kept in the outbox database until delivered.
+    // Escalation timeouts are taken per tier, in EscalationTier order.
+    NotificationManager(UserDatabase* userDb, const std::string& outboxPath = "hms_outbox.db",
+                        const NotificationOutbox::Options& outboxOptions = NotificationOutbox::Options(),
+                        const NotificationCoalescer::Options& coalescerOptions = NotificationCoalescer::Options(),
+                        const EscalationEngine::Options& escalationOptions = EscalationEngine::Options(),
+                        const SnapshotEncoder::Options& snapshotOptions = SnapshotEncoder::Options());
     ~NotificationManager();
     
     void initialize();
     void shutdown();
     
-    // Add a fall event to be notified
+    // Add a fall event to be notified; its frame snapshot, if any, is
+    // attached to the emails as a JPEG
     void notifyFallEvent(const FallEvent& fallEvent, int userId);
     
+    // Add an inactivity or wandering alert to be notified
+    void notifyActivityAlert(const ActivityAlert& alert, int userId);
+    
+    // A reply from a contact: settles the alert and stops it escalating.
+    // False when the resident has no alert to respond to.
+    bool recordResponse(int userId, int personId, const std::string& message,
+                        const std::string& responder = "");
+    
+    // A text message from a contact's number answers every unanswered alert
+    // sent to it; false when there was none
+    bool recordSmsReply(const std::string& fromNumber, const std::string& text);
+    
+    // A provider's delivery report ("delivered", "read", "failed", ...) for
+    // messages sent to a number; false when no alert was sent to it
+    bool recordDeliveryReport(const std::string& toNumber, const std::string& status,
+                              const std::string& error = "");
+    
     // Check for responses
     bool hasResponse(int userId, int personId);
     NotificationMessage getLatestResponse(int userId, int personId);
@@ -54,37 +95,96 @@ public:
     using ResponseCallback = std::function<void(const NotificationMessage&)>;
     void registerResponseCallback(ResponseCallback callback);
     
+    // Messages sent, and alerts merged, suppressed or rate limited on the way
+    NotificationCoalescer::Stats getDeliveryStats() const;
+    
+    // The channel that delivers to phone numbers (SMS) or email addresses;
+    // set before initialize(). A null channel leaves that kind of address
+    // unused. Placeholder SMS-over-HTTP and SMTP channels are set until then.
+    void setChannel(OutboxChannel kind, std::shared_ptr<NotificationChannel> channel);
+    bool configureChannel(OutboxChannel kind, const ChannelConfig& config);
+    std::vector<ChannelMetrics> getChannelMetrics() const;
+    
+    // Record alerts, sends and responses; the log is optional and may be set
+    // after initialize()
+    void setEventLog(EventLog* eventLog);
+    
 private:
     UserDatabase* m_userDb;
+    std::atomic<EventLog*> m_eventLog;
     std::atomic<bool> m_running;
     std::thread m_notificationThread;
-    std::thread m_responseCheckThread;
     
-    std::queue<NotificationMessage> m_notificationQueue;
+    // Handoff to the notification thread, guarded by m_queueMutex
+    std::vector<OutboxEntry> m_queuedSends;
+    std::vector<OutboxResult> m_sendResults;
+    std::vector<std::pair<std::pair<int, int>, cv::Mat>> m_queuedSnapshots;   // Encoded by the notification thread
+    std::vector<std::pair<int, int>> m_closedAlerts;    // Escalations that ran out, from the engine's thread
     std::mutex m_queueMutex;
     std::condition_variable m_queueCV;
     
+    std::string m_outboxPath;
+    NotificationOutbox::Options m_outboxOptions;
+    std::unique_ptr<NotificationOutbox> m_outbox;   // Notification thread only
+    NotificationCoalescer m_coalescer;              // Notification thread only, apart from stats
+    
+    // Sends still unsettled per (userId, personId); notification thread only
+    struct Delivery {
+        int remaining = 0;
+        bool anySent = false;     // Only emergency contacts count
+    };
+    std::map<std::pair<int, int>, Delivery> m_deliveries;
+    std::set<std::pair<int, int>> m_exhaustedAlerts;    // Still settling sends; notification thread only
+    
+    // Each alert's encoded snapshot, attached to its emails; notification thread only
+    SnapshotEncoder m_snapshotEncoder;
+    std::map<std::pair<int, int>, std::shared_ptr<const MessageAttachment>> m_attachments;
+    
     std::map<std::pair<int, int>, NotificationMessage> m_activeNotifications;
+    // Alerts sent to each phone number, so replies can be matched to them;
+    // an alert is dropped once answered, or once its escalation has run out
+    // and its sends have settled
+    std::map<std::string, std::set<std::pair<int, int>>> m_alertsByPhone;
     std::mutex m_activeNotificationsMutex;
     
     std::vector<ResponseCallback> m_responseCallbacks;
     std::mutex m_callbackMutex;
     
-    // SMS/Email configuration
-    std::string m_smsApiKey;
-    std::string m_emailSmtpServer;
-    std::string m_emailUsername;
-    std::string m_emailPassword;
+    NotificationTransport m_transport;
+    std::map<OutboxChannel, std::shared_ptr<NotificationChannel>> m_channels;   // Fixed once running
+    EscalationEngine m_escalations;
     
+    void queueNotification(const User& user, int personId, const std::string& subject,
+                           const std::string& message, const cv::Mat& snapshot = cv::Mat());
     void notificationThreadFunc();
-    void responseCheckThreadFunc();
+    void encodeSnapshots(std::vector<std::pair<std::pair<int, int>, cv::Mat>>& snapshots);
+    
+    // Escalation callbacks; false when the tier has nobody to notify
+    bool notifyTier(const EscalationEngine::Escalation& escalation);
+    void escalationExhausted(const EscalationEngine::Escalation& escalation);
+    bool queueTier(const User& user, const NotificationMessage& notification, EscalationTier tier);
+    
+    size_t channelSlots(OutboxChannel kind) const;
+    void dispatch(const NotificationCoalescer::Plan& plan, std::map<int64_t, OutboxEntry>& inFlight,
+                  int64_t nowMs);
+    void sendMessage(const NotificationCoalescer::Send& send);
+    void settleDuplicates(const std::vector<OutboxEntry>& duplicates, int64_t nowMs);
+    void recordSendResults(const std::vector<OutboxResult>& results,
+                           std::map<int64_t, OutboxEntry>& inFlight, int64_t nowMs);
+    void settleSend(const OutboxEntry& entry, OutboxOutcome outcome, const std::string& error,
+                    const std::string& sentStatus);
+    void setNotificationStatus(const std::pair<int, int>& key, NotificationStatus status);
+    void logSendEvent(EventType type, const OutboxEntry& entry, const std::string& status,
+                      const std::string& detail);
     
-    bool sendSmsNotification(const std::string& phoneNumber, const std::string& message);
-    bool sendEmailNotification(const std::string& email, const std::string& subject, const std::string& message);
+    std::vector<std::pair<int, int>> findAlertsByPhone(const std::string& number);
+    // Drops the alerts released selects from m_alertsByPhone; the caller
+    // holds m_activeNotificationsMutex
+    void releasePhones(const std::function<bool(const std::pair<int, int>&)>& released);
+    void processResponse(const NotificationMessage& response, const std::string& responder);
     
-    // Simulate response for testing (in real implementation, this would be an API endpoint)
-    bool checkForResponses();
-    void processResponse(const NotificationMessage& response);
+    void logEvent(EventType type, const NotificationMessage& notification, const std::string& recipient);
+    void logEvent(const EventRecord& event);
 };
 
 } // namespace hms
@@ -0,0 +1,137 @@
+// include/network/notification_transport.hpp
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+#include <curl/curl.h>
+
+namespace hms {
+
+struct TransportResult {
+    bool success = false;
+    long responseCode = 0;     // HTTP status, or the last SMTP reply code
+    std::string error;         // Set when success is false
+    double elapsedMs = 0.0;    // From submission to completion
+};
+
+// Sends SMS gateway requests and emails concurrently from a few threads,
+// each driving a curl multi handle. Connections are cached per thread and
+// DNS lookups and TLS sessions across all of them, so a fan-out to many
+// contacts pays for one handshake per connection rather than one per
+// message. Requests are asynchronous; each has its own timeout and reports
+// through a callback.
+//
+// One thread would do for HTTP, but curl waits for an SMTP server's reply to
+// the end of a message without returning to the multi loop, stalling every
+// other transfer on that handle; several workers keep emails concurrent.
+// Callbacks run on a worker thread and must not block.
+class NotificationTransport {
+public:
+    struct Options {
+        int workerCount = 8;
+        long maxConnections = 8;          // Per worker, across all hosts
+        long maxConnectionsPerHost = 2;   // Per worker; further requests to a host wait for one
+        long connectTimeoutMs = 5000;
+        long requestTimeoutMs = 15000;    // Whole request, including any wait for a connection
+        bool requireTls = true;           // Refuse SMTP servers without STARTTLS
+    };
+    
+    using Callback = std::function<void(const TransportResult& result)>;
+    
+    NotificationTransport();
+    NotificationTransport(const Options& options);
+    ~NotificationTransport();
+    
+    // Expects curl_global_init to have been called
+    bool start();
+    // Requests still queued or in flight fail with "transport stopped"
+    void stop();
+    
+    // POSTs form fields (already URL-encoded) and succeeds on a 2xx status
+    void postForm(const std::string& url, const std::string& fields, Callback callback,
+                  long timeoutMs = 0);
+    
+    // POSTs a body with extra headers ("Name: value"), using basic auth when
+    // a username is given; succeeds on a 2xx status
+    void post(const std::string& url, const std::vector<std::string>& headers, const std::string& body,
+              const std::string& username, const std::string& password, Callback callback,
+              long timeoutMs = 0);
+    
+    // Sends a complete message (headers, blank line, body) to one recipient;
+    // the payload is streamed to the server from the request's own buffer
+    void sendMail(const std::string& smtpUrl, const std::string& username, const std::string& password,
+                  const std::string& from, const std::string& to, std::string payload,
+                  Callback callback, long timeoutMs = 0);
+    
+    // Blocks until every request submitted so far has completed
+    void waitIdle();
+    
+    size_t getInFlightCount() const;
+    uint64_t getCompletedCount() const;
+    
+private:
+    struct Request {
+        bool isMail = false;
+        std::string url;
+        std::string body;          // Request body, or the message for SMTP
+        std::vector<std::string> headers;
+        std::string username;
+        std::string password;
+        std::string mailFrom;
+        std::string mailTo;
+        long timeoutMs = 0;
+        Callback callback;
+        
+        // Transfer state, owned by the transport thread
+        std::chrono::steady_clock::time_point submitted;
+        CURL* easy = nullptr;
+        curl_slist* list = nullptr;    // Mail recipients, or HTTP headers
+        size_t bodyOffset = 0;
+        std::string response;
+        char errorBuffer[CURL_ERROR_SIZE] = {0};
+    };
+    
+    struct Worker {
+        std::thread thread;
+        CURLM* multi = nullptr;
+        std::deque<Request*> pending;      // Submitted, not yet given to curl; guarded by m_mutex
+        size_t outstanding = 0;            // Pending plus in flight; guarded by m_mutex
+        std::vector<Request*> active;      // Worker thread only
+        std::vector<CURL*> idleHandles;    // Worker thread only
+    };
+    
+    Options m_options;
+    CURLSH* m_share;
+    std::mutex m_shareLocks[CURL_LOCK_DATA_LAST];
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<bool> m_running;
+    
+    size_t m_outstanding;      // Across all workers
+    mutable std::mutex m_mutex;
+    std::condition_variable m_idleCondition;
+    
+    std::atomic<size_t> m_inFlight;
+    std::atomic<uint64_t> m_completedCount;
+    
+    void submit(Request* request);
+    void workerThreadFunc(Worker* worker);
+    void startTransfer(Worker& worker, Request* request);
+    void finishTransfer(Worker& worker, Request* request, CURLcode code);
+    void complete(Worker* worker, Request* request, const TransportResult& result);
+    
+    static void lockShare(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+    static void unlockShare(CURL* handle, curl_lock_data data, void* userptr);
+    
+    static size_t writeCallback(char* data, size_t size, size_t count, void* userdata);
+    static size_t readCallback(char* buffer, size_t size, size_t count, void* userdata);
+};
+
+} // namespace hms
@@ -0,0 +1,94 @@
+// include/network/response_webhook.hpp
+#pragma once
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <boost/asio.hpp>
+
+namespace hms {
+
+// A text message a contact sent back, as forwarded by the SMS provider
+struct SmsReply {
+    std::string from;        // The contact's number
+    std::string to;          // Our number
+    std::string text;
+    std::string messageId;
+};
+
+// A provider's delivery report for a message we sent
+struct SmsStatusReport {
+    std::string to;          // The contact's number
+    std::string status;      // Lower case, in the provider's terms: "delivered", "undelivered", ...
+    std::string messageId;
+    std::string error;       // Provider's error code, if it gave one
+};
+
+// Small embedded HTTP server the SMS provider calls back:
+//  POST /sms/reply    a contact replied
+//  POST /sms/status   a delivery report
+// Bodies may be form-encoded, as Twilio and most gateways send them
+// (From, To, Body, MessageSid, MessageStatus, ErrorCode), or a JSON object
+// with the same fields in lower case (from, to, text, message_id, status,
+// error). When a token is set, callers must pass it as ?token= or in an
+// X-Webhook-Token header. A token is required to listen anywhere but on a
+// loopback address.
+//
+// Plain HTTP on one thread; put a TLS-terminating proxy in front of it to
+// take callbacks from the internet. Handlers run on that thread as each
+// request arrives and should not block.
+class ResponseWebhook {
+public:
+    struct Options {
+        std::string address = "127.0.0.1";
+        unsigned short port = 8088;     // 0 picks a free port
+        std::string token;
+        size_t maxBodyBytes = 16384;
+    };
+    
+    struct Stats {
+        uint64_t replies = 0;
+        uint64_t statusReports = 0;
+        uint64_t rejected = 0;          // Bad path, token or payload
+    };
+    
+    using ReplyHandler = std::function<void(const SmsReply&)>;
+    using StatusHandler = std::function<void(const SmsStatusReport&)>;
+    
+    ResponseWebhook(ReplyHandler onReply, StatusHandler onStatus);
+    ResponseWebhook(const Options& options, ReplyHandler onReply, StatusHandler onStatus);
+    ~ResponseWebhook();
+    
+    bool start();
+    void stop();
+    
+    // The port listened on, once started
+    unsigned short getPort() const;
+    Stats getStats() const;
+    
+private:
+    class Session;
+    
+    Options m_options;
+    ReplyHandler m_onReply;
+    StatusHandler m_onStatus;
+    
+    boost::asio::io_context m_io;
+    boost::asio::ip::tcp::acceptor m_acceptor;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    unsigned short m_port;
+    
+    std::atomic<uint64_t> m_replies;
+    std::atomic<uint64_t> m_statusReports;
+    std::atomic<uint64_t> m_rejected;
+    
+    void accept();
+    // Parses and dispatches one request; returns the HTTP status to answer with
+    int handleRequest(const std::string& method, const std::string& target, const std::string& contentType,
+                      const std::string& tokenHeader, const std::string& body);
+};
+
+} // namespace hms
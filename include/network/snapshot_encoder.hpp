@@ -0,0 +1,41 @@
+// include/network/snapshot_encoder.hpp
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <opencv2/opencv.hpp>
+#include "network/notification_channel.hpp"
+
+namespace hms {
+
+// Compresses an alert's frame snapshot into a JPEG small enough to attach to
+// an email without holding up its send. The image is scaled down to
+// maxDimension on its longest side, then quality is lowered step by step
+// and, if that is not enough, the size halved until it fits maxBytes.
+// Stateless; safe to call from any thread.
+class SnapshotEncoder {
+public:
+    struct Options {
+        int maxDimension = 640;          // Longest side, in pixels
+        int quality = 80;                // JPEG quality to start from
+        int minQuality = 40;
+        size_t maxBytes = 100 * 1024;
+    };
+    
+    SnapshotEncoder();
+    SnapshotEncoder(const Options& options);
+    
+    // Null, with a message, for an empty image or one that cannot be
+    // brought under maxBytes
+    std::shared_ptr<const MessageAttachment> encode(const cv::Mat& image, const std::string& filename) const;
+    
+    const Options& getOptions() const;
+    
+private:
+    Options m_options;
+    
+    bool encodeJpeg(const cv::Mat& image, int quality, std::vector<unsigned char>& jpeg) const;
+};
+
+} // namespace hms
@@ -0,0 +1,64 @@
+// include/network/timer_wheel.hpp
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace hms {
+
+// Hashed timer wheel: time is cut into ticks and each timer hangs off the
+// slot for its due tick, in a doubly linked list. Scheduling and cancelling
+// are O(1) whatever the number of timers; advancing visits only the slots
+// of the ticks that passed. Timers further out than one turn of the wheel
+// stay in their slot and are skipped until their turn comes round.
+//
+// Nodes live in a pool and are reused; an id carries the node's generation,
+// so cancelling a timer that already fired is a harmless no-op.
+// Not thread-safe.
+class TimerWheel {
+public:
+    using TimerId = uint64_t;
+    static constexpr TimerId kInvalidTimer = 0;
+    
+    // startMs is the clock reading the wheel starts from
+    TimerWheel(int64_t tickMs = 100, size_t slotCount = 512, int64_t startMs = 0);
+    
+    // Fires no earlier than dueMs, at the first advance() past its tick;
+    // a time already passed fires at the next advance()
+    TimerId schedule(int64_t dueMs, uint64_t payload);
+    bool cancel(TimerId id);
+    
+    // Appends the payloads of timers due by nowMs to fired, in tick order
+    // unless more than a whole turn of the wheel has passed
+    void advance(int64_t nowMs, std::vector<uint64_t>& fired);
+    
+    size_t size() const;
+    int64_t getTickMs() const;
+    
+private:
+    static constexpr uint32_t kNone = UINT32_MAX;
+    
+    struct Node {
+        int64_t dueTick = 0;
+        uint64_t payload = 0;
+        uint32_t prev = kNone;
+        uint32_t next = kNone;
+        uint32_t generation = 1;
+        bool active = false;
+    };
+    
+    int64_t m_tickMs;
+    std::vector<uint32_t> m_slots;     // Head node of each slot's list
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_freeNodes;
+    int64_t m_currentTick;             // Every tick before this one has been processed
+    size_t m_size;
+    
+    void link(uint32_t index);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    void fireSlot(size_t slot, int64_t upToTick, std::vector<uint64_t>& fired);
+};
+
+} // namespace hms
@@ -0,0 +1,35 @@
+// include/ui/camera_view.hpp
+#pragma once
+
+#include <QWidget>
+#include <QImage>
+#include <QString>
+#include <QSize>
+
+namespace hms {
+
+// Live camera view. Draws images that were already scaled to fit it, so a
+// repaint is a single blit; announces its size so they can be.
+class CameraView : public QWidget {
+    Q_OBJECT
+public:
+    explicit CameraView(const QString& placeholder, QWidget *parent = nullptr);
+    
+    void setImage(const QImage& image);
+    
+    // Logical pixels available to images, inside the border
+    QSize imageArea() const;
+    
+signals:
+    void imageAreaChanged(const QSize& size);
+    
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    
+private:
+    QString m_placeholder;
+    QImage m_image;
+};
+
+} // namespace hms
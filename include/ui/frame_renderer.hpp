@@ -0,0 +1,59 @@
+// include/ui/frame_renderer.hpp
+#pragma once
+
+#include <QImage>
+#include <QSize>
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "core/frame_pool.hpp"
+
+namespace hms {
+
+// Turns processed frames into display-ready images on its own thread: scaled
+// to the live view, kept in OpenCV's BGR order and wrapped without a copy, so
+// the GUI thread only has to draw them. Only the newest frame is rendered;
+// frames submitted while one is being scaled replace each other. An image
+// shares its pixels with a pooled buffer, which goes back to the pool once
+// Qt drops the last copy of the image.
+class FrameRenderer {
+public:
+    // Called on the renderer thread
+    using ImageCallback = std::function<void(size_t cameraIndex, const QImage& image)>;
+    
+    explicit FrameRenderer(ImageCallback onImage);
+    ~FrameRenderer();
+    
+    void start();
+    void stop();
+    
+    // Thread-safe, and cheap enough for the processing loop
+    void submit(size_t cameraIndex, const FrameHandle& frame);
+    
+    // Area the images must fit, in logical pixels; the last frame is
+    // rendered again at the new size
+    void setTargetSize(const QSize& size, qreal devicePixelRatio);
+    
+private:
+    ImageCallback m_onImage;
+    FramePool m_pool;
+    
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+    bool m_running;
+    
+    FrameHandle m_pendingFrame;    // Next to render, if any
+    FrameHandle m_lastFrame;       // Kept to re-render on resize
+    size_t m_lastCamera;
+    QSize m_targetSize;
+    qreal m_devicePixelRatio;
+    
+    void threadFunc();
+    QImage render(const FrameHandle& frame, const QSize& targetSize, qreal devicePixelRatio);
+};
+
+} // namespace hms
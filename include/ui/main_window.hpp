@@ -41,9 +41,15 @@
 #include <QDialogButtonBox>
 #include <QTextEdit>
 #include <QSystemTrayIcon>
+#include <QElapsedTimer>
+
+#include <atomic>
+#include <memory>
 
 #include <opencv2/opencv.hpp>
 #include "core/application.hpp"
+#include "ui/camera_view.hpp"
+#include "ui/frame_renderer.hpp"
 
 namespace hms {
 
@@ -74,6 +80,7 @@ private slots:
     // Alert management
     void onAlertReceived(int userId, int personId);
     void onAlertResponded(int userId, int personId, const std::string& response);
+    void onExportAlertsClicked();
     
     // Settings slots
     void onFallDetectionToggled(bool checked);
@@ -88,7 +95,6 @@ private slots:
     
 private:
     Application* m_app;
-    QTimer* m_updateTimer;
     
     // UI components
     QWidget* m_centralWidget;
@@ -98,7 +104,7 @@ private:
     // Camera tab
     QWidget* m_cameraTab;
     QComboBox* m_cameraSelector;
-    QLabel* m_cameraView;
+    CameraView* m_cameraView;
     QPushButton* m_addCameraBtn;
     QPushButton* m_removeCameraBtn;
     QCheckBox* m_fallDetectionChk;
@@ -108,6 +114,11 @@ private:
     // User tab
     QWidget* m_userTab;
     QTableWidget* m_userTable;
+    QLineEdit* m_userSearchEdit;
+    QTimer* m_userSearchTimer;
+    QPushButton* m_prevUserPageBtn;
+    QPushButton* m_nextUserPageBtn;
+    QLabel* m_userPageLabel;
     QPushButton* m_addUserBtn;
     QPushButton* m_editUserBtn;
     QPushButton* m_deleteUserBtn;
@@ -115,6 +126,9 @@ private:
     // Alert tab
     QWidget* m_alertTab;
     QTableWidget* m_alertTable;
+    QComboBox* m_alertUserFilter;
+    QComboBox* m_alertPeriodCombo;
+    QPushButton* m_exportAlertsBtn;
     
     // Dialogs
     QDialog* m_addCameraDialog;
@@ -135,12 +149,31 @@ private:
     
     // State
     int m_selectedUserId;
+    int m_userPage;
+    
+    // Live view: frames of the camera on show go from the processing thread
+    // to the renderer, which scales them to the view; the newest image is
+    // then handed to the GUI thread. One repaint is queued at a time and
+    // runs at most once per display refresh; images arriving meanwhile
+    // replace the pending one.
+    std::unique_ptr<FrameRenderer> m_frameRenderer;
+    QMutex m_pendingImageMutex;
+    QImage m_pendingImage;
+    int m_pendingCamera;
+    bool m_frameRepaintQueued;
+    std::atomic<int> m_displayedCamera;
+    QElapsedTimer m_lastRepaint;
+    int m_refreshIntervalMs;
     
     // Helper methods
-    void updateCameraView(const cv::Mat& frame);
     void updateUserTable();
     void updateAlertTable();
+    void updateAlertUserFilter();
+    std::vector<EventRecord> queryAlertHistory();
     void updateCameraFeeds();
+    void queueFrame(size_t cameraIndex, const FrameHandle& frame);
+    void queueImage(size_t cameraIndex, const QImage& image);
+    void presentFrame();
     
     // UI creation methods
     void createMenus();
@@ -152,7 +185,6 @@ private:
     void createSettingsDialog();
     
     // Utility methods
-    QImage matToQImage(const cv::Mat& mat);
     void showAlert(const QString& title, const QString& message);
 };
 
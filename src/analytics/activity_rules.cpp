@@ -0,0 +1,299 @@
+#include "analytics/activity_rules.hpp"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace hms {
+
+static const int64_t kMinuteMs = 60 * 1000;
+static const int64_t kDayMs = 24 * 60 * kMinuteMs;
+
+static int64_t floorDiv(int64_t value, int64_t divisor) {
+    int64_t quotient = value / divisor;
+    return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+static size_t cameraOf(uint64_t trackKey) {
+    return static_cast<size_t>(trackKey >> 32);
+}
+
+static int personOf(uint64_t trackKey) {
+    return static_cast<int>(trackKey & 0xffffffffu);
+}
+
+static bool isAllDay(const ActivityRule& rule) {
+    return rule.startMinute % (24 * 60) == rule.endMinute % (24 * 60);
+}
+
+ActivityRuleEngine::ActivityRuleEngine(const ZoneMap& zones, const Options& options)
+    : m_zones(zones), m_options(options), m_zoneRules(ZoneMap::MAX_ZONES) {
+}
+
+ActivityRuleEngine::~ActivityRuleEngine() {
+}
+
+int ActivityRuleEngine::addRule(const ActivityRule& rule) {
+    if (rule.type != ActivityRule::Type::INACTIVITY &&
+        (rule.zoneId < 0 || rule.zoneId >= ZoneMap::MAX_ZONES)) {
+        std::cerr << "Activity rule " << rule.name << " needs a zone" << std::endl;
+        return -1;
+    }
+    if (rule.type == ActivityRule::Type::INACTIVITY && rule.durationMs <= 0) {
+        std::cerr << "Activity rule " << rule.name << " needs a duration" << std::endl;
+        return -1;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    size_t index = m_rules.size();
+    RuleState state;
+    state.rule = rule;
+    m_rules.push_back(state);
+    if (rule.type == ActivityRule::Type::INACTIVITY) {
+        m_inactivityRules.push_back(index);
+    } else {
+        m_zoneRules[rule.zoneId].push_back(index);
+    }
+    return static_cast<int>(index);
+}
+
+size_t ActivityRuleEngine::getRuleCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_rules.size();
+}
+
+void ActivityRuleEngine::addObservation(size_t cameraIndex, const MovementSample& sample) {
+    cv::Point point = ZoneMap::referencePoint(sample.box);
+    uint32_t zones = m_zones.lookup(cameraIndex, point);
+    uint64_t key = (static_cast<uint64_t>(cameraIndex) << 32) | static_cast<uint32_t>(sample.trackId);
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    auto it = m_tracks.find(key);
+    bool moved = it == m_tracks.end();
+    if (moved) {
+        it = m_tracks.emplace(key, TrackState{point, 0, sample.userId, sample.timestampMs}).first;
+    }
+    
+    TrackState& track = it->second;
+    if (sample.userId >= 0) {
+        track.userId = sample.userId;
+    }
+    
+    double dx = point.x - track.anchor.x;
+    double dy = point.y - track.anchor.y;
+    if (std::sqrt(dx * dx + dy * dy) >= m_options.movementThresholdPx) {
+        moved = true;
+    }
+    if (moved) {
+        track.anchor = point;
+    }
+    
+    uint32_t entered = zones & ~track.zones;
+    uint32_t exited = track.zones & ~zones;
+    track.zones = zones;
+    track.lastSeenMs = sample.timestampMs;
+    
+    if (moved) {
+        for (size_t index : m_inactivityRules) {
+            RuleState& state = m_rules[index];
+            const ActivityRule& rule = state.rule;
+            if (rule.userId != ANY_USER && rule.userId != track.userId) {
+                continue;
+            }
+            if (rule.zoneId < 0 || (zones & (1u << rule.zoneId))) {
+                state.lastActivityMs = sample.timestampMs;
+                state.inactivityAlerted = false;
+            }
+        }
+    }
+    
+    if (entered != 0 || exited != 0) {
+        applyTransitions(key, track.userId, entered, exited, sample.timestampMs);
+    }
+}
+
+void ActivityRuleEngine::applyTransitions(uint64_t trackKey, int userId, uint32_t entered, uint32_t exited,
+                                          int64_t timestampMs) {
+    uint32_t changed = entered | exited;
+    while (changed != 0) {
+        int zoneId = __builtin_ctz(changed);
+        changed &= changed - 1;
+        uint32_t bit = 1u << zoneId;
+        
+        for (size_t index : m_zoneRules[zoneId]) {
+            RuleState& state = m_rules[index];
+            const ActivityRule& rule = state.rule;
+            if (rule.userId != ANY_USER && rule.userId != userId) {
+                continue;
+            }
+            
+            if (rule.type == ActivityRule::Type::ZONE_ENTER) {
+                if ((entered & bit) && isInSchedule(rule, timestampMs)) {
+                    raiseAlert(state, cameraOf(trackKey), personOf(trackKey), timestampMs,
+                               "Entered " + m_zones.getZoneName(rule.zoneId));
+                }
+            } else if (entered & bit) {
+                // Back in the zone: the same track, or the same resident
+                // under a new one, has not left after all
+                for (auto it = state.exits.begin(); it != state.exits.end();) {
+                    bool samePerson = it->first == trackKey || (userId >= 0 && it->second.userId == userId);
+                    it = samePerson ? state.exits.erase(it) : std::next(it);
+                }
+            } else {
+                // Alert only if this person does not come back within the grace period
+                state.exits.emplace(trackKey, PendingExit{timestampMs, userId});
+            }
+        }
+    }
+}
+
+void ActivityRuleEngine::evaluate(int64_t nowMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    // A track that vanished may be a detector dropout as easily as someone
+    // leaving, so it is forgotten without exiting anything. Exits it made
+    // while still seen stay pending.
+    for (auto it = m_tracks.begin(); it != m_tracks.end();) {
+        if (nowMs - it->second.lastSeenMs > m_options.trackTimeoutMs) {
+            it = m_tracks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    
+    for (auto& state : m_rules) {
+        const ActivityRule& rule = state.rule;
+        
+        if (rule.type == ActivityRule::Type::INACTIVITY) {
+            if (state.lastActivityMs < 0) {
+                state.lastActivityMs = nowMs;  // Nothing seen yet: start counting now
+                continue;
+            }
+            if (state.inactivityAlerted || !isInSchedule(rule, nowMs)) {
+                continue;
+            }
+            
+            // Only time inside the window counts
+            int64_t since = std::max(state.lastActivityMs, windowStartMs(rule, nowMs));
+            if (nowMs - since >= rule.durationMs) {
+                state.inactivityAlerted = true;
+                std::stringstream ss;
+                ss << "No movement for " << (nowMs - since) / kMinuteMs << " minutes";
+                if (rule.zoneId >= 0) {
+                    ss << " in " << m_zones.getZoneName(rule.zoneId);
+                }
+                raiseAlert(state, 0, -1, nowMs, ss.str());
+            }
+        } else if (rule.type == ActivityRule::Type::ZONE_EXIT) {
+            for (auto it = state.exits.begin(); it != state.exits.end();) {
+                int64_t outMs = nowMs - it->second.startMs;
+                if (outMs < rule.durationMs) {
+                    ++it;
+                    continue;
+                }
+                if (isInSchedule(rule, nowMs)) {
+                    std::stringstream ss;
+                    ss << "Left " << m_zones.getZoneName(rule.zoneId) << " " << outMs / kMinuteMs << " minutes ago";
+                    raiseAlert(state, cameraOf(it->first), personOf(it->first), nowMs, ss.str());
+                }
+                it = state.exits.erase(it);
+            }
+        }
+    }
+}
+
+void ActivityRuleEngine::raiseAlert(RuleState& state, size_t cameraIndex, int personId, int64_t timestampMs,
+                                    const std::string& description) {
+    if (timestampMs - state.lastAlertMs < state.rule.cooldownMs) {
+        return;
+    }
+    state.lastAlertMs = timestampMs;
+    
+    ActivityAlert alert;
+    alert.ruleName = state.rule.name;
+    alert.type = state.rule.type;
+    alert.userId = state.rule.userId;
+    alert.cameraIndex = cameraIndex;
+    alert.personId = personId;
+    alert.zoneName = m_zones.getZoneName(state.rule.zoneId);
+    alert.timestamp = std::chrono::system_clock::time_point(std::chrono::milliseconds(timestampMs));
+    alert.description = description;
+    m_newAlerts.push_back(alert);
+}
+
+std::vector<ActivityAlert> ActivityRuleEngine::getNewAlerts() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    std::vector<ActivityAlert> alerts;
+    alerts.swap(m_newAlerts);
+    return alerts;
+}
+
+bool ActivityRuleEngine::isInSchedule(const ActivityRule& rule, int64_t timestampMs) const {
+    if (isAllDay(rule)) {
+        return true;
+    }
+    
+    int64_t local = timestampMs + m_options.utcOffsetMs;
+    int minute = static_cast<int>((local - floorDiv(local, kDayMs) * kDayMs) / kMinuteMs);
+    if (rule.startMinute < rule.endMinute) {
+        return minute >= rule.startMinute && minute < rule.endMinute;
+    }
+    return minute >= rule.startMinute || minute < rule.endMinute;
+}
+
+int64_t ActivityRuleEngine::windowStartMs(const ActivityRule& rule, int64_t timestampMs) const {
+    if (isAllDay(rule)) {
+        return INT64_MIN;
+    }
+    
+    int64_t local = timestampMs + m_options.utcOffsetMs;
+    int64_t dayStart = floorDiv(local, kDayMs) * kDayMs;
+    int64_t start = dayStart + rule.startMinute * kMinuteMs;
+    if (start > local) {
+        start -= kDayMs;  // Window opened yesterday and wraps midnight
+    }
+    return start - m_options.utcOffsetMs;
+}
+
+const char* ActivityRuleEngine::typeToString(ActivityRule::Type type) {
+    switch (type) {
+        case ActivityRule::Type::INACTIVITY:
+            return "inactivity";
+        case ActivityRule::Type::ZONE_ENTER:
+            return "zone_enter";
+        case ActivityRule::Type::ZONE_EXIT:
+            return "zone_exit";
+    }
+    return "unknown";
+}
+
+bool ActivityRuleEngine::typeFromString(const std::string& name, ActivityRule::Type& type) {
+    if (name == "inactivity") {
+        type = ActivityRule::Type::INACTIVITY;
+    } else if (name == "zone_enter") {
+        type = ActivityRule::Type::ZONE_ENTER;
+    } else if (name == "zone_exit") {
+        type = ActivityRule::Type::ZONE_EXIT;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+int ActivityRuleEngine::parseTimeOfDay(const std::string& text) {
+    int hours = 0;
+    int minutes = 0;
+    char separator = 0;
+    std::istringstream in(text);
+    if (!(in >> hours >> separator >> minutes) || separator != ':' ||
+        hours < 0 || hours > 24 || minutes < 0 || minutes > 59 || hours * 60 + minutes > 24 * 60) {
+        return -1;
+    }
+    return hours * 60 + minutes;
+}
+
+} // namespace hms
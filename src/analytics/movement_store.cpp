@@ -0,0 +1,233 @@
+#include "analytics/movement_store.hpp"
+#include <algorithm>
+
+namespace hms {
+
+// Zigzag maps small negative deltas to small unsigned values so they stay
+// short once varint encoded
+static uint64_t zigzagEncode(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+static int64_t zigzagDecode(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+static void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static uint64_t getVarint(const uint8_t*& data) {
+    uint64_t value = 0;
+    int shift = 0;
+    while (*data & 0x80) {
+        value |= static_cast<uint64_t>(*data++ & 0x7F) << shift;
+        shift += 7;
+    }
+    value |= static_cast<uint64_t>(*data++) << shift;
+    return value;
+}
+
+MovementStore::MovementStore()
+    : MovementStore(Options()) {
+}
+
+MovementStore::MovementStore(const Options& options)
+    : m_options(options), m_sampleCount(0) {
+    if (m_options.chunkDurationMs <= 0) {
+        m_options.chunkDurationMs = 60 * 1000;
+    }
+    if (m_options.maxChunkSamples == 0) {
+        m_options.maxChunkSamples = 4096;
+    }
+}
+
+MovementStore::~MovementStore() {
+}
+
+void MovementStore::append(size_t cameraIndex, const MovementSample& sample) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    if (cameraIndex >= m_partitions.size()) {
+        m_partitions.resize(cameraIndex + 1);
+    }
+    
+    Chunk& chunk = openChunk(m_partitions[cameraIndex], sample.timestampMs);
+    chunk.raw[COLUMN_TIMESTAMP].push_back(sample.timestampMs);
+    chunk.raw[COLUMN_TRACK_ID].push_back(sample.trackId);
+    chunk.raw[COLUMN_USER_ID].push_back(sample.userId);
+    chunk.raw[COLUMN_X].push_back(sample.box.x);
+    chunk.raw[COLUMN_Y].push_back(sample.box.y);
+    chunk.raw[COLUMN_WIDTH].push_back(sample.box.width);
+    chunk.raw[COLUMN_HEIGHT].push_back(sample.box.height);
+    
+    chunk.minTimestampMs = std::min(chunk.minTimestampMs, sample.timestampMs);
+    chunk.maxTimestampMs = std::max(chunk.maxTimestampMs, sample.timestampMs);
+    chunk.count++;
+    m_sampleCount++;
+    
+    if (chunk.count >= m_options.maxChunkSamples) {
+        sealChunk(chunk);
+    }
+}
+
+MovementStore::Chunk& MovementStore::openChunk(Partition& partition, int64_t timestampMs) {
+    int64_t partitionStartMs = timestampMs - timestampMs % m_options.chunkDurationMs;
+    
+    if (!partition.chunks.empty()) {
+        Chunk& last = partition.chunks.back();
+        if (!last.sealed && last.partitionStartMs == partitionStartMs) {
+            return last;
+        }
+        if (!last.sealed) {
+            sealChunk(last);
+        }
+    }
+    
+    partition.chunks.emplace_back();
+    Chunk& chunk = partition.chunks.back();
+    chunk.partitionStartMs = partitionStartMs;
+    chunk.minTimestampMs = timestampMs;
+    chunk.maxTimestampMs = timestampMs;
+    chunk.count = 0;
+    chunk.sealed = false;
+    for (auto& column : chunk.raw) {
+        column.reserve(std::min<size_t>(m_options.maxChunkSamples, 256));
+    }
+    return chunk;
+}
+
+void MovementStore::sealChunk(Chunk& chunk) {
+    for (int c = 0; c < COLUMN_COUNT; c++) {
+        // Timestamps are stored relative to the partition start
+        int64_t previous = (c == COLUMN_TIMESTAMP) ? chunk.partitionStartMs : 0;
+        
+        std::vector<uint8_t>& out = chunk.encoded[c];
+        out.reserve(chunk.count * 2);
+        for (int64_t value : chunk.raw[c]) {
+            putVarint(out, zigzagEncode(value - previous));
+            previous = value;
+        }
+        out.shrink_to_fit();
+        
+        std::vector<int64_t>().swap(chunk.raw[c]);
+    }
+    chunk.sealed = true;
+}
+
+void MovementStore::decodeChunk(const Chunk& chunk,
+                                std::array<std::vector<int64_t>, COLUMN_COUNT>& columns) const {
+    for (int c = 0; c < COLUMN_COUNT; c++) {
+        int64_t previous = (c == COLUMN_TIMESTAMP) ? chunk.partitionStartMs : 0;
+        
+        columns[c].resize(chunk.count);
+        const uint8_t* data = chunk.encoded[c].data();
+        for (size_t i = 0; i < chunk.count; i++) {
+            previous += zigzagDecode(getVarint(data));
+            columns[c][i] = previous;
+        }
+    }
+}
+
+void MovementStore::expireBefore(int64_t cutoffMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    for (auto& partition : m_partitions) {
+        while (!partition.chunks.empty() && partition.chunks.front().maxTimestampMs < cutoffMs) {
+            m_sampleCount -= partition.chunks.front().count;
+            partition.chunks.pop_front();
+        }
+    }
+}
+
+void MovementStore::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_partitions.clear();
+    m_sampleCount = 0;
+}
+
+template <typename Predicate>
+std::vector<MovementSample> MovementStore::collect(size_t cameraIndex, int64_t fromMs, int64_t toMs,
+                                                   Predicate predicate) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<MovementSample> samples;
+    
+    if (cameraIndex >= m_partitions.size()) {
+        return samples;
+    }
+    
+    std::array<std::vector<int64_t>, COLUMN_COUNT> decoded;
+    for (const auto& chunk : m_partitions[cameraIndex].chunks) {
+        if (chunk.maxTimestampMs < fromMs || chunk.minTimestampMs >= toMs) {
+            continue;
+        }
+        
+        const auto* columns = &chunk.raw;
+        if (chunk.sealed) {
+            decodeChunk(chunk, decoded);
+            columns = &decoded;
+        }
+        
+        for (size_t i = 0; i < chunk.count; i++) {
+            int64_t timestampMs = (*columns)[COLUMN_TIMESTAMP][i];
+            int trackId = static_cast<int>((*columns)[COLUMN_TRACK_ID][i]);
+            if (timestampMs < fromMs || timestampMs >= toMs || !predicate(trackId)) {
+                continue;
+            }
+            
+            MovementSample sample;
+            sample.timestampMs = timestampMs;
+            sample.trackId = trackId;
+            sample.userId = static_cast<int>((*columns)[COLUMN_USER_ID][i]);
+            sample.box = cv::Rect(static_cast<int>((*columns)[COLUMN_X][i]),
+                                  static_cast<int>((*columns)[COLUMN_Y][i]),
+                                  static_cast<int>((*columns)[COLUMN_WIDTH][i]),
+                                  static_cast<int>((*columns)[COLUMN_HEIGHT][i]));
+            samples.push_back(sample);
+        }
+    }
+    return samples;
+}
+
+std::vector<MovementSample> MovementStore::query(size_t cameraIndex, int64_t fromMs, int64_t toMs) const {
+    return collect(cameraIndex, fromMs, toMs, [](int) { return true; });
+}
+
+std::vector<MovementSample> MovementStore::queryTrack(size_t cameraIndex, int trackId,
+                                                      int64_t fromMs, int64_t toMs) const {
+    return collect(cameraIndex, fromMs, toMs, [trackId](int id) { return id == trackId; });
+}
+
+size_t MovementStore::getSampleCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_sampleCount;
+}
+
+size_t MovementStore::getChunkCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = 0;
+    for (const auto& partition : m_partitions) {
+        count += partition.chunks.size();
+    }
+    return count;
+}
+
+size_t MovementStore::getMemoryUsage() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t bytes = 0;
+    for (const auto& partition : m_partitions) {
+        for (const auto& chunk : partition.chunks) {
+            bytes += sizeof(Chunk);
+            for (int c = 0; c < COLUMN_COUNT; c++) {
+                bytes += chunk.raw[c].capacity() * sizeof(int64_t) + chunk.encoded[c].capacity();
+            }
+        }
+    }
+    return bytes;
+}
+
+} // namespace hms
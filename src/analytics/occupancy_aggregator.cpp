@@ -0,0 +1,232 @@
+#include "analytics/occupancy_aggregator.hpp"
+#include <algorithm>
+
+namespace hms {
+
+static const int64_t kMinuteMs = 60 * 1000;
+static const int64_t kHourMs = 60 * kMinuteMs;
+static const int64_t kDayMs = 24 * kHourMs;
+
+static int64_t floorDiv(int64_t value, int64_t divisor) {
+    int64_t quotient = value / divisor;
+    return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+RollupRing::RollupRing(int64_t bucketMs, size_t bucketCount, size_t width)
+    : m_bucketMs(bucketMs), m_width(width),
+      m_bucketIds(std::max<size_t>(bucketCount, 1), INT64_MIN),
+      m_values(m_bucketIds.size() * width, 0) {
+}
+
+void RollupRing::add(int64_t timeMs, size_t index, uint64_t amountMs) {
+    // An interval that crosses into the next bucket is split at the boundary,
+    // so no bucket holds more time than it spans
+    while (amountMs > 0) {
+        int64_t bucket = floorDiv(timeMs, m_bucketMs);
+        uint64_t partMs = std::min(amountMs, static_cast<uint64_t>((bucket + 1) * m_bucketMs - timeMs));
+        timeMs += static_cast<int64_t>(partMs);
+        amountMs -= partMs;
+        
+        size_t slot = slotOf(bucket);
+        if (m_bucketIds[slot] != bucket) {
+            if (m_bucketIds[slot] > bucket) {
+                continue;  // Older than anything the ring still holds
+            }
+            // First sample of a new bucket: recycle the slot
+            m_bucketIds[slot] = bucket;
+            std::fill_n(m_values.begin() + slot * m_width, m_width, 0);
+        }
+        m_values[slot * m_width + index] += partMs;
+    }
+}
+
+const uint64_t* RollupRing::get(int64_t bucket) const {
+    size_t slot = slotOf(bucket);
+    if (m_bucketIds[slot] != bucket) {
+        return nullptr;
+    }
+    return &m_values[slot * m_width];
+}
+
+size_t RollupRing::slotOf(int64_t bucket) const {
+    int64_t count = static_cast<int64_t>(m_bucketIds.size());
+    return static_cast<size_t>(bucket - floorDiv(bucket, count) * count);
+}
+
+int64_t RollupRing::getBucketMs() const {
+    return m_bucketMs;
+}
+
+OccupancyAggregator::Rollup::Rollup(const Options& options, size_t minuteBuckets, size_t width)
+    : minutes(kMinuteMs, minuteBuckets, width),
+      hours(kHourMs, options.hourBuckets, width),
+      days(kDayMs, options.dayBuckets, width) {
+}
+
+void OccupancyAggregator::Rollup::add(int64_t localMs, size_t index, uint64_t amountMs) {
+    minutes.add(localMs, index, amountMs);
+    hours.add(localMs, index, amountMs);
+    days.add(localMs, index, amountMs);
+}
+
+OccupancyAggregator::OccupancyAggregator(const ZoneMap& zones, const Options& options)
+    : m_zones(zones), m_options(options) {
+    m_options.gridCols = std::max(m_options.gridCols, 1);
+    m_options.gridRows = std::max(m_options.gridRows, 1);
+}
+
+OccupancyAggregator::~OccupancyAggregator() {
+}
+
+void OccupancyAggregator::addObservation(size_t cameraIndex, const MovementSample& sample,
+                                         const cv::Size& frameSize) {
+    if (frameSize.width <= 0 || frameSize.height <= 0) {
+        return;
+    }
+    
+    cv::Point point = ZoneMap::referencePoint(sample.box);
+    int col = std::min(std::max(point.x * m_options.gridCols / frameSize.width, 0), m_options.gridCols - 1);
+    int row = std::min(std::max(point.y * m_options.gridRows / frameSize.height, 0), m_options.gridRows - 1);
+    int cell = row * m_options.gridCols + col;
+    uint32_t zones = m_zones.lookup(cameraIndex, point);
+    
+    uint64_t key = (static_cast<uint64_t>(cameraIndex) << 32) | static_cast<uint32_t>(sample.trackId);
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    auto it = m_tracks.find(key);
+    if (it == m_tracks.end()) {
+        m_tracks[key] = {sample.timestampMs, sample.userId, cell, zones};
+        return;
+    }
+    
+    // The interval since the last sighting is spent where the person was then
+    TrackState& state = it->second;
+    int64_t elapsed = sample.timestampMs - state.lastMs;
+    if (elapsed > 0 && elapsed <= m_options.maxGapMs) {
+        int64_t localMs = state.lastMs + m_options.utcOffsetMs;
+        uint64_t amount = static_cast<uint64_t>(elapsed);
+        
+        if (cameraIndex >= m_heatmaps.size()) {
+            m_heatmaps.resize(cameraIndex + 1);
+        }
+        if (!m_heatmaps[cameraIndex]) {
+            size_t cells = static_cast<size_t>(m_options.gridCols) * m_options.gridRows;
+            m_heatmaps[cameraIndex] = std::make_unique<Rollup>(m_options, m_options.heatmapMinuteBuckets, cells);
+        }
+        m_heatmaps[cameraIndex]->add(localMs, state.cell, amount);
+        
+        if (state.zones != 0) {
+            creditDwell(ALL_USERS, state.zones, localMs, amount);
+            if (state.userId >= 0) {
+                creditDwell(state.userId, state.zones, localMs, amount);
+            }
+        }
+    }
+    
+    if (elapsed >= 0) {
+        // Keep an identity once the track has been recognized
+        state.lastMs = sample.timestampMs;
+        state.userId = sample.userId >= 0 ? sample.userId : state.userId;
+        state.cell = cell;
+        state.zones = zones;
+    }
+}
+
+void OccupancyAggregator::creditDwell(int userId, uint32_t zones, int64_t localMs, uint64_t amountMs) {
+    auto& rollup = m_dwell[userId];
+    if (!rollup) {
+        rollup = std::make_unique<Rollup>(m_options, m_options.minuteBuckets,
+                                          static_cast<size_t>(ZoneMap::MAX_ZONES));
+    }
+    
+    while (zones != 0) {
+        int zoneId = __builtin_ctz(zones);
+        rollup->add(localMs, zoneId, amountMs);
+        zones &= zones - 1;
+    }
+}
+
+void OccupancyAggregator::closeIdleTracks(int64_t nowMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    for (auto it = m_tracks.begin(); it != m_tracks.end();) {
+        if (nowMs - it->second.lastMs > m_options.maxGapMs) {
+            it = m_tracks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+int64_t OccupancyAggregator::getDwellMs(int userId, int zoneId, int64_t fromMs, int64_t toMs) const {
+    if (zoneId < 0 || zoneId >= ZoneMap::MAX_ZONES) {
+        return 0;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    auto it = m_dwell.find(userId);
+    if (it == m_dwell.end()) {
+        return 0;
+    }
+    
+    std::vector<uint64_t> sum(1, 0);
+    sumRange(*it->second, fromMs, toMs, zoneId, 1, sum);
+    return static_cast<int64_t>(sum[0]);
+}
+
+cv::Mat OccupancyAggregator::getHeatmap(size_t cameraIndex, int64_t fromMs, int64_t toMs) const {
+    cv::Mat heatmap = cv::Mat::zeros(m_options.gridRows, m_options.gridCols, CV_32F);
+    size_t cells = static_cast<size_t>(m_options.gridCols) * m_options.gridRows;
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    if (cameraIndex >= m_heatmaps.size() || !m_heatmaps[cameraIndex]) {
+        return heatmap;
+    }
+    
+    std::vector<uint64_t> sum(cells, 0);
+    sumRange(*m_heatmaps[cameraIndex], fromMs, toMs, 0, cells, sum);
+    
+    float* values = heatmap.ptr<float>(0);
+    for (size_t i = 0; i < cells; i++) {
+        values[i] = static_cast<float>(sum[i] / 1000.0);
+    }
+    return heatmap;
+}
+
+const OccupancyAggregator::Options& OccupancyAggregator::getOptions() const {
+    return m_options;
+}
+
+void OccupancyAggregator::sumRange(const Rollup& rollup, int64_t fromMs, int64_t toMs,
+                                   size_t firstIndex, size_t count, std::vector<uint64_t>& sum) const {
+    int64_t start = floorDiv(fromMs + m_options.utcOffsetMs, kMinuteMs) * kMinuteMs;
+    int64_t end = toMs + m_options.utcOffsetMs;
+    
+    // Whole days, then whole hours, then minutes: a day-long range reads
+    // one bucket, an arbitrary one at most a few hundred
+    const RollupRing* rings[] = {&rollup.days, &rollup.hours, &rollup.minutes};
+    
+    while (start < end) {
+        for (const RollupRing* ring : rings) {
+            int64_t bucketMs = ring->getBucketMs();
+            bool isMinute = ring == &rollup.minutes;
+            if (!isMinute && (start % bucketMs != 0 || start + bucketMs > end)) {
+                continue;
+            }
+            
+            const uint64_t* values = ring->get(floorDiv(start, bucketMs));
+            if (values) {
+                for (size_t i = 0; i < count; i++) {
+                    sum[i] += values[firstIndex + i];
+                }
+            }
+            start += bucketMs;
+            break;
+        }
+    }
+}
+
+} // namespace hms
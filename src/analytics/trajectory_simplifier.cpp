@@ -0,0 +1,221 @@
+#include "analytics/trajectory_simplifier.hpp"
+#include <cmath>
+#include <algorithm>
+
+namespace hms {
+
+double TrajectorySimplifier::Stats::getReductionRatio() const {
+    return storedSamples > 0 ? static_cast<double>(inputSamples) / storedSamples : 0.0;
+}
+
+TrajectorySimplifier::TrajectorySimplifier(const Options& options, SampleSink sink)
+    : m_options(options), m_sink(std::move(sink)) {
+    if (m_options.maxPendingSamples < 2) {
+        m_options.maxPendingSamples = 2;
+    }
+}
+
+TrajectorySimplifier::~TrajectorySimplifier() {
+    closeAllTracks();
+}
+
+void TrajectorySimplifier::addSample(size_t cameraIndex, const MovementSample& sample) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.inputSamples++;
+    
+    auto key = std::make_pair(cameraIndex, sample.trackId);
+    auto it = m_tracks.find(key);
+    if (it == m_tracks.end()) {
+        TrackState& state = m_tracks[key];
+        state.pending.push_back(sample);
+        state.lastKept = sample;
+        state.lastSeen = sample;
+        state.lastSeenKept = true;
+        m_stats.thresholdSamples++;
+        return;
+    }
+    
+    TrackState& state = it->second;
+    double deviation = synchronizedDistance(sample, state.lastKept, state.lastKept);
+    bool due = sample.timestampMs - state.lastKept.timestampMs >= m_options.maxIntervalMs;
+    
+    // An identified user replacing -1 is always worth keeping
+    if (deviation >= m_options.minDisplacementPx || due || sample.userId != state.lastKept.userId) {
+        state.pending.push_back(sample);
+        state.lastKept = sample;
+        state.lastSeenKept = true;
+        m_stats.thresholdSamples++;
+    } else {
+        state.dropped.push_back(sample);
+        state.lastSeenKept = false;
+    }
+    state.lastSeen = sample;
+    
+    if (state.pending.size() + state.dropped.size() >= m_options.maxPendingSamples) {
+        flushTrack(cameraIndex, state, false);
+    }
+}
+
+void TrajectorySimplifier::closeIdleTracks(int64_t nowMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    for (auto it = m_tracks.begin(); it != m_tracks.end();) {
+        if (nowMs - it->second.lastSeen.timestampMs >= m_options.trackTimeoutMs) {
+            closeTrack(it->first.first, it->second);
+            it = m_tracks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TrajectorySimplifier::closeAllTracks() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    for (auto& [key, state] : m_tracks) {
+        closeTrack(key.first, state);
+    }
+    m_tracks.clear();
+}
+
+void TrajectorySimplifier::closeTrack(size_t cameraIndex, TrackState& state) {
+    flushTrack(cameraIndex, state, true);
+}
+
+void TrajectorySimplifier::flushTrack(size_t cameraIndex, TrackState& state, bool closing) {
+    // Keep where the track was last seen, so the batch ends no earlier than
+    // its last dropped sample
+    if (!state.lastSeenKept) {
+        state.pending.push_back(state.lastSeen);
+        state.lastKept = state.lastSeen;
+        state.lastSeenKept = true;
+        m_stats.thresholdSamples++;
+    }
+    
+    std::vector<MovementSample> compacted = compact(state.pending, m_options.epsilonPx);
+    measureError(state, compacted);
+    
+    std::vector<MovementSample> output;
+    output.assign(compacted.begin() + (state.anchorStored ? 1 : 0), compacted.end());
+    m_stats.storedSamples += output.size();
+    
+    if (!output.empty() && m_sink) {
+        m_sink(cameraIndex, output);
+    }
+    
+    if (!closing) {
+        // The last stored point anchors compaction of the next batch
+        state.pending.assign(1, compacted.back());
+        state.anchorStored = true;
+    }
+}
+
+void TrajectorySimplifier::measureError(TrackState& state, const std::vector<MovementSample>& stored) {
+    // Where reconstruction puts the track at a sample's time is the stored
+    // segment around it, so that is what every left-out sample is measured
+    // against, whichever stage dropped it
+    auto deviation = [&stored](const MovementSample& sample) {
+        auto next = std::upper_bound(stored.begin(), stored.end(), sample.timestampMs,
+                                     [](int64_t timestampMs, const MovementSample& kept) {
+                                         return timestampMs < kept.timestampMs;
+                                     });
+        if (next == stored.begin()) {
+            return synchronizedDistance(sample, stored.front(), stored.front());
+        }
+        if (next == stored.end()) {
+            return synchronizedDistance(sample, stored.back(), stored.back());
+        }
+        return synchronizedDistance(sample, *(next - 1), *next);
+    };
+    
+    for (const auto& sample : state.pending) {
+        m_stats.maxErrorPx = std::max(m_stats.maxErrorPx, deviation(sample));
+    }
+    for (const auto& sample : state.dropped) {
+        m_stats.maxErrorPx = std::max(m_stats.maxErrorPx, deviation(sample));
+    }
+    state.dropped.clear();
+}
+
+double TrajectorySimplifier::synchronizedDistance(const MovementSample& sample,
+                                                  const MovementSample& a, const MovementSample& b) {
+    double t = 0.0;
+    if (b.timestampMs != a.timestampMs) {
+        t = static_cast<double>(sample.timestampMs - a.timestampMs) / (b.timestampMs - a.timestampMs);
+    }
+    
+    auto lerp = [t](double from, double to) { return from + (to - from) * t; };
+    
+    double ax = a.box.x + a.box.width / 2.0;
+    double ay = a.box.y + a.box.height / 2.0;
+    double bx = b.box.x + b.box.width / 2.0;
+    double by = b.box.y + b.box.height / 2.0;
+    double sx = sample.box.x + sample.box.width / 2.0;
+    double sy = sample.box.y + sample.box.height / 2.0;
+    
+    double centre = std::hypot(sx - lerp(ax, bx), sy - lerp(ay, by));
+    double width = std::abs(sample.box.width - lerp(a.box.width, b.box.width));
+    double height = std::abs(sample.box.height - lerp(a.box.height, b.box.height));
+    return std::max({centre, width, height});
+}
+
+std::vector<MovementSample> TrajectorySimplifier::compact(const std::vector<MovementSample>& samples,
+                                                          double epsilonPx, double* maxErrorPx) {
+    if (samples.size() <= 2) {
+        return samples;
+    }
+    
+    std::vector<bool> keep(samples.size(), false);
+    keep.front() = true;
+    keep.back() = true;
+    double maxDropped = 0.0;
+    
+    // Iterative to stay safe on long tracks
+    std::vector<std::pair<size_t, size_t>> ranges;
+    ranges.emplace_back(0, samples.size() - 1);
+    while (!ranges.empty()) {
+        auto [first, last] = ranges.back();
+        ranges.pop_back();
+        
+        double maxDistance = 0.0;
+        size_t index = first;
+        for (size_t i = first + 1; i < last; i++) {
+            double distance = synchronizedDistance(samples[i], samples[first], samples[last]);
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                index = i;
+            }
+        }
+        
+        if (maxDistance > epsilonPx) {
+            keep[index] = true;
+            ranges.emplace_back(first, index);
+            ranges.emplace_back(index, last);
+        } else {
+            maxDropped = std::max(maxDropped, maxDistance);
+        }
+    }
+    
+    if (maxErrorPx) {
+        *maxErrorPx = maxDropped;
+    }
+    
+    std::vector<MovementSample> result;
+    for (size_t i = 0; i < samples.size(); i++) {
+        if (keep[i]) {
+            result.push_back(samples[i]);
+        }
+    }
+    return result;
+}
+
+const TrajectorySimplifier::Options& TrajectorySimplifier::getOptions() const {
+    return m_options;
+}
+
+TrajectorySimplifier::Stats TrajectorySimplifier::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+} // namespace hms
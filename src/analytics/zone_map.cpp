@@ -0,0 +1,107 @@
+#include "analytics/zone_map.hpp"
+#include <iostream>
+#include <algorithm>
+
+namespace hms {
+
+ZoneMap::ZoneMap(int cellSize)
+    : m_cellSize(cellSize > 0 ? cellSize : 8) {
+}
+
+ZoneMap::~ZoneMap() {
+}
+
+int ZoneMap::addZone(size_t cameraIndex, const std::string& name, const std::vector<cv::Point>& polygon) {
+    if (polygon.size() < 3) {
+        std::cerr << "Zone " << name << " needs at least 3 points" << std::endl;
+        return -1;
+    }
+    
+    int zoneId = getZoneId(name);
+    if (zoneId < 0) {
+        if (m_zoneNames.size() >= MAX_ZONES) {
+            std::cerr << "Maximum number of zones (" << MAX_ZONES << ") already added" << std::endl;
+            return -1;
+        }
+        zoneId = static_cast<int>(m_zoneNames.size());
+        m_zoneNames.push_back(name);
+    }
+    
+    if (cameraIndex >= m_masks.size()) {
+        m_masks.resize(cameraIndex + 1);
+    }
+    CameraMask& mask = m_masks[cameraIndex];
+    
+    // Grow the grid to cover the polygon, keeping existing cells in place
+    int maxX = 0;
+    int maxY = 0;
+    for (const auto& point : polygon) {
+        maxX = std::max(maxX, point.x);
+        maxY = std::max(maxY, point.y);
+    }
+    int cols = std::max(mask.cols, maxX / m_cellSize + 1);
+    int rows = std::max(mask.rows, maxY / m_cellSize + 1);
+    if (cols != mask.cols || rows != mask.rows) {
+        std::vector<uint32_t> cells(static_cast<size_t>(cols) * rows, 0);
+        for (int y = 0; y < mask.rows; y++) {
+            std::copy(mask.cells.begin() + static_cast<size_t>(y) * mask.cols,
+                      mask.cells.begin() + static_cast<size_t>(y + 1) * mask.cols,
+                      cells.begin() + static_cast<size_t>(y) * cols);
+        }
+        mask.cols = cols;
+        mask.rows = rows;
+        mask.cells.swap(cells);
+    }
+    
+    // Rasterize by testing each cell centre once
+    uint32_t bit = 1u << zoneId;
+    for (int y = 0; y < mask.rows; y++) {
+        for (int x = 0; x < mask.cols; x++) {
+            cv::Point2f centre(x * m_cellSize + m_cellSize / 2.0f, y * m_cellSize + m_cellSize / 2.0f);
+            if (cv::pointPolygonTest(polygon, centre, false) >= 0) {
+                mask.cells[static_cast<size_t>(y) * mask.cols + x] |= bit;
+            }
+        }
+    }
+    
+    return zoneId;
+}
+
+uint32_t ZoneMap::lookup(size_t cameraIndex, const cv::Point& point) const {
+    if (cameraIndex >= m_masks.size() || point.x < 0 || point.y < 0) {
+        return 0;
+    }
+    
+    const CameraMask& mask = m_masks[cameraIndex];
+    int x = point.x / m_cellSize;
+    int y = point.y / m_cellSize;
+    if (x >= mask.cols || y >= mask.rows) {
+        return 0;
+    }
+    return mask.cells[static_cast<size_t>(y) * mask.cols + x];
+}
+
+int ZoneMap::getZoneId(const std::string& name) const {
+    auto it = std::find(m_zoneNames.begin(), m_zoneNames.end(), name);
+    if (it == m_zoneNames.end()) {
+        return -1;
+    }
+    return static_cast<int>(it - m_zoneNames.begin());
+}
+
+std::string ZoneMap::getZoneName(int zoneId) const {
+    if (zoneId < 0 || zoneId >= static_cast<int>(m_zoneNames.size())) {
+        return "";
+    }
+    return m_zoneNames[zoneId];
+}
+
+size_t ZoneMap::getZoneCount() const {
+    return m_zoneNames.size();
+}
+
+cv::Point ZoneMap::referencePoint(const cv::Rect& box) {
+    return cv::Point(box.x + box.width / 2, box.y + box.height / 2);
+}
+
+} // namespace hms
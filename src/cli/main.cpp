@@ -2,6 +2,9 @@
 #include <iostream>
 #include <string>
 #include <csignal>
+#include <fstream>
+#include <chrono>
+#include <cstdlib>
 
 hms::Application* g_app = nullptr;
 
@@ -23,6 +26,10 @@ void printUsage(const char* programName) {
     std::cout << "  --no-fall-detection    Disable fall detection" << std::endl;
     std::cout << "  --no-privacy           Disable privacy protection" << std::endl;
     std::cout << "  --no-recording         Disable recording" << std::endl;
+    std::cout << "  --import-users <file>  Import residents from a CSV or JSON file and exit" << std::endl;
+    std::cout << "  --export-events <file> Export alert and notification history as CSV and exit" << std::endl;
+    std::cout << "  --events-user <id>     Export only events for this resident" << std::endl;
+    std::cout << "  --events-days <n>      Export the last n days of events (default: 30)" << std::endl;
     std::cout << "  --help                 Show this help message" << std::endl;
 }
 
@@ -39,6 +46,10 @@ int main(int argc, char** argv) {
     bool fallDetectionEnabled = true;
     bool privacyProtectionEnabled = true;
     bool recordingEnabled = true;
+    std::string importFile;
+    std::string exportEventsFile;
+    int eventsUserId = -1;
+    int eventsDays = 30;
     
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
@@ -60,6 +71,14 @@ int main(int argc, char** argv) {
             privacyProtectionEnabled = false;
         } else if (arg == "--no-recording") {
             recordingEnabled = false;
+        } else if (arg == "--import-users" && i + 1 < argc) {
+            importFile = argv[++i];
+        } else if (arg == "--export-events" && i + 1 < argc) {
+            exportEventsFile = argv[++i];
+        } else if (arg == "--events-user" && i + 1 < argc) {
+            eventsUserId = std::atoi(argv[++i]);
+        } else if (arg == "--events-days" && i + 1 < argc) {
+            eventsDays = std::atoi(argv[++i]);
         } else {
             std::cerr << "Unknown option: " << arg << std::endl;
             printUsage(argv[0]);
@@ -79,6 +98,37 @@ int main(int argc, char** argv) {
             return 1;
         }
         
+        if (!importFile.empty()) {
+            int imported = app.getUserDatabase().importUsers(importFile);
+            if (imported < 0) {
+                std::cerr << "Failed to import users from " << importFile << std::endl;
+                return 1;
+            }
+            std::cout << "Imported " << imported << " users from " << importFile << std::endl;
+            return 0;
+        }
+        
+        if (!exportEventsFile.empty()) {
+            std::ofstream out(exportEventsFile);
+            if (!out.is_open()) {
+                std::cerr << "Failed to open " << exportEventsFile << std::endl;
+                return 1;
+            }
+            
+            auto now = std::chrono::system_clock::now();
+            int64_t toMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                now.time_since_epoch()).count() + 1;
+            int64_t fromMs = toMs - static_cast<int64_t>(eventsDays) * 24 * 3600 * 1000;
+            
+            hms::EventLog& eventLog = app.getEventLog();
+            std::vector<hms::EventRecord> events = eventsUserId >= 0
+                ? eventLog.getEventsByUser(eventsUserId, fromMs, toMs)
+                : eventLog.getEvents(fromMs, toMs);
+            hms::writeEventsCsv(out, events);
+            std::cout << "Exported " << events.size() << " events to " << exportEventsFile << std::endl;
+            return 0;
+        }
+        
         // Apply command line settings
         app.enableFallDetection(fallDetectionEnabled);
         app.enablePrivacyProtection(privacyProtectionEnabled);
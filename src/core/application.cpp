@@ -4,6 +4,7 @@
 #include <chrono>
 #include <thread>
 #include <filesystem>
+#include <ctime>
 #include <nlohmann/json.hpp>
 
 namespace fs = std::filesystem;
@@ -11,13 +12,78 @@ using json = nlohmann::json;
 
 namespace hms {
 
+// Sidebar thumbnail size; also the resolution of the proxy rendition
+static const cv::Size kThumbnailSize(320, 180);
+
+static int64_t toEpochMs(std::chrono::system_clock::time_point timePoint) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        timePoint.time_since_epoch()).count();
+}
+
+// Reads an "sms" or "email" section of the notification config into the
+// channel that delivers it; an empty type means the section is disabled
+static ChannelConfig loadChannelConfig(const json& section, const std::string& defaultType) {
+    ChannelConfig config;
+    if (!section.value("enabled", true)) {
+        return config;
+    }
+    
+    config.type = section.value("provider", defaultType);
+    if (config.type == "http") {
+        config.type = "sms_http";
+    }
+    config.url = section.value("url", "");
+    if (config.type == "smtp" && section.contains("smtp_server")) {
+        int port = section.value("smtp_port", 587);
+        bool implicitTls = section.value("use_ssl", false) && port == 465;
+        config.url = (implicitTls ? "smtps://" : "smtp://") + section["smtp_server"].get<std::string>() + ":" +
+                     std::to_string(port);
+    }
+    config.username = section.value("username", section.value("account_sid", ""));
+    config.password = section.value("password", section.value("auth_token", ""));
+    config.from = section.value("from_email", section.value("from_number", ""));
+    config.token = section.value("token", section.value("api_key", ""));
+    config.maxConcurrent = section.value("max_concurrent", config.maxConcurrent);
+    return config;
+}
+
+// A thumbnail value that moves by more than this has changed; sensor noise
+// and compression artefacts stay below it
+static const int kPixelChangeThreshold = 20;
+// Share of thumbnail values that must change for a frame to be announced
+static const double kChangedFraction = 0.001;
+
+static bool hasVisiblyChanged(const cv::Mat& previous, const cv::Mat& current) {
+    if (previous.empty() || previous.size() != current.size() || previous.type() != current.type()) {
+        return true;
+    }
+    cv::Mat difference;
+    cv::absdiff(previous, current, difference);
+    int changed = cv::countNonZero(difference.reshape(1) > kPixelChangeThreshold);
+    return changed > kChangedFraction * static_cast<double>(difference.total() * difference.channels());
+}
+
+// Offset of local time from UTC, so daily rollups start at local midnight
+static int64_t localUtcOffsetMs() {
+    std::time_t now = std::time(nullptr);
+    std::tm local;
+    localtime_r(&now, &local);
+    return static_cast<int64_t>(local.tm_gmtoff) * 1000;
+}
+
 Application::Application()
     : m_running(false),
       m_fallDetectionEnabled(true),
       m_privacyProtectionEnabled(true),
       m_recordingEnabled(true),
       m_recordingDirectory("recordings"),
-      m_activeCameraIndex(0) {
+      m_activeCameraIndex(0),
+      m_proxyRecordingEnabled(false),
+      m_proxyFps(5.0),
+      m_movementDatabasePath("hms_movement.db"),
+      m_eventLogPath("hms_events.db"),
+      m_outboxPath("hms_outbox.db"),
+      m_alertSnapshotsEnabled(true), m_responseWebhookEnabled(false) {
 }
 
 Application::~Application() {
@@ -31,6 +97,9 @@ bool Application::initialize(const std::string& configPath) {
             fs::create_directories(m_recordingDirectory);
         }
         
+        m_recordingCatalog = std::make_unique<RecordingCatalog>(m_recordingDirectory);
+        m_recordingCatalog->load();
+        
         // Initialize database
         m_userDatabase = std::make_unique<UserDatabase>("hms_database.db");
         if (!m_userDatabase->initialize()) {
@@ -61,10 +130,6 @@ bool Application::initialize(const std::string& configPath) {
             return false;
         }
         
-        // Initialize notification manager
-        m_notificationManager = std::make_unique<NotificationManager>(m_userDatabase.get());
-        m_notificationManager->initialize();
-        
         // Load configuration if file exists
         if (fs::exists(configPath)) {
             std::ifstream configFile(configPath);
@@ -73,6 +138,172 @@ bool Application::initialize(const std::string& configPath) {
                     json config;
                     configFile >> config;
                     
+                    // Load recording options before cameras so their recorders use them
+                    if (config.contains("recording")) {
+                        const auto& recording = config["recording"];
+                        
+                        if (recording.contains("format")) {
+                            m_recordingOptions.container =
+                                VideoRecorder::containerFromString(recording["format"]);
+                        }
+                        
+                        if (recording.contains("codec")) {
+                            std::string codec = recording["codec"];
+                            if (codec.size() == 4) {
+                                m_recordingOptions.fourcc = cv::VideoWriter::fourcc(
+                                    codec[0], codec[1], codec[2], codec[3]);
+                            }
+                        }
+                        
+                        if (recording.contains("fsync_interval_ms")) {
+                            m_recordingOptions.fsyncIntervalMs = recording["fsync_interval_ms"];
+                        }
+                        
+                        if (recording.contains("write_buffer_kb")) {
+                            size_t kb = recording["write_buffer_kb"];
+                            m_recordingOptions.writeBufferBytes = kb * 1024;
+                        }
+                        
+                        if (recording.contains("proxy")) {
+                            const auto& proxy = recording["proxy"];
+                            m_proxyRecordingEnabled = proxy.value("enabled", false);
+                            double proxyFps = proxy.value("fps", m_proxyFps);
+                            if (proxyFps > 0) {
+                                m_proxyFps = proxyFps;
+                            } else {
+                                std::cerr << "Invalid proxy recording fps " << proxyFps << ", using "
+                                          << m_proxyFps << std::endl;
+                            }
+                        }
+                    }
+                    
+                    // Load movement history downsampling options
+                    if (config.contains("movement_history")) {
+                        const auto& history = config["movement_history"];
+                        m_trajectoryOptions.minDisplacementPx =
+                            history.value("min_displacement_px", m_trajectoryOptions.minDisplacementPx);
+                        m_trajectoryOptions.maxIntervalMs =
+                            history.value("max_interval_ms", m_trajectoryOptions.maxIntervalMs);
+                        m_trajectoryOptions.epsilonPx =
+                            history.value("epsilon_px", m_trajectoryOptions.epsilonPx);
+                        m_trajectoryOptions.trackTimeoutMs =
+                            history.value("track_timeout_ms", m_trajectoryOptions.trackTimeoutMs);
+                        m_movementDatabasePath =
+                            history.value("database_path", m_movementDatabasePath);
+                        m_movementDatabaseOptions.flushIntervalMs =
+                            history.value("flush_interval_ms", m_movementDatabaseOptions.flushIntervalMs);
+                        m_movementDatabaseOptions.retentionDays =
+                            history.value("retention_days", m_movementDatabaseOptions.retentionDays);
+                    }
+                    
+                    // Load alert and notification history options
+                    if (config.contains("event_log")) {
+                        const auto& eventLog = config["event_log"];
+                        m_eventLogPath = eventLog.value("database_path", m_eventLogPath);
+                        m_eventLogOptions.flushIntervalMs =
+                            eventLog.value("flush_interval_ms", m_eventLogOptions.flushIntervalMs);
+                        m_eventLogOptions.retentionDays =
+                            eventLog.value("retention_days", m_eventLogOptions.retentionDays);
+                    }
+                    
+                    // Load notification delivery options
+                    if (config.contains("notification") && config["notification"].contains("outbox")) {
+                        const auto& outbox = config["notification"]["outbox"];
+                        m_outboxPath = outbox.value("database_path", m_outboxPath);
+                        m_outboxOptions.maxAttempts = outbox.value("max_attempts", m_outboxOptions.maxAttempts);
+                        m_outboxOptions.baseBackoffMs =
+                            outbox.value("base_backoff_ms", m_outboxOptions.baseBackoffMs);
+                        m_outboxOptions.maxBackoffMs = outbox.value("max_backoff_ms", m_outboxOptions.maxBackoffMs);
+                    }
+                    if (config.contains("notification") && config["notification"].contains("coalescing")) {
+                        const auto& coalescing = config["notification"]["coalescing"];
+                        m_coalescerOptions.windowMs = coalescing.value("window_ms", m_coalescerOptions.windowMs);
+                        m_coalescerOptions.smsPerMinute =
+                            coalescing.value("sms_per_minute", m_coalescerOptions.smsPerMinute);
+                        m_coalescerOptions.smsBurst = coalescing.value("sms_burst", m_coalescerOptions.smsBurst);
+                        m_coalescerOptions.emailPerMinute =
+                            coalescing.value("email_per_minute", m_coalescerOptions.emailPerMinute);
+                        m_coalescerOptions.emailBurst = coalescing.value("email_burst", m_coalescerOptions.emailBurst);
+                    }
+                    if (config.contains("notification") && config["notification"].contains("escalation")) {
+                        const auto& escalation = config["notification"]["escalation"];
+                        auto& timeouts = m_escalationOptions.tierTimeoutsMs;
+                        timeouts[0] = escalation.value("primary_timeout_ms", timeouts[0]);
+                        timeouts[1] = escalation.value("secondary_timeout_ms", timeouts[1]);
+                        timeouts[2] = escalation.value("doctor_timeout_ms", timeouts[2]);
+                    }
+                    if (config.contains("notification") && config["notification"].contains("snapshot")) {
+                        const auto& snapshot = config["notification"]["snapshot"];
+                        m_alertSnapshotsEnabled = snapshot.value("enabled", m_alertSnapshotsEnabled);
+                        m_snapshotOptions.maxDimension = snapshot.value("max_dimension", m_snapshotOptions.maxDimension);
+                        m_snapshotOptions.quality = snapshot.value("quality", m_snapshotOptions.quality);
+                        m_snapshotOptions.maxBytes = snapshot.value("max_bytes", m_snapshotOptions.maxBytes);
+                    }
+                    if (config.contains("notification") && config["notification"].contains("sms")) {
+                        m_channelConfigs[OutboxChannel::SMS] = loadChannelConfig(config["notification"]["sms"],
+                                                                                 "sms_http");
+                    }
+                    if (config.contains("notification") && config["notification"].contains("email")) {
+                        m_channelConfigs[OutboxChannel::EMAIL] = loadChannelConfig(config["notification"]["email"],
+                                                                                   "smtp");
+                    }
+                    if (config.contains("notification") && config["notification"].contains("webhook")) {
+                        const auto& webhook = config["notification"]["webhook"];
+                        m_responseWebhookEnabled = webhook.value("enabled", m_responseWebhookEnabled);
+                        m_responseWebhookOptions.address = webhook.value("address", m_responseWebhookOptions.address);
+                        m_responseWebhookOptions.port = webhook.value("port", m_responseWebhookOptions.port);
+                        m_responseWebhookOptions.token = webhook.value("token", m_responseWebhookOptions.token);
+                    }
+                    
+                    // Load zones drawn on each camera, in frame pixels
+                    if (config.contains("zones") && config["zones"].is_array()) {
+                        for (const auto& zone : config["zones"]) {
+                            std::vector<cv::Point> polygon;
+                            for (const auto& point : zone["polygon"]) {
+                                polygon.emplace_back(point[0].get<int>(), point[1].get<int>());
+                            }
+                            m_zoneMap.addZone(zone.value("camera", 0), zone["name"].get<std::string>(), polygon);
+                        }
+                    }
+                    
+                    // Load occupancy aggregation options
+                    if (config.contains("occupancy")) {
+                        const auto& occupancy = config["occupancy"];
+                        m_occupancyOptions.gridCols = occupancy.value("grid_cols", m_occupancyOptions.gridCols);
+                        m_occupancyOptions.gridRows = occupancy.value("grid_rows", m_occupancyOptions.gridRows);
+                        m_occupancyOptions.maxGapMs = occupancy.value("max_gap_ms", m_occupancyOptions.maxGapMs);
+                    }
+                    
+                    // Load inactivity and wandering rules; zones are resolved by name
+                    if (config.contains("activity_rules") && config["activity_rules"].is_array()) {
+                        for (const auto& entry : config["activity_rules"]) {
+                            ActivityRule rule;
+                            rule.name = entry.value("name", std::string("Activity alert"));
+                            if (!ActivityRuleEngine::typeFromString(entry.value("type", std::string()), rule.type)) {
+                                std::cerr << "Unknown activity rule type for " << rule.name << std::endl;
+                                continue;
+                            }
+                            rule.userId = entry.value("user_id", ActivityRuleEngine::ANY_USER);
+                            if (entry.contains("zone")) {
+                                rule.zoneId = m_zoneMap.getZoneId(entry["zone"].get<std::string>());
+                            }
+                            rule.durationMs = static_cast<int64_t>(entry.value("duration_min", 0.0) * 60 * 1000);
+                            rule.cooldownMs = static_cast<int64_t>(entry.value("cooldown_min", 15.0) * 60 * 1000);
+                            if (entry.contains("schedule")) {
+                                const auto& schedule = entry["schedule"];
+                                rule.startMinute = ActivityRuleEngine::parseTimeOfDay(
+                                    schedule.value("start", std::string("00:00")));
+                                rule.endMinute = ActivityRuleEngine::parseTimeOfDay(
+                                    schedule.value("end", std::string("24:00")));
+                                if (rule.startMinute < 0 || rule.endMinute < 0) {
+                                    std::cerr << "Invalid schedule for activity rule " << rule.name << std::endl;
+                                    continue;
+                                }
+                            }
+                            m_activityRules.push_back(rule);
+                        }
+                    }
+                    
                     // Load cameras
                     if (config.contains("cameras") && config["cameras"].is_array()) {
                         for (const auto& camera : config["cameras"]) {
@@ -116,6 +347,9 @@ bool Application::initialize(const std::string& configPath) {
                             if (!fs::exists(m_recordingDirectory)) {
                                 fs::create_directories(m_recordingDirectory);
                             }
+                            
+                            m_recordingCatalog = std::make_unique<RecordingCatalog>(m_recordingDirectory);
+                            m_recordingCatalog->load();
                         }
                     }
                 } catch (const std::exception& e) {
@@ -124,6 +358,79 @@ bool Application::initialize(const std::string& configPath) {
             }
         }
         
+        // Initialize movement history persistence and reload the last 24 hours
+        m_movementDatabase = std::make_unique<MovementDatabase>(m_movementDatabasePath,
+                                                                m_movementDatabaseOptions);
+        if (m_movementDatabase->initialize()) {
+            auto cutoff = std::chrono::system_clock::now() - std::chrono::hours(24);
+            for (const auto& record : m_movementDatabase->getMovementsSince(toEpochMs(cutoff))) {
+                m_movementStore.append(record.cameraIndex, record.sample);
+            }
+        } else {
+            std::cerr << "Movement history will not be persisted" << std::endl;
+        }
+        
+        // Create the notification manager; it starts once the alert history is attached
+        m_notificationManager = std::make_unique<NotificationManager>(m_userDatabase.get(), m_outboxPath,
+                                                                      m_outboxOptions, m_coalescerOptions,
+                                                                      m_escalationOptions, m_snapshotOptions);
+        for (const auto& channel : m_channelConfigs) {
+            if (channel.second.type.empty()) {
+                m_notificationManager->setChannel(channel.first, nullptr);
+            } else if (!m_notificationManager->configureChannel(channel.first, channel.second)) {
+                std::cerr << "Using the default " << (channel.first == OutboxChannel::EMAIL ? "email" : "SMS")
+                          << " channel" << std::endl;
+            }
+        }
+        
+        // Initialize the alert history; alerts still go out without it
+        m_eventLog = std::make_unique<EventLog>(m_eventLogPath, m_eventLogOptions);
+        if (m_eventLog->initialize()) {
+            m_notificationManager->setEventLog(m_eventLog.get());
+        } else {
+            std::cerr << "Alert history will not be persisted" << std::endl;
+        }
+        
+        // Initialize notification manager; it replays sends left in the outbox
+        m_notificationManager->initialize();
+        
+        // Take replies from the SMS provider as they arrive; without the
+        // webhook, alerts escalate until a response is recorded some other way
+        if (m_responseWebhookEnabled) {
+            m_responseWebhook = std::make_unique<ResponseWebhook>(
+                m_responseWebhookOptions,
+                [this](const SmsReply& reply) {
+                    m_notificationManager->recordSmsReply(reply.from, reply.text);
+                },
+                [this](const SmsStatusReport& report) {
+                    m_notificationManager->recordDeliveryReport(report.to, report.status, report.error);
+                });
+            if (!m_responseWebhook->start()) {
+                std::cerr << "SMS replies will not be received" << std::endl;
+            }
+        }
+        
+        // Initialize movement history downsampling
+        m_trajectorySimplifier = std::make_unique<TrajectorySimplifier>(
+            m_trajectoryOptions,
+            [this](size_t cameraIndex, const std::vector<MovementSample>& samples) {
+                for (const auto& sample : samples) {
+                    m_movementStore.append(cameraIndex, sample);
+                }
+                m_movementDatabase->addSamples(cameraIndex, samples);
+            });
+        
+        // Initialize occupancy rollups; they see every observation, not the downsampled stream
+        m_occupancyOptions.utcOffsetMs = localUtcOffsetMs();
+        m_occupancyAggregator = std::make_unique<OccupancyAggregator>(m_zoneMap, m_occupancyOptions);
+        
+        // Initialize activity rules
+        m_activityRuleOptions.utcOffsetMs = m_occupancyOptions.utcOffsetMs;
+        m_activityRuleEngine = std::make_unique<ActivityRuleEngine>(m_zoneMap, m_activityRuleOptions);
+        for (const auto& rule : m_activityRules) {
+            m_activityRuleEngine->addRule(rule);
+        }
+        
         return true;
     } catch (const std::exception& e) {
         std::cerr << "Error initializing application: " << e.what() << std::endl;
@@ -143,27 +450,16 @@ void Application::run() {
     {
         std::lock_guard<std::mutex> lock(m_framesMutex);
         m_cameraFrames.resize(numCameras);
+        m_cameraThumbnails.resize(numCameras);
+        m_announcedThumbnails.resize(numCameras);
     }
     
     // Initialize video writers if recording is enabled
     if (m_recordingEnabled) {
-        m_videoWriters.resize(numCameras);
         m_recordingStartTime = std::chrono::system_clock::now();
         
         for (size_t i = 0; i < numCameras; i++) {
-            auto timePoint = std::chrono::system_clock::now();
-            auto timeT = std::chrono::system_clock::to_time_t(timePoint);
-            std::tm* now = std::localtime(&timeT);
-            
-            char buffer[128];
-            strftime(buffer, sizeof(buffer), "%Y%m%d_%H%M%S", now);
-            
-            std::string filename = m_recordingDirectory + "/camera_" + 
-                                  std::to_string(i) + "_" + buffer + ".mp4";
-            
-            m_videoWriters[i].open(filename, 
-                                  cv::VideoWriter::fourcc('a', 'v', 'c', '1'), 
-                                  30, cv::Size(1280, 720));
+            openRecorders(i);
         }
     }
     
@@ -190,17 +486,43 @@ void Application::stop() {
         m_uiThread.join();
     }
     
-    // Close video writers
-    for (auto& writer : m_videoWriters) {
-        if (writer.isOpened()) {
-            writer.release();
-        }
+    // Close video recorders
+    closeRecorders();
+    
+    // Flush open tracks into the movement history
+    if (m_trajectorySimplifier) {
+        m_trajectorySimplifier->closeAllTracks();
+        m_movementDatabase->flush();
+        
+        TrajectorySimplifier::Stats stats = m_trajectorySimplifier->getStats();
+        std::cout << "Movement history: " << stats.inputSamples << " samples observed, "
+                  << stats.storedSamples << " stored (" << stats.getReductionRatio()
+                  << "x reduction), max error " << stats.maxErrorPx << " px" << std::endl;
+    }
+    
+    // No more replies once the notification manager is gone
+    if (m_responseWebhook) {
+        m_responseWebhook->stop();
     }
-    m_videoWriters.clear();
     
     // Shutdown notification manager
     if (m_notificationManager) {
         m_notificationManager->shutdown();
+        
+        NotificationCoalescer::Stats stats = m_notificationManager->getDeliveryStats();
+        std::cout << "Notifications: " << stats.sends << " messages sent, " << stats.merged << " alerts merged, "
+                  << stats.suppressed << " duplicates suppressed, " << stats.rateLimited
+                  << " sends rate limited" << std::endl;
+        for (const ChannelMetrics& channel : m_notificationManager->getChannelMetrics()) {
+            std::cout << "  " << channel.name << ": " << channel.sent << " sent, " << channel.failed
+                      << " failed, " << channel.averageLatencyMs << " ms average latency, "
+                      << channel.maxLatencyMs << " ms max" << std::endl;
+        }
+    }
+    
+    // Write out events logged by the final sends
+    if (m_eventLog) {
+        m_eventLog->flush();
     }
 }
 
@@ -216,25 +538,13 @@ bool Application::addCamera(const std::string& uri, Camera::ConnectionType type)
         // Resize frame buffers
         std::lock_guard<std::mutex> lock(m_framesMutex);
         m_cameraFrames.resize(m_cameraManager->getCameraCount());
+        m_cameraThumbnails.resize(m_cameraManager->getCameraCount());
+        m_announcedThumbnails.resize(m_cameraManager->getCameraCount());
         
         // Add video writer if recording is enabled
         if (m_recordingEnabled) {
             size_t index = m_cameraManager->getCameraCount() - 1;
-            
-            auto timePoint = std::chrono::system_clock::now();
-            auto timeT = std::chrono::system_clock::to_time_t(timePoint);
-            std::tm* now = std::localtime(&timeT);
-            
-            char buffer[128];
-            strftime(buffer, sizeof(buffer), "%Y%m%d_%H%M%S", now);
-            
-            std::string filename = m_recordingDirectory + "/camera_" + 
-                                  std::to_string(index) + "_" + buffer + ".mp4";
-            
-            m_videoWriters.resize(m_cameraManager->getCameraCount());
-            m_videoWriters[index].open(filename, 
-                                      cv::VideoWriter::fourcc('a', 'v', 'c', '1'), 
-                                      30, cv::Size(1280, 720));
+            openRecorders(index);
         }
     }
     
@@ -249,32 +559,16 @@ bool Application::removeCamera(const std::string& id) {
         // Resize frame buffers
         std::lock_guard<std::mutex> lock(m_framesMutex);
         m_cameraFrames.resize(m_cameraManager->getCameraCount());
+        m_cameraThumbnails.resize(m_cameraManager->getCameraCount());
+        m_announcedThumbnails.resize(m_cameraManager->getCameraCount());
         
         // Close and remove video writer if recording is enabled
         if (m_recordingEnabled && m_cameraManager->getCameraCount() < cameraCount) {
-            for (size_t i = 0; i < m_videoWriters.size(); i++) {
-                if (m_videoWriters[i].isOpened()) {
-                    m_videoWriters[i].release();
-                }
-            }
+            closeRecorders();
             
-            m_videoWriters.resize(m_cameraManager->getCameraCount());
-            
-            // Recreate video writers
+            // Recreate video recorders
             for (size_t i = 0; i < m_cameraManager->getCameraCount(); i++) {
-                auto timePoint = std::chrono::system_clock::now();
-                auto timeT = std::chrono::system_clock::to_time_t(timePoint);
-                std::tm* now = std::localtime(&timeT);
-                
-                char buffer[128];
-                strftime(buffer, sizeof(buffer), "%Y%m%d_%H%M%S", now);
-                
-                std::string filename = m_recordingDirectory + "/camera_" + 
-                                      std::to_string(i) + "_" + buffer + ".mp4";
-                
-                m_videoWriters[i].open(filename, 
-                                      cv::VideoWriter::fourcc('a', 'v', 'c', '1'), 
-                                      30, cv::Size(1280, 720));
+                openRecorders(i);
             }
         }
         
@@ -305,11 +599,17 @@ bool Application::deleteUser(int userId) {
 }
 
 User Application::getUserById(int userId) {
-    return m_userDatabase->getUserById(userId);
+    std::shared_ptr<const User> user = m_userDatabase->getDirectory().findUser(userId);
+    if (!user) {
+        User missing;
+        missing.id = -1;
+        return missing;
+    }
+    return *user;
 }
 
 std::vector<User> Application::getAllUsers() {
-    return m_userDatabase->getAllUsers();
+    return m_userDatabase->getDirectory().getSnapshot()->toVector();
 }
 
 void Application::setActiveCameraIndex(size_t index) {
@@ -353,31 +653,13 @@ void Application::enableRecording(bool enable) {
         m_recordingStartTime = std::chrono::system_clock::now();
         
         size_t numCameras = m_cameraManager->getCameraCount();
-        m_videoWriters.resize(numCameras);
         
         for (size_t i = 0; i < numCameras; i++) {
-            auto timePoint = std::chrono::system_clock::now();
-            auto timeT = std::chrono::system_clock::to_time_t(timePoint);
-            std::tm* now = std::localtime(&timeT);
-            
-            char buffer[128];
-            strftime(buffer, sizeof(buffer), "%Y%m%d_%H%M%S", now);
-            
-            std::string filename = m_recordingDirectory + "/camera_" + 
-                                  std::to_string(i) + "_" + buffer + ".mp4";
-            
-            m_videoWriters[i].open(filename, 
-                                  cv::VideoWriter::fourcc('a', 'v', 'c', '1'), 
-                                  30, cv::Size(1280, 720));
+            openRecorders(i);
         }
     } else {
         // Stop recording
-        for (auto& writer : m_videoWriters) {
-            if (writer.isOpened()) {
-                writer.release();
-            }
-        }
-        m_videoWriters.clear();
+        closeRecorders();
     }
 }
 
@@ -399,11 +681,18 @@ void Application::setRecordingDirectory(const std::string& directory) {
         fs::create_directories(directory);
     }
     
+    // If recording is enabled, close the current segments into the old catalog
+    // and restart recording with the new directory
+    bool wasRecording = m_recordingEnabled;
+    if (wasRecording) {
+        enableRecording(false);
+    }
+    
     m_recordingDirectory = directory;
+    m_recordingCatalog = std::make_unique<RecordingCatalog>(m_recordingDirectory);
+    m_recordingCatalog->load();
     
-    // If recording is enabled, restart recording with new directory
-    if (m_recordingEnabled) {
-        enableRecording(false);
+    if (wasRecording) {
         enableRecording(true);
     }
 }
@@ -433,23 +722,55 @@ void Application::processingThreadFunc() {
             // Process frame
             processFrame(i, frame);
             
-            // Store processed frame
+            // Downscale once; the UI sidebar and the proxy rendition share it
+            cv::Mat thumbnail;
+            cv::resize(frame, thumbnail, kThumbnailSize, 0, 0, cv::INTER_AREA);
+            
+            // Store processed frame in a recycled buffer; viewers hear of it
+            // only when it differs from the last one they were sent
+            FramePool::Handle published = m_framePool.acquire(frame.rows, frame.cols, frame.type());
+            frame.copyTo(*published);
+            bool changed = false;
             {
                 std::lock_guard<std::mutex> lock(m_framesMutex);
                 if (i < m_cameraFrames.size()) {
-                    m_cameraFrames[i] = frame.clone();
+                    m_cameraFrames[i] = published;
+                    m_cameraThumbnails[i] = thumbnail;
+                    changed = hasVisiblyChanged(m_announcedThumbnails[i], thumbnail);
+                    if (changed) {
+                        m_announcedThumbnails[i] = thumbnail;
+                    }
+                }
+            }
+            if (changed) {
+                std::lock_guard<std::mutex> lock(m_frameCallbacksMutex);
+                for (const auto& callback : m_frameCallbacks) {
+                    callback(i, published);
                 }
             }
             
             // Record frame if enabled
-            if (m_recordingEnabled && i < m_videoWriters.size() && m_videoWriters[i].isOpened()) {
-                m_videoWriters[i].write(frame);
+            if (m_recordingEnabled && i < m_videoRecorders.size() && m_videoRecorders[i]) {
+                m_videoRecorders[i]->write(frame);
+            }
+            
+            // Record the proxy rendition at its own, lower frame rate
+            if (m_recordingEnabled && i < m_proxyRecorders.size() && m_proxyRecorders[i]) {
+                auto now = std::chrono::steady_clock::now();
+                auto interval = std::chrono::duration<double>(1.0 / m_proxyFps);
+                if (now - m_lastProxyFrameTimes[i] >= interval) {
+                    m_proxyRecorders[i]->write(thumbnail);
+                    m_lastProxyFrameTimes[i] = now;
+                }
             }
         }
         
         // Handle fall events
         handleFallEvents();
         
+        // Evaluate inactivity and wandering rules
+        handleActivityAlerts();
+        
         // Clean up old recordings
         cleanupOldRecordings();
         
@@ -524,8 +845,13 @@ void Application::processFrame(size_t cameraIndex, cv::Mat& frame) {
     // Save movement records
     for (const auto& person : persons) {
         // For now, we'll use -1 as the userId since we don't have face recognition yet
-        saveMovementRecord(-1, person.id, person.boundingBox);
+        saveMovementRecord(cameraIndex, -1, person.id, person.boundingBox, frame.size());
     }
+    
+    // Tracks that left the scene are compacted and written out
+    int64_t nowMs = toEpochMs(std::chrono::system_clock::now());
+    m_trajectorySimplifier->closeIdleTracks(nowMs);
+    m_occupancyAggregator->closeIdleTracks(nowMs);
 }
 
 void Application::updateUI() {
@@ -555,30 +881,28 @@ void Application::updateUI() {
     cv::Mat ui(720, 1280, CV_8UC3, cv::Scalar(0, 0, 0));
     
     // Get frames
-    std::vector<cv::Mat> frames;
+    std::vector<FrameHandle> frames;
+    std::vector<cv::Mat> thumbnails;
     {
         std::lock_guard<std::mutex> lock(m_framesMutex);
         frames = m_cameraFrames;
+        thumbnails = m_cameraThumbnails;
     }
     
     // Draw active camera in main area
-    if (activeCameraIndex < frames.size() && !frames[activeCameraIndex].empty()) {
-        cv::Mat activeFrame = frames[activeCameraIndex].clone();
-        cv::resize(activeFrame, activeFrame, cv::Size(960, 720));
-        activeFrame.copyTo(ui(cv::Rect(0, 0, 960, 720)));
+    if (activeCameraIndex < frames.size() && frames[activeCameraIndex] && !frames[activeCameraIndex]->empty()) {
+        cv::Mat activeView = ui(cv::Rect(0, 0, 960, 720));
+        cv::resize(*frames[activeCameraIndex], activeView, cv::Size(960, 720));
     }
     
     // Draw sidebar with all cameras
-    for (size_t i = 0; i < numCameras && i < frames.size(); i++) {
-        if (frames[i].empty()) {
+    for (size_t i = 0; i < numCameras && i < thumbnails.size(); i++) {
+        if (thumbnails[i].empty()) {
             continue;
         }
         
-        cv::Mat thumbnail;
-        cv::resize(frames[i], thumbnail, cv::Size(320, 180));
-        
         int y = i * 180;
-        thumbnail.copyTo(ui(cv::Rect(960, y, 320, 180)));
+        thumbnails[i].copyTo(ui(cv::Rect(960, y, 320, 180)));
         
         // Highlight active camera
         if (i == activeCameraIndex) {
@@ -630,11 +954,36 @@ void Application::handleFallEvents() {
         if (it != fallEvents.end()) {
             // TODO: In a real implementation, we would use face recognition to identify the person
             // For now, we'll notify all users
-            std::vector<User> users = m_userDatabase->getAllUsers();
+            auto directory = m_userDatabase->getDirectory().getSnapshot();
             
-            for (const auto& user : users) {
-                m_notificationManager->notifyFallEvent(*it, user.id);
+            // Only frames that went through the privacy filters leave the home
+            FallEvent event = *it;
+            if (!m_alertSnapshotsEnabled || !m_privacyProtectionEnabled) {
+                event.frameSnapshot.release();
             }
+            
+            for (const auto& entry : directory->users) {
+                m_notificationManager->notifyFallEvent(event, entry.first);
+            }
+        }
+    }
+}
+
+void Application::handleActivityAlerts() {
+    m_activityRuleEngine->evaluate(toEpochMs(std::chrono::system_clock::now()));
+    
+    for (const auto& alert : m_activityRuleEngine->getNewAlerts()) {
+        std::cout << "Activity alert: " << alert.ruleName << " - " << alert.description << std::endl;
+        
+        // Rules bound to a resident notify their contacts; the rest go to everyone, as falls do
+        if (alert.userId >= 0) {
+            m_notificationManager->notifyActivityAlert(alert, alert.userId);
+            continue;
+        }
+        
+        auto directory = m_userDatabase->getDirectory().getSnapshot();
+        for (const auto& entry : directory->users) {
+            m_notificationManager->notifyActivityAlert(alert, entry.first);
         }
     }
 }
@@ -649,36 +998,21 @@ void Application::cleanupOldRecordings() {
     auto duration = std::chrono::duration_cast<std::chrono::hours>(now - m_recordingStartTime).count();
     
     if (duration >= 24) {
-        // Close current video writers
-        for (auto& writer : m_videoWriters) {
-            if (writer.isOpened()) {
-                writer.release();
-            }
-        }
+        // Close current video recorders
+        closeRecorders();
         
-        // Create new video writers
+        // Create new video recorders
         m_recordingStartTime = now;
         size_t numCameras = m_cameraManager->getCameraCount();
         
         for (size_t i = 0; i < numCameras; i++) {
-            auto timeT = std::chrono::system_clock::to_time_t(now);
-            std::tm* timeInfo = std::localtime(&timeT);
-            
-            char buffer[128];
-            strftime(buffer, sizeof(buffer), "%Y%m%d_%H%M%S", timeInfo);
-            
-            std::string filename = m_recordingDirectory + "/camera_" + 
-                                  std::to_string(i) + "_" + buffer + ".mp4";
-            
-            m_videoWriters[i].open(filename, 
-                                  cv::VideoWriter::fourcc('a', 'v', 'c', '1'), 
-                                  30, cv::Size(1280, 720));
+            openRecorders(i);
         }
         
         // Delete old recordings (older than 24 hours)
         try {
             for (const auto& entry : fs::directory_iterator(m_recordingDirectory)) {
-                if (entry.is_regular_file() && entry.path().extension() == ".mp4") {
+                if (entry.is_regular_file() && VideoRecorder::isRecordingFile(entry.path().string())) {
                     auto fileTime = fs::last_write_time(entry.path());
                     // Convert to time_t for comparison (C++17 compatible)
                     auto fileTimeT = fs::last_write_time(entry.path()).time_since_epoch().count();
@@ -687,6 +1021,7 @@ void Application::cleanupOldRecordings() {
                     
                     if (fileAge > 24) {
                         fs::remove(entry.path());
+                        m_recordingCatalog->removeSegment(entry.path().string());
                     }
                 }
             }
@@ -696,31 +1031,90 @@ void Application::cleanupOldRecordings() {
     }
 }
 
-void Application::saveMovementRecord(int userId, int personId, const cv::Rect& position) {
-    MovementRecord record;
-    record.userId = userId;
-    record.personId = personId;
-    record.timestamp = std::chrono::system_clock::now();
-    record.position = position;
+void Application::openRecorders(size_t cameraIndex) {
+    if (cameraIndex >= m_videoRecorders.size()) {
+        m_videoRecorders.resize(cameraIndex + 1);
+        m_proxyRecorders.resize(cameraIndex + 1);
+        m_lastProxyFrameTimes.resize(cameraIndex + 1);
+    }
+    
+    m_videoRecorders[cameraIndex] = openVideoRecorder(cameraIndex, RecordingCatalog::MAIN_RENDITION);
+    
+    if (m_proxyRecordingEnabled) {
+        m_proxyRecorders[cameraIndex] = openVideoRecorder(cameraIndex, RecordingCatalog::PROXY_RENDITION);
+        m_lastProxyFrameTimes[cameraIndex] = std::chrono::steady_clock::time_point();
+    }
+}
+
+void Application::closeRecorders() {
+    int64_t endTimeMs = toEpochMs(std::chrono::system_clock::now());
     
-    std::lock_guard<std::mutex> lock(m_historyMutex);
-    m_movementHistory.push_back(record);
+    for (auto* recorders : {&m_videoRecorders, &m_proxyRecorders}) {
+        for (auto& recorder : *recorders) {
+            if (recorder) {
+                recorder->release();
+                m_recordingCatalog->closeSegment(recorder->getFilePath(), endTimeMs);
+            }
+        }
+        recorders->clear();
+    }
+    m_lastProxyFrameTimes.clear();
 }
 
-void Application::cleanupOldMovementRecords() {
-    auto now = std::chrono::system_clock::now();
+std::unique_ptr<VideoRecorder> Application::openVideoRecorder(size_t cameraIndex, const std::string& rendition) {
+    auto timePoint = std::chrono::system_clock::now();
+    auto timeT = std::chrono::system_clock::to_time_t(timePoint);
+    std::tm* now = std::localtime(&timeT);
+    
+    char buffer[128];
+    strftime(buffer, sizeof(buffer), "%Y%m%d_%H%M%S", now);
     
-    std::lock_guard<std::mutex> lock(m_historyMutex);
+    std::string basePath = m_recordingDirectory + "/camera_" + 
+                          std::to_string(cameraIndex) + "_" + buffer;
     
-    // Remove records older than 24 hours
-    m_movementHistory.erase(
-        std::remove_if(m_movementHistory.begin(), m_movementHistory.end(),
-                      [&now](const MovementRecord& record) {
-                          auto age = std::chrono::duration_cast<std::chrono::hours>(
-                              now - record.timestamp).count();
-                          return age >= 24;
-                      }),
-        m_movementHistory.end());
+    VideoRecorder::Options options = m_recordingOptions;
+    if (rendition == RecordingCatalog::PROXY_RENDITION) {
+        basePath += "_proxy";
+        options.frameSize = kThumbnailSize;
+        options.fps = m_proxyFps;
+    }
+    
+    auto recorder = std::make_unique<VideoRecorder>(options);
+    if (!recorder->open(basePath)) {
+        return nullptr;
+    }
+    
+    RecordingEntry entry;
+    entry.cameraIndex = cameraIndex;
+    entry.rendition = rendition;
+    entry.path = recorder->getFilePath();
+    entry.startTimeMs = toEpochMs(timePoint);
+    entry.endTimeMs = 0;
+    entry.width = options.frameSize.width;
+    entry.height = options.frameSize.height;
+    entry.fps = options.fps;
+    m_recordingCatalog->addSegment(entry);
+    
+    return recorder;
+}
+
+void Application::saveMovementRecord(size_t cameraIndex, int userId, int personId, const cv::Rect& position,
+                                     const cv::Size& frameSize) {
+    MovementSample sample;
+    sample.timestampMs = toEpochMs(std::chrono::system_clock::now());
+    sample.trackId = personId;
+    sample.userId = userId;
+    sample.box = position;
+    
+    m_occupancyAggregator->addObservation(cameraIndex, sample, frameSize);
+    m_activityRuleEngine->addObservation(cameraIndex, sample);
+    m_trajectorySimplifier->addSample(cameraIndex, sample);
+}
+
+void Application::cleanupOldMovementRecords() {
+    // Remove records older than 24 hours; only whole expired chunks are touched
+    auto cutoff = std::chrono::system_clock::now() - std::chrono::hours(24);
+    m_movementStore.expireBefore(toEpochMs(cutoff));
 }
 
 void Application::drawPersonBoundingBoxes(cv::Mat& frame, const std::vector<DetectedPerson>& persons) {
@@ -825,7 +1219,9 @@ cv::Mat Application::getProcessedFrame(size_t cameraIndex) {
     cv::Mat frame;
     std::lock_guard<std::mutex> lock(m_framesMutex);
     if (cameraIndex < m_cameraFrames.size()) {
-        frame = m_cameraFrames[cameraIndex].clone();
+        if (m_cameraFrames[cameraIndex]) {
+            frame = m_cameraFrames[cameraIndex]->clone();
+        }
     } else {
         // Return an empty frame if the camera index is invalid
         frame = cv::Mat(480, 640, CV_8UC3, cv::Scalar(0, 0, 0));
@@ -835,8 +1231,52 @@ cv::Mat Application::getProcessedFrame(size_t cameraIndex) {
     return frame;
 }
 
+FrameHandle Application::getLatestFrame(size_t cameraIndex) {
+    std::lock_guard<std::mutex> lock(m_framesMutex);
+    if (cameraIndex < m_cameraFrames.size()) {
+        return m_cameraFrames[cameraIndex];
+    }
+    return nullptr;
+}
+
+void Application::registerFrameCallback(FrameCallback callback) {
+    std::lock_guard<std::mutex> lock(m_frameCallbacksMutex);
+    m_frameCallbacks.push_back(callback);
+}
+
 UserDatabase& Application::getUserDatabase() {
     return *m_userDatabase;
 }
 
+RecordingCatalog& Application::getRecordingCatalog() {
+    return *m_recordingCatalog;
+}
+
+MovementDatabase& Application::getMovementDatabase() {
+    return *m_movementDatabase;
+}
+
+EventLog& Application::getEventLog() {
+    return *m_eventLog;
+}
+
+TrajectorySimplifier::Stats Application::getMovementHistoryStats() const {
+    if (!m_trajectorySimplifier) {
+        return TrajectorySimplifier::Stats();
+    }
+    return m_trajectorySimplifier->getStats();
+}
+
+const ZoneMap& Application::getZoneMap() const {
+    return m_zoneMap;
+}
+
+OccupancyAggregator& Application::getOccupancyAggregator() {
+    return *m_occupancyAggregator;
+}
+
+ActivityRuleEngine& Application::getActivityRuleEngine() {
+    return *m_activityRuleEngine;
+}
+
 } // namespace hms
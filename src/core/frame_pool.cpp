@@ -0,0 +1,63 @@
+#include "core/frame_pool.hpp"
+
+namespace hms {
+
+FramePool::FramePool(size_t maxIdle)
+    : m_state(std::make_shared<State>()) {
+    m_state->maxIdle = maxIdle;
+}
+
+FramePool::Handle FramePool::acquire(int rows, int cols, int type) {
+    std::unique_ptr<cv::Mat> mat;
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (!m_state->idle.empty()) {
+            mat = std::move(m_state->idle.back());
+            m_state->idle.pop_back();
+        }
+    }
+    if (!mat) {
+        mat = std::make_unique<cv::Mat>();
+    }
+    
+    // A no-op for a buffer of the same size and type, the common case
+    bool allocates = mat->rows != rows || mat->cols != cols || mat->type() != type || mat->empty();
+    mat->create(rows, cols, type);
+    if (allocates) {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->allocations++;
+    }
+    
+    std::weak_ptr<State> weakState = m_state;
+    return Handle(mat.release(), [weakState](cv::Mat* released) { release(weakState, released); });
+}
+
+void FramePool::release(const std::weak_ptr<State>& weakState, cv::Mat* mat) {
+    std::unique_ptr<cv::Mat> owned(mat);
+    
+    // Someone kept a cv::Mat header onto the pixels; leave them to it
+    if (owned->u && owned->u->refcount > 1) {
+        owned->release();
+    }
+    
+    std::shared_ptr<State> state = weakState.lock();
+    if (!state) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (state->idle.size() < state->maxIdle) {
+        state->idle.push_back(std::move(owned));
+    }
+}
+
+size_t FramePool::getIdleCount() const {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->idle.size();
+}
+
+uint64_t FramePool::getAllocationCount() const {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->allocations;
+}
+
+} // namespace hms
@@ -0,0 +1,220 @@
+#include "core/recording_catalog.hpp"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include <sys/stat.h>
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace hms {
+
+static json entryToJson(const RecordingEntry& entry) {
+    return {
+        {"op", "add"},
+        {"camera", entry.cameraIndex},
+        {"rendition", entry.rendition},
+        {"path", entry.path},
+        {"start", entry.startTimeMs},
+        {"end", entry.endTimeMs},
+        {"width", entry.width},
+        {"height", entry.height},
+        {"fps", entry.fps}
+    };
+}
+
+// Last modification of a segment file, the closest record of when a crash
+// stopped it; 0 if unknown
+static int64_t modificationTimeMs(const std::string& path) {
+    struct stat info;
+    if (::stat(path.c_str(), &info) != 0) {
+        return 0;
+    }
+    return static_cast<int64_t>(info.st_mtim.tv_sec) * 1000 + info.st_mtim.tv_nsec / 1000000;
+}
+
+static bool coversTime(const RecordingEntry& entry, int64_t timeMs) {
+    return entry.startTimeMs <= timeMs && (entry.endTimeMs == 0 || timeMs < entry.endTimeMs);
+}
+
+RecordingCatalog::RecordingCatalog(const std::string& directory)
+    : m_catalogPath((fs::path(directory) / "catalog.jsonl").string()) {
+}
+
+RecordingCatalog::~RecordingCatalog() {
+}
+
+bool RecordingCatalog::load() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    
+    std::ifstream file(m_catalogPath);
+    if (!file.is_open()) {
+        return true;  // Nothing recorded yet
+    }
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        
+        try {
+            json record = json::parse(line);
+            std::string op = record["op"];
+            std::string path = record["path"];
+            
+            if (op == "add") {
+                RecordingEntry entry;
+                entry.cameraIndex = record["camera"];
+                entry.rendition = record["rendition"];
+                entry.path = path;
+                entry.startTimeMs = record["start"];
+                entry.endTimeMs = record["end"];
+                entry.width = record["width"];
+                entry.height = record["height"];
+                entry.fps = record["fps"];
+                m_entries.push_back(entry);
+            } else if (op == "close") {
+                for (auto& entry : m_entries) {
+                    if (entry.path == path) {
+                        entry.endTimeMs = record["end"];
+                    }
+                }
+            } else if (op == "remove") {
+                m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(),
+                                               [&path](const RecordingEntry& entry) {
+                                                   return entry.path == path;
+                                               }),
+                                m_entries.end());
+            }
+        } catch (const std::exception& e) {
+            // A torn last line after a crash is expected; skip it
+            std::cerr << "Skipping invalid catalog record: " << e.what() << std::endl;
+        }
+    }
+    file.close();
+    
+    // Segments whose file is gone were deleted outside the application
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(),
+                                   [](const RecordingEntry& entry) {
+                                       return !fs::exists(entry.path);
+                                   }),
+                    m_entries.end());
+    
+    // Nothing is being written while the catalog loads, so a segment still
+    // open was cut short by a crash. Close it where the next segment of the
+    // same camera and rendition starts, or else when its file last changed,
+    // so it does not cover every time after it.
+    for (auto& entry : m_entries) {
+        if (entry.endTimeMs != 0) {
+            continue;
+        }
+        int64_t endTimeMs = 0;
+        for (const auto& next : m_entries) {
+            if (next.cameraIndex == entry.cameraIndex && next.rendition == entry.rendition &&
+                next.startTimeMs > entry.startTimeMs && (endTimeMs == 0 || next.startTimeMs < endTimeMs)) {
+                endTimeMs = next.startTimeMs;
+            }
+        }
+        if (endTimeMs == 0) {
+            endTimeMs = modificationTimeMs(entry.path);
+        }
+        entry.endTimeMs = std::max(endTimeMs, entry.startTimeMs + 1);
+    }
+    
+    // Compact the log so it holds one record per live segment
+    std::string tempPath = m_catalogPath + ".tmp";
+    std::ofstream compacted(tempPath, std::ios::trunc);
+    if (!compacted.is_open()) {
+        std::cerr << "Failed to compact recording catalog: " << m_catalogPath << std::endl;
+        return false;
+    }
+    for (const auto& entry : m_entries) {
+        compacted << entryToJson(entry).dump() << "\n";
+    }
+    compacted.close();
+    
+    std::error_code ec;
+    fs::rename(tempPath, m_catalogPath, ec);
+    if (ec) {
+        std::cerr << "Failed to replace recording catalog: " << ec.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void RecordingCatalog::addSegment(const RecordingEntry& entry) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.push_back(entry);
+    appendLine(entryToJson(entry).dump());
+}
+
+void RecordingCatalog::closeSegment(const std::string& path, int64_t endTimeMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& entry : m_entries) {
+        if (entry.path == path) {
+            entry.endTimeMs = endTimeMs;
+        }
+    }
+    appendLine(json{{"op", "close"}, {"path", path}, {"end", endTimeMs}}.dump());
+}
+
+void RecordingCatalog::removeSegment(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = std::remove_if(m_entries.begin(), m_entries.end(),
+                             [&path](const RecordingEntry& entry) {
+                                 return entry.path == path;
+                             });
+    if (it == m_entries.end()) {
+        return;
+    }
+    m_entries.erase(it, m_entries.end());
+    appendLine(json{{"op", "remove"}, {"path", path}}.dump());
+}
+
+std::vector<RecordingEntry> RecordingCatalog::getSegments(size_t cameraIndex, int64_t fromMs, int64_t toMs) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<RecordingEntry> segments;
+    for (const auto& entry : m_entries) {
+        bool overlaps = entry.startTimeMs < toMs && (entry.endTimeMs == 0 || entry.endTimeMs > fromMs);
+        if (entry.cameraIndex == cameraIndex && overlaps) {
+            segments.push_back(entry);
+        }
+    }
+    return segments;
+}
+
+std::optional<RecordingEntry> RecordingCatalog::findScrubbingSegment(size_t cameraIndex, int64_t timeMs) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::optional<RecordingEntry> mainSegment;
+    for (const auto& entry : m_entries) {
+        if (entry.cameraIndex != cameraIndex || !coversTime(entry, timeMs)) {
+            continue;
+        }
+        if (entry.rendition == PROXY_RENDITION) {
+            return entry;
+        }
+        if (!mainSegment) {
+            mainSegment = entry;
+        }
+    }
+    return mainSegment;
+}
+
+std::string RecordingCatalog::getCatalogPath() const {
+    return m_catalogPath;
+}
+
+void RecordingCatalog::appendLine(const std::string& line) {
+    std::ofstream file(m_catalogPath, std::ios::app);
+    if (!file.is_open()) {
+        std::cerr << "Failed to append to recording catalog: " << m_catalogPath << std::endl;
+        return;
+    }
+    file << line << "\n";
+}
+
+} // namespace hms
@@ -0,0 +1,285 @@
+#include "core/video_recorder.hpp"
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace hms {
+
+// Pause after a failed poll or read so a persistent error does not spin
+static const int kErrorBackoffMs = 10;
+
+// Make the directory entry of a freshly created file durable, otherwise the
+// file itself can vanish on power loss even though its data was synced.
+static void syncParentDirectory(const std::string& filePath) {
+    std::string dir = fs::path(filePath).parent_path().string();
+    if (dir.empty()) {
+        dir = ".";
+    }
+    
+    int dirFd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+}
+
+VideoRecorder::VideoRecorder(const Options& options)
+    : m_options(options), m_fifoFd(-1), m_fileFd(-1), m_opened(false),
+      m_framesWritten(0), m_syncedBytes(0) {
+    if (m_options.writeBufferBytes == 0) {
+        m_options.writeBufferBytes = 1 << 20;
+    }
+    if (m_options.fsyncIntervalMs <= 0) {
+        m_options.fsyncIntervalMs = 1000;
+    }
+}
+
+VideoRecorder::~VideoRecorder() {
+    release();
+}
+
+bool VideoRecorder::open(const std::string& basePath) {
+    release();
+    
+    m_filePath = basePath + getExtension(m_options.container);
+    m_framesWritten = 0;
+    m_syncedBytes = 0;
+    
+    if (m_options.container == Container::MP4) {
+        m_opened = m_writer.open(m_filePath, m_options.fourcc, m_options.fps, m_options.frameSize);
+        if (!m_opened) {
+            std::cerr << "Failed to open video writer: " << m_filePath << std::endl;
+        }
+        return m_opened;
+    }
+    
+    m_opened = openStreaming();
+    if (!m_opened) {
+        closeDescriptors();
+    }
+    return m_opened;
+}
+
+bool VideoRecorder::openStreaming() {
+    fs::path file(m_filePath);
+    m_fifoPath = (file.parent_path() /
+                  ("." + file.stem().string() + ".pipe" + file.extension().string())).string();
+    
+    // A FIFO may be left behind by a previous crash
+    ::unlink(m_fifoPath.c_str());
+    if (::mkfifo(m_fifoPath.c_str(), 0600) != 0) {
+        std::cerr << "Failed to create recording FIFO " << m_fifoPath << ": "
+                  << std::strerror(errno) << std::endl;
+        return false;
+    }
+    
+    // Open the read end without blocking so the encoder's open() can complete
+    m_fifoFd = ::open(m_fifoPath.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fifoFd < 0) {
+        std::cerr << "Failed to open recording FIFO: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    
+    // A larger pipe lets the encoder run ahead while a write or fsync is in flight
+    ::fcntl(m_fifoFd, F_SETPIPE_SZ, 1 << 20);
+    
+    m_fileFd = ::open(m_filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_fileFd < 0) {
+        std::cerr << "Failed to create recording file " << m_filePath << ": "
+                  << std::strerror(errno) << std::endl;
+        return false;
+    }
+    syncParentDirectory(m_filePath);
+    
+    // The muxer is picked from the FIFO's extension and sees a non-seekable
+    // output, so it streams without ever seeking back for an index
+    if (!m_writer.open(m_fifoPath, cv::CAP_FFMPEG, m_options.fourcc,
+                       m_options.fps, m_options.frameSize)) {
+        std::cerr << "Failed to open video writer: " << m_filePath << std::endl;
+        return false;
+    }
+    
+    int flags = ::fcntl(m_fifoFd, F_GETFL);
+    ::fcntl(m_fifoFd, F_SETFL, flags & ~O_NONBLOCK);
+    
+    m_drainThread = std::thread(&VideoRecorder::drainThreadFunc, this);
+    return true;
+}
+
+void VideoRecorder::write(const cv::Mat& frame) {
+    if (!m_opened) {
+        return;
+    }
+    
+    m_writer.write(frame);
+    m_framesWritten++;
+}
+
+void VideoRecorder::release() {
+    if (m_writer.isOpened()) {
+        // Closing the encoder closes the FIFO's write end; the drain thread
+        // sees EOF, flushes what is left and performs a final sync
+        m_writer.release();
+    }
+    
+    if (m_drainThread.joinable()) {
+        m_drainThread.join();
+    }
+    
+    closeDescriptors();
+    m_opened = false;
+}
+
+bool VideoRecorder::isOpened() const {
+    return m_opened;
+}
+
+std::string VideoRecorder::getFilePath() const {
+    return m_filePath;
+}
+
+uint64_t VideoRecorder::getFramesWritten() const {
+    return m_framesWritten;
+}
+
+uint64_t VideoRecorder::getSyncedBytes() const {
+    return m_syncedBytes;
+}
+
+void VideoRecorder::drainThreadFunc() {
+    std::vector<char> buffer(m_options.writeBufferBytes);
+    size_t used = 0;
+    uint64_t written = 0;
+    bool failed = false;
+    bool eof = false;
+    
+    auto interval = std::chrono::milliseconds(m_options.fsyncIntervalMs);
+    auto nextSync = std::chrono::steady_clock::now() + interval;
+    
+    while (!eof) {
+        auto now = std::chrono::steady_clock::now();
+        int timeoutMs = static_cast<int>(std::max<int64_t>(0,
+            std::chrono::duration_cast<std::chrono::milliseconds>(nextSync - now).count()));
+        
+        pollfd pfd;
+        pfd.fd = m_fifoFd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        
+        // Like a disk error, a pipe error fails the recording but not the
+        // loop: the encoder must never block on a pipe nobody drains
+        int rc = ::poll(&pfd, 1, timeoutMs);
+        if (rc < 0 && errno != EINTR) {
+            if (!failed) {
+                std::cerr << "Recording poll failed: " << std::strerror(errno) << std::endl;
+            }
+            failed = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(kErrorBackoffMs));
+            continue;
+        }
+        
+        if (rc > 0) {
+            ssize_t n = ::read(m_fifoFd, buffer.data() + used, buffer.size() - used);
+            if (n > 0) {
+                used += static_cast<size_t>(n);
+            } else if (n == 0) {
+                eof = true;
+            } else if (errno != EINTR && errno != EAGAIN) {
+                if (!failed) {
+                    std::cerr << "Recording read failed: " << std::strerror(errno) << std::endl;
+                }
+                failed = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(kErrorBackoffMs));
+            }
+        }
+        
+        bool due = std::chrono::steady_clock::now() >= nextSync;
+        if (used == buffer.size() || due || eof) {
+            if (used > 0) {
+                // Keep draining after an error, but stop touching the file
+                if (!failed && writeFully(buffer.data(), used)) {
+                    written += used;
+                } else {
+                    failed = true;
+                }
+                used = 0;
+            }
+            
+            if (due || eof) {
+                if (!failed && written != m_syncedBytes && ::fdatasync(m_fileFd) == 0) {
+                    m_syncedBytes = written;
+                }
+                nextSync = std::chrono::steady_clock::now() + interval;
+            }
+        }
+    }
+}
+
+bool VideoRecorder::writeFully(const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(m_fileFd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Recording write failed for " << m_filePath << ": "
+                      << std::strerror(errno) << std::endl;
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void VideoRecorder::closeDescriptors() {
+    if (m_fifoFd >= 0) {
+        ::close(m_fifoFd);
+        m_fifoFd = -1;
+    }
+    if (m_fileFd >= 0) {
+        ::close(m_fileFd);
+        m_fileFd = -1;
+    }
+    if (!m_fifoPath.empty()) {
+        ::unlink(m_fifoPath.c_str());
+        m_fifoPath.clear();
+    }
+}
+
+std::string VideoRecorder::getExtension(Container container) {
+    switch (container) {
+        case Container::MP4:
+            return ".mp4";
+        case Container::MPEG_TS:
+            return ".ts";
+        case Container::MATROSKA:
+            return ".mkv";
+    }
+    return ".ts";
+}
+
+VideoRecorder::Container VideoRecorder::containerFromString(const std::string& format) {
+    if (format == "mp4") {
+        return Container::MP4;
+    } else if (format == "mkv" || format == "matroska") {
+        return Container::MATROSKA;
+    }
+    return Container::MPEG_TS;
+}
+
+bool VideoRecorder::isRecordingFile(const std::string& path) {
+    std::string ext = fs::path(path).extension().string();
+    return ext == ".mp4" || ext == ".ts" || ext == ".mkv";
+}
+
+} // namespace hms
@@ -0,0 +1,345 @@
+#include "database/event_log.hpp"
+#include "database/schema_migrator.hpp"
+#include <iostream>
+#include <chrono>
+
+namespace hms {
+
+static int64_t currentTimeMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static const char* const kEventTypeNames[] = {
+    "fall_detected",
+    "activity_alert",
+    "notification_queued",
+    "notification_sent",
+    "notification_failed",
+    "response_received",
+    "alert_escalated"
+};
+
+const char* eventTypeToString(EventType type) {
+    return kEventTypeNames[static_cast<int>(type)];
+}
+
+bool eventTypeFromString(const std::string& text, EventType& type) {
+    for (size_t i = 0; i < sizeof(kEventTypeNames) / sizeof(kEventTypeNames[0]); i++) {
+        if (text == kEventTypeNames[i]) {
+            type = static_cast<EventType>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Quotes a field when it contains a separator, quote or line break
+static std::string csvField(const std::string& value) {
+    if (value.find_first_of(",\"\r\n") == std::string::npos) {
+        return value;
+    }
+    
+    std::string quoted = "\"";
+    for (char c : value) {
+        if (c == '"') {
+            quoted += '"';
+        }
+        quoted += c;
+    }
+    quoted += '"';
+    return quoted;
+}
+
+void writeEventsCsv(std::ostream& out, const std::vector<EventRecord>& events) {
+    out << "id,timestamp_ms,type,camera,track_id,user_id,status,recipient,subject,detail\n";
+    for (const auto& event : events) {
+        out << event.id << ','
+            << event.timestampMs << ','
+            << eventTypeToString(event.type) << ','
+            << event.cameraIndex << ','
+            << event.trackId << ','
+            << event.userId << ','
+            << csvField(event.status) << ','
+            << csvField(event.recipient) << ','
+            << csvField(event.subject) << ','
+            << csvField(event.detail) << '\n';
+    }
+}
+
+EventLog::EventLog(const std::string& dbPath)
+    : EventLog(dbPath, Options()) {
+}
+
+EventLog::EventLog(const std::string& dbPath, const Options& options)
+    : m_dbPath(dbPath), m_options(options), m_writeDb(nullptr), m_readDb(nullptr),
+      m_insertStmt(nullptr), m_initialized(false), m_lastPurgeMs(0) {
+}
+
+EventLog::~EventLog() {
+    shutdown();
+}
+
+bool EventLog::initialize() {
+    if (m_initialized) {
+        return true;
+    }
+    
+    int rc = sqlite3_open(m_dbPath.c_str(), &m_writeDb);
+    if (rc != SQLITE_OK) {
+        std::cerr << "Cannot open event log: " << sqlite3_errmsg(m_writeDb) << std::endl;
+        sqlite3_close(m_writeDb);
+        m_writeDb = nullptr;
+        return false;
+    }
+    
+    // Same durability trade-off as the movement history: WAL so the history
+    // view can read during a batch, NORMAL sync so a batch costs no fsync
+    sqlite3_busy_timeout(m_writeDb, 1000);
+    executeSql(m_writeDb, "PRAGMA journal_mode = WAL;");
+    executeSql(m_writeDb, "PRAGMA synchronous = NORMAL;");
+    if (!migrateSchema()) {
+        shutdown();
+        return false;
+    }
+    
+    rc = sqlite3_prepare_v2(m_writeDb,
+                            "INSERT INTO events "
+                            "(type, timestamp_ms, camera, track_id, user_id, status, recipient, subject, detail) "
+                            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);",
+                            -1, &m_insertStmt, nullptr);
+    if (rc != SQLITE_OK) {
+        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_writeDb) << std::endl;
+        shutdown();
+        return false;
+    }
+    
+    rc = sqlite3_open_v2(m_dbPath.c_str(), &m_readDb, SQLITE_OPEN_READONLY, nullptr);
+    if (rc != SQLITE_OK) {
+        std::cerr << "Cannot open event log for reading: " << sqlite3_errmsg(m_readDb) << std::endl;
+        shutdown();
+        return false;
+    }
+    sqlite3_busy_timeout(m_readDb, 1000);
+    
+    m_writer = std::make_unique<AsyncBatchWriter<EventRecord>>(
+        [this](const std::vector<EventRecord>& batch) { return writeBatch(batch); },
+        m_options.flushIntervalMs, m_options.batchSize, m_options.maxQueuedEvents);
+    m_writer->start();
+    
+    m_initialized = true;
+    return true;
+}
+
+bool EventLog::isInitialized() const {
+    return m_initialized;
+}
+
+void EventLog::shutdown() {
+    // Stopping the writer writes out whatever is still queued
+    if (m_writer) {
+        m_writer->stop();
+    }
+    
+    if (m_insertStmt) {
+        sqlite3_finalize(m_insertStmt);
+        m_insertStmt = nullptr;
+    }
+    if (m_writeDb) {
+        executeSql(m_writeDb, "PRAGMA optimize;");
+    }
+    if (m_readDb) {
+        sqlite3_close(m_readDb);
+        m_readDb = nullptr;
+    }
+    if (m_writeDb) {
+        sqlite3_close(m_writeDb);
+        m_writeDb = nullptr;
+    }
+    m_initialized = false;
+}
+
+bool EventLog::migrateSchema() {
+    // Append new steps at the end; never edit one that has shipped
+    SchemaMigrator migrator("event log");
+    
+    // Both indexes end in timestamp_ms so range scans come out in time order
+    migrator.addMigration(1, "events with user and time indexes",
+        "CREATE TABLE events ("
+        "id INTEGER PRIMARY KEY,"
+        "type TEXT NOT NULL,"
+        "timestamp_ms INTEGER NOT NULL,"
+        "camera INTEGER NOT NULL,"
+        "track_id INTEGER NOT NULL,"
+        "user_id INTEGER NOT NULL,"
+        "status TEXT,"
+        "recipient TEXT,"
+        "subject TEXT,"
+        "detail TEXT"
+        ");"
+        "CREATE INDEX idx_events_user_time ON events (user_id, timestamp_ms);"
+        "CREATE INDEX idx_events_time ON events (timestamp_ms);");
+    
+    return migrator.migrate(m_writeDb);
+}
+
+bool EventLog::executeSql(sqlite3* db, const std::string& sql) {
+    char* errMsg = nullptr;
+    int rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg);
+    
+    if (rc != SQLITE_OK) {
+        std::cerr << "SQL error: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    
+    return true;
+}
+
+bool EventLog::log(const EventRecord& event) {
+    if (!m_initialized) {
+        return false;
+    }
+    
+    return m_writer->enqueue(event);
+}
+
+void EventLog::flush() {
+    if (m_writer) {
+        m_writer->flush();
+    }
+}
+
+bool EventLog::writeBatch(const std::vector<EventRecord>& batch) {
+    if (!executeSql(m_writeDb, "BEGIN TRANSACTION;")) {
+        return false;
+    }
+    
+    for (const auto& event : batch) {
+        sqlite3_bind_text(m_insertStmt, 1, eventTypeToString(event.type), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(m_insertStmt, 2, event.timestampMs);
+        sqlite3_bind_int(m_insertStmt, 3, event.cameraIndex);
+        sqlite3_bind_int(m_insertStmt, 4, event.trackId);
+        sqlite3_bind_int(m_insertStmt, 5, event.userId);
+        sqlite3_bind_text(m_insertStmt, 6, event.status.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(m_insertStmt, 7, event.recipient.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(m_insertStmt, 8, event.subject.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(m_insertStmt, 9, event.detail.c_str(), -1, SQLITE_STATIC);
+        
+        int rc = sqlite3_step(m_insertStmt);
+        sqlite3_reset(m_insertStmt);
+        
+        if (rc != SQLITE_DONE) {
+            std::cerr << "SQL step error: " << sqlite3_errmsg(m_writeDb) << std::endl;
+            executeSql(m_writeDb, "ROLLBACK;");
+            return false;
+        }
+    }
+    
+    if (!executeSql(m_writeDb, "COMMIT;")) {
+        executeSql(m_writeDb, "ROLLBACK;");
+        return false;
+    }
+    
+    purgeExpired();
+    return true;
+}
+
+void EventLog::purgeExpired() {
+    if (m_options.retentionDays <= 0) {
+        return;
+    }
+    
+    int64_t now = currentTimeMs();
+    if (now - m_lastPurgeMs < 3600 * 1000) {
+        return;
+    }
+    m_lastPurgeMs = now;
+    
+    int64_t cutoff = now - static_cast<int64_t>(m_options.retentionDays) * 24 * 3600 * 1000;
+    executeSql(m_writeDb, "DELETE FROM events WHERE timestamp_ms < " + std::to_string(cutoff) + ";");
+}
+
+static std::string columnText(sqlite3_stmt* stmt, int column) {
+    const unsigned char* text = sqlite3_column_text(stmt, column);
+    return text ? reinterpret_cast<const char*>(text) : "";
+}
+
+std::vector<EventRecord> EventLog::runQuery(const std::string& sql,
+                                            const std::function<void(sqlite3_stmt*)>& bind) {
+    std::vector<EventRecord> events;
+    if (!m_initialized) {
+        return events;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_readMutex);
+    
+    sqlite3_stmt* stmt;
+    int rc = sqlite3_prepare_v2(m_readDb, sql.c_str(), -1, &stmt, nullptr);
+    if (rc != SQLITE_OK) {
+        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_readDb) << std::endl;
+        return events;
+    }
+    
+    bind(stmt);
+    
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        EventRecord event;
+        event.id = sqlite3_column_int64(stmt, 0);
+        if (!eventTypeFromString(columnText(stmt, 1), event.type)) {
+            std::cerr << "Unknown event type: " << columnText(stmt, 1) << std::endl;
+            continue;
+        }
+        event.timestampMs = sqlite3_column_int64(stmt, 2);
+        event.cameraIndex = sqlite3_column_int(stmt, 3);
+        event.trackId = sqlite3_column_int(stmt, 4);
+        event.userId = sqlite3_column_int(stmt, 5);
+        event.status = columnText(stmt, 6);
+        event.recipient = columnText(stmt, 7);
+        event.subject = columnText(stmt, 8);
+        event.detail = columnText(stmt, 9);
+        events.push_back(event);
+    }
+    
+    if (rc != SQLITE_DONE) {
+        std::cerr << "SQL step error: " << sqlite3_errmsg(m_readDb) << std::endl;
+    }
+    
+    sqlite3_finalize(stmt);
+    return events;
+}
+
+std::vector<EventRecord> EventLog::getEventsByUser(int userId, int64_t fromMs, int64_t toMs) {
+    return runQuery("SELECT id, type, timestamp_ms, camera, track_id, user_id, "
+                    "status, recipient, subject, detail "
+                    "FROM events "
+                    "WHERE user_id = ? AND timestamp_ms >= ? AND timestamp_ms < ? "
+                    "ORDER BY timestamp_ms, id;",
+                    [&](sqlite3_stmt* stmt) {
+                        sqlite3_bind_int(stmt, 1, userId);
+                        sqlite3_bind_int64(stmt, 2, fromMs);
+                        sqlite3_bind_int64(stmt, 3, toMs);
+                    });
+}
+
+std::vector<EventRecord> EventLog::getEvents(int64_t fromMs, int64_t toMs) {
+    return runQuery("SELECT id, type, timestamp_ms, camera, track_id, user_id, "
+                    "status, recipient, subject, detail "
+                    "FROM events "
+                    "WHERE timestamp_ms >= ? AND timestamp_ms < ? "
+                    "ORDER BY timestamp_ms, id;",
+                    [&](sqlite3_stmt* stmt) {
+                        sqlite3_bind_int64(stmt, 1, fromMs);
+                        sqlite3_bind_int64(stmt, 2, toMs);
+                    });
+}
+
+uint64_t EventLog::getWrittenCount() const {
+    return m_writer ? m_writer->getWrittenCount() : 0;
+}
+
+uint64_t EventLog::getDroppedCount() const {
+    return m_writer ? m_writer->getDroppedCount() : 0;
+}
+
+} // namespace hms
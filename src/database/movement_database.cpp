@@ -0,0 +1,311 @@
+#include "database/movement_database.hpp"
+#include <iostream>
+#include <chrono>
+
+namespace hms {
+
+static int64_t currentTimeMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+MovementDatabase::MovementDatabase(const std::string& dbPath)
+    : MovementDatabase(dbPath, Options()) {
+}
+
+MovementDatabase::MovementDatabase(const std::string& dbPath, const Options& options)
+    : m_dbPath(dbPath), m_options(options), m_writeDb(nullptr), m_readDb(nullptr),
+      m_insertStmt(nullptr), m_initialized(false), m_lastPurgeMs(0) {
+}
+
+MovementDatabase::~MovementDatabase() {
+    shutdown();
+}
+
+bool MovementDatabase::initialize() {
+    if (m_initialized) {
+        return true;
+    }
+    
+    int rc = sqlite3_open(m_dbPath.c_str(), &m_writeDb);
+    if (rc != SQLITE_OK) {
+        std::cerr << "Cannot open movement database: " << sqlite3_errmsg(m_writeDb) << std::endl;
+        sqlite3_close(m_writeDb);
+        m_writeDb = nullptr;
+        return false;
+    }
+    
+    // WAL lets the query connection read while a batch is being committed;
+    // NORMAL sync is durable at checkpoints, which is enough for history
+    executeSql(m_writeDb, "PRAGMA journal_mode = WAL;");
+    executeSql(m_writeDb, "PRAGMA synchronous = NORMAL;");
+    createTables();
+    
+    rc = sqlite3_prepare_v2(m_writeDb,
+                            "INSERT INTO movement_samples "
+                            "(camera, track_id, user_id, timestamp_ms, x, y, width, height) "
+                            "VALUES (?, ?, ?, ?, ?, ?, ?, ?);",
+                            -1, &m_insertStmt, nullptr);
+    if (rc != SQLITE_OK) {
+        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_writeDb) << std::endl;
+        shutdown();
+        return false;
+    }
+    
+    rc = sqlite3_open_v2(m_dbPath.c_str(), &m_readDb, SQLITE_OPEN_READONLY, nullptr);
+    if (rc != SQLITE_OK) {
+        std::cerr << "Cannot open movement database for reading: " << sqlite3_errmsg(m_readDb) << std::endl;
+        shutdown();
+        return false;
+    }
+    sqlite3_busy_timeout(m_readDb, 1000);
+    
+    m_writer = std::make_unique<AsyncBatchWriter<MovementRecord>>(
+        [this](const std::vector<MovementRecord>& batch) { return writeBatch(batch); },
+        m_options.flushIntervalMs, m_options.batchSize, m_options.maxQueuedSamples);
+    m_writer->start();
+    
+    m_initialized = true;
+    return true;
+}
+
+bool MovementDatabase::isInitialized() const {
+    return m_initialized;
+}
+
+void MovementDatabase::shutdown() {
+    // Stopping the writer writes out whatever is still queued
+    if (m_writer) {
+        m_writer->stop();
+    }
+    
+    if (m_insertStmt) {
+        sqlite3_finalize(m_insertStmt);
+        m_insertStmt = nullptr;
+    }
+    if (m_writeDb) {
+        // Refresh planner statistics so queries keep picking the right index
+        executeSql(m_writeDb, "PRAGMA optimize;");
+    }
+    {
+        // A query may still be running on another thread
+        std::lock_guard<std::mutex> lock(m_readMutex);
+        if (m_readDb) {
+            sqlite3_close(m_readDb);
+            m_readDb = nullptr;
+        }
+    }
+    if (m_writeDb) {
+        sqlite3_close(m_writeDb);
+        m_writeDb = nullptr;
+    }
+    m_initialized = false;
+}
+
+void MovementDatabase::createTables() {
+    std::string sql = "CREATE TABLE IF NOT EXISTS movement_samples ("
+                      "camera INTEGER NOT NULL,"
+                      "track_id INTEGER NOT NULL,"
+                      "user_id INTEGER NOT NULL,"
+                      "timestamp_ms INTEGER NOT NULL,"
+                      "x INTEGER NOT NULL,"
+                      "y INTEGER NOT NULL,"
+                      "width INTEGER NOT NULL,"
+                      "height INTEGER NOT NULL"
+                      ");";
+    executeSql(m_writeDb, sql);
+    
+    // One index per query shape; each ends in timestamp_ms so range scans
+    // come out in time order without a sort. Until statistics exist SQLite
+    // breaks ties by creation order, so the more selective track index
+    // comes first.
+    executeSql(m_writeDb, "CREATE INDEX IF NOT EXISTS idx_movement_track_time "
+                          "ON movement_samples (camera, track_id, timestamp_ms);");
+    executeSql(m_writeDb, "CREATE INDEX IF NOT EXISTS idx_movement_camera_time "
+                          "ON movement_samples (camera, timestamp_ms);");
+    executeSql(m_writeDb, "CREATE INDEX IF NOT EXISTS idx_movement_user_time "
+                          "ON movement_samples (user_id, timestamp_ms);");
+    // For the startup reload and retention, which filter on time alone
+    executeSql(m_writeDb, "CREATE INDEX IF NOT EXISTS idx_movement_time "
+                          "ON movement_samples (timestamp_ms);");
+}
+
+bool MovementDatabase::executeSql(sqlite3* db, const std::string& sql) {
+    char* errMsg = nullptr;
+    int rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg);
+    
+    if (rc != SQLITE_OK) {
+        std::cerr << "SQL error: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    
+    return true;
+}
+
+bool MovementDatabase::addSamples(size_t cameraIndex, const std::vector<MovementSample>& samples) {
+    if (!m_initialized) {
+        return false;
+    }
+    
+    std::vector<MovementRecord> records;
+    records.reserve(samples.size());
+    for (const auto& sample : samples) {
+        records.push_back({cameraIndex, sample});
+    }
+    return m_writer->enqueue(records);
+}
+
+void MovementDatabase::flush() {
+    if (m_writer) {
+        m_writer->flush();
+    }
+}
+
+bool MovementDatabase::writeBatch(const std::vector<MovementRecord>& batch) {
+    if (!executeSql(m_writeDb, "BEGIN TRANSACTION;")) {
+        return false;
+    }
+    
+    for (const auto& record : batch) {
+        const MovementSample& sample = record.sample;
+        sqlite3_bind_int64(m_insertStmt, 1, static_cast<sqlite3_int64>(record.cameraIndex));
+        sqlite3_bind_int(m_insertStmt, 2, sample.trackId);
+        sqlite3_bind_int(m_insertStmt, 3, sample.userId);
+        sqlite3_bind_int64(m_insertStmt, 4, sample.timestampMs);
+        sqlite3_bind_int(m_insertStmt, 5, sample.box.x);
+        sqlite3_bind_int(m_insertStmt, 6, sample.box.y);
+        sqlite3_bind_int(m_insertStmt, 7, sample.box.width);
+        sqlite3_bind_int(m_insertStmt, 8, sample.box.height);
+        
+        int rc = sqlite3_step(m_insertStmt);
+        sqlite3_reset(m_insertStmt);
+        
+        if (rc != SQLITE_DONE) {
+            std::cerr << "SQL step error: " << sqlite3_errmsg(m_writeDb) << std::endl;
+            executeSql(m_writeDb, "ROLLBACK;");
+            return false;
+        }
+    }
+    
+    if (!executeSql(m_writeDb, "COMMIT;")) {
+        executeSql(m_writeDb, "ROLLBACK;");
+        return false;
+    }
+    
+    purgeExpired();
+    return true;
+}
+
+void MovementDatabase::purgeExpired() {
+    if (m_options.retentionDays <= 0) {
+        return;
+    }
+    
+    // Hourly is plenty for a retention measured in days
+    int64_t now = currentTimeMs();
+    if (now - m_lastPurgeMs < 3600 * 1000) {
+        return;
+    }
+    m_lastPurgeMs = now;
+    
+    int64_t cutoff = now - static_cast<int64_t>(m_options.retentionDays) * 24 * 3600 * 1000;
+    executeSql(m_writeDb, "DELETE FROM movement_samples WHERE timestamp_ms < " +
+                          std::to_string(cutoff) + ";");
+}
+
+std::vector<MovementRecord> MovementDatabase::runQuery(const std::string& sql,
+                                                       const std::function<void(sqlite3_stmt*)>& bind) {
+    std::vector<MovementRecord> records;
+    if (!m_initialized) {
+        return records;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_readMutex);
+    
+    sqlite3_stmt* stmt;
+    int rc = sqlite3_prepare_v2(m_readDb, sql.c_str(), -1, &stmt, nullptr);
+    if (rc != SQLITE_OK) {
+        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_readDb) << std::endl;
+        return records;
+    }
+    
+    bind(stmt);
+    
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        MovementRecord record;
+        record.cameraIndex = static_cast<size_t>(sqlite3_column_int64(stmt, 0));
+        record.sample.trackId = sqlite3_column_int(stmt, 1);
+        record.sample.userId = sqlite3_column_int(stmt, 2);
+        record.sample.timestampMs = sqlite3_column_int64(stmt, 3);
+        record.sample.box = cv::Rect(sqlite3_column_int(stmt, 4), sqlite3_column_int(stmt, 5),
+                                     sqlite3_column_int(stmt, 6), sqlite3_column_int(stmt, 7));
+        records.push_back(record);
+    }
+    
+    if (rc != SQLITE_DONE) {
+        std::cerr << "SQL step error: " << sqlite3_errmsg(m_readDb) << std::endl;
+    }
+    
+    sqlite3_finalize(stmt);
+    return records;
+}
+
+std::vector<MovementRecord> MovementDatabase::getMovementsByCamera(size_t cameraIndex,
+                                                                   int64_t fromMs, int64_t toMs) {
+    return runQuery("SELECT camera, track_id, user_id, timestamp_ms, x, y, width, height "
+                    "FROM movement_samples "
+                    "WHERE camera = ? AND timestamp_ms >= ? AND timestamp_ms < ? "
+                    "ORDER BY timestamp_ms;",
+                    [&](sqlite3_stmt* stmt) {
+                        sqlite3_bind_int64(stmt, 1, static_cast<sqlite3_int64>(cameraIndex));
+                        sqlite3_bind_int64(stmt, 2, fromMs);
+                        sqlite3_bind_int64(stmt, 3, toMs);
+                    });
+}
+
+std::vector<MovementRecord> MovementDatabase::getMovementsByTrack(size_t cameraIndex, int trackId,
+                                                                  int64_t fromMs, int64_t toMs) {
+    return runQuery("SELECT camera, track_id, user_id, timestamp_ms, x, y, width, height "
+                    "FROM movement_samples "
+                    "WHERE camera = ? AND track_id = ? AND timestamp_ms >= ? AND timestamp_ms < ? "
+                    "ORDER BY timestamp_ms;",
+                    [&](sqlite3_stmt* stmt) {
+                        sqlite3_bind_int64(stmt, 1, static_cast<sqlite3_int64>(cameraIndex));
+                        sqlite3_bind_int(stmt, 2, trackId);
+                        sqlite3_bind_int64(stmt, 3, fromMs);
+                        sqlite3_bind_int64(stmt, 4, toMs);
+                    });
+}
+
+std::vector<MovementRecord> MovementDatabase::getMovementsByUser(int userId, int64_t fromMs, int64_t toMs) {
+    return runQuery("SELECT camera, track_id, user_id, timestamp_ms, x, y, width, height "
+                    "FROM movement_samples "
+                    "WHERE user_id = ? AND timestamp_ms >= ? AND timestamp_ms < ? "
+                    "ORDER BY timestamp_ms;",
+                    [&](sqlite3_stmt* stmt) {
+                        sqlite3_bind_int(stmt, 1, userId);
+                        sqlite3_bind_int64(stmt, 2, fromMs);
+                        sqlite3_bind_int64(stmt, 3, toMs);
+                    });
+}
+
+std::vector<MovementRecord> MovementDatabase::getMovementsSince(int64_t fromMs) {
+    return runQuery("SELECT camera, track_id, user_id, timestamp_ms, x, y, width, height "
+                    "FROM movement_samples "
+                    "WHERE timestamp_ms >= ? "
+                    "ORDER BY timestamp_ms;",
+                    [&](sqlite3_stmt* stmt) {
+                        sqlite3_bind_int64(stmt, 1, fromMs);
+                    });
+}
+
+uint64_t MovementDatabase::getWrittenCount() const {
+    return m_writer ? m_writer->getWrittenCount() : 0;
+}
+
+uint64_t MovementDatabase::getDroppedCount() const {
+    return m_writer ? m_writer->getDroppedCount() : 0;
+}
+
+} // namespace hms
@@ -0,0 +1,435 @@
+#include "database/notification_outbox.hpp"
+#include "database/schema_migrator.hpp"
+#include <iostream>
+#include <random>
+#include <algorithm>
+
+namespace hms {
+
+static const char* channelToString(OutboxChannel channel) {
+    return channel == OutboxChannel::EMAIL ? "email" : "sms";
+}
+
+static OutboxChannel channelFromString(const std::string& text) {
+    return text == "email" ? OutboxChannel::EMAIL : OutboxChannel::SMS;
+}
+
+static std::string columnText(sqlite3_stmt* stmt, int column) {
+    const unsigned char* text = sqlite3_column_text(stmt, column);
+    return text ? reinterpret_cast<const char*>(text) : "";
+}
+
+NotificationOutbox::NotificationOutbox(const std::string& dbPath)
+    : NotificationOutbox(dbPath, Options()) {
+}
+
+NotificationOutbox::NotificationOutbox(const std::string& dbPath, const Options& options)
+    : m_dbPath(dbPath), m_options(options), m_db(nullptr), m_insertStmt(nullptr), m_claimStmt(nullptr),
+      m_claimChannelStmt(nullptr), m_leaseStmt(nullptr), m_deleteStmt(nullptr), m_retryStmt(nullptr), m_failStmt(nullptr),
+      m_initialized(false) {
+}
+
+NotificationOutbox::~NotificationOutbox() {
+    shutdown();
+}
+
+bool NotificationOutbox::initialize() {
+    if (m_initialized) {
+        return true;
+    }
+    
+    int rc = sqlite3_open(m_dbPath.c_str(), &m_db);
+    if (rc != SQLITE_OK) {
+        std::cerr << "Cannot open notification outbox: " << sqlite3_errmsg(m_db) << std::endl;
+        sqlite3_close(m_db);
+        m_db = nullptr;
+        return false;
+    }
+    
+    // Unlike the histories, an accepted alert must survive a power cut, so
+    // every commit is synced; commits are per batch, which keeps that cheap
+    sqlite3_busy_timeout(m_db, 1000);
+    executeSql("PRAGMA journal_mode = WAL;");
+    executeSql("PRAGMA synchronous = FULL;");
+    if (!migrateSchema()) {
+        shutdown();
+        return false;
+    }
+    
+    bool prepared =
+        prepare("INSERT INTO outbox "
+                "(user_id, person_id, channel, recipient, subject, message, counts_as_sent, "
+                "created_ms, attempts, next_attempt_ms, status) "
+                "VALUES (?, ?, ?, ?, ?, ?, ?, ?, 0, ?, 'pending');", &m_insertStmt) &&
+        prepare("SELECT id, user_id, person_id, channel, recipient, subject, message, counts_as_sent, "
+                "created_ms, attempts, next_attempt_ms "
+                "FROM outbox WHERE status = 'pending' AND next_attempt_ms <= ? "
+                "ORDER BY next_attempt_ms, id LIMIT ?;", &m_claimStmt) &&
+        prepare("SELECT id, user_id, person_id, channel, recipient, subject, message, counts_as_sent, "
+                "created_ms, attempts, next_attempt_ms "
+                "FROM outbox WHERE status = 'pending' AND channel = ? AND next_attempt_ms <= ? "
+                "ORDER BY next_attempt_ms, id LIMIT ?;", &m_claimChannelStmt) &&
+        prepare("UPDATE outbox SET next_attempt_ms = ? WHERE id = ?;", &m_leaseStmt) &&
+        prepare("DELETE FROM outbox WHERE id = ?;", &m_deleteStmt) &&
+        prepare("UPDATE outbox SET attempts = ?, next_attempt_ms = ?, last_error = ? WHERE id = ?;",
+                &m_retryStmt) &&
+        prepare("UPDATE outbox SET attempts = ?, status = 'failed', last_error = ? WHERE id = ?;",
+                &m_failStmt);
+    if (!prepared) {
+        shutdown();
+        return false;
+    }
+    
+    // Replay: whatever was leased or backing off when we stopped is due now
+    if (!executeSql("UPDATE outbox SET next_attempt_ms = 0 WHERE status = 'pending';")) {
+        shutdown();
+        return false;
+    }
+    
+    m_initialized = true;
+    
+    size_t pending = getPendingCount();
+    if (pending > 0) {
+        std::cout << "Notification outbox: replaying " << pending << " unsent messages" << std::endl;
+    }
+    return true;
+}
+
+bool NotificationOutbox::isInitialized() const {
+    return m_initialized;
+}
+
+void NotificationOutbox::shutdown() {
+    for (sqlite3_stmt** stmt : {&m_insertStmt, &m_claimStmt, &m_claimChannelStmt, &m_leaseStmt,
+                                &m_deleteStmt, &m_retryStmt, &m_failStmt}) {
+        if (*stmt) {
+            sqlite3_finalize(*stmt);
+            *stmt = nullptr;
+        }
+    }
+    if (m_db) {
+        sqlite3_close(m_db);
+        m_db = nullptr;
+    }
+    m_initialized = false;
+}
+
+bool NotificationOutbox::migrateSchema() {
+    // Append new steps at the end; never edit one that has shipped
+    SchemaMigrator migrator("notification outbox");
+    
+    // The partial index holds only pending entries, so finding due ones
+    // stays cheap however many have failed for good
+    migrator.addMigration(1, "outbox with due index",
+        "CREATE TABLE outbox ("
+        "id INTEGER PRIMARY KEY,"
+        "user_id INTEGER NOT NULL,"
+        "person_id INTEGER NOT NULL,"
+        "channel TEXT NOT NULL,"
+        "recipient TEXT NOT NULL,"
+        "subject TEXT,"
+        "message TEXT NOT NULL,"
+        "counts_as_sent INTEGER NOT NULL,"
+        "created_ms INTEGER NOT NULL,"
+        "attempts INTEGER NOT NULL,"
+        "next_attempt_ms INTEGER NOT NULL,"
+        "status TEXT NOT NULL,"
+        "last_error TEXT"
+        ");"
+        "CREATE INDEX idx_outbox_due ON outbox (next_attempt_ms) WHERE status = 'pending';");
+    
+    // Sends are claimed per channel, as many as the channel has slots for
+    migrator.addMigration(2, "due index per channel",
+        "CREATE INDEX idx_outbox_channel_due ON outbox (channel, next_attempt_ms) WHERE status = 'pending';");
+    
+    return migrator.migrate(m_db);
+}
+
+bool NotificationOutbox::executeSql(const std::string& sql) {
+    char* errMsg = nullptr;
+    int rc = sqlite3_exec(m_db, sql.c_str(), nullptr, nullptr, &errMsg);
+    
+    if (rc != SQLITE_OK) {
+        std::cerr << "SQL error: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    
+    return true;
+}
+
+bool NotificationOutbox::prepare(const char* sql, sqlite3_stmt** stmt) {
+    if (sqlite3_prepare_v2(m_db, sql, -1, stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_db) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool NotificationOutbox::stepAndReset(sqlite3_stmt* stmt) {
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    
+    if (rc != SQLITE_DONE) {
+        std::cerr << "SQL step error: " << sqlite3_errmsg(m_db) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool NotificationOutbox::add(std::vector<OutboxEntry>& entries, int64_t nowMs) {
+    if (!m_initialized) {
+        return false;
+    }
+    if (entries.empty()) {
+        return true;
+    }
+    
+    if (!executeSql("BEGIN TRANSACTION;")) {
+        return false;
+    }
+    
+    for (auto& entry : entries) {
+        entry.attempts = 0;
+        entry.createdMs = nowMs;
+        entry.nextAttemptMs = std::max(entry.nextAttemptMs, nowMs);
+        
+        sqlite3_bind_int(m_insertStmt, 1, entry.userId);
+        sqlite3_bind_int(m_insertStmt, 2, entry.personId);
+        sqlite3_bind_text(m_insertStmt, 3, channelToString(entry.channel), -1, SQLITE_STATIC);
+        sqlite3_bind_text(m_insertStmt, 4, entry.recipient.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(m_insertStmt, 5, entry.subject.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(m_insertStmt, 6, entry.message.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int(m_insertStmt, 7, entry.countsAsSent ? 1 : 0);
+        sqlite3_bind_int64(m_insertStmt, 8, entry.createdMs);
+        sqlite3_bind_int64(m_insertStmt, 9, entry.nextAttemptMs);
+        
+        if (!stepAndReset(m_insertStmt)) {
+            executeSql("ROLLBACK;");
+            return false;
+        }
+        entry.id = sqlite3_last_insert_rowid(m_db);
+    }
+    
+    if (!executeSql("COMMIT;")) {
+        executeSql("ROLLBACK;");
+        return false;
+    }
+    return true;
+}
+
+std::vector<OutboxEntry> NotificationOutbox::claimDue(int64_t nowMs, size_t limit) {
+    if (!m_initialized || limit == 0) {
+        return {};
+    }
+    sqlite3_bind_int64(m_claimStmt, 1, nowMs);
+    sqlite3_bind_int64(m_claimStmt, 2, static_cast<int64_t>(limit));
+    return claim(m_claimStmt, nowMs);
+}
+
+std::vector<OutboxEntry> NotificationOutbox::claimDue(int64_t nowMs, size_t limit, OutboxChannel channel) {
+    if (!m_initialized || limit == 0) {
+        return {};
+    }
+    sqlite3_bind_text(m_claimChannelStmt, 1, channelToString(channel), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(m_claimChannelStmt, 2, nowMs);
+    sqlite3_bind_int64(m_claimChannelStmt, 3, static_cast<int64_t>(limit));
+    return claim(m_claimChannelStmt, nowMs);
+}
+
+std::vector<OutboxEntry> NotificationOutbox::claim(sqlite3_stmt* stmt, int64_t nowMs) {
+    std::vector<OutboxEntry> entries;
+    if (!executeSql("BEGIN TRANSACTION;")) {
+        sqlite3_reset(stmt);
+        return entries;
+    }
+    
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        OutboxEntry entry;
+        entry.id = sqlite3_column_int64(stmt, 0);
+        entry.userId = sqlite3_column_int(stmt, 1);
+        entry.personId = sqlite3_column_int(stmt, 2);
+        entry.channel = channelFromString(columnText(stmt, 3));
+        entry.recipient = columnText(stmt, 4);
+        entry.subject = columnText(stmt, 5);
+        entry.message = columnText(stmt, 6);
+        entry.countsAsSent = sqlite3_column_int(stmt, 7) != 0;
+        entry.createdMs = sqlite3_column_int64(stmt, 8);
+        entry.attempts = sqlite3_column_int(stmt, 9);
+        entry.nextAttemptMs = sqlite3_column_int64(stmt, 10);
+        entries.push_back(entry);
+    }
+    sqlite3_reset(stmt);
+    
+    if (rc != SQLITE_DONE) {
+        std::cerr << "SQL step error: " << sqlite3_errmsg(m_db) << std::endl;
+        executeSql("ROLLBACK;");
+        return {};
+    }
+    
+    for (const auto& entry : entries) {
+        sqlite3_bind_int64(m_leaseStmt, 1, nowMs + m_options.leaseMs);
+        sqlite3_bind_int64(m_leaseStmt, 2, entry.id);
+        if (!stepAndReset(m_leaseStmt)) {
+            executeSql("ROLLBACK;");
+            return {};
+        }
+    }
+    
+    if (!executeSql("COMMIT;")) {
+        executeSql("ROLLBACK;");
+        return {};
+    }
+    return entries;
+}
+
+bool NotificationOutbox::reschedule(const std::vector<OutboxEntry>& entries) {
+    if (!m_initialized) {
+        return false;
+    }
+    if (entries.empty()) {
+        return true;
+    }
+    
+    if (!executeSql("BEGIN TRANSACTION;")) {
+        return false;
+    }
+    
+    for (const auto& entry : entries) {
+        sqlite3_bind_int64(m_leaseStmt, 1, entry.nextAttemptMs);
+        sqlite3_bind_int64(m_leaseStmt, 2, entry.id);
+        if (!stepAndReset(m_leaseStmt)) {
+            executeSql("ROLLBACK;");
+            return false;
+        }
+    }
+    
+    if (!executeSql("COMMIT;")) {
+        executeSql("ROLLBACK;");
+        return false;
+    }
+    return true;
+}
+
+std::vector<OutboxOutcome> NotificationOutbox::recordResults(const std::vector<OutboxResult>& results,
+                                                             int64_t nowMs) {
+    std::vector<OutboxOutcome> outcomes;
+    if (!m_initialized || results.empty()) {
+        return outcomes;
+    }
+    
+    if (!executeSql("BEGIN TRANSACTION;")) {
+        return outcomes;
+    }
+    
+    for (const auto& result : results) {
+        sqlite3_stmt* stmt;
+        OutboxOutcome outcome;
+        int attempts = result.attempts + 1;
+        
+        if (result.success) {
+            stmt = m_deleteStmt;
+            sqlite3_bind_int64(stmt, 1, result.id);
+            outcome = OutboxOutcome::SENT;
+        } else if (attempts >= m_options.maxAttempts) {
+            stmt = m_failStmt;
+            sqlite3_bind_int(stmt, 1, attempts);
+            sqlite3_bind_text(stmt, 2, result.error.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_int64(stmt, 3, result.id);
+            outcome = OutboxOutcome::GAVE_UP;
+        } else {
+            stmt = m_retryStmt;
+            sqlite3_bind_int(stmt, 1, attempts);
+            sqlite3_bind_int64(stmt, 2, nowMs + backoffMs(attempts));
+            sqlite3_bind_text(stmt, 3, result.error.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_int64(stmt, 4, result.id);
+            outcome = OutboxOutcome::RETRY;
+        }
+        
+        if (!stepAndReset(stmt)) {
+            executeSql("ROLLBACK;");
+            return {};
+        }
+        outcomes.push_back(outcome);
+    }
+    
+    if (!executeSql("COMMIT;")) {
+        executeSql("ROLLBACK;");
+        return {};
+    }
+    return outcomes;
+}
+
+int64_t NotificationOutbox::backoffMs(int attempts) const {
+    // Exponential with "equal jitter": half the delay is fixed, half random,
+    // so recipients that failed together do not all retry together
+    int64_t delay = m_options.baseBackoffMs;
+    for (int i = 1; i < attempts && delay < m_options.maxBackoffMs; i++) {
+        delay *= 2;
+    }
+    delay = std::min(delay, m_options.maxBackoffMs);
+    
+    thread_local std::mt19937_64 generator(std::random_device{}());
+    std::uniform_int_distribution<int64_t> jitter(0, delay / 2);
+    return delay - delay / 2 + jitter(generator);
+}
+
+int64_t NotificationOutbox::getNextDueMs() {
+    return queryNextDueMs("SELECT MIN(next_attempt_ms) FROM outbox WHERE status = 'pending';", nullptr);
+}
+
+int64_t NotificationOutbox::getNextDueMs(OutboxChannel channel) {
+    return queryNextDueMs("SELECT MIN(next_attempt_ms) FROM outbox WHERE status = 'pending' AND channel = ?;",
+                          channelToString(channel));
+}
+
+int64_t NotificationOutbox::queryNextDueMs(const char* sql, const char* channel) {
+    if (!m_initialized) {
+        return -1;
+    }
+    
+    sqlite3_stmt* stmt;
+    if (!prepare(sql, &stmt)) {
+        return -1;
+    }
+    if (channel) {
+        sqlite3_bind_text(stmt, 1, channel, -1, SQLITE_STATIC);
+    }
+    
+    int64_t nextDueMs = -1;
+    if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
+        nextDueMs = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return nextDueMs;
+}
+
+size_t NotificationOutbox::countWithStatus(const char* status) {
+    if (!m_initialized) {
+        return 0;
+    }
+    
+    sqlite3_stmt* stmt;
+    if (!prepare("SELECT COUNT(*) FROM outbox WHERE status = ?;", &stmt)) {
+        return 0;
+    }
+    sqlite3_bind_text(stmt, 1, status, -1, SQLITE_STATIC);
+    
+    size_t count = 0;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        count = static_cast<size_t>(sqlite3_column_int64(stmt, 0));
+    }
+    sqlite3_finalize(stmt);
+    return count;
+}
+
+size_t NotificationOutbox::getPendingCount() {
+    return countWithStatus("pending");
+}
+
+size_t NotificationOutbox::getFailedCount() {
+    return countWithStatus("failed");
+}
+
+} // namespace hms
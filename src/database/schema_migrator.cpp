@@ -0,0 +1,87 @@
+#include "database/schema_migrator.hpp"
+#include <iostream>
+
+namespace hms {
+
+SchemaMigrator::SchemaMigrator(const std::string& name)
+    : m_name(name) {
+}
+
+bool SchemaMigrator::addMigration(int version, const std::string& description, const std::string& sql) {
+    if (version != getLatestVersion() + 1) {
+        std::cerr << m_name << " migration " << version << " out of order" << std::endl;
+        return false;
+    }
+    
+    m_migrations.push_back(Migration{version, description, sql});
+    return true;
+}
+
+int SchemaMigrator::getLatestVersion() const {
+    return m_migrations.empty() ? 0 : m_migrations.back().version;
+}
+
+int SchemaMigrator::getVersion(sqlite3* db) {
+    sqlite3_stmt* stmt = nullptr;
+    int version = -1;
+    
+    if (sqlite3_prepare_v2(db, "PRAGMA user_version;", -1, &stmt, nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        version = sqlite3_column_int(stmt, 0);
+    }
+    
+    sqlite3_finalize(stmt);
+    return version;
+}
+
+bool SchemaMigrator::migrate(sqlite3* db) {
+    int current = getVersion(db);
+    if (current < 0) {
+        std::cerr << "Cannot read " << m_name << " schema version: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+    if (current > getLatestVersion()) {
+        std::cerr << m_name << " schema version " << current << " is newer than this build supports ("
+                  << getLatestVersion() << ")" << std::endl;
+        return false;
+    }
+    
+    for (const auto& migration : m_migrations) {
+        if (migration.version <= current) {
+            continue;
+        }
+        
+        std::cout << "Upgrading " << m_name << " schema to version " << migration.version << ": "
+                  << migration.description << std::endl;
+        
+        // user_version is stored in the database header, so it commits or rolls back with the step
+        if (!execute(db, "BEGIN IMMEDIATE;")) {
+            return false;
+        }
+        if (!execute(db, migration.sql) ||
+            !execute(db, "PRAGMA user_version = " + std::to_string(migration.version) + ";") ||
+            !execute(db, "COMMIT;")) {
+            execute(db, "ROLLBACK;");
+            std::cerr << m_name << " migration " << migration.version << " failed" << std::endl;
+            return false;
+        }
+        current = migration.version;
+    }
+    
+    return true;
+}
+
+bool SchemaMigrator::execute(sqlite3* db, const std::string& sql) {
+    char* errMsg = nullptr;
+    int rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg);
+    
+    if (rc != SQLITE_OK) {
+        std::cerr << "SQL error: " << (errMsg ? errMsg : sqlite3_errmsg(db)) << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    
+    return true;
+}
+
+} // namespace hms
@@ -0,0 +1,120 @@
+#include "database/statement_cache.hpp"
+#include <iostream>
+
+namespace hms {
+
+StatementCache::Handle::Handle()
+    : m_cache(nullptr), m_queryId(-1), m_stmt(nullptr) {
+}
+
+StatementCache::Handle::Handle(StatementCache* cache, int queryId, sqlite3_stmt* stmt)
+    : m_cache(cache), m_queryId(queryId), m_stmt(stmt) {
+}
+
+StatementCache::Handle::Handle(Handle&& other) noexcept
+    : m_cache(other.m_cache), m_queryId(other.m_queryId), m_stmt(other.m_stmt) {
+    other.m_stmt = nullptr;
+}
+
+StatementCache::Handle& StatementCache::Handle::operator=(Handle&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_cache = other.m_cache;
+        m_queryId = other.m_queryId;
+        m_stmt = other.m_stmt;
+        other.m_stmt = nullptr;
+    }
+    return *this;
+}
+
+StatementCache::Handle::~Handle() {
+    release();
+}
+
+void StatementCache::Handle::release() {
+    if (!m_stmt) {
+        return;
+    }
+    
+    if (m_queryId < 0) {
+        sqlite3_finalize(m_stmt);
+    } else {
+        sqlite3_reset(m_stmt);
+        sqlite3_clear_bindings(m_stmt);
+        m_cache->giveBack(m_queryId);
+    }
+    m_stmt = nullptr;
+}
+
+StatementCache::StatementCache()
+    : m_db(nullptr), m_prepareCount(0) {
+}
+
+StatementCache::~StatementCache() {
+    clear();
+}
+
+void StatementCache::setDatabase(sqlite3* db) {
+    clear();
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_db = db;
+}
+
+StatementCache::Handle StatementCache::acquire(int queryId, const char* sql) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    
+    if (!m_db || queryId < 0) {
+        return Handle();
+    }
+    
+    if (static_cast<size_t>(queryId) >= m_entries.size()) {
+        m_entries.resize(queryId + 1);
+    }
+    
+    Entry& entry = m_entries[queryId];
+    if (entry.stmt && !entry.inUse) {
+        entry.inUse = true;
+        return Handle(this, queryId, entry.stmt);
+    }
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v3(m_db, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr);
+    m_prepareCount++;
+    
+    if (rc != SQLITE_OK) {
+        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_db) << std::endl;
+        sqlite3_finalize(stmt);
+        return Handle();
+    }
+    
+    if (entry.stmt) {
+        // Already held further up the stack or by another thread
+        return Handle(this, -1, stmt);
+    }
+    
+    entry.stmt = stmt;
+    entry.inUse = true;
+    return Handle(this, queryId, stmt);
+}
+
+void StatementCache::giveBack(int queryId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries[queryId].inUse = false;
+}
+
+void StatementCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    for (auto& entry : m_entries) {
+        sqlite3_finalize(entry.stmt);
+    }
+    m_entries.clear();
+}
+
+uint64_t StatementCache::getPrepareCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_prepareCount;
+}
+
+} // namespace hms
@@ -1,84 +1,283 @@
 #include "database/user_database.hpp"
+#include "database/user_import.hpp"
+#include "database/schema_migrator.hpp"
 #include <iostream>
 #include <sstream>
+#include <unordered_map>
+#include <cctype>
 
 namespace hms {
 
+static std::string columnText(sqlite3_stmt* stmt, int column) {
+    const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+    return text ? text : "";
+}
+
+// Counts each statement as it starts running
+static int countStatement(unsigned, void* context, void*, void*) {
+    ++*static_cast<std::atomic<uint64_t>*>(context);
+    return 0;
+}
+
 UserDatabase::UserDatabase(const std::string& dbPath)
-    : m_dbPath(dbPath), m_db(nullptr), m_initialized(false) {
+    : UserDatabase(dbPath, Options()) {
+}
+
+UserDatabase::UserDatabase(const std::string& dbPath, const Options& options)
+    : m_dbPath(dbPath), m_options(options), m_initialized(false), m_statementCount(0),
+      m_transactionDepth(0), m_transactionFailed(false) {
 }
 
 UserDatabase::~UserDatabase() {
-    if (m_db) {
-        sqlite3_close(m_db);
+    closeConnections();
+}
+
+UserDatabase::ReadLease::ReadLease(UserDatabase& owner)
+    : m_owner(owner), m_connection(nullptr) {
+    if (owner.m_readers.empty()) {
+        // No pool (in-memory database): read through the writer
+        m_writeLock = std::unique_lock<std::recursive_mutex>(owner.m_writeMutex);
+        m_connection = &owner.m_writer;
+        return;
+    }
+    
+    std::unique_lock<std::mutex> lock(owner.m_poolMutex);
+    owner.m_poolCondition.wait(lock, [&owner] { return !owner.m_idleReaders.empty(); });
+    m_connection = owner.m_idleReaders.back();
+    owner.m_idleReaders.pop_back();
+}
+
+UserDatabase::ReadLease::~ReadLease() {
+    if (m_writeLock.owns_lock()) {
+        return;
     }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_owner.m_poolMutex);
+        m_owner.m_idleReaders.push_back(m_connection);
+    }
+    m_owner.m_poolCondition.notify_one();
+}
+
+UserDatabase::WriteTransaction::WriteTransaction(UserDatabase& owner)
+    : m_owner(owner), m_lock(owner.m_writeMutex), m_done(false) {
+    if (owner.m_transactionDepth++ == 0) {
+        owner.m_pendingChanges.clear();
+        owner.m_transactionFailed = !owner.executeSql("BEGIN IMMEDIATE;");
+    }
+}
+
+UserDatabase::WriteTransaction::~WriteTransaction() {
+    if (!m_done) {
+        // Abandoned by an early return: the outermost transaction must not commit
+        m_owner.m_transactionFailed = true;
+        finish();
+    }
+}
+
+bool UserDatabase::WriteTransaction::ok() const {
+    return !m_owner.m_transactionFailed;
+}
+
+bool UserDatabase::WriteTransaction::commit() {
+    if (m_done) {
+        return false;
+    }
+    return finish();
+}
+
+bool UserDatabase::WriteTransaction::finish() {
+    m_done = true;
+    if (--m_owner.m_transactionDepth > 0) {
+        return !m_owner.m_transactionFailed;
+    }
+    
+    if (m_owner.m_transactionFailed || !m_owner.executeSql("COMMIT;")) {
+        // Nothing to roll back if BEGIN never took
+        if (!sqlite3_get_autocommit(m_owner.m_writer.db)) {
+            m_owner.executeSql("ROLLBACK;");
+        }
+        m_owner.m_pendingChanges.clear();
+        return false;
+    }
+    
+    // Readers see the change only once it is durable
+    m_owner.m_directory.apply(m_owner.m_pendingChanges);
+    m_owner.m_pendingChanges.clear();
+    return true;
 }
 
 bool UserDatabase::initialize() {
+    std::lock_guard<std::recursive_mutex> lock(m_writeMutex);
     if (m_initialized) {
         return true;
     }
     
-    int rc = sqlite3_open(m_dbPath.c_str(), &m_db);
+    int rc = sqlite3_open(m_dbPath.c_str(), &m_writer.db);
     if (rc != SQLITE_OK) {
-        std::cerr << "Cannot open database: " << sqlite3_errmsg(m_db) << std::endl;
-        sqlite3_close(m_db);
-        m_db = nullptr;
+        std::cerr << "Cannot open database: " << sqlite3_errmsg(m_writer.db) << std::endl;
+        sqlite3_close(m_writer.db);
+        m_writer.db = nullptr;
         return false;
     }
     
-    createTables();
+    sqlite3_trace_v2(m_writer.db, SQLITE_TRACE_STMT, countStatement, &m_statementCount);
+    sqlite3_busy_timeout(m_writer.db, m_options.busyTimeoutMs);
+    
+    // WAL lets readers work from a snapshot while a write commits; with WAL,
+    // NORMAL sync can lose the last commits on power loss but never corrupts
+    executeSql("PRAGMA journal_mode = WAL;");
+    executeSql("PRAGMA synchronous = NORMAL;");
+    executeSql("PRAGMA mmap_size = " + std::to_string(m_options.mmapSizeBytes) + ";");
+    
+    // Per connection, and cannot change inside a transaction
+    executeSql("PRAGMA foreign_keys = ON;");
+    
+    if (!migrateSchema()) {
+        closeConnections();
+        return false;
+    }
+    m_writer.statements.setDatabase(m_writer.db);
+    
+    // An in-memory database is private to its connection, so it gets no pool
+    if (m_dbPath != ":memory:" && !m_dbPath.empty()) {
+        for (int i = 0; i < m_options.readerCount; i++) {
+            if (!openReader()) {
+                closeConnections();
+                return false;
+            }
+        }
+    }
+    
     m_initialized = true;
+    m_directory.reset(readAllUsers(m_writer));
     return true;
 }
 
+bool UserDatabase::openReader() {
+    std::unique_ptr<Connection> reader(new Connection());
+    int rc = sqlite3_open_v2(m_dbPath.c_str(), &reader->db, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr);
+    if (rc != SQLITE_OK) {
+        std::cerr << "Cannot open database for reading: " << sqlite3_errmsg(reader->db) << std::endl;
+        sqlite3_close(reader->db);
+        return false;
+    }
+    
+    sqlite3_trace_v2(reader->db, SQLITE_TRACE_STMT, countStatement, &m_statementCount);
+    sqlite3_busy_timeout(reader->db, m_options.busyTimeoutMs);
+    std::string mmap = "PRAGMA mmap_size = " + std::to_string(m_options.mmapSizeBytes) + ";";
+    sqlite3_exec(reader->db, mmap.c_str(), nullptr, nullptr, nullptr);
+    reader->statements.setDatabase(reader->db);
+    
+    m_idleReaders.push_back(reader.get());
+    m_readers.push_back(std::move(reader));
+    return true;
+}
+
+void UserDatabase::closeConnections() {
+    // Statements must be finalized before their connection can close
+    for (auto& reader : m_readers) {
+        reader->statements.clear();
+        sqlite3_close(reader->db);
+    }
+    m_readers.clear();
+    m_idleReaders.clear();
+    
+    m_writer.statements.clear();
+    if (m_writer.db) {
+        sqlite3_close(m_writer.db);
+        m_writer.db = nullptr;
+    }
+    m_initialized = false;
+}
+
 bool UserDatabase::isInitialized() const {
     return m_initialized;
 }
 
-void UserDatabase::createTables() {
-    // Create users table
-    std::string sql = "CREATE TABLE IF NOT EXISTS users ("
-                      "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-                      "name TEXT NOT NULL,"
-                      "notes TEXT,"
-                      "image_reference TEXT"
-                      ");";
-    executeSql(sql);
-    
-    // Create emergency contacts table
-    sql = "CREATE TABLE IF NOT EXISTS emergency_contacts ("
-          "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-          "user_id INTEGER NOT NULL,"
-          "name TEXT NOT NULL,"
-          "phone TEXT NOT NULL,"
-          "email TEXT,"
-          "address TEXT,"
-          "relationship TEXT,"
-          "FOREIGN KEY (user_id) REFERENCES users (id) ON DELETE CASCADE"
-          ");";
-    executeSql(sql);
-    
-    // Create doctors table
-    sql = "CREATE TABLE IF NOT EXISTS doctors ("
-          "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-          "user_id INTEGER NOT NULL,"
-          "name TEXT NOT NULL,"
-          "phone TEXT NOT NULL,"
-          "email TEXT,"
-          "address TEXT,"
-          "specialization TEXT,"
-          "FOREIGN KEY (user_id) REFERENCES users (id) ON DELETE CASCADE"
-          ");";
-    executeSql(sql);
-    
-    // Enable foreign keys
-    executeSql("PRAGMA foreign_keys = ON;");
+bool UserDatabase::migrateSchema() {
+    // Append new steps at the end; never edit one that has shipped
+    SchemaMigrator migrator("user database");
+    
+    // IF NOT EXISTS adopts databases created before versioning
+    migrator.addMigration(1, "users, emergency contacts and doctors",
+        "CREATE TABLE IF NOT EXISTS users ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "name TEXT NOT NULL,"
+        "notes TEXT,"
+        "image_reference TEXT"
+        ");"
+        "CREATE TABLE IF NOT EXISTS emergency_contacts ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "user_id INTEGER NOT NULL,"
+        "name TEXT NOT NULL,"
+        "phone TEXT NOT NULL,"
+        "email TEXT,"
+        "address TEXT,"
+        "relationship TEXT,"
+        "FOREIGN KEY (user_id) REFERENCES users (id) ON DELETE CASCADE"
+        ");"
+        "CREATE TABLE IF NOT EXISTS doctors ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "user_id INTEGER NOT NULL,"
+        "name TEXT NOT NULL,"
+        "phone TEXT NOT NULL,"
+        "email TEXT,"
+        "address TEXT,"
+        "specialization TEXT,"
+        "FOREIGN KEY (user_id) REFERENCES users (id) ON DELETE CASCADE"
+        ");");
+    
+    // Per-user lookups and the ON DELETE CASCADE from users would otherwise scan
+    migrator.addMigration(2, "index contacts and doctors by user",
+        "CREATE INDEX IF NOT EXISTS idx_emergency_contacts_user ON emergency_contacts (user_id);"
+        "CREATE INDEX IF NOT EXISTS idx_doctors_user ON doctors (user_id);");
+    
+    // One search row per user, rebuilt by triggers from the user_search_source
+    // view whenever the user, one of their contacts or their doctor changes.
+    // Phone numbers are indexed both as written and as bare digits. While
+    // user_search_paused has a row the triggers do nothing; addUsers uses it
+    // to index a whole batch in one pass.
+    auto refreshSearchRow = [](const std::string& userId) {
+        return "DELETE FROM user_search WHERE rowid = " + userId + ";"
+               "INSERT INTO user_search (rowid, name, notes, contacts, doctor) "
+               "SELECT id, name, notes, contacts, doctor FROM user_search_source WHERE id = " + userId + ";";
+    };
+    auto searchTrigger = [](const std::string& name, const std::string& event, const std::string& body) {
+        return "CREATE TRIGGER " + name + " AFTER " + event +
+               " WHEN NOT EXISTS (SELECT 1 FROM user_search_paused) BEGIN " + body + " END;";
+    };
+    migrator.addMigration(3, "full-text search over users, contacts and doctors",
+        "CREATE VIRTUAL TABLE user_search USING fts5("
+        "name, notes, contacts, doctor, tokenize = 'unicode61 remove_diacritics 2', prefix = '2 3');"
+        "CREATE TABLE user_search_paused (paused INTEGER);"
+        "CREATE VIEW user_search_source AS SELECT u.id, u.name, u.notes,"
+        " (SELECT group_concat(c.name || ' ' || c.phone || ' ' ||"
+        "  replace(replace(replace(replace(replace(c.phone, '-', ''), ' ', ''), '(', ''), ')', ''), '.', ''), ' ')"
+        "  FROM emergency_contacts c WHERE c.user_id = u.id) AS contacts,"
+        " (SELECT group_concat(d.name, ' ') FROM doctors d WHERE d.user_id = u.id) AS doctor"
+        " FROM users u;" +
+        searchTrigger("users_search_insert", "INSERT ON users", refreshSearchRow("NEW.id")) +
+        searchTrigger("users_search_update", "UPDATE ON users",
+                      "DELETE FROM user_search WHERE rowid = OLD.id;" + refreshSearchRow("NEW.id")) +
+        searchTrigger("users_search_delete", "DELETE ON users", "DELETE FROM user_search WHERE rowid = OLD.id;") +
+        searchTrigger("contacts_search_insert", "INSERT ON emergency_contacts", refreshSearchRow("NEW.user_id")) +
+        searchTrigger("contacts_search_update", "UPDATE ON emergency_contacts",
+                      refreshSearchRow("OLD.user_id") + refreshSearchRow("NEW.user_id")) +
+        searchTrigger("contacts_search_delete", "DELETE ON emergency_contacts", refreshSearchRow("OLD.user_id")) +
+        searchTrigger("doctors_search_insert", "INSERT ON doctors", refreshSearchRow("NEW.user_id")) +
+        searchTrigger("doctors_search_update", "UPDATE ON doctors",
+                      refreshSearchRow("OLD.user_id") + refreshSearchRow("NEW.user_id")) +
+        searchTrigger("doctors_search_delete", "DELETE ON doctors", refreshSearchRow("OLD.user_id")) +
+        "INSERT INTO user_search (rowid, name, notes, contacts, doctor) "
+        "SELECT id, name, notes, contacts, doctor FROM user_search_source;");
+    
+    return migrator.migrate(m_writer.db);
 }
 
 bool UserDatabase::executeSql(const std::string& sql) {
     char* errMsg = nullptr;
-    int rc = sqlite3_exec(m_db, sql.c_str(), nullptr, nullptr, &errMsg);
+    int rc = sqlite3_exec(m_writer.db, sql.c_str(), nullptr, nullptr, &errMsg);
     
     if (rc != SQLITE_OK) {
         std::cerr << "SQL error: " << errMsg << std::endl;
@@ -94,42 +293,107 @@ bool UserDatabase::addUser(User& user) {
         return false;
     }
     
-    std::string sql = "INSERT INTO users (name, notes, image_reference) "
-                      "VALUES (?, ?, ?);";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
-    
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_db) << std::endl;
+    // The user row, contacts and doctor commit together or not at all
+    WriteTransaction transaction(*this);
+    if (!transaction.ok()) {
+        return false;
+    }
+    if (!insertUser(user)) {
+        user.id = -1;
+        return false;
+    }
+    return transaction.commit();
+}
+
+bool UserDatabase::addUsers(std::vector<User>& users) {
+    if (!m_initialized && !initialize()) {
         return false;
     }
     
-    sqlite3_bind_text(stmt, 1, user.name.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, user.notes.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, user.imageReference.c_str(), -1, SQLITE_STATIC);
+    // One transaction, and so one sync, for the whole batch
+    WriteTransaction transaction(*this);
+    if (!transaction.ok()) {
+        return false;
+    }
     
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    // Rewriting a search row as each contact arrives makes FTS5 flush its
+    // pending index every time; instead index the new users once at the end.
+    // They are the only users with IDs from the first one on, as IDs only grow.
+    bool indexed = executeSql("INSERT INTO user_search_paused VALUES (1);");
+    for (auto& user : users) {
+        if (!indexed || !insertUser(user)) {
+            std::cerr << "Failed to add user " << user.name << ", batch rolled back" << std::endl;
+            for (auto& added : users) {
+                added.id = -1;
+            }
+            return false;
+        }
+    }
+    indexed = executeSql("DELETE FROM user_search_paused;");
+    if (indexed && !users.empty()) {
+        indexed = executeSql("INSERT INTO user_search (rowid, name, notes, contacts, doctor) "
+                             "SELECT id, name, notes, contacts, doctor FROM user_search_source "
+                             "WHERE id >= " + std::to_string(users.front().id) + " ORDER BY id;");
+    }
     
-    if (rc != SQLITE_DONE) {
-        std::cerr << "SQL step error: " << sqlite3_errmsg(m_db) << std::endl;
+    if (!indexed || !transaction.commit()) {
+        for (auto& added : users) {
+            added.id = -1;
+        }
         return false;
     }
+    return true;
+}
+
+int UserDatabase::importUsers(const std::string& filePath) {
+    std::vector<User> users;
+    if (!loadUsersFromFile(filePath, users)) {
+        return -1;
+    }
+    
+    if (!addUsers(users)) {
+        return -1;
+    }
+    return static_cast<int>(users.size());
+}
+
+bool UserDatabase::insertUser(User& user) {
+    {
+        StatementCache::Handle stmt = m_writer.statements.acquire(QUERY_INSERT_USER,
+            "INSERT INTO users (name, notes, image_reference) "
+            "VALUES (?, ?, ?);");
+        if (!stmt) {
+            return false;
+        }
+        
+        sqlite3_bind_text(stmt, 1, user.name.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, user.notes.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, user.imageReference.c_str(), -1, SQLITE_STATIC);
+        
+        int rc = sqlite3_step(stmt);
+        
+        if (rc != SQLITE_DONE) {
+            std::cerr << "SQL step error: " << sqlite3_errmsg(m_writer.db) << std::endl;
+            return false;
+        }
+    }
     
     // Get the last inserted row ID
-    user.id = static_cast<int>(sqlite3_last_insert_rowid(m_db));
+    user.id = static_cast<int>(sqlite3_last_insert_rowid(m_writer.db));
     
     // Add emergency contacts
-    for (const auto& contact : user.emergencyContacts) {
-        addEmergencyContact(user.id, contact);
+    for (auto& contact : user.emergencyContacts) {
+        if (!addEmergencyContact(user.id, contact)) {
+            return false;
+        }
     }
     
-    // Add family doctor
-    if (!user.familyDoctor.name.empty()) {
-        setFamilyDoctor(user.id, user.familyDoctor);
+    // Add family doctor; a new user cannot have one yet, so skip the lookup
+    if (!user.familyDoctor.name.empty() && !insertFamilyDoctor(user.id, user.familyDoctor)) {
+        return false;
     }
     
+    m_pendingChanges.push_back(UserDirectory::upsertUser(user));
     return true;
 }
 
@@ -138,14 +402,15 @@ bool UserDatabase::updateUser(const User& user) {
         return false;
     }
     
-    std::string sql = "UPDATE users SET name = ?, notes = ?, image_reference = ? "
-                      "WHERE id = ?;";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+    WriteTransaction transaction(*this);
+    if (!transaction.ok()) {
+        return false;
+    }
     
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_db) << std::endl;
+    StatementCache::Handle stmt = m_writer.statements.acquire(QUERY_UPDATE_USER,
+        "UPDATE users SET name = ?, notes = ?, image_reference = ? "
+        "WHERE id = ?;");
+    if (!stmt) {
         return false;
     }
     
@@ -154,15 +419,20 @@ bool UserDatabase::updateUser(const User& user) {
     sqlite3_bind_text(stmt, 3, user.imageReference.c_str(), -1, SQLITE_STATIC);
     sqlite3_bind_int(stmt, 4, user.id);
     
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    int rc = sqlite3_step(stmt);
     
     if (rc != SQLITE_DONE) {
-        std::cerr << "SQL step error: " << sqlite3_errmsg(m_db) << std::endl;
+        std::cerr << "SQL step error: " << sqlite3_errmsg(m_writer.db) << std::endl;
         return false;
     }
     
-    return true;
+    User changed = user;
+    m_pendingChanges.push_back(UserDirectory::modifyUser(user.id, [changed](User& cached) {
+        cached.name = changed.name;
+        cached.notes = changed.notes;
+        cached.imageReference = changed.imageReference;
+    }));
+    return transaction.commit();
 }
 
 bool UserDatabase::deleteUser(int userId) {
@@ -170,28 +440,29 @@ bool UserDatabase::deleteUser(int userId) {
         return false;
     }
     
-    // With foreign key constraints, deleting the user will cascade to contacts and doctor
-    std::string sql = "DELETE FROM users WHERE id = ?;";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+    WriteTransaction transaction(*this);
+    if (!transaction.ok()) {
+        return false;
+    }
     
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_db) << std::endl;
+    // With foreign key constraints, deleting the user will cascade to contacts and doctor
+    StatementCache::Handle stmt = m_writer.statements.acquire(QUERY_DELETE_USER,
+        "DELETE FROM users WHERE id = ?;");
+    if (!stmt) {
         return false;
     }
     
     sqlite3_bind_int(stmt, 1, userId);
     
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    int rc = sqlite3_step(stmt);
     
     if (rc != SQLITE_DONE) {
-        std::cerr << "SQL step error: " << sqlite3_errmsg(m_db) << std::endl;
+        std::cerr << "SQL step error: " << sqlite3_errmsg(m_writer.db) << std::endl;
         return false;
     }
     
-    return true;
+    m_pendingChanges.push_back(UserDirectory::removeUser(userId));
+    return transaction.commit();
 }
 
 User UserDatabase::getUserById(int userId) {
@@ -202,103 +473,136 @@ User UserDatabase::getUserById(int userId) {
         return user;
     }
     
-    std::string sql = "SELECT id, name, notes, image_reference FROM users WHERE id = ?;";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
-    
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_db) << std::endl;
-        return user;
-    }
-    
-    sqlite3_bind_int(stmt, 1, userId);
-    
-    rc = sqlite3_step(stmt);
-    
-    if (rc == SQLITE_ROW) {
-        user.id = sqlite3_column_int(stmt, 0);
-        
-        const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        if (name) user.name = name;
+    ReadLease reader(*this);
+    {
+        StatementCache::Handle stmt = reader->statements.acquire(QUERY_SELECT_USER,
+            "SELECT id, name, notes, image_reference FROM users WHERE id = ?;");
+        if (!stmt) {
+            return user;
+        }
         
-        const char* notes = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        if (notes) user.notes = notes;
+        sqlite3_bind_int(stmt, 1, userId);
         
-        const char* imageRef = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        if (imageRef) user.imageReference = imageRef;
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            user.id = sqlite3_column_int(stmt, 0);
+            user.name = columnText(stmt, 1);
+            user.notes = columnText(stmt, 2);
+            user.imageReference = columnText(stmt, 3);
+        }
     }
     
-    sqlite3_finalize(stmt);
-    
     if (user.id != -1) {
         // Get emergency contacts
-        user.emergencyContacts = getEmergencyContacts(userId);
+        user.emergencyContacts = readEmergencyContacts(*reader, userId);
         
         // Get family doctor
-        user.familyDoctor = getFamilyDoctor(userId);
+        user.familyDoctor = readFamilyDoctor(*reader, userId);
     }
     
     return user;
 }
 
 std::vector<User> UserDatabase::getAllUsers() {
-    std::vector<User> users;
-    
     if (!m_initialized && !initialize()) {
-        return users;
+        return std::vector<User>();
     }
     
-    std::string sql = "SELECT id, name, notes, image_reference FROM users;";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+    ReadLease reader(*this);
+    return readAllUsers(*reader);
+}
+
+std::vector<User> UserDatabase::readAllUsers(Connection& connection) {
+    std::vector<User> users;
     
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_db) << std::endl;
-        return users;
+    // Three set-based queries instead of two lookups per user; contacts and
+    // doctors are attached through a hash index on user ID
+    std::unordered_map<int, size_t> userIndex;
+    {
+        StatementCache::Handle stmt = connection.statements.acquire(QUERY_SELECT_ALL_USERS,
+            "SELECT id, name, notes, image_reference FROM users ORDER BY id;");
+        if (!stmt) {
+            return users;
+        }
+        
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            User user;
+            user.id = sqlite3_column_int(stmt, 0);
+            user.name = columnText(stmt, 1);
+            user.notes = columnText(stmt, 2);
+            user.imageReference = columnText(stmt, 3);
+            
+            userIndex[user.id] = users.size();
+            users.push_back(std::move(user));
+        }
     }
     
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        User user;
-        user.id = sqlite3_column_int(stmt, 0);
-        
-        const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        if (name) user.name = name;
-        
-        const char* notes = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        if (notes) user.notes = notes;
-        
-        const char* imageRef = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        if (imageRef) user.imageReference = imageRef;
-        
-        // Get emergency contacts
-        user.emergencyContacts = getEmergencyContacts(user.id);
-        
-        // Get family doctor
-        user.familyDoctor = getFamilyDoctor(user.id);
+    // Contacts in insertion order, as getEmergencyContacts returns them
+    {
+        StatementCache::Handle stmt = connection.statements.acquire(QUERY_SELECT_ALL_CONTACTS,
+            "SELECT user_id, name, phone, email, address, relationship, id FROM emergency_contacts "
+            "ORDER BY id;");
+        if (!stmt) {
+            return users;
+        }
         
-        users.push_back(user);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            auto it = userIndex.find(sqlite3_column_int(stmt, 0));
+            if (it == userIndex.end()) {
+                continue;
+            }
+            
+            EmergencyContact contact;
+            contact.name = columnText(stmt, 1);
+            contact.phone = columnText(stmt, 2);
+            contact.email = columnText(stmt, 3);
+            contact.address = columnText(stmt, 4);
+            contact.relationship = columnText(stmt, 5);
+            contact.id = sqlite3_column_int(stmt, 6);
+            users[it->second].emergencyContacts.push_back(std::move(contact));
+        }
     }
     
-    sqlite3_finalize(stmt);
+    // A user has at most one doctor; keep the first, as getFamilyDoctor does
+    {
+        StatementCache::Handle stmt = connection.statements.acquire(QUERY_SELECT_ALL_DOCTORS,
+            "SELECT user_id, name, phone, email, address, specialization FROM doctors "
+            "ORDER BY id;");
+        if (!stmt) {
+            return users;
+        }
+        
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            auto it = userIndex.find(sqlite3_column_int(stmt, 0));
+            if (it == userIndex.end() || !users[it->second].familyDoctor.name.empty()) {
+                continue;
+            }
+            
+            Doctor& doctor = users[it->second].familyDoctor;
+            doctor.name = columnText(stmt, 1);
+            doctor.phone = columnText(stmt, 2);
+            doctor.email = columnText(stmt, 3);
+            doctor.address = columnText(stmt, 4);
+            doctor.specialization = columnText(stmt, 5);
+        }
+    }
     
     return users;
 }
 
-bool UserDatabase::addEmergencyContact(int userId, const EmergencyContact& contact) {
+bool UserDatabase::addEmergencyContact(int userId, EmergencyContact& contact) {
     if (!m_initialized && !initialize()) {
         return false;
     }
     
-    std::string sql = "INSERT INTO emergency_contacts (user_id, name, phone, email, address, relationship) "
-                      "VALUES (?, ?, ?, ?, ?, ?);";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+    WriteTransaction transaction(*this);
+    if (!transaction.ok()) {
+        return false;
+    }
     
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_db) << std::endl;
+    StatementCache::Handle stmt = m_writer.statements.acquire(QUERY_INSERT_CONTACT,
+        "INSERT INTO emergency_contacts (user_id, name, phone, email, address, relationship) "
+        "VALUES (?, ?, ?, ?, ?, ?);");
+    if (!stmt) {
         return false;
     }
     
@@ -309,63 +613,58 @@ bool UserDatabase::addEmergencyContact(int userId, const EmergencyContact& conta
     sqlite3_bind_text(stmt, 5, contact.address.c_str(), -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 6, contact.relationship.c_str(), -1, SQLITE_STATIC);
     
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    int rc = sqlite3_step(stmt);
     
     if (rc != SQLITE_DONE) {
-        std::cerr << "SQL step error: " << sqlite3_errmsg(m_db) << std::endl;
+        std::cerr << "SQL step error: " << sqlite3_errmsg(m_writer.db) << std::endl;
         return false;
     }
     
-    return true;
+    contact.id = static_cast<int>(sqlite3_last_insert_rowid(m_writer.db));
+    
+    m_pendingChanges.push_back(UserDirectory::modifyUser(userId, [contact](User& cached) {
+        cached.emergencyContacts.push_back(contact);
+    }));
+    return transaction.commit();
 }
 
-bool UserDatabase::updateEmergencyContact(int userId, int contactIndex, const EmergencyContact& contact) {
-    if (!m_initialized && !initialize()) {
-        return false;
-    }
-    
-    // First, get all contacts for this user
-    std::vector<EmergencyContact> contacts = getEmergencyContacts(userId);
-    
-    if (contactIndex < 0 || contactIndex >= static_cast<int>(contacts.size())) {
+int UserDatabase::getContactIdAt(int userId, int contactIndex) {
+    if (contactIndex < 0) {
         std::cerr << "Invalid contact index: " << contactIndex << std::endl;
-        return false;
+        return -1;
     }
     
-    // Get the contact ID from the database
-    std::string sql = "SELECT id FROM emergency_contacts WHERE user_id = ? LIMIT 1 OFFSET ?;";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
-    
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_db) << std::endl;
-        return false;
+    StatementCache::Handle stmt = m_writer.statements.acquire(QUERY_SELECT_CONTACT_ID_AT,
+        "SELECT id FROM emergency_contacts WHERE user_id = ? ORDER BY id LIMIT 1 OFFSET ?;");
+    if (!stmt) {
+        return -1;
     }
     
     sqlite3_bind_int(stmt, 1, userId);
     sqlite3_bind_int(stmt, 2, contactIndex);
     
-    rc = sqlite3_step(stmt);
-    
-    if (rc != SQLITE_ROW) {
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
         std::cerr << "Contact not found at index: " << contactIndex << std::endl;
-        sqlite3_finalize(stmt);
-        return false;
+        return -1;
     }
     
-    int contactId = sqlite3_column_int(stmt, 0);
-    sqlite3_finalize(stmt);
-    
-    // Now update the contact
-    sql = "UPDATE emergency_contacts SET name = ?, phone = ?, email = ?, address = ?, relationship = ? "
-          "WHERE id = ?;";
+    return sqlite3_column_int(stmt, 0);
+}
+
+bool UserDatabase::updateEmergencyContact(const EmergencyContact& contact) {
+    if (!m_initialized && !initialize()) {
+        return false;
+    }
     
-    rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+    WriteTransaction transaction(*this);
+    if (!transaction.ok()) {
+        return false;
+    }
     
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_db) << std::endl;
+    StatementCache::Handle stmt = m_writer.statements.acquire(QUERY_UPDATE_CONTACT,
+        "UPDATE emergency_contacts SET name = ?, phone = ?, email = ?, address = ?, relationship = ? "
+        "WHERE id = ?;");
+    if (!stmt) {
         return false;
     }
     
@@ -374,123 +673,199 @@ bool UserDatabase::updateEmergencyContact(int userId, int contactIndex, const Em
     sqlite3_bind_text(stmt, 3, contact.email.c_str(), -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 4, contact.address.c_str(), -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 5, contact.relationship.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 6, contactId);
+    sqlite3_bind_int(stmt, 6, contact.id);
     
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    int rc = sqlite3_step(stmt);
     
     if (rc != SQLITE_DONE) {
-        std::cerr << "SQL step error: " << sqlite3_errmsg(m_db) << std::endl;
+        std::cerr << "SQL step error: " << sqlite3_errmsg(m_writer.db) << std::endl;
+        return false;
+    }
+    if (sqlite3_changes(m_writer.db) == 0) {
+        std::cerr << "Contact not found: " << contact.id << std::endl;
         return false;
     }
     
-    return true;
+    m_pendingChanges.push_back(UserDirectory::updateContact(contact));
+    return transaction.commit();
 }
 
-bool UserDatabase::deleteEmergencyContact(int userId, int contactIndex) {
+bool UserDatabase::updateEmergencyContact(int userId, int contactIndex, const EmergencyContact& contact) {
     if (!m_initialized && !initialize()) {
         return false;
     }
     
-    // First, get all contacts for this user
-    std::vector<EmergencyContact> contacts = getEmergencyContacts(userId);
+    WriteTransaction transaction(*this);
+    if (!transaction.ok()) {
+        return false;
+    }
     
-    if (contactIndex < 0 || contactIndex >= static_cast<int>(contacts.size())) {
-        std::cerr << "Invalid contact index: " << contactIndex << std::endl;
+    EmergencyContact updated = contact;
+    updated.id = getContactIdAt(userId, contactIndex);
+    if (updated.id < 0 || !updateEmergencyContact(updated)) {
         return false;
     }
     
-    // Get the contact ID from the database
-    std::string sql = "SELECT id FROM emergency_contacts WHERE user_id = ? LIMIT 1 OFFSET ?;";
+    return transaction.commit();
+}
+
+bool UserDatabase::deleteEmergencyContact(int contactId) {
+    if (!m_initialized && !initialize()) {
+        return false;
+    }
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+    WriteTransaction transaction(*this);
+    if (!transaction.ok()) {
+        return false;
+    }
     
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_db) << std::endl;
+    StatementCache::Handle stmt = m_writer.statements.acquire(QUERY_DELETE_CONTACT,
+        "DELETE FROM emergency_contacts WHERE id = ?;");
+    if (!stmt) {
         return false;
     }
     
-    sqlite3_bind_int(stmt, 1, userId);
-    sqlite3_bind_int(stmt, 2, contactIndex);
+    sqlite3_bind_int(stmt, 1, contactId);
     
-    rc = sqlite3_step(stmt);
+    int rc = sqlite3_step(stmt);
     
-    if (rc != SQLITE_ROW) {
-        std::cerr << "Contact not found at index: " << contactIndex << std::endl;
-        sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        std::cerr << "SQL step error: " << sqlite3_errmsg(m_writer.db) << std::endl;
+        return false;
+    }
+    if (sqlite3_changes(m_writer.db) == 0) {
+        std::cerr << "Contact not found: " << contactId << std::endl;
         return false;
     }
     
-    int contactId = sqlite3_column_int(stmt, 0);
-    sqlite3_finalize(stmt);
-    
-    // Now delete the contact
-    sql = "DELETE FROM emergency_contacts WHERE id = ?;";
+    m_pendingChanges.push_back(UserDirectory::removeContact(contactId));
+    return transaction.commit();
+}
+
+bool UserDatabase::deleteEmergencyContact(int userId, int contactIndex) {
+    if (!m_initialized && !initialize()) {
+        return false;
+    }
     
-    rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+    WriteTransaction transaction(*this);
+    if (!transaction.ok()) {
+        return false;
+    }
     
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_db) << std::endl;
+    int contactId = getContactIdAt(userId, contactIndex);
+    if (contactId < 0 || !deleteEmergencyContact(contactId)) {
         return false;
     }
     
-    sqlite3_bind_int(stmt, 1, contactId);
+    return transaction.commit();
+}
+
+// Turns free text into an FTS5 query: every word must match as a prefix.
+// Words are split where the tokenizer splits them and quoted, so input such
+// as "O'Brien" or "NOT" cannot change the meaning of the query.
+static std::string toMatchExpression(const std::string& query) {
+    std::string expression;
+    std::string word;
+    
+    for (size_t i = 0; i <= query.size(); i++) {
+        unsigned char c = i < query.size() ? static_cast<unsigned char>(query[i]) : ' ';
+        if (std::isalnum(c) || c >= 0x80) {
+            word += static_cast<char>(c);
+        } else if (!word.empty()) {
+            if (!expression.empty()) {
+                expression += " ";
+            }
+            expression += "\"" + word + "\"*";
+            word.clear();
+        }
+    }
     
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    return expression;
+}
+
+std::vector<User> UserDatabase::searchUsers(const std::string& query, int limit, int offset) {
+    std::vector<User> users;
+    if (!m_initialized && !initialize()) {
+        return users;
+    }
     
-    if (rc != SQLITE_DONE) {
-        std::cerr << "SQL step error: " << sqlite3_errmsg(m_db) << std::endl;
-        return false;
+    std::vector<int> userIds;
+    {
+        ReadLease reader(*this);
+        std::string expression = toMatchExpression(query);
+        
+        // Name matches rank above matches in contacts or the doctor, which
+        // rank above notes
+        StatementCache::Handle stmt = expression.empty()
+            ? reader->statements.acquire(QUERY_SELECT_USER_PAGE,
+                "SELECT id FROM users ORDER BY name, id LIMIT ? OFFSET ?;")
+            : reader->statements.acquire(QUERY_SEARCH_USERS,
+                "SELECT rowid FROM user_search WHERE user_search MATCH ? "
+                "ORDER BY bm25(user_search, 10.0, 1.0, 5.0, 5.0), rowid LIMIT ? OFFSET ?;");
+        if (!stmt) {
+            return users;
+        }
+        
+        int index = 1;
+        if (!expression.empty()) {
+            sqlite3_bind_text(stmt, index++, expression.c_str(), -1, SQLITE_TRANSIENT);
+        }
+        sqlite3_bind_int(stmt, index++, limit);
+        sqlite3_bind_int(stmt, index++, offset);
+        
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            userIds.push_back(sqlite3_column_int(stmt, 0));
+        }
+        if (rc != SQLITE_DONE) {
+            std::cerr << "User search failed: " << sqlite3_errmsg(sqlite3_db_handle(stmt)) << std::endl;
+        }
     }
     
-    return true;
+    // Full records come from the directory rather than more queries
+    std::shared_ptr<const UserDirectory::Snapshot> snapshot = m_directory.getSnapshot();
+    for (int userId : userIds) {
+        std::shared_ptr<const User> user = snapshot->find(userId);
+        if (user) {
+            users.push_back(*user);
+        }
+    }
+    
+    return users;
 }
 
 std::vector<EmergencyContact> UserDatabase::getEmergencyContacts(int userId) {
-    std::vector<EmergencyContact> contacts;
-    
     if (!m_initialized && !initialize()) {
-        return contacts;
+        return std::vector<EmergencyContact>();
     }
     
-    std::string sql = "SELECT name, phone, email, address, relationship FROM emergency_contacts "
-                      "WHERE user_id = ?;";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+    ReadLease reader(*this);
+    return readEmergencyContacts(*reader, userId);
+}
+
+std::vector<EmergencyContact> UserDatabase::readEmergencyContacts(Connection& connection, int userId) {
+    std::vector<EmergencyContact> contacts;
     
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_db) << std::endl;
+    StatementCache::Handle stmt = connection.statements.acquire(QUERY_SELECT_CONTACTS,
+        "SELECT name, phone, email, address, relationship, id FROM emergency_contacts "
+        "WHERE user_id = ? ORDER BY id;");
+    if (!stmt) {
         return contacts;
     }
     
     sqlite3_bind_int(stmt, 1, userId);
     
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
         EmergencyContact contact;
-        
-        const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        if (name) contact.name = name;
-        
-        const char* phone = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        if (phone) contact.phone = phone;
-        
-        const char* email = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        if (email) contact.email = email;
-        
-        const char* address = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        if (address) contact.address = address;
-        
-        const char* relationship = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-        if (relationship) contact.relationship = relationship;
-        
+        contact.name = columnText(stmt, 0);
+        contact.phone = columnText(stmt, 1);
+        contact.email = columnText(stmt, 2);
+        contact.address = columnText(stmt, 3);
+        contact.relationship = columnText(stmt, 4);
+        contact.id = sqlite3_column_int(stmt, 5);
         contacts.push_back(contact);
     }
     
-    sqlite3_finalize(stmt);
-    
     return contacts;
 }
 
@@ -499,68 +874,84 @@ bool UserDatabase::setFamilyDoctor(int userId, const Doctor& doctor) {
         return false;
     }
     
-    // First, check if a doctor already exists for this user
-    std::string sql = "SELECT id FROM doctors WHERE user_id = ?;";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
-    
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_db) << std::endl;
+    WriteTransaction transaction(*this);
+    if (!transaction.ok()) {
         return false;
     }
     
-    sqlite3_bind_int(stmt, 1, userId);
-    
-    rc = sqlite3_step(stmt);
-    bool doctorExists = (rc == SQLITE_ROW);
-    int doctorId = doctorExists ? sqlite3_column_int(stmt, 0) : -1;
-    
-    sqlite3_finalize(stmt);
-    
-    if (doctorExists) {
-        // Update existing doctor
-        sql = "UPDATE doctors SET name = ?, phone = ?, email = ?, address = ?, specialization = ? "
-              "WHERE id = ?;";
-        
-        rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
-        
-        if (rc != SQLITE_OK) {
-            std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_db) << std::endl;
+    // First, check if a doctor already exists for this user
+    int doctorId = -1;
+    {
+        StatementCache::Handle stmt = m_writer.statements.acquire(QUERY_SELECT_DOCTOR_ID,
+            "SELECT id FROM doctors WHERE user_id = ?;");
+        if (!stmt) {
             return false;
         }
         
-        sqlite3_bind_text(stmt, 1, doctor.name.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 2, doctor.phone.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 3, doctor.email.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 4, doctor.address.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 5, doctor.specialization.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_int(stmt, 6, doctorId);
-    } else {
-        // Insert new doctor
-        sql = "INSERT INTO doctors (user_id, name, phone, email, address, specialization) "
-              "VALUES (?, ?, ?, ?, ?, ?);";
-        
-        rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+        sqlite3_bind_int(stmt, 1, userId);
         
-        if (rc != SQLITE_OK) {
-            std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_db) << std::endl;
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            doctorId = sqlite3_column_int(stmt, 0);
+        }
+    }
+    
+    if (doctorId < 0) {
+        if (!insertFamilyDoctor(userId, doctor)) {
             return false;
         }
-        
-        sqlite3_bind_int(stmt, 1, userId);
-        sqlite3_bind_text(stmt, 2, doctor.name.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 3, doctor.phone.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 4, doctor.email.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 5, doctor.address.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 6, doctor.specialization.c_str(), -1, SQLITE_STATIC);
+        m_pendingChanges.push_back(UserDirectory::modifyUser(userId, [doctor](User& cached) {
+            cached.familyDoctor = doctor;
+        }));
+        return transaction.commit();
+    }
+    
+    // Update existing doctor
+    StatementCache::Handle stmt = m_writer.statements.acquire(QUERY_UPDATE_DOCTOR,
+        "UPDATE doctors SET name = ?, phone = ?, email = ?, address = ?, specialization = ? "
+        "WHERE id = ?;");
+    if (!stmt) {
+        return false;
     }
     
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    sqlite3_bind_text(stmt, 1, doctor.name.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, doctor.phone.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, doctor.email.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, doctor.address.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 5, doctor.specialization.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 6, doctorId);
+    
+    int rc = sqlite3_step(stmt);
     
     if (rc != SQLITE_DONE) {
-        std::cerr << "SQL step error: " << sqlite3_errmsg(m_db) << std::endl;
+        std::cerr << "SQL step error: " << sqlite3_errmsg(m_writer.db) << std::endl;
+        return false;
+    }
+    
+    m_pendingChanges.push_back(UserDirectory::modifyUser(userId, [doctor](User& cached) {
+        cached.familyDoctor = doctor;
+    }));
+    return transaction.commit();
+}
+
+bool UserDatabase::insertFamilyDoctor(int userId, const Doctor& doctor) {
+    StatementCache::Handle stmt = m_writer.statements.acquire(QUERY_INSERT_DOCTOR,
+        "INSERT INTO doctors (user_id, name, phone, email, address, specialization) "
+        "VALUES (?, ?, ?, ?, ?, ?);");
+    if (!stmt) {
+        return false;
+    }
+    
+    sqlite3_bind_int(stmt, 1, userId);
+    sqlite3_bind_text(stmt, 2, doctor.name.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, doctor.phone.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, doctor.email.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 5, doctor.address.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 6, doctor.specialization.c_str(), -1, SQLITE_STATIC);
+    
+    int rc = sqlite3_step(stmt);
+    
+    if (rc != SQLITE_DONE) {
+        std::cerr << "SQL step error: " << sqlite3_errmsg(m_writer.db) << std::endl;
         return false;
     }
     
@@ -568,47 +959,55 @@ bool UserDatabase::setFamilyDoctor(int userId, const Doctor& doctor) {
 }
 
 Doctor UserDatabase::getFamilyDoctor(int userId) {
-    Doctor doctor;
-    
     if (!m_initialized && !initialize()) {
-        return doctor;
+        return Doctor();
     }
     
-    std::string sql = "SELECT name, phone, email, address, specialization FROM doctors "
-                      "WHERE user_id = ?;";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
+    ReadLease reader(*this);
+    return readFamilyDoctor(*reader, userId);
+}
+
+Doctor UserDatabase::readFamilyDoctor(Connection& connection, int userId) {
+    Doctor doctor;
     
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg(m_db) << std::endl;
+    StatementCache::Handle stmt = connection.statements.acquire(QUERY_SELECT_DOCTOR,
+        "SELECT name, phone, email, address, specialization FROM doctors "
+        "WHERE user_id = ?;");
+    if (!stmt) {
         return doctor;
     }
     
     sqlite3_bind_int(stmt, 1, userId);
     
-    rc = sqlite3_step(stmt);
-    
-    if (rc == SQLITE_ROW) {
-        const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        if (name) doctor.name = name;
-        
-        const char* phone = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        if (phone) doctor.phone = phone;
-        
-        const char* email = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        if (email) doctor.email = email;
-        
-        const char* address = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        if (address) doctor.address = address;
-        
-        const char* specialization = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-        if (specialization) doctor.specialization = specialization;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        doctor.name = columnText(stmt, 0);
+        doctor.phone = columnText(stmt, 1);
+        doctor.email = columnText(stmt, 2);
+        doctor.address = columnText(stmt, 3);
+        doctor.specialization = columnText(stmt, 4);
     }
     
-    sqlite3_finalize(stmt);
-    
     return doctor;
 }
 
+uint64_t UserDatabase::getStatementCount() const {
+    return m_statementCount;
+}
+
+uint64_t UserDatabase::getPrepareCount() const {
+    uint64_t count = m_writer.statements.getPrepareCount();
+    for (const auto& reader : m_readers) {
+        count += reader->statements.getPrepareCount();
+    }
+    return count;
+}
+
+UserDirectory& UserDatabase::getDirectory() {
+    return m_directory;
+}
+
+size_t UserDatabase::getReaderCount() const {
+    return m_readers.size();
+}
+
 } // namespace hms
@@ -0,0 +1,137 @@
+#include "database/user_directory.hpp"
+#include <atomic>
+
+namespace hms {
+
+std::shared_ptr<const User> UserDirectory::Snapshot::find(int userId) const {
+    auto it = users.find(userId);
+    return it != users.end() ? it->second : nullptr;
+}
+
+std::vector<User> UserDirectory::Snapshot::toVector() const {
+    std::vector<User> result;
+    result.reserve(users.size());
+    for (const auto& entry : users) {
+        result.push_back(*entry.second);
+    }
+    return result;
+}
+
+UserDirectory::UserDirectory()
+    : m_snapshot(std::make_shared<const Snapshot>()) {
+}
+
+UserDirectory::~UserDirectory() {
+}
+
+std::shared_ptr<const UserDirectory::Snapshot> UserDirectory::getSnapshot() const {
+    return std::atomic_load(&m_snapshot);
+}
+
+std::shared_ptr<const User> UserDirectory::findUser(int userId) const {
+    return getSnapshot()->find(userId);
+}
+
+void UserDirectory::reset(const std::vector<User>& users) {
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    
+    auto snapshot = std::make_shared<Snapshot>();
+    for (const auto& user : users) {
+        snapshot->users[user.id] = std::make_shared<const User>(user);
+    }
+    snapshot->version = getSnapshot()->version + 1;
+    publish(snapshot);
+}
+
+void UserDirectory::apply(const std::vector<Change>& changes) {
+    if (changes.empty()) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    
+    // Copies the map of pointers only; untouched users are shared
+    std::shared_ptr<const Snapshot> current = getSnapshot();
+    auto snapshot = std::make_shared<Snapshot>(*current);
+    for (const auto& change : changes) {
+        change(snapshot->users);
+    }
+    snapshot->version = current->version + 1;
+    publish(snapshot);
+}
+
+void UserDirectory::publish(std::shared_ptr<Snapshot> snapshot) {
+    uint64_t version = snapshot->version;
+    std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>(std::move(snapshot)));
+    
+    std::lock_guard<std::mutex> lock(m_callbackMutex);
+    for (const auto& callback : m_callbacks) {
+        callback(version);
+    }
+}
+
+void UserDirectory::registerChangeCallback(ChangeCallback callback) {
+    std::lock_guard<std::mutex> lock(m_callbackMutex);
+    m_callbacks.push_back(callback);
+}
+
+UserDirectory::Change UserDirectory::upsertUser(const User& user) {
+    auto copy = std::make_shared<const User>(user);
+    return [copy](UserMap& users) {
+        users[copy->id] = copy;
+    };
+}
+
+UserDirectory::Change UserDirectory::removeUser(int userId) {
+    return [userId](UserMap& users) {
+        users.erase(userId);
+    };
+}
+
+UserDirectory::Change UserDirectory::modifyUser(int userId, std::function<void(User& user)> edit) {
+    return [userId, edit](UserMap& users) {
+        auto it = users.find(userId);
+        if (it == users.end()) {
+            return;
+        }
+        
+        // Copy on write: readers holding the old snapshot keep the old User
+        auto updated = std::make_shared<User>(*it->second);
+        edit(*updated);
+        it->second = updated;
+    };
+}
+
+UserDirectory::Change UserDirectory::updateContact(const EmergencyContact& contact) {
+    return [contact](UserMap& users) {
+        for (auto& entry : users) {
+            const auto& contacts = entry.second->emergencyContacts;
+            for (size_t i = 0; i < contacts.size(); i++) {
+                if (contacts[i].id == contact.id) {
+                    auto updated = std::make_shared<User>(*entry.second);
+                    updated->emergencyContacts[i] = contact;
+                    entry.second = updated;
+                    return;
+                }
+            }
+        }
+    };
+}
+
+UserDirectory::Change UserDirectory::removeContact(int contactId) {
+    return [contactId](UserMap& users) {
+        for (auto& entry : users) {
+            const auto& contacts = entry.second->emergencyContacts;
+            for (size_t i = 0; i < contacts.size(); i++) {
+                if (contacts[i].id == contactId) {
+                    auto updated = std::make_shared<User>(*entry.second);
+                    updated->emergencyContacts.erase(updated->emergencyContacts.begin() + i);
+                    entry.second = updated;
+                    return;
+                }
+            }
+        }
+    };
+}
+
+} // namespace hms
@@ -0,0 +1,198 @@
+#include "database/user_import.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace hms {
+
+static std::string lowerExtension(const std::string& filePath) {
+    size_t dot = filePath.find_last_of('.');
+    if (dot == std::string::npos) {
+        return "";
+    }
+    
+    std::string extension = filePath.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension;
+}
+
+// Splits one CSV record, which may span lines inside quotes; false at end of input
+static bool readCsvRecord(std::istream& in, std::vector<std::string>& fields) {
+    fields.clear();
+    
+    std::string line;
+    if (!std::getline(in, line)) {
+        return false;
+    }
+    
+    std::string field;
+    bool quoted = false;
+    for (size_t i = 0;; i++) {
+        if (i == line.size()) {
+            if (quoted && std::getline(in, line)) {
+                field += '\n';
+                i = static_cast<size_t>(-1);
+                continue;
+            }
+            break;
+        }
+        
+        char c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                field += '"';
+                i++;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                field += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.push_back(field);
+            field.clear();
+        } else if (c != '\r') {
+            field += c;
+        }
+    }
+    fields.push_back(field);
+    return true;
+}
+
+bool loadUsersFromFile(const std::string& filePath, std::vector<User>& users) {
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        std::cerr << "Cannot open user file: " << filePath << std::endl;
+        return false;
+    }
+    
+    std::string extension = lowerExtension(filePath);
+    if (extension == "csv") {
+        return parseUsersCsv(file, users);
+    }
+    if (extension == "json") {
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return parseUsersJson(buffer.str(), users);
+    }
+    
+    std::cerr << "Unsupported user file type: " << filePath << std::endl;
+    return false;
+}
+
+bool parseUsersJson(const std::string& text, std::vector<User>& users) {
+    try {
+        json root = json::parse(text);
+        const json& list = root.is_object() ? root.at("users") : root;
+        if (!list.is_array()) {
+            std::cerr << "User file must hold an array of users" << std::endl;
+            return false;
+        }
+        
+        for (const auto& item : list) {
+            User user;
+            user.id = -1;
+            user.name = item.at("name").get<std::string>();
+            user.notes = item.value("notes", "");
+            user.imageReference = item.value("image_reference", "");
+            
+            if (item.contains("emergency_contacts")) {
+                for (const auto& entry : item["emergency_contacts"]) {
+                    EmergencyContact contact;
+                    contact.name = entry.at("name").get<std::string>();
+                    contact.phone = entry.value("phone", "");
+                    contact.email = entry.value("email", "");
+                    contact.address = entry.value("address", "");
+                    contact.relationship = entry.value("relationship", "");
+                    user.emergencyContacts.push_back(contact);
+                }
+            }
+            
+            if (item.contains("family_doctor")) {
+                const json& entry = item["family_doctor"];
+                user.familyDoctor.name = entry.value("name", "");
+                user.familyDoctor.phone = entry.value("phone", "");
+                user.familyDoctor.email = entry.value("email", "");
+                user.familyDoctor.address = entry.value("address", "");
+                user.familyDoctor.specialization = entry.value("specialization", "");
+            }
+            
+            users.push_back(user);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error parsing user file: " << e.what() << std::endl;
+        return false;
+    }
+    
+    return true;
+}
+
+bool parseUsersCsv(std::istream& in, std::vector<User>& users) {
+    std::vector<std::string> header;
+    if (!readCsvRecord(in, header)) {
+        std::cerr << "User file is empty" << std::endl;
+        return false;
+    }
+    
+    std::unordered_map<std::string, size_t> columns;
+    for (size_t i = 0; i < header.size(); i++) {
+        columns[header[i]] = i;
+    }
+    if (columns.find("name") == columns.end()) {
+        std::cerr << "User file has no name column" << std::endl;
+        return false;
+    }
+    
+    std::vector<std::string> fields;
+    auto field = [&columns, &fields](const char* name) {
+        auto it = columns.find(name);
+        return it != columns.end() && it->second < fields.size() ? fields[it->second] : std::string();
+    };
+    
+    size_t firstNew = users.size();
+    int lineNumber = 1;
+    while (readCsvRecord(in, fields)) {
+        lineNumber++;
+        if (fields.size() == 1 && fields[0].empty()) {
+            continue;  // Blank line
+        }
+        
+        if (!field("name").empty()) {
+            User user;
+            user.id = -1;
+            user.name = field("name");
+            user.notes = field("notes");
+            user.imageReference = field("image_reference");
+            user.familyDoctor.name = field("doctor_name");
+            user.familyDoctor.phone = field("doctor_phone");
+            user.familyDoctor.email = field("doctor_email");
+            user.familyDoctor.address = field("doctor_address");
+            user.familyDoctor.specialization = field("doctor_specialization");
+            users.push_back(user);
+        } else if (users.size() == firstNew) {
+            std::cerr << "User file line " << lineNumber << ": contact before any resident" << std::endl;
+            return false;
+        }
+        
+        if (!field("contact_name").empty()) {
+            EmergencyContact contact;
+            contact.name = field("contact_name");
+            contact.phone = field("contact_phone");
+            contact.email = field("contact_email");
+            contact.address = field("contact_address");
+            contact.relationship = field("contact_relationship");
+            users.back().emergencyContacts.push_back(contact);
+        }
+    }
+    
+    return true;
+}
+
+} // namespace hms
@@ -0,0 +1,177 @@
+#include "network/escalation_engine.hpp"
+#include <chrono>
+
+namespace hms {
+
+// Enough for the default timeouts to stay within a few turns of the wheel
+static const size_t kWheelSlots = 4096;
+
+static int64_t currentTimeMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+EscalationEngine::EscalationEngine(TierCallback notifyTier, ExhaustedCallback exhausted)
+    : EscalationEngine(Options(), std::move(notifyTier), std::move(exhausted)) {
+}
+
+EscalationEngine::EscalationEngine(const Options& options, TierCallback notifyTier, ExhaustedCallback exhausted)
+    : m_options(options), m_notifyTier(std::move(notifyTier)), m_exhausted(std::move(exhausted)),
+      m_wheel(options.tickMs, kWheelSlots), m_running(false) {
+}
+
+EscalationEngine::~EscalationEngine() {
+    stop();
+}
+
+void EscalationEngine::start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running) {
+        return;
+    }
+    m_running = true;
+    m_thread = std::thread(&EscalationEngine::threadFunc, this);
+}
+
+void EscalationEngine::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+uint64_t EscalationEngine::residentKey(int userId, int personId) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(userId)) << 32) | static_cast<uint32_t>(personId);
+}
+
+bool EscalationEngine::open(int userId, int personId, int64_t nowMs) {
+    Escalation escalation;
+    escalation.userId = userId;
+    escalation.personId = personId;
+    escalation.openedMs = nowMs;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto inserted = m_open.emplace(residentKey(userId, personId), OpenEscalation());
+        if (!inserted.second) {
+            return false;
+        }
+        inserted.first->second.escalation = escalation;
+    }
+    
+    notify(escalation, nowMs);
+    return true;
+}
+
+bool EscalationEngine::acknowledge(int userId, int personId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_open.find(residentKey(userId, personId));
+    if (it == m_open.end()) {
+        return false;
+    }
+    
+    m_wheel.cancel(it->second.timer);
+    m_open.erase(it);
+    return true;
+}
+
+int EscalationEngine::getTier(int userId, int personId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_open.find(residentKey(userId, personId));
+    return it == m_open.end() ? -1 : static_cast<int>(it->second.escalation.tier);
+}
+
+size_t EscalationEngine::getOpenCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_open.size();
+}
+
+void EscalationEngine::advance(int64_t nowMs) {
+    std::vector<Escalation> timedOut;
+    std::vector<Escalation> exhausted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<uint64_t> fired;
+        m_wheel.advance(nowMs, fired);
+        
+        for (uint64_t key : fired) {
+            auto it = m_open.find(key);
+            if (it == m_open.end()) {
+                continue;
+            }
+            it->second.timer = TimerWheel::kInvalidTimer;
+            Escalation& escalation = it->second.escalation;
+            if (++escalation.tier >= m_options.tierTimeoutsMs.size()) {
+                exhausted.push_back(escalation);
+                m_open.erase(it);
+            } else {
+                timedOut.push_back(escalation);
+            }
+        }
+    }
+    
+    for (const auto& escalation : exhausted) {
+        m_exhausted(escalation);
+    }
+    for (const auto& escalation : timedOut) {
+        notify(escalation, nowMs);
+    }
+}
+
+void EscalationEngine::notify(Escalation escalation, int64_t nowMs) {
+    uint64_t key = residentKey(escalation.userId, escalation.personId);
+    
+    while (true) {
+        bool notified = escalation.tier < m_options.tierTimeoutsMs.size() && m_notifyTier(escalation);
+        
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_open.find(key);
+        if (it == m_open.end() || it->second.escalation.openedMs != escalation.openedMs ||
+            it->second.escalation.tier != escalation.tier) {
+            // Acknowledged while the tier was being notified
+            return;
+        }
+        
+        if (notified) {
+            it->second.timer = m_wheel.schedule(nowMs + m_options.tierTimeoutsMs[escalation.tier], key);
+            m_cv.notify_one();
+            return;
+        }
+        
+        // Nobody in this tier: straight on to the next
+        if (++escalation.tier >= m_options.tierTimeoutsMs.size()) {
+            m_open.erase(it);
+            break;
+        }
+        it->second.escalation.tier = escalation.tier;
+    }
+    
+    m_exhausted(escalation);
+}
+
+void EscalationEngine::threadFunc() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_running) {
+        // Idle until a timeout is pending, then tick
+        if (m_wheel.size() == 0) {
+            m_cv.wait(lock, [this] { return !m_running || m_wheel.size() > 0; });
+        } else {
+            m_cv.wait_for(lock, std::chrono::milliseconds(m_wheel.getTickMs()), [this] { return !m_running; });
+        }
+        if (!m_running) {
+            break;
+        }
+        
+        lock.unlock();
+        advance(currentTimeMs());
+        lock.lock();
+    }
+}
+
+} // namespace hms
@@ -0,0 +1,295 @@
+#include "network/notification_channel.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cctype>
+#include <nlohmann/json.hpp>
+
+namespace hms {
+
+// Form-encodes a value for an SMS gateway
+static std::string urlEncode(const std::string& value) {
+    static const char* const kHex = "0123456789ABCDEF";
+    std::string encoded;
+    for (unsigned char c : value) {
+        if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            encoded += static_cast<char>(c);
+        } else {
+            encoded += '%';
+            encoded += kHex[c >> 4];
+            encoded += kHex[c & 0x0F];
+        }
+    }
+    return encoded;
+}
+
+// Base64 in lines of 76 characters, as MIME requires
+static std::string base64Encode(const std::vector<unsigned char>& data) {
+    static const char* const kAlphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    static const size_t kLineGroups = 19;   // 4 characters each
+    
+    std::string encoded;
+    encoded.reserve((data.size() + 2) / 3 * 4 + data.size() / 57 * 2 + 2);
+    size_t groups = 0;
+    for (size_t i = 0; i < data.size(); i += 3) {
+        uint32_t triple = static_cast<uint32_t>(data[i]) << 16;
+        if (i + 1 < data.size()) {
+            triple |= static_cast<uint32_t>(data[i + 1]) << 8;
+        }
+        if (i + 2 < data.size()) {
+            triple |= data[i + 2];
+        }
+        encoded += kAlphabet[(triple >> 18) & 0x3F];
+        encoded += kAlphabet[(triple >> 12) & 0x3F];
+        encoded += i + 1 < data.size() ? kAlphabet[(triple >> 6) & 0x3F] : '=';
+        encoded += i + 2 < data.size() ? kAlphabet[triple & 0x3F] : '=';
+        if (++groups == kLineGroups) {
+            encoded += "\r\n";
+            groups = 0;
+        }
+    }
+    if (groups > 0) {
+        encoded += "\r\n";
+    }
+    return encoded;
+}
+
+NotificationChannel::NotificationChannel(const std::string& name, size_t maxConcurrent)
+    : m_name(name), m_maxConcurrent(std::max<size_t>(1, maxConcurrent)), m_inFlight(0), m_sent(0), m_failed(0),
+      m_totalLatencyMs(0.0), m_maxLatencyMs(0.0) {
+}
+
+const std::string& NotificationChannel::getName() const {
+    return m_name;
+}
+
+void NotificationChannel::send(const ChannelMessage& message, Callback callback) {
+    Pending pending{message, std::move(callback), std::chrono::steady_clock::now()};
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_inFlight >= m_maxConcurrent) {
+            m_pending.push_back(std::move(pending));
+            return;
+        }
+        m_inFlight++;
+    }
+    start(std::move(pending));
+}
+
+void NotificationChannel::start(Pending pending) {
+    auto submitted = pending.submitted;
+    Callback callback = std::move(pending.callback);
+    deliver(pending.message, [this, submitted, callback](const TransportResult& result) {
+        finish(submitted, result.success);
+        if (callback) {
+            callback(result);
+        }
+    });
+}
+
+void NotificationChannel::finish(std::chrono::steady_clock::time_point submitted, bool success) {
+    double latencyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - submitted).count();
+    
+    // The slot passes straight to the next message waiting for one
+    Pending next;
+    bool haveNext = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (success) {
+            m_sent++;
+        } else {
+            m_failed++;
+        }
+        m_totalLatencyMs += latencyMs;
+        m_maxLatencyMs = std::max(m_maxLatencyMs, latencyMs);
+        
+        if (!m_pending.empty()) {
+            next = std::move(m_pending.front());
+            m_pending.pop_front();
+            haveNext = true;
+        } else {
+            m_inFlight--;
+        }
+    }
+    
+    if (haveNext) {
+        start(std::move(next));
+    }
+}
+
+ChannelMetrics NotificationChannel::getMetrics() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ChannelMetrics metrics;
+    metrics.name = m_name;
+    metrics.sent = m_sent;
+    metrics.failed = m_failed;
+    metrics.inFlight = m_inFlight;
+    metrics.queued = m_pending.size();
+    if (m_sent + m_failed > 0) {
+        metrics.averageLatencyMs = m_totalLatencyMs / static_cast<double>(m_sent + m_failed);
+    }
+    metrics.maxLatencyMs = m_maxLatencyMs;
+    return metrics;
+}
+
+size_t NotificationChannel::getFreeSlots() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t taken = m_inFlight + m_pending.size();
+    return taken >= m_maxConcurrent ? 0 : m_maxConcurrent - taken;
+}
+
+std::unique_ptr<NotificationChannel> createNotificationChannel(const std::string& name, const ChannelConfig& config,
+                                                               NotificationTransport& transport) {
+    std::string missing;
+    if (config.type == "twilio") {
+        if (config.username.empty() || config.password.empty() || config.from.empty()) {
+            missing = "account SID, auth token and sender number";
+        }
+    } else if (config.type == "sms_http" || config.type == "smtp" || config.type == "webhook") {
+        if (config.url.empty()) {
+            missing = "URL";
+        }
+    } else if (config.type != "capture") {
+        std::cerr << "Unknown notification channel type for " << name << ": " << config.type << std::endl;
+        return nullptr;
+    }
+    if (!missing.empty()) {
+        std::cerr << "Notification channel " << name << " (" << config.type << ") is missing its " << missing << std::endl;
+        return nullptr;
+    }
+    
+    if (config.type == "sms_http" || config.type == "twilio") {
+        return std::make_unique<SmsHttpChannel>(name, config, transport);
+    }
+    if (config.type == "smtp") {
+        return std::make_unique<SmtpChannel>(name, config, transport);
+    }
+    if (config.type == "webhook") {
+        return std::make_unique<WebhookChannel>(name, config, transport);
+    }
+    return std::make_unique<CaptureChannel>(name, config.maxConcurrent);
+}
+
+SmsHttpChannel::SmsHttpChannel(const std::string& name, const ChannelConfig& config,
+                               NotificationTransport& transport)
+    : NotificationChannel(name, config.maxConcurrent), m_config(config), m_transport(transport),
+      m_twilio(config.type == "twilio") {
+    if (m_twilio && m_config.url.empty()) {
+        m_config.url = "https://api.twilio.com/2010-04-01/Accounts/" + urlEncode(m_config.username) +
+                       "/Messages.json";
+    }
+}
+
+void SmsHttpChannel::deliver(const ChannelMessage& message, Callback done) {
+    if (m_twilio) {
+        std::string fields = "To=" + urlEncode(message.recipient) +
+                             "&From=" + urlEncode(m_config.from) +
+                             "&Body=" + urlEncode(message.body);
+        m_transport.post(m_config.url, {}, fields, m_config.username, m_config.password, std::move(done));
+        return;
+    }
+    
+    std::string fields = "apikey=" + urlEncode(m_config.token) +
+                         "&to=" + urlEncode(message.recipient) +
+                         "&message=" + urlEncode(message.body);
+    if (!m_config.from.empty()) {
+        fields += "&from=" + urlEncode(m_config.from);
+    }
+    m_transport.postForm(m_config.url, fields, std::move(done));
+}
+
+SmtpChannel::SmtpChannel(const std::string& name, const ChannelConfig& config, NotificationTransport& transport)
+    : NotificationChannel(name, config.maxConcurrent), m_config(config), m_transport(transport) {
+    if (m_config.from.empty()) {
+        m_config.from = m_config.username;
+    }
+}
+
+std::string buildMailPayload(const std::string& from, const ChannelMessage& message) {
+    std::string payload = "To: " + message.recipient + "\r\n"
+                        + "From: " + from + "\r\n"
+                        + "Subject: " + message.subject + "\r\n";
+    
+    if (message.attachments.empty()) {
+        payload += "\r\n" + message.body + "\r\n";
+        return payload;
+    }
+    
+    // Neither base64 nor our alert text can contain the boundary
+    static const std::string kBoundary = "hms-alert-boundary-0b7d2c";
+    payload += "MIME-Version: 1.0\r\n"
+               "Content-Type: multipart/mixed; boundary=\"" + kBoundary + "\"\r\n"
+               "\r\n"
+               "--" + kBoundary + "\r\n"
+               "Content-Type: text/plain; charset=utf-8\r\n"
+               "Content-Transfer-Encoding: 8bit\r\n"
+               "\r\n" + message.body + "\r\n";
+    for (const auto& attachment : message.attachments) {
+        payload += "--" + kBoundary + "\r\n"
+                   "Content-Type: " + attachment->contentType + "; name=\"" + attachment->filename + "\"\r\n"
+                   "Content-Transfer-Encoding: base64\r\n"
+                   "Content-Disposition: attachment; filename=\"" + attachment->filename + "\"\r\n"
+                   "\r\n" + base64Encode(attachment->data);
+    }
+    payload += "--" + kBoundary + "--\r\n";
+    return payload;
+}
+
+void SmtpChannel::deliver(const ChannelMessage& message, Callback done) {
+    m_transport.sendMail(m_config.url, m_config.username, m_config.password, m_config.from, message.recipient,
+                         buildMailPayload(m_config.from, message), std::move(done));
+}
+
+WebhookChannel::WebhookChannel(const std::string& name, const ChannelConfig& config,
+                               NotificationTransport& transport)
+    : NotificationChannel(name, config.maxConcurrent), m_config(config), m_transport(transport) {
+}
+
+void WebhookChannel::deliver(const ChannelMessage& message, Callback done) {
+    nlohmann::json payload = {
+        {"channel", getName()},
+        {"recipient", message.recipient},
+        {"subject", message.subject},
+        {"message", message.body}
+    };
+    
+    std::vector<std::string> headers = {"Content-Type: application/json"};
+    if (!m_config.token.empty()) {
+        headers.push_back("Authorization: Bearer " + m_config.token);
+    }
+    m_transport.post(m_config.url, headers, payload.dump(), "", "", std::move(done));
+}
+
+CaptureChannel::CaptureChannel(const std::string& name, size_t maxConcurrent)
+    : NotificationChannel(name, maxConcurrent), m_failing(false) {
+}
+
+std::vector<ChannelMessage> CaptureChannel::getMessages() const {
+    std::lock_guard<std::mutex> lock(m_messagesMutex);
+    return m_messages;
+}
+
+void CaptureChannel::clear() {
+    std::lock_guard<std::mutex> lock(m_messagesMutex);
+    m_messages.clear();
+}
+
+void CaptureChannel::setFailing(bool failing) {
+    std::lock_guard<std::mutex> lock(m_messagesMutex);
+    m_failing = failing;
+}
+
+void CaptureChannel::deliver(const ChannelMessage& message, Callback done) {
+    TransportResult result;
+    {
+        std::lock_guard<std::mutex> lock(m_messagesMutex);
+        if (m_failing) {
+            result.error = "capture channel set to fail";
+        } else {
+            m_messages.push_back(message);
+            result.success = true;
+        }
+    }
+    done(result);
+}
+
+} // namespace hms
@@ -0,0 +1,243 @@
+#include "network/notification_coalescer.hpp"
+#include <algorithm>
+#include <functional>
+#include <cmath>
+
+namespace hms {
+
+TokenBucket::TokenBucket(double perMinute, double burst)
+    : m_perMs(perMinute / 60000.0), m_capacity(std::max(1.0, burst)), m_tokens(m_capacity),
+      m_lastRefillMs(-1) {
+}
+
+void TokenBucket::refill(int64_t nowMs) {
+    if (m_lastRefillMs >= 0 && nowMs > m_lastRefillMs) {
+        m_tokens = std::min(m_capacity, m_tokens + (nowMs - m_lastRefillMs) * m_perMs);
+    }
+    m_lastRefillMs = std::max(m_lastRefillMs, nowMs);
+}
+
+bool TokenBucket::tryTake(int64_t nowMs) {
+    // A rate of zero or less means no limit
+    if (m_perMs <= 0.0) {
+        return true;
+    }
+    
+    refill(nowMs);
+    if (m_tokens < 1.0) {
+        return false;
+    }
+    m_tokens -= 1.0;
+    return true;
+}
+
+int64_t TokenBucket::nextTokenMs(int64_t nowMs, size_t ahead) {
+    if (m_perMs <= 0.0) {
+        return nowMs;
+    }
+    
+    refill(nowMs);
+    double needed = static_cast<double>(ahead) + 1.0 - m_tokens;
+    if (needed <= 0.0) {
+        return nowMs;
+    }
+    return nowMs + static_cast<int64_t>(std::ceil(needed / m_perMs));
+}
+
+NotificationCoalescer::NotificationCoalescer()
+    : NotificationCoalescer(Options()) {
+}
+
+NotificationCoalescer::NotificationCoalescer(const Options& options)
+    : m_options(options),
+      m_smsBucket(options.smsPerMinute, options.smsBurst),
+      m_emailBucket(options.emailPerMinute, options.emailBurst),
+      m_lastPruneMs(0), m_sends(0), m_merged(0), m_suppressed(0), m_rateLimited(0) {
+}
+
+std::string NotificationCoalescer::recipientKey(OutboxChannel channel, const std::string& recipient) {
+    return (channel == OutboxChannel::EMAIL ? "email:" : "sms:") + recipient;
+}
+
+size_t NotificationCoalescer::contentHash(const OutboxEntry& entry) {
+    return std::hash<std::string>()(entry.subject + '\n' + entry.message);
+}
+
+NotificationCoalescer::Plan NotificationCoalescer::plan(const std::vector<OutboxEntry>& due, int64_t nowMs) {
+    prune(nowMs);
+    
+    // Group by recipient, keeping the order in which recipients first appear
+    std::vector<std::string> order;
+    std::map<std::string, std::vector<OutboxEntry>> groups;
+    for (const auto& entry : due) {
+        std::string key = recipientKey(entry.channel, entry.recipient);
+        auto& group = groups[key];
+        if (group.empty()) {
+            order.push_back(key);
+        }
+        group.push_back(entry);
+    }
+    
+    Plan plan;
+    size_t smsDeferred = 0;
+    size_t emailDeferred = 0;
+    
+    for (const auto& key : order) {
+        const auto& group = groups[key];
+        RecipientState& state = m_recipients[key];
+        
+        // Repeats of a message the recipient got are settled now; repeats of
+        // one still being sent, or of one in this group, wait for its result
+        std::vector<OutboxEntry> fresh;
+        std::vector<size_t> hashes;
+        std::vector<std::pair<size_t, OutboxEntry>> repeats;
+        for (const auto& entry : group) {
+            size_t hash = contentHash(entry);
+            auto recent = std::find_if(state.recentMessages.begin(), state.recentMessages.end(),
+                                       [&](const RecentMessage& message) {
+                                           return message.hash == hash &&
+                                                  (!message.delivered || message.sentMs + m_options.windowMs > nowMs);
+                                       });
+            if (m_options.windowMs > 0 && recent != state.recentMessages.end()) {
+                if (recent->delivered) {
+                    plan.suppressed.push_back(entry);
+                    m_suppressed++;
+                } else {
+                    hold(*recent, entry);
+                }
+                continue;
+            }
+            if (std::find(hashes.begin(), hashes.end(), hash) != hashes.end()) {
+                repeats.emplace_back(hash, entry);
+                continue;
+            }
+            hashes.push_back(hash);
+            fresh.push_back(entry);
+        }
+        if (fresh.empty()) {
+            continue;
+        }
+        
+        // Over the channel's rate: try again when a token will be free,
+        // spacing deferred recipients so they do not all wake together
+        bool isEmail = fresh.front().channel == OutboxChannel::EMAIL;
+        TokenBucket& bucket = isEmail ? m_emailBucket : m_smsBucket;
+        if (!bucket.tryTake(nowMs)) {
+            size_t& ahead = isEmail ? emailDeferred : smsDeferred;
+            int64_t retryMs = bucket.nextTokenMs(nowMs, ahead++);
+            for (auto entry : fresh) {
+                entry.nextAttemptMs = retryMs;
+                plan.deferred.push_back(entry);
+            }
+            for (auto& repeat : repeats) {
+                repeat.second.nextAttemptMs = retryMs;
+                plan.deferred.push_back(repeat.second);
+            }
+            m_rateLimited++;
+            continue;
+        }
+        
+        for (size_t hash : hashes) {
+            state.recentMessages.push_back({hash, nowMs, false, {}});
+        }
+        for (const auto& repeat : repeats) {
+            auto recent = std::find_if(state.recentMessages.begin(), state.recentMessages.end(),
+                                       [&](const RecentMessage& message) {
+                                           return message.hash == repeat.first && !message.delivered;
+                                       });
+            hold(*recent, repeat.second);
+        }
+        
+        m_sends++;
+        m_merged += fresh.size() - 1;
+        plan.sends.push_back({mergeParts(fresh), fresh});
+    }
+    
+    return plan;
+}
+
+void NotificationCoalescer::hold(RecentMessage& message, const OutboxEntry& entry) {
+    // A repeat claimed again after its lease ran out replaces itself
+    auto held = std::find_if(message.held.begin(), message.held.end(),
+                             [&](const OutboxEntry& other) { return other.id == entry.id; });
+    if (held != message.held.end()) {
+        *held = entry;
+    } else {
+        message.held.push_back(entry);
+    }
+}
+
+OutboxEntry NotificationCoalescer::mergeParts(const std::vector<OutboxEntry>& parts) {
+    OutboxEntry merged = parts.front();
+    if (parts.size() == 1) {
+        return merged;
+    }
+    
+    merged.subject = parts.front().subject + " (+" + std::to_string(parts.size() - 1) + " more)";
+    merged.message = std::to_string(parts.size()) + " alerts:";
+    for (size_t i = 0; i < parts.size(); i++) {
+        merged.message += "\n\n" + std::to_string(i + 1) + ". " + parts[i].message;
+        merged.countsAsSent = merged.countsAsSent || parts[i].countsAsSent;
+    }
+    return merged;
+}
+
+void NotificationCoalescer::prune(int64_t nowMs) {
+    if (nowMs - m_lastPruneMs < std::max<int64_t>(m_options.windowMs, 1000)) {
+        return;
+    }
+    m_lastPruneMs = nowMs;
+    
+    // Messages still being sent stay until complete() hears of them
+    int64_t cutoff = nowMs - m_options.windowMs;
+    for (auto it = m_recipients.begin(); it != m_recipients.end();) {
+        auto& recent = it->second.recentMessages;
+        recent.erase(std::remove_if(recent.begin(), recent.end(),
+                                    [cutoff](const RecentMessage& message) {
+                                        return message.delivered && message.sentMs <= cutoff;
+                                    }),
+                     recent.end());
+        if (recent.empty()) {
+            it = m_recipients.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::vector<OutboxEntry> NotificationCoalescer::complete(const OutboxEntry& part, bool success) {
+    auto it = m_recipients.find(recipientKey(part.channel, part.recipient));
+    if (it == m_recipients.end()) {
+        return {};
+    }
+    
+    size_t hash = contentHash(part);
+    auto& recent = it->second.recentMessages;
+    auto message = std::find_if(recent.begin(), recent.end(), [hash](const RecentMessage& other) {
+        return other.hash == hash && !other.delivered;
+    });
+    if (message == recent.end()) {
+        return {};
+    }
+    
+    std::vector<OutboxEntry> held;
+    held.swap(message->held);
+    if (success) {
+        message->delivered = true;
+        m_suppressed += held.size();
+    } else {
+        recent.erase(message);
+    }
+    return held;
+}
+
+NotificationCoalescer::Stats NotificationCoalescer::getStats() const {
+    Stats stats;
+    stats.sends = m_sends;
+    stats.merged = m_merged;
+    stats.suppressed = m_suppressed;
+    stats.rateLimited = m_rateLimited;
+    return stats;
+}
+
+} // namespace hms
@@ -2,27 +2,79 @@
 #include <iostream>
 #include <sstream>
 #include <curl/curl.h>
-#include <random>
+#include <cctype>
+#include <algorithm>
 
 namespace hms {
 
-// Callback function for CURL to handle response data
-static size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* s) {
-    size_t newLength = size * nmemb;
-    try {
-        s->append((char*)contents, newLength);
-        return newLength;
-    } catch(std::bad_alloc& e) {
-        return 0;
+// Keeps the digits and a leading '+', so "+1 (555) 010-0" and "+15550100"
+// are the same number
+static std::string normalizePhone(const std::string& number) {
+    std::string normalized;
+    for (char c : number) {
+        if (std::isdigit(static_cast<unsigned char>(c)) || (c == '+' && normalized.empty())) {
+            normalized += c;
+        }
     }
+    return normalized;
+}
+
+// Claimed sends awaiting a result; more wait in the outbox
+static const size_t kMaxInFlightSends = 512;
+
+// Wait before trying again to store sends the outbox refused
+static const int64_t kStoreRetryMs = 1000;
+
+static int64_t toEpochMs(std::chrono::system_clock::time_point timePoint) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(timePoint.time_since_epoch()).count();
 }
 
-NotificationManager::NotificationManager(UserDatabase* userDb)
-    : m_userDb(userDb), m_running(false), 
-      m_smsApiKey("YOUR_SMS_API_KEY"), // Replace with actual API key in production
-      m_emailSmtpServer("smtp.example.com"),
-      m_emailUsername("notifications@example.com"),
-      m_emailPassword("your_password") { // Use secure storage in production
+static const char* statusToString(NotificationStatus status) {
+    switch (status) {
+        case NotificationStatus::PENDING: return "pending";
+        case NotificationStatus::SENT: return "sent";
+        case NotificationStatus::DELIVERED: return "delivered";
+        case NotificationStatus::READ: return "read";
+        case NotificationStatus::RESPONDED: return "responded";
+        case NotificationStatus::FAILED: return "failed";
+    }
+    return "unknown";
+}
+
+static const char* tierToString(EscalationTier tier) {
+    switch (tier) {
+        case EscalationTier::PRIMARY_CONTACT: return "primary contact";
+        case EscalationTier::SECONDARY_CONTACTS: return "secondary contacts";
+        case EscalationTier::FAMILY_DOCTOR: return "family doctor";
+    }
+    return "unknown";
+}
+
+NotificationManager::NotificationManager(UserDatabase* userDb, const std::string& outboxPath,
+                                         const NotificationOutbox::Options& outboxOptions,
+                                         const NotificationCoalescer::Options& coalescerOptions,
+                                         const EscalationEngine::Options& escalationOptions,
+                                         const SnapshotEncoder::Options& snapshotOptions)
+    : m_userDb(userDb), m_eventLog(nullptr), m_running(false),
+      m_outboxPath(outboxPath), m_outboxOptions(outboxOptions), m_coalescer(coalescerOptions),
+      m_snapshotEncoder(snapshotOptions),
+      m_escalations(escalationOptions,
+                    [this](const EscalationEngine::Escalation& escalation) { return notifyTier(escalation); },
+                    [this](const EscalationEngine::Escalation& escalation) { escalationExhausted(escalation); }) {
+    // Placeholders until the real gateway and mail server are configured
+    ChannelConfig sms;
+    sms.type = "sms_http";
+    sms.url = "https://api.example.com/sms";
+    sms.token = "YOUR_SMS_API_KEY";
+    configureChannel(OutboxChannel::SMS, sms);
+    
+    ChannelConfig email;
+    email.type = "smtp";
+    email.url = "smtp.example.com";
+    email.username = "notifications@example.com";
+    email.password = "your_password";
+    email.maxConcurrent = 4;
+    configureChannel(OutboxChannel::EMAIL, email);
 }
 
 NotificationManager::~NotificationManager() {
@@ -39,11 +91,24 @@ void NotificationManager::initialize() {
     // Initialize CURL globally
     curl_global_init(CURL_GLOBAL_ALL);
     
+    // Without the outbox file, alerts still go out but do not survive a restart
+    m_outbox = std::make_unique<NotificationOutbox>(m_outboxPath, m_outboxOptions);
+    if (!m_outbox->initialize()) {
+        std::cerr << "Notification outbox unavailable; unsent alerts will not survive a restart" << std::endl;
+        m_outbox = std::make_unique<NotificationOutbox>(":memory:", m_outboxOptions);
+        m_outbox->initialize();
+    }
+    
+    // Sends go out concurrently over kept-alive connections
+    if (!m_transport.start()) {
+        std::cerr << "Notification transport failed to start; alerts will not be sent" << std::endl;
+    }
+    
     // Start notification thread
     m_notificationThread = std::thread(&NotificationManager::notificationThreadFunc, this);
     
-    // Start response check thread
-    m_responseCheckThread = std::thread(&NotificationManager::responseCheckThreadFunc, this);
+    // Unanswered alerts are widened tier by tier from here
+    m_escalations.start();
 }
 
 void NotificationManager::shutdown() {
@@ -51,6 +116,8 @@ void NotificationManager::shutdown() {
         return;
     }
     
+    // No more tiers are queued once the notification thread has gone
+    m_escalations.stop();
     m_running = false;
     
     // Notify threads to exit
@@ -61,20 +128,22 @@ void NotificationManager::shutdown() {
         m_notificationThread.join();
     }
     
-    if (m_responseCheckThread.joinable()) {
-        m_responseCheckThread.join();
-    }
+    // Sends still in flight are abandoned; they stay in the outbox and are
+    // sent again on the next start
+    m_transport.stop();
+    m_outbox->shutdown();
     
     // Cleanup CURL
     curl_global_cleanup();
 }
 
 void NotificationManager::notifyFallEvent(const FallEvent& fallEvent, int userId) {
-    User user = m_userDb->getUserById(userId);
-    if (user.id == -1) {
+    std::shared_ptr<const User> found = m_userDb->getDirectory().findUser(userId);
+    if (!found) {
         std::cerr << "User not found: " << userId << std::endl;
         return;
     }
+    const User& user = *found;
     
     // Create notification message
     std::stringstream ss;
@@ -83,42 +152,335 @@ void NotificationManager::notifyFallEvent(const FallEvent& fallEvent, int userId
        << std::chrono::system_clock::to_time_t(std::chrono::system_clock::now())
        << ". Please respond to this message to confirm you are taking action.";
     
-    std::string message = ss.str();
+    EventRecord event;
+    event.type = EventType::FALL_DETECTED;
+    event.timestampMs = toEpochMs(std::chrono::system_clock::now());
+    event.trackId = fallEvent.personId;
+    event.userId = user.id;
+    event.subject = "Fall Detected";
+    logEvent(event);
+    
+    queueNotification(user, fallEvent.personId, "Fall Detected", ss.str(), fallEvent.frameSnapshot);
+}
+
+void NotificationManager::notifyActivityAlert(const ActivityAlert& alert, int userId) {
+    std::shared_ptr<const User> found = m_userDb->getDirectory().findUser(userId);
+    if (!found) {
+        std::cerr << "User not found: " << userId << std::endl;
+        return;
+    }
+    const User& user = *found;
+    
+    std::stringstream ss;
+    ss << "ALERT: " << alert.ruleName << " for " << user.name << ". " << alert.description << ". "
+       << "This alert was triggered at " 
+       << std::chrono::system_clock::to_time_t(alert.timestamp)
+       << ". Please respond to this message to confirm you are taking action.";
+    
+    EventRecord event;
+    event.type = EventType::ACTIVITY_ALERT;
+    event.timestampMs = toEpochMs(alert.timestamp);
+    event.cameraIndex = static_cast<int>(alert.cameraIndex);
+    event.trackId = alert.personId;
+    event.userId = user.id;
+    event.subject = alert.ruleName;
+    event.detail = alert.description;
+    logEvent(event);
+    
+    queueNotification(user, alert.personId, alert.ruleName, ss.str());
+}
+
+void NotificationManager::queueNotification(const User& user, int personId, const std::string& subject,
+                                            const std::string& message, const cv::Mat& snapshot) {
+    NotificationMessage notification;
+    notification.userId = user.id;
+    notification.personId = personId;
+    notification.subject = subject;
+    notification.message = message;
+    notification.timestamp = std::chrono::system_clock::now();
+    notification.status = NotificationStatus::PENDING;
     
-    // Queue notifications for all emergency contacts
     {
+        std::lock_guard<std::mutex> activeLock(m_activeNotificationsMutex);
+        m_activeNotifications[std::make_pair(user.id, personId)] = notification;
+    }
+    
+    // Compressing the snapshot is left to the notification thread; it is
+    // handed over ahead of the sends, so they find it encoded
+    if (!snapshot.empty()) {
         std::lock_guard<std::mutex> lock(m_queueMutex);
-        
-        for (const auto& contact : user.emergencyContacts) {
-            NotificationMessage notification;
-            notification.userId = userId;
-            notification.personId = fallEvent.personId;
-            notification.message = message;
-            notification.timestamp = std::chrono::system_clock::now();
-            notification.status = NotificationStatus::PENDING;
-            
-            m_notificationQueue.push(notification);
-            
-            // Store in active notifications
-            std::lock_guard<std::mutex> activeLock(m_activeNotificationsMutex);
-            m_activeNotifications[std::make_pair(userId, fallEvent.personId)] = notification;
+        m_queuedSnapshots.emplace_back(std::make_pair(user.id, personId), snapshot);
+    }
+    
+    // The primary contact is alerted now and the other tiers only if nobody
+    // responds in time. While an earlier alert for the resident is still
+    // escalating, the new one goes to every tier that alert has reached.
+    int64_t nowMs = toEpochMs(notification.timestamp);
+    while (!m_escalations.open(user.id, personId, nowMs)) {
+        int reached = m_escalations.getTier(user.id, personId);
+        if (reached >= 0) {
+            for (int tier = 0; tier <= reached; tier++) {
+                queueTier(user, notification, static_cast<EscalationTier>(tier));
+            }
+            break;
+        }
+        // Closed in the meantime; open a new one
+    }
+}
+
+bool NotificationManager::queueTier(const User& user, const NotificationMessage& notification,
+                                    EscalationTier tier) {
+    // One send per recipient and channel; the notification thread writes
+    // them to the outbox, so callers never wait on disk
+    std::vector<OutboxEntry> sends;
+    auto addSend = [&](OutboxChannel channel, const std::string& recipient, const std::string& sendSubject,
+                       const std::string& text, bool countsAsSent) {
+        // Nothing to deliver with, e.g. email not set up
+        auto it = m_channels.find(channel);
+        if (it == m_channels.end() || !it->second) {
+            return;
         }
         
-        // Also notify family doctor if available
+        OutboxEntry entry;
+        entry.userId = notification.userId;
+        entry.personId = notification.personId;
+        entry.channel = channel;
+        entry.recipient = recipient;
+        entry.subject = sendSubject;
+        entry.message = text;
+        entry.countsAsSent = countsAsSent;
+        sends.push_back(entry);
+    };
+    
+    // Later tiers are told the alert has gone unanswered so far
+    const std::string& subject = notification.subject;
+    std::string message = notification.message;
+    if (tier != EscalationTier::PRIMARY_CONTACT) {
+        message = "No one has responded to this alert yet. " + message;
+    }
+    
+    if (tier == EscalationTier::FAMILY_DOCTOR) {
         if (!user.familyDoctor.name.empty()) {
-            NotificationMessage notification;
-            notification.userId = userId;
-            notification.personId = fallEvent.personId;
-            notification.message = message + " (Medical assistance may be required)";
-            notification.timestamp = std::chrono::system_clock::now();
-            notification.status = NotificationStatus::PENDING;
-            
-            m_notificationQueue.push(notification);
+            std::string doctorMessage = message + " (Medical assistance may be required)";
+            if (!user.familyDoctor.phone.empty()) {
+                addSend(OutboxChannel::SMS, user.familyDoctor.phone, subject, doctorMessage, false);
+            }
+            if (!user.familyDoctor.email.empty()) {
+                addSend(OutboxChannel::EMAIL, user.familyDoctor.email, "MEDICAL EMERGENCY ALERT: " + subject,
+                        doctorMessage, false);
+            }
+            logEvent(EventType::NOTIFICATION_QUEUED, notification, user.familyDoctor.name);
         }
+    } else {
+        // Emergency contacts by SMS and by email; the first is the primary
+        size_t first = tier == EscalationTier::PRIMARY_CONTACT ? 0 : 1;
+        size_t last = tier == EscalationTier::PRIMARY_CONTACT ? 1 : user.emergencyContacts.size();
+        for (size_t i = first; i < std::min(last, user.emergencyContacts.size()); i++) {
+            const auto& contact = user.emergencyContacts[i];
+            if (!contact.phone.empty()) {
+                addSend(OutboxChannel::SMS, contact.phone, subject, message, true);
+            }
+            if (!contact.email.empty()) {
+                addSend(OutboxChannel::EMAIL, contact.email, "EMERGENCY ALERT: " + subject, message, true);
+            }
+            logEvent(EventType::NOTIFICATION_QUEUED, notification, contact.name);
+        }
+    }
+    
+    if (sends.empty()) {
+        return false;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_activeNotificationsMutex);
+        for (const auto& entry : sends) {
+            if (entry.channel == OutboxChannel::SMS) {
+                m_alertsByPhone[normalizePhone(entry.recipient)].insert(
+                    std::make_pair(entry.userId, entry.personId));
+            }
+        }
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_queuedSends.insert(m_queuedSends.end(), sends.begin(), sends.end());
     }
     
     // Notify the thread that new notifications are available
     m_queueCV.notify_one();
+    return true;
+}
+
+bool NotificationManager::notifyTier(const EscalationEngine::Escalation& escalation) {
+    NotificationMessage notification;
+    {
+        std::lock_guard<std::mutex> lock(m_activeNotificationsMutex);
+        auto it = m_activeNotifications.find(std::make_pair(escalation.userId, escalation.personId));
+        if (it == m_activeNotifications.end()) {
+            return false;
+        }
+        // Answered just now; the escalation is about to be cancelled
+        if (it->second.status == NotificationStatus::RESPONDED) {
+            return true;
+        }
+        notification = it->second;
+    }
+    
+    // Contacts are read when the tier is reached, so later edits count
+    std::shared_ptr<const User> user = m_userDb->getDirectory().findUser(escalation.userId);
+    if (!user) {
+        return false;
+    }
+    
+    EscalationTier tier = static_cast<EscalationTier>(escalation.tier);
+    if (!queueTier(*user, notification, tier)) {
+        return false;
+    }
+    
+    if (tier != EscalationTier::PRIMARY_CONTACT) {
+        std::cout << "No response for user " << escalation.userId << ", person " << escalation.personId
+                  << "; escalating to " << tierToString(tier) << std::endl;
+        
+        EventRecord event;
+        event.type = EventType::ALERT_ESCALATED;
+        event.timestampMs = toEpochMs(std::chrono::system_clock::now());
+        event.trackId = escalation.personId;
+        event.userId = escalation.userId;
+        event.status = "escalated";
+        event.recipient = tierToString(tier);
+        event.subject = notification.subject;
+        logEvent(event);
+    }
+    return true;
+}
+
+void NotificationManager::escalationExhausted(const EscalationEngine::Escalation& escalation) {
+    std::cerr << "No response for user " << escalation.userId << ", person " << escalation.personId
+              << " after every escalation tier was notified" << std::endl;
+    
+    EventRecord event;
+    event.type = EventType::ALERT_ESCALATED;
+    event.timestampMs = toEpochMs(std::chrono::system_clock::now());
+    event.trackId = escalation.personId;
+    event.userId = escalation.userId;
+    event.status = "unanswered";
+    {
+        std::lock_guard<std::mutex> lock(m_activeNotificationsMutex);
+        auto it = m_activeNotifications.find(std::make_pair(escalation.userId, escalation.personId));
+        if (it != m_activeNotifications.end()) {
+            event.subject = it->second.subject;
+        }
+    }
+    logEvent(event);
+    
+    // Its sends may still be settling; the notification thread drops the
+    // alert's numbers once they have
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_closedAlerts.emplace_back(escalation.userId, escalation.personId);
+    }
+    m_queueCV.notify_one();
+}
+
+bool NotificationManager::recordResponse(int userId, int personId, const std::string& message,
+                                         const std::string& responder) {
+    NotificationMessage response;
+    {
+        std::lock_guard<std::mutex> lock(m_activeNotificationsMutex);
+        auto it = m_activeNotifications.find(std::make_pair(userId, personId));
+        if (it == m_activeNotifications.end()) {
+            return false;
+        }
+        it->second.status = NotificationStatus::RESPONDED;
+        it->second.responseMessage = message;
+        it->second.responseTimestamp = std::chrono::system_clock::now();
+        response = it->second;
+        
+        // Answered: later replies and delivery reports have nothing to match
+        releasePhones([&](const std::pair<int, int>& key) { return key == it->first; });
+    }
+    
+    m_escalations.acknowledge(userId, personId);
+    processResponse(response, responder);
+    return true;
+}
+
+void NotificationManager::releasePhones(const std::function<bool(const std::pair<int, int>&)>& released) {
+    for (auto it = m_alertsByPhone.begin(); it != m_alertsByPhone.end();) {
+        auto& keys = it->second;
+        for (auto key = keys.begin(); key != keys.end();) {
+            key = released(*key) ? keys.erase(key) : std::next(key);
+        }
+        it = keys.empty() ? m_alertsByPhone.erase(it) : std::next(it);
+    }
+}
+
+std::vector<std::pair<int, int>> NotificationManager::findAlertsByPhone(const std::string& number) {
+    // Unanswered alerts only; an answered one needs nothing more
+    std::vector<std::pair<int, int>> keys;
+    std::lock_guard<std::mutex> lock(m_activeNotificationsMutex);
+    auto it = m_alertsByPhone.find(normalizePhone(number));
+    if (it == m_alertsByPhone.end()) {
+        return keys;
+    }
+    for (const auto& key : it->second) {
+        auto active = m_activeNotifications.find(key);
+        if (active != m_activeNotifications.end() && active->second.status != NotificationStatus::RESPONDED) {
+            keys.push_back(key);
+        }
+    }
+    return keys;
+}
+
+bool NotificationManager::recordSmsReply(const std::string& fromNumber, const std::string& text) {
+    // A contact alerted for several residents answers for all of them, as
+    // their alerts may have reached them merged into one message
+    std::vector<std::pair<int, int>> keys = findAlertsByPhone(fromNumber);
+    if (keys.empty()) {
+        std::cerr << "Reply from " << fromNumber << " matches no unanswered alert" << std::endl;
+        return false;
+    }
+    
+    for (const auto& key : keys) {
+        recordResponse(key.first, key.second, text, fromNumber);
+    }
+    return true;
+}
+
+bool NotificationManager::recordDeliveryReport(const std::string& toNumber, const std::string& status,
+                                               const std::string& error) {
+    std::vector<std::pair<int, int>> keys = findAlertsByPhone(toNumber);
+    if (keys.empty()) {
+        return false;
+    }
+    
+    // Interim states ("queued", "sent", ...) add nothing to the send result
+    bool delivered = status == "delivered" || status == "read";
+    bool failed = status == "failed" || status == "undelivered";
+    if (!delivered && !failed) {
+        return true;
+    }
+    
+    for (const auto& key : keys) {
+        if (status == "read") {
+            setNotificationStatus(key, NotificationStatus::READ);
+        } else if (delivered) {
+            setNotificationStatus(key, NotificationStatus::DELIVERED);
+        }
+        
+        // A failed delivery is only recorded; the escalation moves on to
+        // the next tier if nobody else responds
+        EventRecord event;
+        event.type = delivered ? EventType::NOTIFICATION_SENT : EventType::NOTIFICATION_FAILED;
+        event.timestampMs = toEpochMs(std::chrono::system_clock::now());
+        event.trackId = key.second;
+        event.userId = key.first;
+        event.status = status;
+        event.recipient = toNumber;
+        event.detail = error;
+        logEvent(event);
+    }
+    return true;
 }
 
 bool NotificationManager::hasResponse(int userId, int personId) {
@@ -152,204 +514,429 @@ void NotificationManager::registerResponseCallback(ResponseCallback callback) {
     m_responseCallbacks.push_back(callback);
 }
 
+NotificationCoalescer::Stats NotificationManager::getDeliveryStats() const {
+    return m_coalescer.getStats();
+}
+
+void NotificationManager::setChannel(OutboxChannel kind, std::shared_ptr<NotificationChannel> channel) {
+    if (m_running) {
+        std::cerr << "Notification channels cannot change once running" << std::endl;
+        return;
+    }
+    m_channels[kind] = std::move(channel);
+}
+
+bool NotificationManager::configureChannel(OutboxChannel kind, const ChannelConfig& config) {
+    std::unique_ptr<NotificationChannel> channel =
+        createNotificationChannel(kind == OutboxChannel::EMAIL ? "email" : "sms", config, m_transport);
+    if (!channel) {
+        return false;
+    }
+    setChannel(kind, std::move(channel));
+    return true;
+}
+
+std::vector<ChannelMetrics> NotificationManager::getChannelMetrics() const {
+    std::vector<ChannelMetrics> metrics;
+    for (const auto& channel : m_channels) {
+        if (channel.second) {
+            metrics.push_back(channel.second->getMetrics());
+        }
+    }
+    return metrics;
+}
+
+void NotificationManager::setEventLog(EventLog* eventLog) {
+    m_eventLog = eventLog;
+}
+
+void NotificationManager::logEvent(EventType type, const NotificationMessage& notification,
+                                   const std::string& recipient) {
+    EventRecord event;
+    event.type = type;
+    event.timestampMs = toEpochMs(std::chrono::system_clock::now());
+    event.trackId = notification.personId;
+    event.userId = notification.userId;
+    event.recipient = recipient;
+    event.subject = notification.subject;
+    
+    // Each event moves the notification to a new status
+    switch (type) {
+        case EventType::NOTIFICATION_SENT:
+            event.status = statusToString(NotificationStatus::SENT);
+            break;
+        case EventType::NOTIFICATION_FAILED:
+            event.status = statusToString(NotificationStatus::FAILED);
+            break;
+        case EventType::RESPONSE_RECEIVED:
+            event.timestampMs = toEpochMs(notification.responseTimestamp);
+            event.status = statusToString(NotificationStatus::RESPONDED);
+            event.detail = notification.responseMessage;
+            break;
+        default:
+            event.status = statusToString(notification.status);
+            event.detail = notification.message;
+            break;
+    }
+    
+    logEvent(event);
+}
+
+void NotificationManager::logEvent(const EventRecord& event) {
+    // Enqueue only; the log writes on its own thread
+    EventLog* eventLog = m_eventLog;
+    if (eventLog && !eventLog->log(event)) {
+        std::cerr << "Event log full, dropped " << eventTypeToString(event.type) << " event" << std::endl;
+    }
+}
+
 void NotificationManager::notificationThreadFunc() {
-    while (m_running) {
-        NotificationMessage notification;
-        
-        // Wait for a notification to be available
+    // Sends claimed from the outbox and handed to the transport
+    std::map<int64_t, OutboxEntry> inFlight;
+    // Sends the outbox failed to store, kept until it takes them
+    std::vector<OutboxEntry> unstored;
+    int64_t nextDueMs = m_outbox->getNextDueMs();
+    
+    while (true) {
+        std::vector<OutboxEntry> queued;
+        std::vector<OutboxResult> results;
+        std::vector<std::pair<std::pair<int, int>, cv::Mat>> snapshots;
+        std::vector<std::pair<int, int>> closed;
         {
+            // Sleep until an alert is queued, a send completes or a retry is
+            // due; with every send slot taken, only a completion helps
             std::unique_lock<std::mutex> lock(m_queueMutex);
-            m_queueCV.wait(lock, [this] { 
-                return !m_running || !m_notificationQueue.empty(); 
-            });
-            
-            if (!m_running) {
-                break;
-            }
-            
-            if (m_notificationQueue.empty()) {
-                continue;
+            auto ready = [this] {
+                return !m_running || !m_queuedSends.empty() || !m_sendResults.empty() || !m_closedAlerts.empty();
+            };
+            if (nextDueMs < 0 || inFlight.size() >= kMaxInFlightSends) {
+                m_queueCV.wait(lock, ready);
+            } else {
+                auto due = std::chrono::system_clock::time_point(std::chrono::milliseconds(nextDueMs));
+                m_queueCV.wait_until(lock, due, ready);
             }
-            
-            notification = m_notificationQueue.front();
-            m_notificationQueue.pop();
+            queued.swap(m_queuedSends);
+            results.swap(m_sendResults);
+            snapshots.swap(m_queuedSnapshots);
+            closed.swap(m_closedAlerts);
         }
         
-        // Get user information
-        User user = m_userDb->getUserById(notification.userId);
-        if (user.id == -1) {
-            std::cerr << "User not found: " << notification.userId << std::endl;
-            continue;
+        if (!snapshots.empty()) {
+            encodeSnapshots(snapshots);
         }
         
-        bool notificationSent = false;
+        int64_t nowMs = toEpochMs(std::chrono::system_clock::now());
         
-        // Send notifications to all emergency contacts
-        for (const auto& contact : user.emergencyContacts) {
-            // Try SMS first
-            if (!contact.phone.empty()) {
-                if (sendSmsNotification(contact.phone, notification.message)) {
-                    notificationSent = true;
-                }
+        // On disk before anything is sent, even when shutting down. A failed
+        // write is tried again rather than losing an alert to it.
+        if (!unstored.empty()) {
+            queued.insert(queued.begin(), unstored.begin(), unstored.end());
+            unstored.clear();
+        }
+        if (!queued.empty()) {
+            for (auto& entry : queued) {
+                entry.nextAttemptMs = nowMs;
             }
-            
-            // Try email as backup
-            if (!contact.email.empty()) {
-                std::string subject = "EMERGENCY ALERT: Fall Detected";
-                if (sendEmailNotification(contact.email, subject, notification.message)) {
-                    notificationSent = true;
+            if (m_outbox->add(queued, nowMs)) {
+                for (const auto& entry : queued) {
+                    m_deliveries[std::make_pair(entry.userId, entry.personId)].remaining++;
                 }
+            } else {
+                std::cerr << "Failed to store " << queued.size() << " notifications in the outbox, retrying in "
+                          << kStoreRetryMs << " ms" << std::endl;
+                unstored.swap(queued);
             }
         }
         
-        // Also notify family doctor if available
-        if (!user.familyDoctor.name.empty()) {
-            if (!user.familyDoctor.phone.empty()) {
-                sendSmsNotification(user.familyDoctor.phone, notification.message);
+        if (!results.empty()) {
+            recordSendResults(results, inFlight, nowMs);
+        }
+        
+        // An alert whose escalation has run out keeps matching delivery
+        // reports until its last send has settled, and no longer
+        m_exhaustedAlerts.insert(closed.begin(), closed.end());
+        if (!m_exhaustedAlerts.empty() && (!closed.empty() || !results.empty())) {
+            std::set<std::pair<int, int>> released;
+            for (const auto& key : m_exhaustedAlerts) {
+                if (m_deliveries.count(key) == 0) {
+                    released.insert(key);
+                }
             }
-            
-            if (!user.familyDoctor.email.empty()) {
-                std::string subject = "MEDICAL EMERGENCY ALERT: Fall Detected";
-                sendEmailNotification(user.familyDoctor.email, subject, notification.message);
+            if (!released.empty()) {
+                std::lock_guard<std::mutex> lock(m_activeNotificationsMutex);
+                releasePhones([&](const std::pair<int, int>& key) {
+                    return released.count(key) > 0 && m_escalations.getTier(key.first, key.second) < 0;
+                });
+            }
+            for (const auto& key : released) {
+                m_exhaustedAlerts.erase(key);
             }
         }
         
-        // Update notification status
-        {
-            std::lock_guard<std::mutex> lock(m_activeNotificationsMutex);
-            auto it = m_activeNotifications.find(std::make_pair(notification.userId, notification.personId));
-            if (it != m_activeNotifications.end()) {
-                it->second.status = notificationSent ? NotificationStatus::SENT : NotificationStatus::FAILED;
+        // Whatever is still in flight is sent again on the next start; what
+        // never reached the outbox is lost
+        if (!m_running) {
+            for (const auto& entry : unstored) {
+                logSendEvent(EventType::NOTIFICATION_FAILED, entry, "failed", "outbox write failed");
             }
+            break;
+        }
+        
+        // Each channel gets no more than it can start at once: a send queued
+        // behind its slots would spend its lease waiting and be claimed
+        // again. A full channel waits for a completion instead.
+        nextDueMs = -1;
+        for (OutboxChannel kind : {OutboxChannel::SMS, OutboxChannel::EMAIL}) {
+            size_t room = kMaxInFlightSends - std::min(inFlight.size(), kMaxInFlightSends);
+            size_t slots = std::min(room, channelSlots(kind));
+            std::vector<OutboxEntry> due = m_outbox->claimDue(nowMs, slots, kind);
+            if (!due.empty()) {
+                dispatch(m_coalescer.plan(due, nowMs), inFlight, nowMs);
+            }
+            if (channelSlots(kind) > 0) {
+                int64_t channelDueMs = m_outbox->getNextDueMs(kind);
+                if (channelDueMs >= 0 && (nextDueMs < 0 || channelDueMs < nextDueMs)) {
+                    nextDueMs = channelDueMs;
+                }
+            }
+        }
+        if (!unstored.empty() && (nextDueMs < 0 || nowMs + kStoreRetryMs < nextDueMs)) {
+            nextDueMs = nowMs + kStoreRetryMs;
         }
     }
 }
 
-void NotificationManager::responseCheckThreadFunc() {
-    while (m_running) {
-        // Check for responses every 5 seconds
-        if (checkForResponses()) {
-            // Process any new responses
-        }
-        
-        // Sleep for 5 seconds
-        std::this_thread::sleep_for(std::chrono::seconds(5));
+size_t NotificationManager::channelSlots(OutboxChannel kind) const {
+    // Without a channel, sends fail at once and take no slot
+    auto channel = m_channels.find(kind);
+    if (channel == m_channels.end() || !channel->second) {
+        return kMaxInFlightSends;
     }
+    return channel->second->getFreeSlots();
 }
 
-bool NotificationManager::sendSmsNotification(const std::string& phoneNumber, const std::string& message) {
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        std::cerr << "Failed to initialize CURL for SMS" << std::endl;
-        return false;
+void NotificationManager::dispatch(const NotificationCoalescer::Plan& plan,
+                                   std::map<int64_t, OutboxEntry>& inFlight, int64_t nowMs) {
+    for (const auto& send : plan.sends) {
+        for (const auto& part : send.parts) {
+            inFlight[part.id] = part;
+        }
+        sendMessage(send);
     }
     
-    // This is a placeholder for a real SMS API integration
-    // In a real implementation, you would integrate with Twilio, Nexmo, or another SMS service
-    
-    std::string url = "https://api.example.com/sms";
-    std::string postFields = "apikey=" + m_smsApiKey + 
-                            "&to=" + phoneNumber + 
-                            "&message=" + curl_easy_escape(curl, message.c_str(), 0);
-    
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postFields.c_str());
-    
-    std::string response;
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-    
-    CURLcode res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
-    
-    if (res != CURLE_OK) {
-        std::cerr << "SMS send failed: " << curl_easy_strerror(res) << std::endl;
-        return false;
+    // Rate limited: back in the outbox until a token is free
+    if (!m_outbox->reschedule(plan.deferred)) {
+        std::cerr << "Failed to defer rate-limited notifications; they are retried when their lease ends"
+                  << std::endl;
     }
     
-    // In a real implementation, parse the response to confirm delivery
-    std::cout << "SMS notification sent to " << phoneNumber << std::endl;
-    return true;
+    settleDuplicates(plan.suppressed, nowMs);
 }
 
-bool NotificationManager::sendEmailNotification(const std::string& email, const std::string& subject, const std::string& message) {
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        std::cerr << "Failed to initialize CURL for email" << std::endl;
-        return false;
+void NotificationManager::settleDuplicates(const std::vector<OutboxEntry>& duplicates, int64_t nowMs) {
+    // Duplicates count as delivered along with the message they repeat
+    if (duplicates.empty()) {
+        return;
+    }
+    std::vector<OutboxResult> results;
+    for (const auto& entry : duplicates) {
+        results.push_back({entry.id, entry.attempts, true, ""});
+    }
+    std::vector<OutboxOutcome> outcomes = m_outbox->recordResults(results, nowMs);
+    for (size_t i = 0; i < outcomes.size(); i++) {
+        settleSend(duplicates[i], outcomes[i], "", "suppressed");
+    }
+}
+
+void NotificationManager::sendMessage(const NotificationCoalescer::Send& send) {
+    // One transport result settles every alert merged into the message
+    std::vector<std::pair<int64_t, int>> parts;
+    for (const auto& part : send.parts) {
+        parts.emplace_back(part.id, part.attempts);
+    }
+    auto done = [this, parts](const TransportResult& result) {
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            for (const auto& part : parts) {
+                m_sendResults.push_back({part.first, part.second, result.success, result.error});
+            }
+        }
+        m_queueCV.notify_one();
+    };
+    
+    const OutboxEntry& message = send.message;
+    auto channel = m_channels.find(message.channel);
+    if (channel == m_channels.end() || !channel->second) {
+        TransportResult result;
+        result.error = "no channel for this kind of address";
+        done(result);
+        return;
     }
     
-    // This is a placeholder for a real email API integration
-    // In a real implementation, you would use libcurl to connect to an SMTP server
-    
-    struct curl_slist* recipients = NULL;
-    recipients = curl_slist_append(recipients, email.c_str());
-    
-    std::string emailContent = "To: " + email + "\r\n"
-                             + "From: " + m_emailUsername + "\r\n"
-                             + "Subject: " + subject + "\r\n"
-                             + "\r\n"
-                             + message;
-    
-    curl_easy_setopt(curl, CURLOPT_URL, m_emailSmtpServer.c_str());
-    curl_easy_setopt(curl, CURLOPT_MAIL_FROM, m_emailUsername.c_str());
-    curl_easy_setopt(curl, CURLOPT_MAIL_RCPT, recipients);
-    curl_easy_setopt(curl, CURLOPT_READDATA, emailContent.c_str());
-    curl_easy_setopt(curl, CURLOPT_USERNAME, m_emailUsername.c_str());
-    curl_easy_setopt(curl, CURLOPT_PASSWORD, m_emailPassword.c_str());
-    curl_easy_setopt(curl, CURLOPT_USE_SSL, CURLUSESSL_ALL);
-    
-    CURLcode res = curl_easy_perform(curl);
-    curl_slist_free_all(recipients);
-    curl_easy_cleanup(curl);
+    ChannelMessage channelMessage{message.recipient, message.subject, message.message, {}};
     
-    if (res != CURLE_OK) {
-        std::cerr << "Email send failed: " << curl_easy_strerror(res) << std::endl;
-        return false;
+    // Emails carry the snapshot of each alert merged into them
+    if (message.channel == OutboxChannel::EMAIL) {
+        for (const auto& part : send.parts) {
+            auto attachment = m_attachments.find(std::make_pair(part.userId, part.personId));
+            if (attachment != m_attachments.end() &&
+                std::find(channelMessage.attachments.begin(), channelMessage.attachments.end(),
+                          attachment->second) == channelMessage.attachments.end()) {
+                channelMessage.attachments.push_back(attachment->second);
+            }
+        }
     }
-    
-    std::cout << "Email notification sent to " << email << std::endl;
-    return true;
+    channel->second->send(channelMessage, done);
 }
 
-bool NotificationManager::checkForResponses() {
-    // In a real implementation, this would check an API endpoint or SMS/Email inbox
-    // For this example, we'll simulate responses randomly
-    
-    std::lock_guard<std::mutex> lock(m_activeNotificationsMutex);
+void NotificationManager::encodeSnapshots(std::vector<std::pair<std::pair<int, int>, cv::Mat>>& snapshots) {
+    // Snapshots of alerts that are over are dropped as new ones arrive
+    for (auto it = m_attachments.begin(); it != m_attachments.end();) {
+        bool sending = m_deliveries.count(it->first) > 0;
+        if (!sending && m_escalations.getTier(it->first.first, it->first.second) < 0) {
+            it = m_attachments.erase(it);
+        } else {
+            ++it;
+        }
+    }
     
-    bool newResponseFound = false;
+    // Falls reported for every resident share one frame; it is encoded once
+    std::shared_ptr<const MessageAttachment> previous;
+    const unsigned char* previousData = nullptr;
+    for (auto& snapshot : snapshots) {
+        const auto& key = snapshot.first;
+        if (!previous || snapshot.second.data != previousData) {
+            previous = m_snapshotEncoder.encode(snapshot.second, "snapshot_" + std::to_string(key.second) + ".jpg");
+            previousData = snapshot.second.data;
+        }
+        if (previous) {
+            m_attachments[key] = previous;
+        } else {
+            m_attachments.erase(key);
+        }
+    }
+}
+
+void NotificationManager::recordSendResults(const std::vector<OutboxResult>& results,
+                                            std::map<int64_t, OutboxEntry>& inFlight, int64_t nowMs) {
+    std::vector<OutboxOutcome> outcomes = m_outbox->recordResults(results, nowMs);
+    if (outcomes.size() != results.size()) {
+        // Not recorded; the leases run out and the sends are retried
+        std::cerr << "Failed to record notification results in the outbox" << std::endl;
+        for (const auto& result : results) {
+            auto it = inFlight.find(result.id);
+            if (it != inFlight.end()) {
+                m_coalescer.complete(it->second, false);
+                inFlight.erase(it);
+            }
+        }
+        return;
+    }
     
-    for (auto& pair : m_activeNotifications) {
-        auto& notification = pair.second;
+    for (size_t i = 0; i < results.size(); i++) {
+        auto it = inFlight.find(results[i].id);
+        if (it == inFlight.end()) {
+            continue;
+        }
+        OutboxEntry entry = it->second;
+        inFlight.erase(it);
+        settleSend(entry, outcomes[i], results[i].error, "sent");
         
-        // Only check notifications that have been sent but not responded to
-        if (notification.status == NotificationStatus::SENT || 
-            notification.status == NotificationStatus::DELIVERED || 
-            notification.status == NotificationStatus::READ) {
-            
-            // Simulate a 10% chance of receiving a response
-            static std::random_device rd;
-            static std::mt19937 gen(rd());
-            static std::uniform_real_distribution<> dis(0.0, 1.0);
-            
-            if (dis(gen) < 0.1) {  // 10% chance
-                notification.status = NotificationStatus::RESPONDED;
-                notification.responseMessage = "I'm on my way to help. ETA 10 minutes.";
-                notification.responseTimestamp = std::chrono::system_clock::now();
-                
-                newResponseFound = true;
-                
-                // Process the response
-                processResponse(notification);
+        // Repeats held for this send are delivered with it, or go out in
+        // its place now that it has failed
+        std::vector<OutboxEntry> held = m_coalescer.complete(entry, results[i].success);
+        if (results[i].success) {
+            settleDuplicates(held, nowMs);
+        } else if (!held.empty()) {
+            for (auto& repeat : held) {
+                repeat.nextAttemptMs = nowMs;
+            }
+            if (!m_outbox->reschedule(held)) {
+                std::cerr << "Failed to requeue held duplicates; they are retried when their lease ends"
+                          << std::endl;
             }
         }
     }
+}
+
+void NotificationManager::settleSend(const OutboxEntry& entry, OutboxOutcome outcome, const std::string& error,
+                                     const std::string& sentStatus) {
+    switch (outcome) {
+        case OutboxOutcome::SENT:
+            std::cout << "Notification " << sentStatus << " to " << entry.recipient << std::endl;
+            logSendEvent(EventType::NOTIFICATION_SENT, entry, sentStatus, "");
+            break;
+        case OutboxOutcome::RETRY:
+            std::cerr << "Notification to " << entry.recipient << " failed, will retry: " << error << std::endl;
+            logSendEvent(EventType::NOTIFICATION_FAILED, entry, "retrying", error);
+            return;
+        case OutboxOutcome::GAVE_UP:
+            std::cerr << "Notification to " << entry.recipient << " failed after "
+                      << entry.attempts + 1 << " attempts: " << error << std::endl;
+            logSendEvent(EventType::NOTIFICATION_FAILED, entry, "failed", error);
+            break;
+    }
     
-    return newResponseFound;
+    // Settle the alert: SENT on the first contact reached, FAILED once
+    // every send of a tier has finished without reaching one, unless an
+    // earlier tier did. Sends replayed from an earlier run have no alert
+    // to settle.
+    auto key = std::make_pair(entry.userId, entry.personId);
+    auto delivery = m_deliveries.find(key);
+    if (delivery == m_deliveries.end()) {
+        return;
+    }
+    if (outcome == OutboxOutcome::SENT && entry.countsAsSent) {
+        delivery->second.anySent = true;
+        setNotificationStatus(key, NotificationStatus::SENT);
+    }
+    if (--delivery->second.remaining == 0) {
+        if (!delivery->second.anySent) {
+            setNotificationStatus(key, NotificationStatus::FAILED);
+        }
+        m_deliveries.erase(delivery);
+    }
+}
+
+void NotificationManager::setNotificationStatus(const std::pair<int, int>& key, NotificationStatus status) {
+    std::lock_guard<std::mutex> lock(m_activeNotificationsMutex);
+    auto it = m_activeNotifications.find(key);
+    if (it == m_activeNotifications.end() || it->second.status == NotificationStatus::RESPONDED) {
+        return;
+    }
+    
+    // Sent, delivered and read only move forward, as provider reports can
+    // arrive before the send result. A tier that reached nobody, such as
+    // the doctor's, whose sends never count, cannot undo an earlier tier
+    // that did; a later tier may still succeed after a failure.
+    NotificationStatus current = it->second.status;
+    if (status == NotificationStatus::FAILED) {
+        if (current != NotificationStatus::PENDING && current != NotificationStatus::FAILED) {
+            return;
+        }
+    } else if (current != NotificationStatus::FAILED && status <= current) {
+        return;
+    }
+    it->second.status = status;
 }
 
-void NotificationManager::processResponse(const NotificationMessage& response) {
+void NotificationManager::logSendEvent(EventType type, const OutboxEntry& entry, const std::string& status,
+                                       const std::string& detail) {
+    EventRecord event;
+    event.type = type;
+    event.timestampMs = toEpochMs(std::chrono::system_clock::now());
+    event.trackId = entry.personId;
+    event.userId = entry.userId;
+    event.status = status;
+    event.recipient = entry.recipient;
+    event.subject = entry.subject;
+    event.detail = detail;
+    logEvent(event);
+}
+
+void NotificationManager::processResponse(const NotificationMessage& response, const std::string& responder) {
+    logEvent(EventType::RESPONSE_RECEIVED, response, responder);
+    
     // Call all registered callbacks
     std::lock_guard<std::mutex> lock(m_callbackMutex);
     for (const auto& callback : m_responseCallbacks) {
@@ -0,0 +1,371 @@
+#include "network/notification_transport.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+namespace hms {
+
+NotificationTransport::NotificationTransport()
+    : NotificationTransport(Options()) {
+}
+
+NotificationTransport::NotificationTransport(const Options& options)
+    : m_options(options), m_share(nullptr), m_running(false),
+      m_outstanding(0), m_inFlight(0), m_completedCount(0) {
+}
+
+NotificationTransport::~NotificationTransport() {
+    stop();
+}
+
+bool NotificationTransport::start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running) {
+        return true;
+    }
+    
+    // DNS results and TLS sessions are shared by every worker, so the share
+    // handle needs locking; connections stay in each worker's multi handle
+    m_share = curl_share_init();
+    if (!m_share) {
+        std::cerr << "Failed to initialize CURL for notifications" << std::endl;
+        return false;
+    }
+    curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, lockShare);
+    curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, unlockShare);
+    curl_share_setopt(m_share, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    
+    int workerCount = std::max(1, m_options.workerCount);
+    for (int i = 0; i < workerCount; i++) {
+        auto worker = std::make_unique<Worker>();
+        worker->multi = curl_multi_init();
+        if (!worker->multi) {
+            std::cerr << "Failed to initialize CURL for notifications" << std::endl;
+            for (auto& created : m_workers) {
+                curl_multi_cleanup(created->multi);
+            }
+            m_workers.clear();
+            curl_share_cleanup(m_share);
+            m_share = nullptr;
+            return false;
+        }
+        curl_multi_setopt(worker->multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, m_options.maxConnections);
+        curl_multi_setopt(worker->multi, CURLMOPT_MAX_HOST_CONNECTIONS, m_options.maxConnectionsPerHost);
+        curl_multi_setopt(worker->multi, CURLMOPT_MAXCONNECTS, m_options.maxConnections);
+        m_workers.push_back(std::move(worker));
+    }
+    
+    m_running = true;
+    for (auto& worker : m_workers) {
+        worker->thread = std::thread(&NotificationTransport::workerThreadFunc, this, worker.get());
+    }
+    return true;
+}
+
+void NotificationTransport::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+        for (auto& worker : m_workers) {
+            curl_multi_wakeup(worker->multi);
+        }
+    }
+    
+    for (auto& worker : m_workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+        curl_multi_cleanup(worker->multi);
+    }
+    m_workers.clear();
+    
+    curl_share_cleanup(m_share);
+    m_share = nullptr;
+}
+
+void NotificationTransport::postForm(const std::string& url, const std::string& fields, Callback callback,
+                                     long timeoutMs) {
+    Request* request = new Request();
+    request->url = url;
+    request->body = fields;
+    request->timeoutMs = timeoutMs;
+    request->callback = std::move(callback);
+    submit(request);
+}
+
+void NotificationTransport::post(const std::string& url, const std::vector<std::string>& headers,
+                                 const std::string& body, const std::string& username,
+                                 const std::string& password, Callback callback, long timeoutMs) {
+    Request* request = new Request();
+    request->url = url;
+    request->headers = headers;
+    request->body = body;
+    request->username = username;
+    request->password = password;
+    request->timeoutMs = timeoutMs;
+    request->callback = std::move(callback);
+    submit(request);
+}
+
+void NotificationTransport::sendMail(const std::string& smtpUrl, const std::string& username,
+                                     const std::string& password, const std::string& from,
+                                     const std::string& to, std::string payload,
+                                     Callback callback, long timeoutMs) {
+    Request* request = new Request();
+    request->isMail = true;
+    request->url = smtpUrl;
+    request->body = std::move(payload);
+    request->username = username;
+    request->password = password;
+    request->mailFrom = from;
+    request->mailTo = to;
+    request->timeoutMs = timeoutMs;
+    request->callback = std::move(callback);
+    submit(request);
+}
+
+void NotificationTransport::submit(Request* request) {
+    request->submitted = std::chrono::steady_clock::now();
+    
+    {
+        // Wake the worker under the lock so stop() cannot free its multi handle first
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_running) {
+            // The least loaded worker, so one stalled on a slow mail server
+            // does not collect a backlog
+            Worker* target = m_workers.front().get();
+            for (auto& worker : m_workers) {
+                if (worker->outstanding < target->outstanding) {
+                    target = worker.get();
+                }
+            }
+            target->pending.push_back(request);
+            target->outstanding++;
+            m_outstanding++;
+            curl_multi_wakeup(target->multi);
+            return;
+        }
+    }
+    
+    TransportResult result;
+    result.error = "transport not running";
+    if (request->callback) {
+        request->callback(result);
+    }
+    delete request;
+}
+
+void NotificationTransport::waitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idleCondition.wait(lock, [this] { return m_outstanding == 0; });
+}
+
+size_t NotificationTransport::getInFlightCount() const {
+    return m_inFlight;
+}
+
+uint64_t NotificationTransport::getCompletedCount() const {
+    return m_completedCount;
+}
+
+void NotificationTransport::workerThreadFunc(Worker* worker) {
+    while (true) {
+        std::deque<Request*> pending;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            pending.swap(worker->pending);
+        }
+        for (Request* request : pending) {
+            startTransfer(*worker, request);
+        }
+        
+        if (!m_running) {
+            break;
+        }
+        
+        int stillRunning = 0;
+        curl_multi_perform(worker->multi, &stillRunning);
+        
+        CURLMsg* message;
+        int messagesLeft;
+        while ((message = curl_multi_info_read(worker->multi, &messagesLeft))) {
+            if (message->msg != CURLMSG_DONE) {
+                continue;
+            }
+            Request* request = nullptr;
+            curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &request);
+            finishTransfer(*worker, request, message->data.result);
+        }
+        
+        // Sleeps until a socket is ready, a timeout is due or submit() wakes us
+        curl_multi_poll(worker->multi, nullptr, 0, 1000, nullptr);
+    }
+    
+    // Stopped: fail whatever is left. Nothing can be queued any more, as
+    // submit() checks m_running under the same lock.
+    TransportResult stopped;
+    stopped.error = "transport stopped";
+    
+    while (!worker->active.empty()) {
+        Request* request = worker->active.back();
+        worker->active.pop_back();
+        curl_multi_remove_handle(worker->multi, request->easy);
+        curl_easy_cleanup(request->easy);
+        curl_slist_free_all(request->list);
+        m_inFlight--;
+        complete(worker, request, stopped);
+    }
+    
+    std::deque<Request*> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        pending.swap(worker->pending);
+    }
+    for (Request* request : pending) {
+        complete(worker, request, stopped);
+    }
+    
+    for (CURL* easy : worker->idleHandles) {
+        curl_easy_cleanup(easy);
+    }
+    worker->idleHandles.clear();
+}
+
+void NotificationTransport::startTransfer(Worker& worker, Request* request) {
+    // Handles are reused; their settings are reset but allocations are kept
+    CURL* easy;
+    if (!worker.idleHandles.empty()) {
+        easy = worker.idleHandles.back();
+        worker.idleHandles.pop_back();
+        curl_easy_reset(easy);
+    } else {
+        easy = curl_easy_init();
+    }
+    if (!easy) {
+        TransportResult result;
+        result.error = "failed to create a CURL handle";
+        complete(&worker, request, result);
+        return;
+    }
+    request->easy = easy;
+    
+    long timeoutMs = request->timeoutMs > 0 ? request->timeoutMs : m_options.requestTimeoutMs;
+    curl_easy_setopt(easy, CURLOPT_URL, request->url.c_str());
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, request);
+    curl_easy_setopt(easy, CURLOPT_SHARE, m_share);
+    curl_easy_setopt(easy, CURLOPT_ERRORBUFFER, request->errorBuffer);
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, m_options.connectTimeoutMs);
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, timeoutMs);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, writeCallback);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, request);
+    
+    if (request->isMail) {
+        request->list = curl_slist_append(nullptr, request->mailTo.c_str());
+        curl_easy_setopt(easy, CURLOPT_MAIL_FROM, request->mailFrom.c_str());
+        curl_easy_setopt(easy, CURLOPT_MAIL_RCPT, request->list);
+        curl_easy_setopt(easy, CURLOPT_READFUNCTION, readCallback);
+        curl_easy_setopt(easy, CURLOPT_READDATA, request);
+        curl_easy_setopt(easy, CURLOPT_UPLOAD, 1L);
+        curl_easy_setopt(easy, CURLOPT_USE_SSL, m_options.requireTls ? CURLUSESSL_ALL : CURLUSESSL_TRY);
+        if (!request->username.empty()) {
+            curl_easy_setopt(easy, CURLOPT_USERNAME, request->username.c_str());
+            curl_easy_setopt(easy, CURLOPT_PASSWORD, request->password.c_str());
+        }
+    } else {
+        for (const auto& header : request->headers) {
+            request->list = curl_slist_append(request->list, header.c_str());
+        }
+        curl_easy_setopt(easy, CURLOPT_HTTPHEADER, request->list);
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDS, request->body.c_str());
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE, static_cast<long>(request->body.size()));
+        if (!request->username.empty()) {
+            curl_easy_setopt(easy, CURLOPT_HTTPAUTH, CURLAUTH_BASIC);
+            curl_easy_setopt(easy, CURLOPT_USERNAME, request->username.c_str());
+            curl_easy_setopt(easy, CURLOPT_PASSWORD, request->password.c_str());
+        }
+    }
+    
+    CURLMcode rc = curl_multi_add_handle(worker.multi, easy);
+    if (rc != CURLM_OK) {
+        TransportResult result;
+        result.error = curl_multi_strerror(rc);
+        curl_slist_free_all(request->list);
+        worker.idleHandles.push_back(easy);
+        complete(&worker, request, result);
+        return;
+    }
+    
+    worker.active.push_back(request);
+    m_inFlight++;
+}
+
+void NotificationTransport::finishTransfer(Worker& worker, Request* request, CURLcode code) {
+    TransportResult result;
+    curl_easy_getinfo(request->easy, CURLINFO_RESPONSE_CODE, &result.responseCode);
+    
+    if (code != CURLE_OK) {
+        result.error = request->errorBuffer[0] ? request->errorBuffer : curl_easy_strerror(code);
+    } else if (!request->isMail && (result.responseCode < 200 || result.responseCode >= 300)) {
+        result.error = "HTTP status " + std::to_string(result.responseCode);
+    } else {
+        result.success = true;
+    }
+    
+    curl_multi_remove_handle(worker.multi, request->easy);
+    curl_slist_free_all(request->list);
+    request->list = nullptr;
+    worker.idleHandles.push_back(request->easy);
+    
+    worker.active.erase(std::find(worker.active.begin(), worker.active.end(), request));
+    m_inFlight--;
+    complete(&worker, request, result);
+}
+
+void NotificationTransport::complete(Worker* worker, Request* request, const TransportResult& result) {
+    TransportResult timed = result;
+    timed.elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - request->submitted).count();
+    
+    if (request->callback) {
+        request->callback(timed);
+    }
+    delete request;
+    m_completedCount++;
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        worker->outstanding--;
+        m_outstanding--;
+    }
+    m_idleCondition.notify_all();
+}
+
+void NotificationTransport::lockShare(CURL*, curl_lock_data data, curl_lock_access, void* userptr) {
+    static_cast<NotificationTransport*>(userptr)->m_shareLocks[data].lock();
+}
+
+void NotificationTransport::unlockShare(CURL*, curl_lock_data data, void* userptr) {
+    static_cast<NotificationTransport*>(userptr)->m_shareLocks[data].unlock();
+}
+
+size_t NotificationTransport::writeCallback(char* data, size_t size, size_t count, void* userdata) {
+    Request* request = static_cast<Request*>(userdata);
+    request->response.append(data, size * count);
+    return size * count;
+}
+
+size_t NotificationTransport::readCallback(char* buffer, size_t size, size_t count, void* userdata) {
+    Request* request = static_cast<Request*>(userdata);
+    size_t length = std::min(size * count, request->body.size() - request->bodyOffset);
+    std::memcpy(buffer, request->body.data() + request->bodyOffset, length);
+    request->bodyOffset += length;
+    return length;
+}
+
+} // namespace hms
@@ -0,0 +1,346 @@
+#include "network/response_webhook.hpp"
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <algorithm>
+#include <cctype>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <nlohmann/json.hpp>
+
+namespace hms {
+
+namespace beast = boost::beast;
+namespace http = boost::beast::http;
+using boost::asio::ip::tcp;
+
+// A client that stops mid-request is dropped after this long
+static const int kRequestTimeoutSeconds = 10;
+
+static std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+static std::string urlDecode(const std::string& value) {
+    std::string decoded;
+    for (size_t i = 0; i < value.size(); i++) {
+        if (value[i] == '+') {
+            decoded += ' ';
+        } else if (value[i] == '%' && i + 2 < value.size() &&
+                   std::isxdigit(static_cast<unsigned char>(value[i + 1])) &&
+                   std::isxdigit(static_cast<unsigned char>(value[i + 2]))) {
+            decoded += static_cast<char>(std::stoi(value.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else {
+            decoded += value[i];
+        }
+    }
+    return decoded;
+}
+
+// name=value pairs joined by '&'; names are lower-cased
+static std::map<std::string, std::string> parseForm(const std::string& text) {
+    std::map<std::string, std::string> fields;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find('&', start);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        std::string pair = text.substr(start, end - start);
+        size_t equals = pair.find('=');
+        if (!pair.empty()) {
+            std::string name = urlDecode(pair.substr(0, equals));
+            std::string value = equals == std::string::npos ? "" : urlDecode(pair.substr(equals + 1));
+            fields[toLower(name)] = value;
+        }
+        start = end + 1;
+    }
+    return fields;
+}
+
+// A flat JSON object; false when the body is not one
+static bool parseJson(const std::string& text, std::map<std::string, std::string>& fields) {
+    nlohmann::json json = nlohmann::json::parse(text, nullptr, false);
+    if (json.is_discarded() || !json.is_object()) {
+        return false;
+    }
+    for (auto it = json.begin(); it != json.end(); ++it) {
+        if (it->is_string()) {
+            fields[toLower(it.key())] = it->get<std::string>();
+        } else if (it->is_number()) {
+            fields[toLower(it.key())] = it->dump();
+        }
+    }
+    return true;
+}
+
+// The first of names present in fields, or empty
+static std::string field(const std::map<std::string, std::string>& fields, std::initializer_list<const char*> names) {
+    for (const char* name : names) {
+        auto it = fields.find(name);
+        if (it != fields.end()) {
+            return it->second;
+        }
+    }
+    return "";
+}
+
+// Compares without stopping at the first difference, so timing does not
+// reveal how much of a guessed token was right
+static bool tokensMatch(const std::string& expected, const std::string& given) {
+    if (expected.size() != given.size()) {
+        return false;
+    }
+    unsigned char difference = 0;
+    for (size_t i = 0; i < expected.size(); i++) {
+        difference |= static_cast<unsigned char>(expected[i] ^ given[i]);
+    }
+    return difference == 0;
+}
+
+static std::string toString(beast::string_view view) {
+    return std::string(view.data(), view.size());
+}
+
+// One client connection; reads requests until the client closes it or
+// stops asking for keep-alive
+class ResponseWebhook::Session : public std::enable_shared_from_this<Session> {
+public:
+    Session(tcp::socket socket, ResponseWebhook& webhook)
+        : m_stream(std::move(socket)), m_webhook(webhook) {
+    }
+    
+    void read() {
+        m_parser.emplace();
+        m_parser->body_limit(m_webhook.m_options.maxBodyBytes);
+        m_stream.expires_after(std::chrono::seconds(kRequestTimeoutSeconds));
+        http::async_read(m_stream, m_buffer, *m_parser,
+                         [self = shared_from_this()](beast::error_code ec, size_t) { self->onRead(ec); });
+    }
+    
+private:
+    beast::tcp_stream m_stream;
+    beast::flat_buffer m_buffer;
+    std::optional<http::request_parser<http::string_body>> m_parser;
+    http::response<http::string_body> m_response;
+    ResponseWebhook& m_webhook;
+    
+    void onRead(beast::error_code ec) {
+        if (ec == http::error::end_of_stream) {
+            close();
+            return;
+        }
+        if (ec == http::error::body_limit) {
+            m_webhook.m_rejected++;
+            respond(413, false);
+            return;
+        }
+        if (ec) {
+            // Timed out or reset; the connection closes with the session
+            return;
+        }
+        
+        const auto& request = m_parser->get();
+        int status = m_webhook.handleRequest(toString(request.method_string()), toString(request.target()),
+                                             toString(request[http::field::content_type]),
+                                             toString(request["X-Webhook-Token"]), request.body());
+        respond(status, request.keep_alive());
+    }
+    
+    void respond(int status, bool keepAlive) {
+        m_response = {};
+        m_response.version(11);
+        m_response.result(static_cast<http::status>(status));
+        m_response.set(http::field::content_type, "text/plain");
+        m_response.body() = toString(http::obsolete_reason(m_response.result())) + "\n";
+        m_response.keep_alive(keepAlive);
+        m_response.prepare_payload();
+        
+        http::async_write(m_stream, m_response,
+                          [self = shared_from_this(), keepAlive](beast::error_code ec, size_t) {
+                              if (ec) {
+                                  return;
+                              }
+                              if (keepAlive) {
+                                  self->read();
+                              } else {
+                                  self->close();
+                              }
+                          });
+    }
+    
+    void close() {
+        beast::error_code ec;
+        m_stream.socket().shutdown(tcp::socket::shutdown_send, ec);
+    }
+};
+
+ResponseWebhook::ResponseWebhook(ReplyHandler onReply, StatusHandler onStatus)
+    : ResponseWebhook(Options(), std::move(onReply), std::move(onStatus)) {
+}
+
+ResponseWebhook::ResponseWebhook(const Options& options, ReplyHandler onReply, StatusHandler onStatus)
+    : m_options(options), m_onReply(std::move(onReply)), m_onStatus(std::move(onStatus)),
+      m_acceptor(m_io), m_running(false), m_port(0), m_replies(0), m_statusReports(0), m_rejected(0) {
+}
+
+ResponseWebhook::~ResponseWebhook() {
+    stop();
+}
+
+bool ResponseWebhook::start() {
+    if (m_running) {
+        return true;
+    }
+    
+    boost::system::error_code ec;
+    boost::asio::ip::address address = boost::asio::ip::make_address(m_options.address, ec);
+    if (ec) {
+        std::cerr << "Invalid response webhook address " << m_options.address << ": " << ec.message() << std::endl;
+        return false;
+    }
+    
+    // Without a token, whoever can reach the port can answer alerts and
+    // stop their escalation; only the local machine may do that
+    if (m_options.token.empty() && !address.is_loopback()) {
+        std::cerr << "Response webhook on " << m_options.address
+                  << " needs a token; set one, or listen on a loopback address" << std::endl;
+        return false;
+    }
+    
+    tcp::endpoint endpoint(address, m_options.port);
+    m_acceptor.open(endpoint.protocol(), ec);
+    if (!ec) {
+        m_acceptor.set_option(boost::asio::socket_base::reuse_address(true), ec);
+    }
+    if (!ec) {
+        m_acceptor.bind(endpoint, ec);
+    }
+    if (!ec) {
+        m_acceptor.listen(boost::asio::socket_base::max_listen_connections, ec);
+    }
+    if (ec) {
+        std::cerr << "Response webhook failed to listen on " << m_options.address << ":" << m_options.port
+                  << ": " << ec.message() << std::endl;
+        m_acceptor.close(ec);
+        return false;
+    }
+    m_port = m_acceptor.local_endpoint().port();
+    
+    accept();
+    m_running = true;
+    m_thread = std::thread([this] { m_io.run(); });
+    
+    std::cout << "Listening for SMS replies on " << m_options.address << ":" << m_port << std::endl;
+    return true;
+}
+
+void ResponseWebhook::stop() {
+    if (!m_running) {
+        return;
+    }
+    m_running = false;
+    
+    // Open connections are dropped; providers retry callbacks that fail
+    m_io.stop();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    
+    boost::system::error_code ec;
+    m_acceptor.close(ec);
+}
+
+unsigned short ResponseWebhook::getPort() const {
+    return m_port;
+}
+
+ResponseWebhook::Stats ResponseWebhook::getStats() const {
+    Stats stats;
+    stats.replies = m_replies;
+    stats.statusReports = m_statusReports;
+    stats.rejected = m_rejected;
+    return stats;
+}
+
+void ResponseWebhook::accept() {
+    m_acceptor.async_accept([this](beast::error_code ec, tcp::socket socket) {
+        if (ec) {
+            if (ec != boost::asio::error::operation_aborted) {
+                std::cerr << "Response webhook accept failed: " << ec.message() << std::endl;
+                accept();
+            }
+            return;
+        }
+        std::make_shared<Session>(std::move(socket), *this)->read();
+        accept();
+    });
+}
+
+int ResponseWebhook::handleRequest(const std::string& method, const std::string& target,
+                                   const std::string& contentType, const std::string& tokenHeader,
+                                   const std::string& body) {
+    size_t query = target.find('?');
+    std::string path = target.substr(0, query);
+    std::map<std::string, std::string> params;
+    if (query != std::string::npos) {
+        params = parseForm(target.substr(query + 1));
+    }
+    
+    int status = 200;
+    if (path != "/sms/reply" && path != "/sms/status") {
+        status = 404;
+    } else if (method != "POST") {
+        status = 405;
+    } else if (!m_options.token.empty() &&
+               !tokensMatch(m_options.token, tokenHeader.empty() ? field(params, {"token"}) : tokenHeader)) {
+        status = 401;
+    }
+    if (status != 200) {
+        m_rejected++;
+        return status;
+    }
+    
+    std::map<std::string, std::string> fields;
+    if (toLower(contentType).find("json") != std::string::npos) {
+        if (!parseJson(body, fields)) {
+            m_rejected++;
+            return 400;
+        }
+    } else {
+        fields = parseForm(body);
+    }
+    
+    if (path == "/sms/reply") {
+        SmsReply reply;
+        reply.from = field(fields, {"from"});
+        reply.to = field(fields, {"to"});
+        reply.text = field(fields, {"body", "text", "message"});
+        reply.messageId = field(fields, {"messagesid", "message_id", "id"});
+        if (reply.from.empty()) {
+            m_rejected++;
+            return 400;
+        }
+        m_replies++;
+        m_onReply(reply);
+    } else {
+        SmsStatusReport report;
+        report.to = field(fields, {"to"});
+        report.status = toLower(field(fields, {"messagestatus", "status"}));
+        report.messageId = field(fields, {"messagesid", "message_id", "id"});
+        report.error = field(fields, {"errorcode", "error"});
+        if (report.to.empty() || report.status.empty()) {
+            m_rejected++;
+            return 400;
+        }
+        m_statusReports++;
+        m_onStatus(report);
+    }
+    return 200;
+}
+
+} // namespace hms
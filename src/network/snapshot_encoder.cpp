@@ -0,0 +1,72 @@
+#include "network/snapshot_encoder.hpp"
+#include <iostream>
+#include <algorithm>
+
+namespace hms {
+
+// Each retry lowers the quality by this much, down to minQuality
+static const int kQualityStep = 15;
+// Smallest side worth sending
+static const int kMinDimension = 32;
+
+SnapshotEncoder::SnapshotEncoder()
+    : SnapshotEncoder(Options()) {
+}
+
+SnapshotEncoder::SnapshotEncoder(const Options& options)
+    : m_options(options) {
+}
+
+const SnapshotEncoder::Options& SnapshotEncoder::getOptions() const {
+    return m_options;
+}
+
+bool SnapshotEncoder::encodeJpeg(const cv::Mat& image, int quality, std::vector<unsigned char>& jpeg) const {
+    std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, quality};
+    try {
+        return cv::imencode(".jpg", image, jpeg, params);
+    } catch (const cv::Exception& e) {
+        std::cerr << "Failed to encode snapshot: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+std::shared_ptr<const MessageAttachment> SnapshotEncoder::encode(const cv::Mat& image,
+                                                                 const std::string& filename) const {
+    if (image.empty()) {
+        return nullptr;
+    }
+    
+    // Shrinking first is far cheaper than encoding the full frame
+    cv::Mat scaled = image;
+    int longest = std::max(image.cols, image.rows);
+    if (m_options.maxDimension > 0 && longest > m_options.maxDimension) {
+        double scale = static_cast<double>(m_options.maxDimension) / longest;
+        cv::resize(image, scaled, cv::Size(), scale, scale, cv::INTER_AREA);
+    }
+    
+    auto attachment = std::make_shared<MessageAttachment>();
+    attachment->filename = filename;
+    attachment->contentType = "image/jpeg";
+    
+    int quality = m_options.quality;
+    while (true) {
+        if (!encodeJpeg(scaled, quality, attachment->data)) {
+            return nullptr;
+        }
+        if (attachment->data.size() <= m_options.maxBytes) {
+            return attachment;
+        }
+        
+        if (quality > m_options.minQuality) {
+            quality = std::max(m_options.minQuality, quality - kQualityStep);
+        } else if (std::min(scaled.cols, scaled.rows) / 2 >= kMinDimension) {
+            cv::resize(scaled, scaled, cv::Size(scaled.cols / 2, scaled.rows / 2), 0, 0, cv::INTER_AREA);
+        } else {
+            std::cerr << "Snapshot " << filename << " does not fit in " << m_options.maxBytes << " bytes" << std::endl;
+            return nullptr;
+        }
+    }
+}
+
+} // namespace hms
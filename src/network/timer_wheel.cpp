@@ -0,0 +1,120 @@
+#include "network/timer_wheel.hpp"
+#include <algorithm>
+
+namespace hms {
+
+TimerWheel::TimerWheel(int64_t tickMs, size_t slotCount, int64_t startMs)
+    : m_tickMs(std::max<int64_t>(1, tickMs)), m_slots(std::max<size_t>(1, slotCount), kNone),
+      m_currentTick(startMs / m_tickMs), m_size(0) {
+}
+
+TimerWheel::TimerId TimerWheel::schedule(int64_t dueMs, uint64_t payload) {
+    // Round up, so a timer never fires early
+    int64_t dueTick = std::max((dueMs + m_tickMs - 1) / m_tickMs, m_currentTick);
+    
+    uint32_t index;
+    if (!m_freeNodes.empty()) {
+        index = m_freeNodes.back();
+        m_freeNodes.pop_back();
+    } else {
+        index = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    
+    Node& node = m_nodes[index];
+    node.dueTick = dueTick;
+    node.payload = payload;
+    node.active = true;
+    link(index);
+    m_size++;
+    
+    return (static_cast<uint64_t>(node.generation) << 32) | index;
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    uint32_t index = static_cast<uint32_t>(id & 0xFFFFFFFF);
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+    if (index >= m_nodes.size() || !m_nodes[index].active || m_nodes[index].generation != generation) {
+        return false;
+    }
+    
+    unlink(index);
+    release(index);
+    return true;
+}
+
+void TimerWheel::advance(int64_t nowMs, std::vector<uint64_t>& fired) {
+    int64_t nowTick = nowMs / m_tickMs;
+    if (nowTick < m_currentTick) {
+        return;
+    }
+    
+    // After a long gap, one pass over every slot covers all the missed ticks
+    int64_t ticks = nowTick - m_currentTick + 1;
+    if (ticks >= static_cast<int64_t>(m_slots.size())) {
+        for (size_t slot = 0; slot < m_slots.size(); slot++) {
+            fireSlot(slot, nowTick, fired);
+        }
+    } else {
+        for (int64_t tick = m_currentTick; tick <= nowTick; tick++) {
+            fireSlot(static_cast<size_t>(tick % static_cast<int64_t>(m_slots.size())), tick, fired);
+        }
+    }
+    m_currentTick = nowTick + 1;
+}
+
+void TimerWheel::fireSlot(size_t slot, int64_t upToTick, std::vector<uint64_t>& fired) {
+    uint32_t index = m_slots[slot];
+    while (index != kNone) {
+        uint32_t next = m_nodes[index].next;
+        if (m_nodes[index].dueTick <= upToTick) {
+            fired.push_back(m_nodes[index].payload);
+            unlink(index);
+            release(index);
+        }
+        index = next;
+    }
+}
+
+size_t TimerWheel::size() const {
+    return m_size;
+}
+
+int64_t TimerWheel::getTickMs() const {
+    return m_tickMs;
+}
+
+void TimerWheel::link(uint32_t index) {
+    Node& node = m_nodes[index];
+    uint32_t& head = m_slots[static_cast<size_t>(node.dueTick % static_cast<int64_t>(m_slots.size()))];
+    node.prev = kNone;
+    node.next = head;
+    if (head != kNone) {
+        m_nodes[head].prev = index;
+    }
+    head = index;
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    Node& node = m_nodes[index];
+    if (node.prev != kNone) {
+        m_nodes[node.prev].next = node.next;
+    } else {
+        m_slots[static_cast<size_t>(node.dueTick % static_cast<int64_t>(m_slots.size()))] = node.next;
+    }
+    if (node.next != kNone) {
+        m_nodes[node.next].prev = node.prev;
+    }
+    node.prev = kNone;
+    node.next = kNone;
+}
+
+void TimerWheel::release(uint32_t index) {
+    Node& node = m_nodes[index];
+    node.active = false;
+    node.generation++;
+    m_freeNodes.push_back(index);
+    m_size--;
+}
+
+} // namespace hms
@@ -0,0 +1,56 @@
+#include "ui/camera_view.hpp"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
+
+namespace hms {
+
+// Width of the frame drawn around the view
+static const int kBorderWidth = 1;
+
+CameraView::CameraView(const QString& placeholder, QWidget *parent)
+    : QWidget(parent)
+    , m_placeholder(placeholder)
+{
+    setMinimumSize(320, 240);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+}
+
+void CameraView::setImage(const QImage& image)
+{
+    m_image = image;
+    update();
+}
+
+QSize CameraView::imageArea() const
+{
+    return rect().adjusted(kBorderWidth, kBorderWidth, -kBorderWidth, -kBorderWidth).size();
+}
+
+void CameraView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.setPen(QColor("#ccc"));
+    painter.drawRect(rect().adjusted(0, 0, -1, -1));
+    
+    if (m_image.isNull()) {
+        painter.drawText(rect(), Qt::AlignCenter, m_placeholder);
+        return;
+    }
+    
+    // Centered as it is; the image's device pixel ratio maps it 1:1 onto the
+    // screen, so Qt copies rather than scales it
+    qreal devicePixelRatio = m_image.devicePixelRatio();
+    int imageWidth = qRound(m_image.width() / devicePixelRatio);
+    int imageHeight = qRound(m_image.height() / devicePixelRatio);
+    painter.drawImage(QPoint((width() - imageWidth) / 2, (height() - imageHeight) / 2), m_image);
+}
+
+void CameraView::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    emit imageAreaChanged(imageArea());
+}
+
+} // namespace hms
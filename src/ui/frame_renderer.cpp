@@ -0,0 +1,141 @@
+#include "ui/frame_renderer.hpp"
+#include <iostream>
+#include <algorithm>
+
+namespace hms {
+
+// One image on screen, one on its way there and one being scaled
+static const size_t kPooledImages = 3;
+
+FrameRenderer::FrameRenderer(ImageCallback onImage)
+    : m_onImage(std::move(onImage))
+    , m_pool(kPooledImages)
+    , m_running(false)
+    , m_lastCamera(0)
+    , m_devicePixelRatio(1.0) {
+}
+
+FrameRenderer::~FrameRenderer() {
+    stop();
+}
+
+void FrameRenderer::start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running) {
+        return;
+    }
+    m_running = true;
+    m_thread = std::thread(&FrameRenderer::threadFunc, this);
+}
+
+void FrameRenderer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void FrameRenderer::submit(size_t cameraIndex, const FrameHandle& frame) {
+    if (!frame || frame->empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingFrame = frame;
+        m_lastFrame = frame;
+        m_lastCamera = cameraIndex;
+    }
+    m_cv.notify_one();
+}
+
+void FrameRenderer::setTargetSize(const QSize& size, qreal devicePixelRatio) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (size == m_targetSize && devicePixelRatio == m_devicePixelRatio) {
+            return;
+        }
+        m_targetSize = size;
+        m_devicePixelRatio = devicePixelRatio;
+        m_pendingFrame = m_lastFrame;
+    }
+    m_cv.notify_one();
+}
+
+void FrameRenderer::threadFunc() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv.wait(lock, [this] { return !m_running || (m_pendingFrame && !m_targetSize.isEmpty()); });
+        if (!m_running) {
+            return;
+        }
+        
+        FrameHandle frame;
+        frame.swap(m_pendingFrame);
+        size_t cameraIndex = m_lastCamera;
+        QSize targetSize = m_targetSize;
+        qreal devicePixelRatio = m_devicePixelRatio;
+        
+        lock.unlock();
+        QImage image = render(frame, targetSize, devicePixelRatio);
+        frame.reset();
+        if (!image.isNull()) {
+            m_onImage(cameraIndex, image);
+        }
+        lock.lock();
+    }
+}
+
+QImage FrameRenderer::render(const FrameHandle& frame, const QSize& targetSize, qreal devicePixelRatio) {
+    // Qt reads OpenCV's BGR order directly; no channel swap needed
+    QImage::Format format;
+    if (frame->type() == CV_8UC3) {
+        format = QImage::Format_BGR888;
+    } else if (frame->type() == CV_8UC1) {
+        format = QImage::Format_Grayscale8;
+    } else {
+        std::cerr << "Unsupported frame type for display: " << frame->type() << std::endl;
+        return QImage();
+    }
+    
+    // Fit the view in device pixels, keeping the frame's aspect ratio
+    int maxWidth = qRound(targetSize.width() * devicePixelRatio);
+    int maxHeight = qRound(targetSize.height() * devicePixelRatio);
+    if (maxWidth <= 0 || maxHeight <= 0) {
+        return QImage();
+    }
+    double scale = std::min(static_cast<double>(maxWidth) / frame->cols,
+                            static_cast<double>(maxHeight) / frame->rows);
+    int width = std::max(1, static_cast<int>(frame->cols * scale));
+    int height = std::max(1, static_cast<int>(frame->rows * scale));
+    
+    // A frame that already fits is shown as it is
+    FrameHandle pixels = frame;
+    if (width != frame->cols || height != frame->rows) {
+        FramePool::Handle scaled = m_pool.acquire(height, width, frame->type());
+        try {
+            cv::resize(*frame, *scaled, scaled->size(), 0, 0, scale < 1.0 ? cv::INTER_AREA : cv::INTER_LINEAR);
+        } catch (const cv::Exception& e) {
+            std::cerr << "Failed to scale frame for display: " << e.what() << std::endl;
+            return QImage();
+        }
+        pixels = scaled;
+    }
+    
+    // The image holds a reference to the pixels for as long as Qt keeps any
+    // copy of it; read-only, so Qt copies rather than write into them
+    auto* owner = new FrameHandle(std::move(pixels));
+    QImage image(static_cast<const uchar*>((*owner)->data), width, height,
+                 static_cast<qsizetype>((*owner)->step), format,
+                 [](void* info) { delete static_cast<FrameHandle*>(info); }, owner);
+    image.setDevicePixelRatio(devicePixelRatio);
+    return image;
+}
+
+} // namespace hms
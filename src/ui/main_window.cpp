@@ -10,14 +10,24 @@
 #include <QDesktopServices>
 #include <QUrl>
 #include <QApplication>
+#include <QScreen>
+#include <fstream>
+#include <algorithm>
 
 namespace hms {
 
+// Rows per page of the user table
+static const int kUserPageSize = 50;
+
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , m_app(nullptr)
-    , m_updateTimer(new QTimer(this))
     , m_selectedUserId(-1)
+    , m_userPage(0)
+    , m_pendingCamera(-1)
+    , m_frameRepaintQueued(false)
+    , m_displayedCamera(-1)
+    , m_refreshIntervalMs(16)
 {
     setWindowTitle("Human Monitoring System");
     setMinimumSize(1024, 768);
@@ -28,6 +38,10 @@ MainWindow::MainWindow(QWidget *parent)
     
     m_tabWidget = new QTabWidget(m_centralWidget);
     
+    m_frameRenderer = std::make_unique<FrameRenderer>([this](size_t cameraIndex, const QImage& image) {
+        queueImage(cameraIndex, image);
+    });
+    
     // Create tabs
     createCameraTab();
     createUserTab();
@@ -49,10 +63,6 @@ MainWindow::MainWindow(QWidget *parent)
     createAddCameraDialog();
     createAddUserDialog();
     createSettingsDialog();
-    
-    // Connect timer for updating camera feeds
-    connect(m_updateTimer, &QTimer::timeout, this, &MainWindow::updateCameraFeeds);
-    m_updateTimer->start(33); // ~30 fps
 }
 
 MainWindow::~MainWindow()
@@ -61,6 +71,7 @@ MainWindow::~MainWindow()
         m_app->stop();
         delete m_app;
     }
+    m_frameRenderer->stop();
 }
 
 void MainWindow::initialize()
@@ -68,9 +79,6 @@ void MainWindow::initialize()
     if (!m_app) {
         m_app = new Application();
         
-        // Connect signals
-        connect(m_updateTimer, &QTimer::timeout, this, &MainWindow::updateCameraFeeds);
-        
         // Initialize application
         bool initialized = m_app->initialize("config.json");
         if (!initialized) {
@@ -94,11 +102,25 @@ void MainWindow::initialize()
             }
         }
         
-        // Populate user table
+        // Populate user table, and refresh it whenever residents change,
+        // whichever thread made the change
         updateUserTable();
+        m_app->getUserDatabase().getDirectory().registerChangeCallback([this](uint64_t) {
+            QMetaObject::invokeMethod(this, [this] { updateUserTable(); }, Qt::QueuedConnection);
+        });
         
-        // Start update timer
-        m_updateTimer->start(100); // 10 fps
+        // The live view is repainted when the engine announces a changed
+        // frame, no faster than the display refreshes; a still scene costs
+        // the GUI thread nothing
+        QScreen* display = screen();
+        qreal refreshRate = display && display->refreshRate() > 0 ? display->refreshRate() : 60.0;
+        m_refreshIntervalMs = std::max(1, qRound(1000.0 / refreshRate));
+        m_frameRenderer->setTargetSize(m_cameraView->imageArea(), m_cameraView->devicePixelRatioF());
+        m_frameRenderer->start();
+        m_app->registerFrameCallback([this](size_t cameraIndex, const FrameHandle& frame) {
+            queueFrame(cameraIndex, frame);
+        });
+        updateCameraFeeds();
         
         m_statusLabel->setText("Application initialized successfully");
     }
@@ -183,6 +205,7 @@ void MainWindow::onCameraSelected(int index)
     if (index >= 0) {
         m_statusLabel->setText(QString("Selected camera: %1").arg(m_cameraSelector->itemText(index)));
     }
+    updateCameraFeeds();
 }
 
 // User management slots
@@ -376,51 +399,159 @@ void MainWindow::updateAlertTable()
 {
     if (!m_app) return;
     
+    updateAlertUserFilter();
+    
     m_alertTable->clear();
     m_alertTable->setRowCount(0);
-    m_alertTable->setColumnCount(5);
-    
-    m_alertTable->setHorizontalHeaderItem(0, new QTableWidgetItem("ID"));
-    m_alertTable->setHorizontalHeaderItem(1, new QTableWidgetItem("User"));
-    m_alertTable->setHorizontalHeaderItem(2, new QTableWidgetItem("Time"));
-    m_alertTable->setHorizontalHeaderItem(3, new QTableWidgetItem("Status"));
-    m_alertTable->setHorizontalHeaderItem(4, new QTableWidgetItem("Response"));
-    
-    // In a real implementation, we would get the alerts from the application
-    // For now, we'll just show a placeholder
-    // This would be replaced with actual alert data
-    /*
-    for (const auto& alert : m_app->getAlerts()) {
+    m_alertTable->setColumnCount(7);
+    
+    m_alertTable->setHorizontalHeaderItem(0, new QTableWidgetItem("Time"));
+    m_alertTable->setHorizontalHeaderItem(1, new QTableWidgetItem("Event"));
+    m_alertTable->setHorizontalHeaderItem(2, new QTableWidgetItem("User"));
+    m_alertTable->setHorizontalHeaderItem(3, new QTableWidgetItem("Camera"));
+    m_alertTable->setHorizontalHeaderItem(4, new QTableWidgetItem("Status"));
+    m_alertTable->setHorizontalHeaderItem(5, new QTableWidgetItem("Recipient"));
+    m_alertTable->setHorizontalHeaderItem(6, new QTableWidgetItem("Details"));
+    
+    // Newest first
+    std::vector<EventRecord> events = queryAlertHistory();
+    for (auto it = events.rbegin(); it != events.rend(); ++it) {
+        const EventRecord& event = *it;
         int row = m_alertTable->rowCount();
         m_alertTable->insertRow(row);
         
-        User user = m_app->getUserById(alert.userId);
-        
-        QTableWidgetItem *idItem = new QTableWidgetItem(QString::number(alert.id));
-        QTableWidgetItem *userItem = new QTableWidgetItem(QString::fromStdString(user.name));
-        QTableWidgetItem *timeItem = new QTableWidgetItem(QDateTime::fromTime_t(alert.timestamp).toString());
-        QTableWidgetItem *statusItem = new QTableWidgetItem(alert.responded ? "Responded" : "Pending");
-        QTableWidgetItem *responseItem = new QTableWidgetItem(QString::fromStdString(alert.response));
+        std::shared_ptr<const User> user = m_app->getUserDatabase().getDirectory().findUser(event.userId);
+        QString userName = user ? QString::fromStdString(user->name) : QString::number(event.userId);
+        QString camera = event.cameraIndex >= 0 ? QString::number(event.cameraIndex + 1) : QString();
+        QString details = QString::fromStdString(event.subject);
+        if (!event.detail.empty()) {
+            details += ": " + QString::fromStdString(event.detail);
+        }
         
-        m_alertTable->setItem(row, 0, idItem);
-        m_alertTable->setItem(row, 1, userItem);
-        m_alertTable->setItem(row, 2, timeItem);
-        m_alertTable->setItem(row, 3, statusItem);
-        m_alertTable->setItem(row, 4, responseItem);
+        m_alertTable->setItem(row, 0, new QTableWidgetItem(
+            QDateTime::fromMSecsSinceEpoch(event.timestampMs).toString("yyyy-MM-dd hh:mm:ss")));
+        m_alertTable->setItem(row, 1, new QTableWidgetItem(eventTypeToString(event.type)));
+        m_alertTable->setItem(row, 2, new QTableWidgetItem(userName));
+        m_alertTable->setItem(row, 3, new QTableWidgetItem(camera));
+        m_alertTable->setItem(row, 4, new QTableWidgetItem(QString::fromStdString(event.status)));
+        m_alertTable->setItem(row, 5, new QTableWidgetItem(QString::fromStdString(event.recipient)));
+        m_alertTable->setItem(row, 6, new QTableWidgetItem(details));
+    }
+    
+    m_alertTable->resizeColumnsToContents();
+}
+
+void MainWindow::updateAlertUserFilter()
+{
+    // Rebuild the resident list, keeping the current selection
+    int selectedUserId = m_alertUserFilter->currentData().isValid() ? m_alertUserFilter->currentData().toInt() : -1;
+    
+    m_alertUserFilter->blockSignals(true);
+    m_alertUserFilter->clear();
+    m_alertUserFilter->addItem("All residents", -1);
+    for (const auto& user : m_app->getAllUsers()) {
+        m_alertUserFilter->addItem(QString::fromStdString(user.name), user.id);
     }
-    */
+    int index = m_alertUserFilter->findData(selectedUserId);
+    m_alertUserFilter->setCurrentIndex(index >= 0 ? index : 0);
+    m_alertUserFilter->blockSignals(false);
+}
+
+std::vector<EventRecord> MainWindow::queryAlertHistory()
+{
+    qint64 toMs = QDateTime::currentMSecsSinceEpoch() + 1;
+    qint64 fromMs = toMs - static_cast<qint64>(m_alertPeriodCombo->currentData().toInt()) * 3600 * 1000;
+    int userId = m_alertUserFilter->currentData().isValid() ? m_alertUserFilter->currentData().toInt() : -1;
+    
+    EventLog& eventLog = m_app->getEventLog();
+    if (userId >= 0) {
+        return eventLog.getEventsByUser(userId, fromMs, toMs);
+    }
+    return eventLog.getEvents(fromMs, toMs);
+}
+
+void MainWindow::onExportAlertsClicked()
+{
+    if (!m_app) return;
+    
+    QString path = QFileDialog::getSaveFileName(this, "Export Alert History", "alert_history.csv",
+                                                "CSV Files (*.csv)");
+    if (path.isEmpty()) {
+        return;
+    }
+    
+    std::ofstream file(path.toStdString());
+    if (!file.is_open()) {
+        QMessageBox::warning(this, "Error", "Failed to write " + path);
+        return;
+    }
+    
+    std::vector<EventRecord> events = queryAlertHistory();
+    writeEventsCsv(file, events);
+    m_statusLabel->setText(QString("Exported %1 events").arg(events.size()));
 }
 
 void MainWindow::updateCameraFeeds()
 {
     if (!m_app) return;
     
+    // Show what the selected camera last produced; newer frames arrive
+    // through queueFrame()
     int selectedCamera = m_cameraSelector->currentIndex();
+    m_displayedCamera = selectedCamera;
     if (selectedCamera >= 0 && selectedCamera < static_cast<int>(m_app->getCameraCount())) {
-        cv::Mat frame = m_app->getProcessedFrame(selectedCamera);
-        if (!frame.empty()) {
-            updateCameraView(frame);
-        }
+        FrameHandle frame = m_app->getLatestFrame(selectedCamera);
+        m_frameRenderer->submit(static_cast<size_t>(selectedCamera), frame);
+    }
+}
+
+void MainWindow::queueFrame(size_t cameraIndex, const FrameHandle& frame)
+{
+    // Runs on the processing thread; scaling is left to the renderer
+    if (static_cast<int>(cameraIndex) == m_displayedCamera) {
+        m_frameRenderer->submit(cameraIndex, frame);
+    }
+}
+
+void MainWindow::queueImage(size_t cameraIndex, const QImage& image)
+{
+    // Runs on the renderer thread: keep the image and make sure one
+    // repaint is on its way to the GUI thread
+    if (static_cast<int>(cameraIndex) != m_displayedCamera) {
+        return;
+    }
+    
+    QMutexLocker locker(&m_pendingImageMutex);
+    m_pendingImage = image;
+    m_pendingCamera = static_cast<int>(cameraIndex);
+    if (!m_frameRepaintQueued) {
+        m_frameRepaintQueued = true;
+        QMetaObject::invokeMethod(this, [this] { presentFrame(); }, Qt::QueuedConnection);
+    }
+}
+
+void MainWindow::presentFrame()
+{
+    // Too soon after the last repaint; try again on the next refresh
+    qint64 sinceRepaintMs = m_lastRepaint.isValid() ? m_lastRepaint.elapsed() : m_refreshIntervalMs;
+    if (sinceRepaintMs < m_refreshIntervalMs) {
+        QTimer::singleShot(static_cast<int>(m_refreshIntervalMs - sinceRepaintMs), this, [this] { presentFrame(); });
+        return;
+    }
+    
+    QImage image;
+    int camera;
+    {
+        QMutexLocker locker(&m_pendingImageMutex);
+        image.swap(m_pendingImage);
+        camera = m_pendingCamera;
+        m_frameRepaintQueued = false;
+    }
+    m_lastRepaint.start();
+    
+    // An image from a camera switched away from since is dropped
+    if (!image.isNull() && camera == m_displayedCamera) {
+        m_cameraView->setImage(image);
     }
 }
 
@@ -468,6 +599,21 @@ void MainWindow::updateUserTable()
 {
     if (!m_app) return;
     
+    // Fetch one extra row to learn whether there is a next page
+    std::string query = m_userSearchEdit->text().toStdString();
+    std::vector<User> users = m_app->getUserDatabase().searchUsers(query, kUserPageSize + 1,
+                                                                   m_userPage * kUserPageSize);
+    if (users.empty() && m_userPage > 0) {
+        // The last page emptied, e.g. after a delete
+        m_userPage--;
+        updateUserTable();
+        return;
+    }
+    bool hasNextPage = static_cast<int>(users.size()) > kUserPageSize;
+    if (hasNextPage) {
+        users.pop_back();
+    }
+    
     m_userTable->clear();
     m_userTable->setRowCount(0);
     m_userTable->setColumnCount(4);
@@ -477,7 +623,7 @@ void MainWindow::updateUserTable()
     m_userTable->setHorizontalHeaderItem(2, new QTableWidgetItem("Email"));
     m_userTable->setHorizontalHeaderItem(3, new QTableWidgetItem("Phone Number"));
     
-    for (const auto& user : m_app->getAllUsers()) {
+    for (const auto& user : users) {
         int row = m_userTable->rowCount();
         m_userTable->insertRow(row);
         
@@ -491,6 +637,10 @@ void MainWindow::updateUserTable()
         m_userTable->setItem(row, 2, emailItem);
         m_userTable->setItem(row, 3, phoneItem);
     }
+    
+    m_prevUserPageBtn->setEnabled(m_userPage > 0);
+    m_nextUserPageBtn->setEnabled(hasNextPage);
+    m_userPageLabel->setText(QString("Page %1").arg(m_userPage + 1));
 }
 
 // UI creation methods
@@ -530,8 +680,10 @@ void MainWindow::createCameraTab()
     m_tabWidget->addTab(m_cameraTab, "Camera Feeds");
     
     // Main camera view
-    m_cameraView = new QLabel("No camera selected");
-    m_cameraView->setStyleSheet("border: 1px solid #ccc;");
+    m_cameraView = new CameraView("No camera selected");
+    connect(m_cameraView, &CameraView::imageAreaChanged, this, [this](const QSize& size) {
+        m_frameRenderer->setTargetSize(size, m_cameraView->devicePixelRatioF());
+    });
     
     // Camera list
     m_cameraSelector = new QComboBox();
@@ -600,6 +752,36 @@ void MainWindow::createUserTab()
     m_userTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     connect(m_userTable, &QTableWidget::cellClicked, this, &MainWindow::onUserSelected);
     
+    // Search runs once typing pauses and starts again from the first page
+    m_userSearchEdit = new QLineEdit();
+    m_userSearchEdit->setPlaceholderText("Search names, notes, contacts or doctors");
+    m_userSearchEdit->setClearButtonEnabled(true);
+    
+    m_userSearchTimer = new QTimer(this);
+    m_userSearchTimer->setSingleShot(true);
+    m_userSearchTimer->setInterval(250);
+    connect(m_userSearchEdit, &QLineEdit::textChanged, m_userSearchTimer, qOverload<>(&QTimer::start));
+    connect(m_userSearchTimer, &QTimer::timeout, this, [this]() {
+        m_userPage = 0;
+        updateUserTable();
+    });
+    
+    m_prevUserPageBtn = new QPushButton("Previous");
+    m_prevUserPageBtn->setEnabled(false);
+    connect(m_prevUserPageBtn, &QPushButton::clicked, this, [this]() {
+        m_userPage--;
+        updateUserTable();
+    });
+    
+    m_nextUserPageBtn = new QPushButton("Next");
+    m_nextUserPageBtn->setEnabled(false);
+    connect(m_nextUserPageBtn, &QPushButton::clicked, this, [this]() {
+        m_userPage++;
+        updateUserTable();
+    });
+    
+    m_userPageLabel = new QLabel("Page 1");
+    
     // User controls
     m_addUserBtn = new QPushButton("Add User");
     connect(m_addUserBtn, &QPushButton::clicked, this, &MainWindow::onAddUserClicked);
@@ -615,8 +797,12 @@ void MainWindow::createUserTab()
     userControlsLayout->addWidget(m_editUserBtn);
     userControlsLayout->addWidget(m_deleteUserBtn);
     userControlsLayout->addStretch();
+    userControlsLayout->addWidget(m_prevUserPageBtn);
+    userControlsLayout->addWidget(m_userPageLabel);
+    userControlsLayout->addWidget(m_nextUserPageBtn);
     
     QVBoxLayout *mainLayout = new QVBoxLayout(m_userTab);
+    mainLayout->addWidget(m_userSearchEdit);
     mainLayout->addWidget(m_userTable);
     mainLayout->addLayout(userControlsLayout);
     m_userTab->setLayout(mainLayout);
@@ -633,7 +819,30 @@ void MainWindow::createAlertTab()
     m_alertTable->setSelectionMode(QAbstractItemView::SingleSelection);
     m_alertTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     
+    // History filters
+    m_alertUserFilter = new QComboBox();
+    m_alertUserFilter->addItem("All residents", -1);
+    connect(m_alertUserFilter, &QComboBox::currentIndexChanged, this, &MainWindow::updateAlertTable);
+    
+    m_alertPeriodCombo = new QComboBox();
+    m_alertPeriodCombo->addItem("Last 24 hours", 24);
+    m_alertPeriodCombo->addItem("Last 7 days", 24 * 7);
+    m_alertPeriodCombo->addItem("Last 30 days", 24 * 30);
+    connect(m_alertPeriodCombo, &QComboBox::currentIndexChanged, this, &MainWindow::updateAlertTable);
+    
+    m_exportAlertsBtn = new QPushButton("Export CSV");
+    connect(m_exportAlertsBtn, &QPushButton::clicked, this, &MainWindow::onExportAlertsClicked);
+    
+    QHBoxLayout *filterLayout = new QHBoxLayout();
+    filterLayout->addWidget(new QLabel("Resident:"));
+    filterLayout->addWidget(m_alertUserFilter);
+    filterLayout->addWidget(new QLabel("Period:"));
+    filterLayout->addWidget(m_alertPeriodCombo);
+    filterLayout->addStretch();
+    filterLayout->addWidget(m_exportAlertsBtn);
+    
     QVBoxLayout *mainLayout = new QVBoxLayout(m_alertTab);
+    mainLayout->addLayout(filterLayout);
     mainLayout->addWidget(m_alertTable);
     m_alertTab->setLayout(mainLayout);
 }
@@ -785,39 +994,6 @@ void MainWindow::createSettingsDialog()
     m_settingsDialog->setLayout(mainLayout);
 }
 
-void MainWindow::updateCameraView(const cv::Mat& frame)
-{
-    if (frame.empty()) return;
-    
-    QImage image = matToQImage(frame);
-    m_cameraView->setPixmap(QPixmap::fromImage(image).scaled(
-        m_cameraView->width(), m_cameraView->height(),
-        Qt::KeepAspectRatio, Qt::SmoothTransformation
-    ));
-}
-
-QImage MainWindow::matToQImage(const cv::Mat& mat)
-{
-    // Convert OpenCV Mat to QImage
-    if (mat.empty()) {
-        return QImage();
-    }
-    
-    if (mat.type() == CV_8UC3) {
-        // BGR to RGB conversion
-        cv::Mat rgbMat;
-        cv::cvtColor(mat, rgbMat, cv::COLOR_BGR2RGB);
-        return QImage(rgbMat.data, rgbMat.cols, rgbMat.rows, 
-                     static_cast<int>(rgbMat.step), QImage::Format_RGB888);
-    } else if (mat.type() == CV_8UC1) {
-        // Grayscale image
-        return QImage(mat.data, mat.cols, mat.rows, 
-                     static_cast<int>(mat.step), QImage::Format_Grayscale8);
-    }
-    
-    return QImage();
-}
-
 void MainWindow::showAlert(const QString& title, const QString& message)
 {
     QMessageBox::warning(this, title, message);
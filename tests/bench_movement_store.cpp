@@ -0,0 +1,126 @@
+// Benchmark for the columnar movement store against the previous
+// std::vector<MovementRecord> history, at 24 hours of history.
+//
+// Usage: bench_movement_store [cameras] [hours] [samples_per_second]
+#include "analytics/movement_store.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <opencv2/opencv.hpp>
+
+using namespace hms;
+using Clock = std::chrono::steady_clock;
+
+// Layout of the record the store replaces
+struct LegacyMovementRecord {
+    int userId;
+    int personId;
+    std::chrono::system_clock::time_point timestamp;
+    cv::Rect position;
+};
+
+static double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int cameras = argc > 1 ? std::atoi(argv[1]) : 16;
+    int hours = argc > 2 ? std::atoi(argv[2]) : 24;
+    int rate = argc > 3 ? std::atoi(argv[3]) : 5;
+    
+    const int64_t startMs = 1700000000000LL;
+    const int64_t durationMs = static_cast<int64_t>(hours) * 3600 * 1000;
+    const int64_t stepMs = 1000 / rate;
+    
+    std::cout << "Movement store benchmark: " << cameras << " cameras, " << hours
+              << " h, " << rate << " samples/s per camera" << std::endl;
+    
+    // One person per camera doing a bounded random walk
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> step(-4, 4);
+    std::vector<cv::Rect> boxes(cameras, cv::Rect(600, 300, 90, 240));
+    
+    MovementStore store;
+    std::vector<LegacyMovementRecord> legacy;
+    
+    auto start = Clock::now();
+    size_t samples = 0;
+    for (int64_t t = startMs; t < startMs + durationMs; t += stepMs) {
+        for (int c = 0; c < cameras; c++) {
+            cv::Rect& box = boxes[c];
+            box.x = std::clamp(box.x + step(rng), 0, 1190);
+            box.y = std::clamp(box.y + step(rng), 0, 480);
+            
+            MovementSample sample;
+            sample.timestampMs = t;
+            sample.trackId = c + 1;
+            sample.userId = -1;
+            sample.box = box;
+            store.append(c, sample);
+            samples++;
+        }
+    }
+    double appendMs = elapsedMs(start);
+    
+    // Build the equivalent legacy history for comparison
+    legacy.reserve(samples);
+    for (int64_t t = startMs; t < startMs + durationMs; t += stepMs) {
+        for (int c = 0; c < cameras; c++) {
+            LegacyMovementRecord record;
+            record.userId = -1;
+            record.personId = c + 1;
+            record.timestamp = std::chrono::system_clock::time_point(std::chrono::milliseconds(t));
+            record.position = boxes[c];
+            legacy.push_back(record);
+        }
+    }
+    
+    size_t storeBytes = store.getMemoryUsage();
+    size_t legacyBytes = legacy.size() * sizeof(LegacyMovementRecord);
+    
+    // Per-frame expiry with nothing old enough to drop: what every loop pays
+    auto cutoff = std::chrono::system_clock::time_point(std::chrono::milliseconds(startMs));
+    start = Clock::now();
+    legacy.erase(std::remove_if(legacy.begin(), legacy.end(),
+                                [&cutoff](const LegacyMovementRecord& record) {
+                                    return record.timestamp < cutoff;
+                                }),
+                 legacy.end());
+    double legacyExpireMs = elapsedMs(start);
+    
+    const int expireIterations = 1000;
+    start = Clock::now();
+    for (int i = 0; i < expireIterations; i++) {
+        store.expireBefore(startMs);
+    }
+    double storeExpireMs = elapsedMs(start) / expireIterations;
+    
+    // One hour of one camera from the middle of the history
+    int64_t queryFrom = startMs + durationMs / 2;
+    start = Clock::now();
+    auto hour = store.query(0, queryFrom, queryFrom + 3600 * 1000);
+    double queryMs = elapsedMs(start);
+    
+    // Drop the oldest hour, as the rolling 24 h window does
+    start = Clock::now();
+    store.expireBefore(startMs + 3600 * 1000);
+    double dropHourMs = elapsedMs(start);
+    
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Samples:                 " << samples << std::endl;
+    std::cout << "Append:                  " << appendMs * 1e6 / samples << " ns/sample" << std::endl;
+    std::cout << "Memory (store):          " << storeBytes / (1024.0 * 1024.0) << " MiB, "
+              << static_cast<double>(storeBytes) / samples << " bytes/sample" << std::endl;
+    std::cout << "Memory (vector):         " << legacyBytes / (1024.0 * 1024.0) << " MiB, "
+              << sizeof(LegacyMovementRecord) << " bytes/sample" << std::endl;
+    std::cout << "Per-frame expiry (store):  " << storeExpireMs * 1000.0 << " us" << std::endl;
+    std::cout << "Per-frame expiry (vector): " << legacyExpireMs * 1000.0 << " us" << std::endl;
+    std::cout << "Drop oldest hour (store):  " << dropHourMs * 1000.0 << " us" << std::endl;
+    std::cout << "Query 1 h of one camera:   " << queryMs << " ms (" << hour.size() << " samples)" << std::endl;
+    
+    return 0;
+}
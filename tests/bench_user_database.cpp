@@ -0,0 +1,84 @@
+// Benchmark for UserDatabase::getAllUsers against the per-user lookups it
+// used to make (one query for users, then contacts and doctor per user).
+//
+// Usage: bench_user_database [users] [contacts_per_user] [iterations]
+#include "database/user_database.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+using namespace hms;
+using Clock = std::chrono::steady_clock;
+
+static double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int userCount = argc > 1 ? std::atoi(argv[1]) : 5000;
+    int contactsPerUser = argc > 2 ? std::atoi(argv[2]) : 2;
+    int iterations = argc > 3 ? std::atoi(argv[3]) : 5;
+    
+    std::cout << "User database benchmark: " << userCount << " users, " << contactsPerUser
+              << " contacts each, " << iterations << " iterations" << std::endl;
+    
+    UserDatabase db(":memory:");
+    if (!db.initialize()) {
+        std::cerr << "Database initialization failed" << std::endl;
+        return 1;
+    }
+    
+    for (int i = 0; i < userCount; i++) {
+        User user;
+        user.name = "Resident " + std::to_string(i);
+        user.notes = "Room " + std::to_string(100 + i % 400);
+        for (int c = 0; c < contactsPerUser; c++) {
+            EmergencyContact contact;
+            contact.name = "Contact " + std::to_string(c);
+            contact.phone = "+1555000" + std::to_string(i % 10000);
+            contact.email = "contact" + std::to_string(c) + "@example.com";
+            contact.relationship = "Family";
+            user.emergencyContacts.push_back(contact);
+        }
+        user.familyDoctor.name = "Dr. " + std::to_string(i % 50);
+        user.familyDoctor.phone = "+15559990000";
+        db.addUser(user);
+    }
+    
+    // Per-user lookups, as getAllUsers used to do them
+    size_t legacyUsers = 0;
+    uint64_t statementsBefore = db.getStatementCount();
+    auto start = Clock::now();
+    for (int n = 0; n < iterations; n++) {
+        std::vector<User> users = db.getAllUsers();
+        for (auto& user : users) {
+            user.emergencyContacts = db.getEmergencyContacts(user.id);
+            user.familyDoctor = db.getFamilyDoctor(user.id);
+        }
+        legacyUsers = users.size();
+    }
+    double legacyMs = elapsedMs(start) / iterations;
+    // getAllUsers itself accounts for 3 of these
+    uint64_t legacyStatements = (db.getStatementCount() - statementsBefore) / iterations - 2;
+    
+    size_t loadedUsers = 0;
+    statementsBefore = db.getStatementCount();
+    start = Clock::now();
+    for (int n = 0; n < iterations; n++) {
+        loadedUsers = db.getAllUsers().size();
+    }
+    double setMs = elapsedMs(start) / iterations;
+    uint64_t setStatements = (db.getStatementCount() - statementsBefore) / iterations;
+    
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Per-user lookups: " << legacyStatements << " statements, " << legacyMs
+              << " ms per load (" << legacyUsers << " users)" << std::endl;
+    std::cout << "getAllUsers:      " << setStatements << " statements, " << setMs
+              << " ms per load (" << loadedUsers << " users)" << std::endl;
+    std::cout << "Speedup: " << legacyMs / setMs << "x" << std::endl;
+    
+    return 0;
+}
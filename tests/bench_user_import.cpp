@@ -0,0 +1,97 @@
+// Benchmark for bulk onboarding: addUser per resident (one transaction each)
+// against addUsers (one transaction for the batch), on a database file.
+//
+// Usage: bench_user_import [users] [contacts_per_user]
+#include "database/user_database.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace hms;
+using Clock = std::chrono::steady_clock;
+
+static double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static void removeDatabaseFiles(const std::string& path) {
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+}
+
+static std::vector<User> makeUsers(int userCount, int contactsPerUser) {
+    std::vector<User> users;
+    for (int i = 0; i < userCount; i++) {
+        User user;
+        user.id = -1;
+        user.name = "Resident " + std::to_string(i);
+        user.notes = "Room " + std::to_string(100 + i % 400);
+        for (int c = 0; c < contactsPerUser; c++) {
+            EmergencyContact contact;
+            contact.name = "Contact " + std::to_string(c);
+            contact.phone = "+1555000" + std::to_string(i % 10000);
+            contact.relationship = "Family";
+            user.emergencyContacts.push_back(contact);
+        }
+        user.familyDoctor.name = "Dr. " + std::to_string(i % 50);
+        user.familyDoctor.phone = "+15559990000";
+        users.push_back(user);
+    }
+    return users;
+}
+
+int main(int argc, char** argv) {
+    int userCount = argc > 1 ? std::atoi(argv[1]) : 5000;
+    int contactsPerUser = argc > 2 ? std::atoi(argv[2]) : 2;
+    const std::string path = "bench_user_import.db";
+    
+    std::cout << "User import benchmark: " << userCount << " users, " << contactsPerUser
+              << " contacts each" << std::endl;
+    
+    std::vector<User> users = makeUsers(userCount, contactsPerUser);
+    
+    removeDatabaseFiles(path);
+    double singleMs = 0.0;
+    {
+        UserDatabase db(path);
+        if (!db.initialize()) {
+            std::cerr << "Database initialization failed" << std::endl;
+            return 1;
+        }
+        
+        auto start = Clock::now();
+        for (auto& user : users) {
+            db.addUser(user);
+        }
+        singleMs = elapsedMs(start);
+    }
+    
+    removeDatabaseFiles(path);
+    double batchMs = 0.0;
+    size_t loaded = 0;
+    {
+        UserDatabase db(path);
+        if (!db.initialize()) {
+            std::cerr << "Database initialization failed" << std::endl;
+            return 1;
+        }
+        
+        auto start = Clock::now();
+        db.addUsers(users);
+        batchMs = elapsedMs(start);
+        loaded = db.getAllUsers().size();
+    }
+    removeDatabaseFiles(path);
+    
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "addUser per resident: " << singleMs << " ms" << std::endl;
+    std::cout << "addUsers batch:       " << batchMs << " ms (" << loaded << " users)" << std::endl;
+    std::cout << "Speedup: " << singleMs / batchMs << "x" << std::endl;
+    
+    return loaded == users.size() ? 0 : 1;
+}
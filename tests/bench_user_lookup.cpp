@@ -0,0 +1,134 @@
+// Benchmark for UserDatabase::getUserById with cached prepared statements
+// against the prepare/step/finalize-per-call pattern it used to follow. The
+// "before" side runs the same three queries on a second connection to the
+// same database file.
+//
+// Usage: bench_user_lookup [users] [lookups]
+#include "database/user_database.hpp"
+#include <sqlite3.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace hms;
+using Clock = std::chrono::steady_clock;
+
+static double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static std::string columnText(sqlite3_stmt* stmt, int col) {
+    const unsigned char* text = sqlite3_column_text(stmt, col);
+    return text ? reinterpret_cast<const char*>(text) : "";
+}
+
+// getUserById as it was before the statement cache
+static User uncachedGetUserById(sqlite3* db, int userId) {
+    User user;
+    user.id = -1;
+    
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(db, "SELECT id, name, notes, image_reference FROM users WHERE id = ?;", -1, &stmt, nullptr);
+    sqlite3_bind_int(stmt, 1, userId);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        user.id = sqlite3_column_int(stmt, 0);
+        user.name = columnText(stmt, 1);
+        user.notes = columnText(stmt, 2);
+        user.imageReference = columnText(stmt, 3);
+    }
+    sqlite3_finalize(stmt);
+    
+    if (user.id == -1) {
+        return user;
+    }
+    
+    sqlite3_prepare_v2(db, "SELECT name, phone, email, address, relationship FROM emergency_contacts "
+                       "WHERE user_id = ?;", -1, &stmt, nullptr);
+    sqlite3_bind_int(stmt, 1, userId);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        EmergencyContact contact;
+        contact.name = columnText(stmt, 0);
+        contact.phone = columnText(stmt, 1);
+        contact.email = columnText(stmt, 2);
+        contact.address = columnText(stmt, 3);
+        contact.relationship = columnText(stmt, 4);
+        user.emergencyContacts.push_back(contact);
+    }
+    sqlite3_finalize(stmt);
+    
+    sqlite3_prepare_v2(db, "SELECT name, phone, email, address, specialization FROM doctors "
+                       "WHERE user_id = ?;", -1, &stmt, nullptr);
+    sqlite3_bind_int(stmt, 1, userId);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        user.familyDoctor.name = columnText(stmt, 0);
+        user.familyDoctor.phone = columnText(stmt, 1);
+        user.familyDoctor.email = columnText(stmt, 2);
+        user.familyDoctor.address = columnText(stmt, 3);
+        user.familyDoctor.specialization = columnText(stmt, 4);
+    }
+    sqlite3_finalize(stmt);
+    
+    return user;
+}
+
+int main(int argc, char** argv) {
+    int userCount = argc > 1 ? std::atoi(argv[1]) : 200;
+    int lookups = argc > 2 ? std::atoi(argv[2]) : 100000;
+    const std::string path = "bench_user_lookup.db";
+    std::remove(path.c_str());
+    
+    std::cout << "User lookup benchmark: " << userCount << " users, " << lookups << " lookups" << std::endl;
+    
+    UserDatabase db(path);
+    if (!db.initialize()) {
+        std::cerr << "Database initialization failed" << std::endl;
+        return 1;
+    }
+    
+    for (int i = 0; i < userCount; i++) {
+        User user;
+        user.name = "Resident " + std::to_string(i);
+        user.notes = "Room " + std::to_string(100 + i);
+        EmergencyContact contact;
+        contact.name = "Contact " + std::to_string(i);
+        contact.phone = "+1555000" + std::to_string(i);
+        user.emergencyContacts.push_back(contact);
+        user.familyDoctor.name = "Dr. " + std::to_string(i % 50);
+        db.addUser(user);
+    }
+    
+    sqlite3* raw = nullptr;
+    if (sqlite3_open(path.c_str(), &raw) != SQLITE_OK) {
+        std::cerr << "Cannot open " << path << ": " << sqlite3_errmsg(raw) << std::endl;
+        sqlite3_close(raw);
+        return 1;
+    }
+    
+    size_t checksum = 0;
+    auto start = Clock::now();
+    for (int n = 0; n < lookups; n++) {
+        checksum += uncachedGetUserById(raw, 1 + n % userCount).emergencyContacts.size();
+    }
+    double uncachedMs = elapsedMs(start);
+    sqlite3_close(raw);
+    
+    uint64_t preparesBefore = db.getPrepareCount();
+    start = Clock::now();
+    for (int n = 0; n < lookups; n++) {
+        checksum -= db.getUserById(1 + n % userCount).emergencyContacts.size();
+    }
+    double cachedMs = elapsedMs(start);
+    uint64_t prepares = db.getPrepareCount() - preparesBefore;
+    
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Prepare per call: " << uncachedMs * 1000.0 / lookups << " us per lookup" << std::endl;
+    std::cout << "Cached statements: " << cachedMs * 1000.0 / lookups << " us per lookup ("
+              << prepares << " prepares)" << std::endl;
+    std::cout << "Speedup: " << uncachedMs / cachedMs << "x" << std::endl;
+    
+    std::remove(path.c_str());
+    return checksum == 0 ? 0 : 1;
+}
@@ -0,0 +1,17 @@
+-- User database at schema version 1: the original tables, versioned,
+-- before the user_id indexes of version 2.
+PRAGMA user_version = 1;
+
+CREATE TABLE users (id INTEGER PRIMARY KEY AUTOINCREMENT,name TEXT NOT NULL,notes TEXT,image_reference TEXT);
+CREATE TABLE emergency_contacts (id INTEGER PRIMARY KEY AUTOINCREMENT,user_id INTEGER NOT NULL,name TEXT NOT NULL,phone TEXT NOT NULL,email TEXT,address TEXT,relationship TEXT,FOREIGN KEY (user_id) REFERENCES users (id) ON DELETE CASCADE);
+CREATE TABLE doctors (id INTEGER PRIMARY KEY AUTOINCREMENT,user_id INTEGER NOT NULL,name TEXT NOT NULL,phone TEXT NOT NULL,email TEXT,address TEXT,specialization TEXT,FOREIGN KEY (user_id) REFERENCES users (id) ON DELETE CASCADE);
+
+INSERT INTO users (id, name, notes, image_reference) VALUES (1, 'Margaret Hill', 'Room 12', 'images/margaret.jpg');
+INSERT INTO users (id, name, notes, image_reference) VALUES (2, 'Walter Reed', '', '');
+INSERT INTO users (id, name, notes, image_reference) VALUES (4, 'Ida Moss', 'Room 3', '');
+
+INSERT INTO emergency_contacts (id, user_id, name, phone, email, address, relationship) VALUES (1, 1, 'Tom Hill', '+15550001', 'tom@example.com', '', 'Son');
+INSERT INTO emergency_contacts (id, user_id, name, phone, email, address, relationship) VALUES (2, 2, 'Ruth Reed', '+15550002', '', '', 'Wife');
+INSERT INTO emergency_contacts (id, user_id, name, phone, email, address, relationship) VALUES (5, 1, 'Ann Hill', '+15550003', '', '', 'Daughter');
+
+INSERT INTO doctors (id, user_id, name, phone, email, address, specialization) VALUES (1, 1, 'Dr. Patel', '+15559001', '', '', 'Geriatrics');
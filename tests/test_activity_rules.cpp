@@ -0,0 +1,201 @@
+#include "analytics/activity_rules.hpp"
+#include <iostream>
+#include <cassert>
+#include <opencv2/opencv.hpp>
+
+using namespace hms;
+
+static const int64_t kMinuteMs = 60 * 1000;
+static const int64_t kHourMs = 60 * kMinuteMs;
+static const int64_t kDayMs = 24 * kHourMs;
+
+// Midnight (UTC, and local for the engines below)
+static const int64_t kDayStart = 20000 * kDayMs;
+
+static MovementSample makeSample(int64_t timestampMs, int trackId, int userId, const cv::Point& centre) {
+    MovementSample sample;
+    sample.timestampMs = timestampMs;
+    sample.trackId = trackId;
+    sample.userId = userId;
+    sample.box = cv::Rect(centre.x - 40, centre.y - 100, 80, 200);
+    return sample;
+}
+
+static ZoneMap makeZones() {
+    ZoneMap zones(8);
+    zones.addZone(0, "bed", {cv::Point(0, 0), cv::Point(320, 0), cv::Point(320, 240), cv::Point(0, 240)});
+    zones.addZone(0, "door", {cv::Point(600, 0), cv::Point(639, 0), cv::Point(639, 479), cv::Point(600, 479)});
+    return zones;
+}
+
+// Test function to verify schedule parsing
+void test_time_of_day() {
+    std::cout << "Testing schedule parsing..." << std::endl;
+    
+    assert(ActivityRuleEngine::parseTimeOfDay("08:30") == 8 * 60 + 30 && "Time parsed wrong");
+    assert(ActivityRuleEngine::parseTimeOfDay("24:00") == 24 * 60 && "End of day rejected");
+    assert(ActivityRuleEngine::parseTimeOfDay("8.30") == -1 && "Malformed time accepted");
+    assert(ActivityRuleEngine::parseTimeOfDay("25:00") == -1 && "Out of range time accepted");
+    
+    ActivityRule::Type type;
+    assert(ActivityRuleEngine::typeFromString("zone_exit", type) && type == ActivityRule::Type::ZONE_EXIT &&
+           "Rule type not parsed");
+    assert(!ActivityRuleEngine::typeFromString("fall", type) && "Unknown rule type accepted");
+    
+    std::cout << "Schedule parsing test completed successfully" << std::endl;
+}
+
+// Test function to verify daytime inactivity alerts
+void test_inactivity() {
+    std::cout << "Testing inactivity rule..." << std::endl;
+    
+    ZoneMap zones = makeZones();
+    ActivityRuleEngine engine(zones, ActivityRuleEngine::Options());
+    
+    ActivityRule rule;
+    rule.name = "No movement during the day";
+    rule.type = ActivityRule::Type::INACTIVITY;
+    rule.durationMs = 2 * kHourMs;
+    rule.startMinute = 8 * 60;
+    rule.endMinute = 20 * 60;
+    int ruleId = engine.addRule(rule);
+    assert(ruleId == 0 && "Rule rejected");
+    
+    // Last movement at 05:00, then only detector jitter
+    int64_t t = kDayStart + 5 * kHourMs;
+    engine.addObservation(0, makeSample(t, 1, -1, cv::Point(100, 100)));
+    for (int i = 0; i < 600; i++) {
+        t += 1000;
+        engine.addObservation(0, makeSample(t, 1, -1, cv::Point(100 + i % 5, 100)));
+    }
+    
+    // The night does not count: the window opens at 08:00
+    engine.evaluate(kDayStart + 8 * kHourMs);
+    assert(engine.getNewAlerts().empty() && "Time before the window counted");
+    engine.evaluate(kDayStart + 9 * kHourMs + 59 * kMinuteMs);
+    assert(engine.getNewAlerts().empty() && "Alert raised early");
+    
+    engine.evaluate(kDayStart + 10 * kHourMs);
+    auto alerts = engine.getNewAlerts();
+    assert(alerts.size() == 1 && alerts[0].ruleName == rule.name && "Inactivity not detected");
+    
+    // Raised once per period of inactivity
+    engine.evaluate(kDayStart + 11 * kHourMs);
+    assert(engine.getNewAlerts().empty() && "Inactivity alert repeated");
+    
+    // Movement re-arms the rule
+    t = kDayStart + 11 * kHourMs;
+    engine.addObservation(0, makeSample(t, 2, -1, cv::Point(400, 300)));
+    engine.addObservation(0, makeSample(t + 1000, 2, -1, cv::Point(450, 300)));
+    engine.evaluate(t + 2 * kHourMs + 1000);
+    assert(engine.getNewAlerts().size() == 1 && "Rule not re-armed by movement");
+    
+    std::cout << "Inactivity rule test completed successfully" << std::endl;
+}
+
+// Test function to verify night-time wandering alerts
+void test_wandering() {
+    std::cout << "Testing wandering rules..." << std::endl;
+    
+    ZoneMap zones = makeZones();
+    ActivityRuleEngine::Options options;
+    options.trackTimeoutMs = 30 * kMinuteMs;
+    ActivityRuleEngine engine(zones, options);
+    
+    ActivityRule leftBed;
+    leftBed.name = "Left bed at night";
+    leftBed.type = ActivityRule::Type::ZONE_EXIT;
+    leftBed.zoneId = zones.getZoneId("bed");
+    leftBed.durationMs = 5 * kMinuteMs;
+    leftBed.startMinute = 22 * 60;
+    leftBed.endMinute = 6 * 60;
+    engine.addRule(leftBed);
+    
+    ActivityRule door;
+    door.name = "At the door at night";
+    door.type = ActivityRule::Type::ZONE_ENTER;
+    door.userId = 7;
+    door.zoneId = zones.getZoneId("door");
+    door.startMinute = 22 * 60;
+    door.endMinute = 6 * 60;
+    engine.addRule(door);
+    
+    ActivityRule noZone;
+    noZone.type = ActivityRule::Type::ZONE_EXIT;
+    int noZoneId = engine.addRule(noZone);
+    assert(noZoneId == -1 && "Zone rule without a zone accepted");
+    
+    // In bed at 23:00, gets up at 23:10 and comes back after 3 minutes
+    int64_t t = kDayStart + 23 * kHourMs;
+    engine.addObservation(0, makeSample(t, 1, 7, cv::Point(100, 100)));
+    t += 10 * kMinuteMs;
+    engine.addObservation(0, makeSample(t, 1, 7, cv::Point(400, 300)));
+    engine.addObservation(0, makeSample(t + 3 * kMinuteMs, 1, 7, cv::Point(100, 100)));
+    engine.evaluate(t + 3 * kMinuteMs + 1000);
+    engine.evaluate(t + 6 * kMinuteMs);
+    assert(engine.getNewAlerts().empty() && "Returning within the grace period alerted");
+    
+    // Gets up again and walks to the door
+    t += 20 * kMinuteMs;
+    engine.addObservation(0, makeSample(t, 1, 7, cv::Point(400, 300)));
+    engine.addObservation(0, makeSample(t + 1000, 1, 7, cv::Point(620, 300)));
+    auto alerts = engine.getNewAlerts();
+    assert(alerts.size() == 1 && alerts[0].ruleName == door.name && alerts[0].userId == 7 &&
+           "Door entry not detected");
+    
+    engine.evaluate(t + 4 * kMinuteMs);
+    assert(engine.getNewAlerts().empty() && "Exit alert raised before the grace period");
+    engine.evaluate(t + 5 * kMinuteMs);
+    alerts = engine.getNewAlerts();
+    assert(alerts.size() == 1 && alerts[0].ruleName == leftBed.name && alerts[0].personId == 1 &&
+           "Leaving the bed not detected");
+    
+    // A track lost while in bed is a detector dropout as far as anyone knows
+    t = kDayStart + kDayMs + 2 * kHourMs;
+    engine.addObservation(0, makeSample(t, 3, -1, cv::Point(100, 100)));
+    engine.evaluate(t + 31 * kMinuteMs);
+    engine.evaluate(t + 40 * kMinuteMs);
+    assert(engine.getNewAlerts().empty() && "Lost track treated as leaving the bed");
+    
+    // Someone else getting into bed does not cancel a pending exit
+    t = kDayStart + kDayMs + 3 * kHourMs;
+    engine.addObservation(0, makeSample(t, 10, -1, cv::Point(100, 100)));
+    engine.addObservation(0, makeSample(t + 1000, 10, -1, cv::Point(400, 300)));
+    engine.addObservation(0, makeSample(t + 2000, 11, -1, cv::Point(400, 300)));
+    engine.addObservation(0, makeSample(t + 3000, 11, -1, cv::Point(100, 100)));
+    engine.evaluate(t + 5 * kMinuteMs + 1000);
+    alerts = engine.getNewAlerts();
+    assert(alerts.size() == 1 && alerts[0].personId == 10 && "Another person entering cancelled the exit");
+    
+    // The same resident coming back under a new track does
+    t = kDayStart + kDayMs + 4 * kHourMs;
+    engine.addObservation(0, makeSample(t, 20, 7, cv::Point(100, 100)));
+    engine.addObservation(0, makeSample(t + 1000, 20, 7, cv::Point(400, 300)));
+    engine.addObservation(0, makeSample(t + kMinuteMs, 21, 7, cv::Point(100, 100)));
+    engine.evaluate(t + 10 * kMinuteMs);
+    assert(engine.getNewAlerts().empty() && "Resident back in bed under a new track alerted");
+    
+    // Rules bound to a user ignore everyone else, and daytime is out of schedule
+    t = kDayStart + kDayMs + 12 * kHourMs;
+    engine.addObservation(0, makeSample(t, 4, 8, cv::Point(620, 300)));
+    engine.addObservation(0, makeSample(t + kHourMs, 5, 7, cv::Point(620, 300)));
+    assert(engine.getNewAlerts().empty() && "Rule fired for another user or outside its schedule");
+    
+    std::cout << "Wandering rules test completed successfully" << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Activity Rules tests..." << std::endl;
+    
+    try {
+        test_time_of_day();
+        test_inactivity();
+        test_wandering();
+        
+        std::cout << "All Activity Rules tests completed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -1,7 +1,14 @@
 #include "database/user_database.hpp"
+#include "database/user_import.hpp"
 #include <iostream>
 #include <cassert>
 #include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
 
 using namespace hms;
 
@@ -48,7 +55,7 @@ void test_user_crud() {
     
     // Verify deletion
     User deletedUser = db.getUserById(user.id);
-    assert(deletedUser.id == 0 && "User not properly deleted");
+    assert(deletedUser.id == -1 && "User not properly deleted");
     
     std::cout << "User CRUD operations test completed successfully" << std::endl;
 }
@@ -165,6 +172,514 @@ void test_family_doctors() {
     std::cout << "Family doctor operations test completed successfully" << std::endl;
 }
 
+// Test function to verify getAllUsers assembles every user in a fixed number of queries
+void test_get_all_users() {
+    std::cout << "Testing getAllUsers..." << std::endl;
+    
+    UserDatabase db(":memory:");
+    bool initialized = db.initialize();
+    assert(initialized && "Database initialization failed");
+    
+    // User i has i % 3 contacts and a doctor when i is even
+    for (int i = 0; i < 20; i++) {
+        User user;
+        user.name = "Resident " + std::to_string(i);
+        for (int c = 0; c < i % 3; c++) {
+            EmergencyContact contact;
+            contact.name = user.name + " contact " + std::to_string(c);
+            contact.phone = "555-000-" + std::to_string(c);
+            user.emergencyContacts.push_back(contact);
+        }
+        if (i % 2 == 0) {
+            user.familyDoctor.name = "Dr. " + std::to_string(i);
+            user.familyDoctor.phone = "555-999-0000";
+        }
+        bool added = db.addUser(user);
+        assert(added && "Failed to add user");
+    }
+    
+    uint64_t statementsBefore = db.getStatementCount();
+    std::vector<User> users = db.getAllUsers();
+    assert(db.getStatementCount() - statementsBefore == 3 && "getAllUsers should not query per user");
+    
+    assert(users.size() == 20 && "Wrong number of users");
+    for (const auto& user : users) {
+        // Must match what the per-user lookups return
+        std::vector<EmergencyContact> contacts = db.getEmergencyContacts(user.id);
+        assert(user.emergencyContacts.size() == contacts.size() && "Contacts attached to the wrong user");
+        for (size_t c = 0; c < contacts.size(); c++) {
+            assert(user.emergencyContacts[c].name == contacts[c].name && "Contact order differs");
+        }
+        assert(user.familyDoctor.name == db.getFamilyDoctor(user.id).name && "Doctor attached to the wrong user");
+    }
+    
+    std::cout << "getAllUsers test completed successfully" << std::endl;
+}
+
+// Test function to verify prepared statements are reused
+void test_statement_cache() {
+    std::cout << "Testing statement cache..." << std::endl;
+    
+    UserDatabase db(":memory:");
+    bool initialized = db.initialize();
+    assert(initialized && "Database initialization failed");
+    
+    User user;
+    user.name = "Cached User";
+    EmergencyContact contact;
+    contact.name = "Cached Contact";
+    user.emergencyContacts.push_back(contact);
+    user.familyDoctor.name = "Dr. Cache";
+    bool added = db.addUser(user);
+    assert(added && "Failed to add user");
+    
+    // The first lookup compiles its three queries, later ones reuse them
+    db.getUserById(user.id);
+    uint64_t preparesBefore = db.getPrepareCount();
+    for (int i = 0; i < 100; i++) {
+        User retrieved = db.getUserById(user.id);
+        assert(retrieved.name == user.name && "Cached lookup returned wrong user");
+        assert(retrieved.emergencyContacts.size() == 1 && "Cached lookup lost contacts");
+        assert(retrieved.familyDoctor.name == "Dr. Cache" && "Cached lookup lost doctor");
+    }
+    assert(db.getPrepareCount() == preparesBefore && "Statements prepared again");
+    
+    // Bindings are cleared between uses
+    assert(db.getUserById(user.id + 1).id == -1 && "Stale binding reused");
+    
+    // A statement still in use is not handed out twice
+    StatementCache cache;
+    sqlite3* raw = nullptr;
+    sqlite3_open(":memory:", &raw);
+    cache.setDatabase(raw);
+    {
+        StatementCache::Handle outer = cache.acquire(0, "SELECT 1;");
+        StatementCache::Handle inner = cache.acquire(0, "SELECT 1;");
+        assert(outer && inner && static_cast<sqlite3_stmt*>(outer) != static_cast<sqlite3_stmt*>(inner) &&
+               "Statement shared between nested uses");
+        bool stepped = sqlite3_step(outer) == SQLITE_ROW && sqlite3_step(inner) == SQLITE_ROW;
+        assert(stepped && "Nested step failed");
+    }
+    {
+        StatementCache::Handle again = cache.acquire(0, "SELECT 1;");
+        bool stepped = sqlite3_step(again) == SQLITE_ROW;
+        assert(stepped && "Statement not reset on release");
+    }
+    assert(cache.getPrepareCount() == 2 && "Released statement not reused");
+    bool invalidPrepared = cache.acquire(1, "NOT SQL;") != nullptr;
+    assert(!invalidPrepared && "Invalid SQL returned a statement");
+    cache.clear();
+    sqlite3_close(raw);
+    
+    std::cout << "Statement cache test completed successfully" << std::endl;
+}
+
+static void removeDatabaseFiles(const std::string& path) {
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+}
+
+// Test function to verify reads use the pool and are not blocked by writes
+void test_reader_pool() {
+    std::cout << "Testing reader pool..." << std::endl;
+    
+    const std::string path = "test_reader_pool.db";
+    removeDatabaseFiles(path);
+    
+    {
+        UserDatabase::Options options;
+        options.readerCount = 3;
+        UserDatabase db(path, options);
+        bool initialized = db.initialize();
+        assert(initialized && "Database initialization failed");
+        assert(db.getReaderCount() == 3 && "Reader pool not opened");
+        
+        User user;
+        user.name = "Pooled User";
+        EmergencyContact contact;
+        contact.name = "Pooled Contact";
+        contact.phone = "555-0100";
+        user.emergencyContacts.push_back(contact);
+        bool added = db.addUser(user);
+        assert(added && "Failed to add user");
+        
+        // Another process holding the write lock does not stall readers
+        sqlite3* other = nullptr;
+        sqlite3_open(path.c_str(), &other);
+        char* row = nullptr;
+        sqlite3_exec(other, "PRAGMA journal_mode;", [](void* out, int, char** values, char**) {
+            *static_cast<char**>(out) = sqlite3_mprintf("%s", values[0]);
+            return 0;
+        }, &row, nullptr);
+        assert(row && std::string(row) == "wal" && "Database not in WAL mode");
+        sqlite3_free(row);
+        
+        int rc = sqlite3_exec(other, "BEGIN IMMEDIATE; INSERT INTO users (name) VALUES ('Uncommitted');",
+                              nullptr, nullptr, nullptr);
+        assert(rc == SQLITE_OK && "Could not take the write lock");
+        auto start = std::chrono::steady_clock::now();
+        assert(db.getUserById(user.id).name == user.name && "Read failed during a write");
+        assert(db.getAllUsers().size() == 1 && "Uncommitted row visible to readers");
+        assert(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(500) &&
+               "Read blocked behind a write");
+        sqlite3_exec(other, "ROLLBACK;", nullptr, nullptr, nullptr);
+        sqlite3_close(other);
+        
+        // Concurrent readers alongside a writer
+        std::atomic<int> failures(0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 6; t++) {
+            threads.emplace_back([&db, &user, &failures] {
+                for (int i = 0; i < 200; i++) {
+                    User retrieved = db.getUserById(user.id);
+                    if (retrieved.name != user.name || retrieved.emergencyContacts.size() != 1) {
+                        failures++;
+                    }
+                }
+            });
+        }
+        threads.emplace_back([&db] {
+            for (int i = 0; i < 50; i++) {
+                User extra;
+                extra.name = "Extra " + std::to_string(i);
+                db.addUser(extra);
+            }
+        });
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assert(failures == 0 && "Concurrent reads returned wrong data");
+        assert(db.getAllUsers().size() == 51 && "Concurrent writes lost");
+    }
+    
+    UserDatabase memoryDb(":memory:");
+    memoryDb.initialize();
+    assert(memoryDb.getReaderCount() == 0 && "In-memory database cannot share readers");
+    
+    removeDatabaseFiles(path);
+    
+    std::cout << "Reader pool test completed successfully" << std::endl;
+}
+
+// Test function to verify compound writes are all-or-nothing
+void test_transactions() {
+    std::cout << "Testing transactional writes..." << std::endl;
+    
+    const std::string path = "test_transactions.db";
+    removeDatabaseFiles(path);
+    
+    {
+        UserDatabase db(path);
+        bool initialized = db.initialize();
+        assert(initialized && "Database initialization failed");
+        
+        // Make one contact name fail to insert
+        sqlite3* other = nullptr;
+        sqlite3_open(path.c_str(), &other);
+        int rc = sqlite3_exec(other, "CREATE TRIGGER reject_contact BEFORE INSERT ON emergency_contacts "
+                              "WHEN NEW.name = 'Rejected' BEGIN SELECT RAISE(ABORT, 'rejected'); END;",
+                              nullptr, nullptr, nullptr);
+        assert(rc == SQLITE_OK && "Failed to create trigger");
+        sqlite3_close(other);
+        
+        User user;
+        user.name = "Half Written";
+        EmergencyContact good;
+        good.name = "Accepted";
+        good.phone = "555-0101";
+        EmergencyContact bad;
+        bad.name = "Rejected";
+        bad.phone = "555-0102";
+        user.emergencyContacts = {good, bad};
+        user.familyDoctor.name = "Dr. Partial";
+        user.familyDoctor.phone = "555-0103";
+        
+        bool userAdded = db.addUser(user);
+        assert(!userAdded && "addUser succeeded with a failing contact");
+        assert(user.id == -1 && "Failed user kept an ID");
+        assert(db.getAllUsers().empty() && "Failed addUser left a user row behind");
+        
+        // A failing user rolls back the whole batch
+        std::vector<User> batch(3);
+        for (size_t i = 0; i < batch.size(); i++) {
+            batch[i].name = "Batch " + std::to_string(i);
+            batch[i].emergencyContacts.push_back(good);
+        }
+        batch[2].emergencyContacts.push_back(bad);
+        bool failingAdded = db.addUsers(batch);
+        assert(!failingAdded && "addUsers succeeded with a failing user");
+        assert(db.getAllUsers().empty() && "Failed batch partially committed");
+        
+        // And the connection is still usable afterwards
+        batch[2].emergencyContacts.pop_back();
+        bool batchAdded = db.addUsers(batch);
+        assert(batchAdded && "addUsers failed");
+        std::vector<User> users = db.getAllUsers();
+        assert(users.size() == 3 && "Batch not committed");
+        for (const auto& added : batch) {
+            assert(added.id > 0 && "Batch user has no ID");
+            assert(db.getEmergencyContacts(added.id).size() == 1 && "Batch contacts missing");
+        }
+        
+        bool doctorSet = db.setFamilyDoctor(batch[0].id, user.familyDoctor);
+        assert(doctorSet && "setFamilyDoctor failed");
+        assert(db.getFamilyDoctor(batch[0].id).name == "Dr. Partial" && "Doctor not stored");
+    }
+    
+    // A write that cannot begin its transaction runs nothing at all
+    {
+        UserDatabase::Options options;
+        options.busyTimeoutMs = 50;
+        UserDatabase db(path, options);
+        bool initialized = db.initialize();
+        assert(initialized && "Database initialization failed");
+        User existing = db.getAllUsers()[0];
+        
+        sqlite3* other = nullptr;
+        sqlite3_open(path.c_str(), &other);
+        int rc = sqlite3_exec(other, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr);
+        assert(rc == SQLITE_OK && "Could not take the write lock");
+        
+        uint64_t statementsBefore = db.getStatementCount();
+        User blocked;
+        blocked.name = "Blocked";
+        bool blockedAdded = db.addUser(blocked);
+        existing.notes = "Changed while locked";
+        bool updated = db.updateUser(existing);
+        uint64_t statements = db.getStatementCount() - statementsBefore;
+        sqlite3_exec(other, "ROLLBACK;", nullptr, nullptr, nullptr);
+        sqlite3_close(other);
+        
+        assert(!blockedAdded && !updated && "Write succeeded without its transaction");
+        assert(statements == 2 && "Statements ran after BEGIN failed");
+        assert(db.getAllUsers().size() == 3 && "Blocked user added");
+        assert(db.getUserById(existing.id).notes.empty() && "Blocked update applied");
+    }
+    
+    removeDatabaseFiles(path);
+    std::cout << "Transactional writes test completed successfully" << std::endl;
+}
+
+// Test function to verify CSV and JSON imports
+void test_import_users() {
+    std::cout << "Testing user import..." << std::endl;
+    
+    std::istringstream csv(
+        "name,notes,contact_name,contact_phone,contact_relationship,doctor_name\n"
+        "Alice Smith,Room 12,Bob Smith,555-0001,Son,Dr. Jones\n"
+        ",,Carol Smith,555-0002,Daughter,\n"
+        "\"Brown, Dave\",\"Prefers \"\"Davy\"\"\",,,,\n");
+    std::vector<User> users;
+    bool parsed = parseUsersCsv(csv, users);
+    assert(parsed && "CSV parse failed");
+    assert(users.size() == 2 && "Wrong number of CSV users");
+    assert(users[0].emergencyContacts.size() == 2 && "Continuation row not attached");
+    assert(users[0].emergencyContacts[1].relationship == "Daughter" && "Contact fields misread");
+    assert(users[0].familyDoctor.name == "Dr. Jones" && "Doctor not read");
+    assert(users[1].name == "Brown, Dave" && users[1].notes == "Prefers \"Davy\"" && "Quoted fields misread");
+    assert(users[1].emergencyContacts.empty() && "Empty contact columns added a contact");
+    
+    std::istringstream orphan("name,contact_name\n,Nobody\n");
+    std::vector<User> rejected;
+    bool orphanParsed = parseUsersCsv(orphan, rejected);
+    assert(!orphanParsed && "Contact without a resident accepted");
+    
+    const std::string jsonPath = "test_import_users.json";
+    {
+        std::ofstream file(jsonPath);
+        file << R"({"users": [
+            {"name": "Erin", "notes": "Room 3",
+             "emergency_contacts": [{"name": "Frank", "phone": "555-0003"}],
+             "family_doctor": {"name": "Dr. Grey", "phone": "555-0004"}},
+            {"name": "Hal"}
+        ]})";
+    }
+    
+    UserDatabase db(":memory:");
+    bool initialized = db.initialize();
+    assert(initialized && "Database initialization failed");
+    int importedCount = db.importUsers(jsonPath);
+    assert(importedCount == 2 && "JSON import failed");
+    int missingCount = db.importUsers("missing_users.json");
+    assert(missingCount == -1 && "Missing file imported");
+    
+    std::vector<User> imported = db.getAllUsers();
+    assert(imported.size() == 2 && "Wrong number of imported users");
+    assert(imported[0].emergencyContacts.size() == 1 && imported[0].familyDoctor.name == "Dr. Grey" &&
+           "Imported user incomplete");
+    
+    std::remove(jsonPath.c_str());
+    std::cout << "User import test completed successfully" << std::endl;
+}
+
+// Test function to verify contacts are addressed by stable IDs
+void test_contact_ids() {
+    std::cout << "Testing contact IDs..." << std::endl;
+    
+    const std::string path = "test_contact_ids.db";
+    removeDatabaseFiles(path);
+    
+    {
+        UserDatabase db(path);
+        bool initialized = db.initialize();
+        assert(initialized && "Database initialization failed");
+        
+        User user;
+        user.name = "Contact Owner";
+        for (int i = 0; i < 3; i++) {
+            EmergencyContact contact;
+            contact.name = "Contact " + std::to_string(i);
+            contact.phone = "555-020" + std::to_string(i);
+            user.emergencyContacts.push_back(contact);
+        }
+        bool added = db.addUser(user);
+        assert(added && "Failed to add user");
+        for (const auto& contact : user.emergencyContacts) {
+            assert(contact.id > 0 && "Contact ID not assigned");
+        }
+        
+        std::vector<EmergencyContact> contacts = db.getEmergencyContacts(user.id);
+        assert(contacts.size() == 3 && contacts[2].id == user.emergencyContacts[2].id && "Contact IDs not read back");
+        
+        // Removing an earlier contact shifts positions but not IDs
+        EmergencyContact target = contacts[2];
+        bool deleted = db.deleteEmergencyContact(contacts[0].id);
+        assert(deleted && "Failed to delete contact by ID");
+        target.phone = "555-0299";
+        bool updated = db.updateEmergencyContact(target);
+        assert(updated && "Failed to update contact by ID");
+        
+        contacts = db.getEmergencyContacts(user.id);
+        assert(contacts.size() == 2 && "Wrong contact deleted");
+        assert(contacts[1].id == target.id && contacts[1].phone == "555-0299" && "Wrong contact updated");
+        assert(db.getDirectory().findUser(user.id)->emergencyContacts[1].phone == "555-0299" &&
+               "Directory missed the update");
+        
+        bool unknownDeleted = db.deleteEmergencyContact(contacts[0].id + 1000);
+        assert(!unknownDeleted && "Unknown contact deleted");
+        EmergencyContact unknown;
+        unknown.id = 9999;
+        unknown.name = "Nobody";
+        bool unknownUpdated = db.updateEmergencyContact(unknown);
+        assert(!unknownUpdated && "Unknown contact updated");
+        
+        EmergencyContact extra;
+        extra.name = "Extra";
+        extra.phone = "555-0210";
+        bool contactAdded = db.addEmergencyContact(user.id, extra);
+        assert(contactAdded && extra.id > target.id && "addEmergencyContact did not set the ID");
+    }
+    
+    // Per-user lookups use the user_id indexes
+    sqlite3* raw = nullptr;
+    sqlite3_open(path.c_str(), &raw);
+    const char* queries[] = {
+        "EXPLAIN QUERY PLAN SELECT name FROM emergency_contacts WHERE user_id = 1;",
+        "EXPLAIN QUERY PLAN SELECT name FROM doctors WHERE user_id = 1;"
+    };
+    for (const char* query : queries) {
+        std::string plan;
+        sqlite3_exec(raw, query, [](void* out, int columns, char** values, char**) {
+            *static_cast<std::string*>(out) += values[columns - 1];
+            return 0;
+        }, &plan, nullptr);
+        assert(plan.find("USING INDEX") != std::string::npos && "user_id lookup does not use an index");
+    }
+    sqlite3_close(raw);
+    
+    removeDatabaseFiles(path);
+    std::cout << "Contact IDs test completed successfully" << std::endl;
+}
+
+void test_search_users() {
+    std::cout << "Testing user search..." << std::endl;
+    
+    const std::string path = "test_search_users.db";
+    removeDatabaseFiles(path);
+    
+    {
+        UserDatabase db(path);
+        bool initialized = db.initialize();
+        assert(initialized && "Database initialization failed");
+        
+        std::vector<User> users(3);
+        users[0].name = "Margaret O'Brien";
+        users[0].notes = "Room 12, uses a walker";
+        users[1].name = "Walter Smith";
+        users[1].notes = "Room 14";
+        users[2].name = "Agnes Smithers";
+        users[2].notes = "Room 20";
+        EmergencyContact contact;
+        contact.name = "Daniel Brien";
+        contact.phone = "(555) 012-3456";
+        users[1].emergencyContacts.push_back(contact);
+        users[2].familyDoctor.name = "Dr. Okafor";
+        users[2].familyDoctor.phone = "555-0300";
+        bool added = db.addUsers(users);
+        assert(added && "Failed to add users");
+        
+        // Prefix matching on names, with the name match ranked first
+        std::vector<User> results = db.searchUsers("bri", 10);
+        assert(results.size() == 2 && "Prefix search missed a user");
+        assert(results[0].id == users[0].id && "Name match not ranked first");
+        assert(results[1].id == users[1].id && "Contact name not searched");
+        
+        // Every word must match, in any column
+        results = db.searchUsers("smith room 2", 10);
+        assert(results.size() == 1 && results[0].id == users[2].id && "Multi-word search wrong");
+        
+        // Contact phones as written or as digits, and the doctor's name
+        results = db.searchUsers("012-34", 10);
+        assert(results.size() == 1 && results[0].id == users[1].id && "Formatted phone not searched");
+        results = db.searchUsers("5550123", 10);
+        assert(results.size() == 1 && results[0].id == users[1].id && "Phone digits not searched");
+        results = db.searchUsers("okaf", 10);
+        assert(results.size() == 1 && results[0].id == users[2].id && "Doctor not searched");
+        
+        // Query syntax in the input is treated as text
+        results = db.searchUsers("\"walker\" NOT", 10);
+        assert(results.empty() && "Query operators were interpreted");
+        results = db.searchUsers("o'brien", 10);
+        assert(results.size() == 1 && results[0].id == users[0].id && "Apostrophe broke the search");
+        
+        // Triggers keep the index in sync with updates and deletes
+        User renamed = users[1];
+        renamed.name = "Walter Jones";
+        bool updated = db.updateUser(renamed);
+        assert(updated && "Failed to update user");
+        results = db.searchUsers("smith", 10);
+        assert(results.size() == 1 && results[0].id == users[2].id && "Old name still indexed");
+        
+        bool deleted = db.deleteEmergencyContact(db.getEmergencyContacts(users[1].id)[0].id);
+        assert(deleted && "Failed to delete contact");
+        assert(db.searchUsers("daniel", 10).empty() && "Deleted contact still indexed");
+        
+        bool userDeleted = db.deleteUser(users[2].id);
+        assert(userDeleted && "Failed to delete user");
+        assert(db.searchUsers("okafor", 10).empty() && "Deleted user still indexed");
+        
+        // An empty query pages through everyone by name
+        results = db.searchUsers("", 1);
+        assert(results.size() == 1 && results[0].id == users[0].id && "First page wrong");
+        results = db.searchUsers("", 1, 1);
+        assert(results.size() == 1 && results[0].id == users[1].id && "Second page wrong");
+        assert(db.searchUsers("", 1, 2).empty() && "Page past the end not empty");
+        
+        // Single writes are indexed again after a batch, even an empty one
+        std::vector<User> none;
+        bool addedNone = db.addUsers(none);
+        assert(addedNone && "Empty batch failed");
+        User late;
+        late.name = "Late Arrival";
+        bool lateAdded = db.addUser(late);
+        assert(lateAdded && db.searchUsers("late", 10).size() == 1 && "Index left paused after a batch");
+    }
+    
+    removeDatabaseFiles(path);
+    std::cout << "User search test completed successfully" << std::endl;
+}
+
 int main() {
     std::cout << "Starting Database tests..." << std::endl;
     
@@ -172,6 +687,13 @@ int main() {
         test_user_crud();
         test_emergency_contacts();
         test_family_doctors();
+        test_get_all_users();
+        test_statement_cache();
+        test_reader_pool();
+        test_transactions();
+        test_import_users();
+        test_contact_ids();
+        test_search_users();
         
         std::cout << "All Database tests completed!" << std::endl;
         return 0;
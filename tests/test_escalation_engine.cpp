@@ -0,0 +1,223 @@
+#include "network/escalation_engine.hpp"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <set>
+
+using namespace hms;
+
+// Records what the engine asked for; residents listed in emptyTiers have
+// nobody in those tiers
+struct Recorder {
+    std::mutex mutex;
+    std::vector<EscalationEngine::Escalation> notified;
+    std::vector<EscalationEngine::Escalation> exhausted;
+    std::set<std::pair<int, size_t>> emptyTiers;   // (userId, tier)
+    
+    EscalationEngine::TierCallback tierCallback() {
+        return [this](const EscalationEngine::Escalation& escalation) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (emptyTiers.count(std::make_pair(escalation.userId, escalation.tier))) {
+                return false;
+            }
+            notified.push_back(escalation);
+            return true;
+        };
+    }
+    
+    EscalationEngine::ExhaustedCallback exhaustedCallback() {
+        return [this](const EscalationEngine::Escalation& escalation) {
+            std::lock_guard<std::mutex> lock(mutex);
+            exhausted.push_back(escalation);
+        };
+    }
+};
+
+static EscalationEngine::Options makeOptions() {
+    EscalationEngine::Options options;
+    options.tierTimeoutsMs = {1000, 2000, 3000};
+    options.tickMs = 100;
+    return options;
+}
+
+// Test function to verify timers fire on time, and cancelled ones never do
+void test_timer_wheel() {
+    std::cout << "Testing timer wheel..." << std::endl;
+    
+    TimerWheel wheel(100, 8, 0);
+    std::vector<uint64_t> fired;
+    
+    wheel.schedule(250, 1);
+    TimerWheel::TimerId cancelled = wheel.schedule(300, 2);
+    wheel.schedule(5000, 3);   // Several turns of the wheel away
+    wheel.schedule(150, 4);
+    assert(wheel.size() == 4 && "Wrong timer count");
+    
+    bool wasCancelled = wheel.cancel(cancelled);
+    assert(wasCancelled && "Timer not cancelled");
+    assert(!wheel.cancel(cancelled) && "Timer cancelled twice");
+    
+    wheel.advance(199, fired);
+    assert(fired.empty() && "Timer fired early");
+    wheel.advance(300, fired);
+    assert(fired.size() == 2 && fired[0] == 4 && fired[1] == 1 && "Timers not fired in order");
+    
+    // Passing its slot on earlier turns does not fire the far timer
+    fired.clear();
+    wheel.advance(1000, fired);
+    wheel.advance(4900, fired);
+    assert(fired.empty() && "Timer fired on an earlier turn of the wheel");
+    wheel.advance(5000, fired);
+    assert(fired.size() == 1 && fired[0] == 3 && "Far timer not fired");
+    assert(wheel.size() == 0 && "Fired timers still counted");
+    
+    // A reused node does not answer to the old id
+    TimerWheel::TimerId reused = wheel.schedule(6000, 5);
+    assert(!wheel.cancel(cancelled) && "Stale id cancelled a reused timer");
+    assert(wheel.cancel(reused) && "Reused timer not cancelled");
+    
+    // A time already passed fires at the next advance
+    wheel.schedule(10, 6);
+    fired.clear();
+    wheel.advance(5100, fired);
+    assert(fired.size() == 1 && fired[0] == 6 && "Overdue timer not fired");
+    
+    std::cout << "Timer wheel test completed successfully" << std::endl;
+}
+
+// Test function to verify an unanswered alert moves through every tier
+void test_tiers() {
+    std::cout << "Testing escalation tiers..." << std::endl;
+    
+    Recorder recorder;
+    EscalationEngine engine(makeOptions(), recorder.tierCallback(), recorder.exhaustedCallback());
+    
+    bool opened = engine.open(1, 7, 0);
+    assert(opened && "Escalation not opened");
+    assert(recorder.notified.size() == 1 && recorder.notified[0].tier == 0 && "First tier not notified");
+    bool reopened = engine.open(1, 7, 500);
+    assert(!reopened && "Second escalation opened for the same resident");
+    assert(engine.getTier(1, 7) == 0 && engine.getTier(1, 8) == -1 && "Wrong tier reported");
+    
+    engine.advance(999);
+    assert(recorder.notified.size() == 1 && "Escalated before the timeout");
+    engine.advance(1000);
+    assert(recorder.notified.size() == 2 && recorder.notified[1].tier == 1 && "Second tier not notified");
+    
+    engine.advance(2999);
+    assert(recorder.notified.size() == 2 && "Second tier's timeout not honoured");
+    engine.advance(3000);
+    assert(recorder.notified.size() == 3 && recorder.notified[2].tier == 2 && "Third tier not notified");
+    
+    engine.advance(6000);
+    assert(recorder.exhausted.size() == 1 && recorder.exhausted[0].userId == 1 && "Exhaustion not reported");
+    assert(engine.getOpenCount() == 0 && "Exhausted escalation still open");
+    
+    std::cout << "Escalation tier test completed successfully" << std::endl;
+}
+
+// Test function to verify responses cancel escalation and empty tiers are skipped
+void test_acknowledge_and_empty_tiers() {
+    std::cout << "Testing acknowledgement and empty tiers..." << std::endl;
+    
+    Recorder recorder;
+    recorder.emptyTiers = {{2, 1}, {3, 0}, {3, 1}, {3, 2}};
+    EscalationEngine engine(makeOptions(), recorder.tierCallback(), recorder.exhaustedCallback());
+    
+    engine.open(1, 1, 0);
+    engine.open(2, 1, 0);
+    bool acknowledged = engine.acknowledge(1, 1);
+    assert(acknowledged && "Open escalation not acknowledged");
+    assert(!engine.acknowledge(1, 1) && "Escalation acknowledged twice");
+    
+    // Resident 2 has no secondary tier, so the third follows the first
+    engine.advance(1000);
+    assert(recorder.notified.size() == 3 && recorder.notified[2].userId == 2 && recorder.notified[2].tier == 2 &&
+           "Empty tier not skipped");
+    
+    // Nobody to notify at all: exhausted at once
+    engine.open(3, 1, 1000);
+    assert(recorder.exhausted.size() == 1 && recorder.exhausted[0].userId == 3 && "Empty escalation not ended");
+    
+    // A new alert after a response starts from the first tier again
+    bool reopened = engine.open(1, 1, 2000);
+    assert(reopened && engine.getTier(1, 1) == 0 && "Escalation not reopened after a response");
+    
+    std::cout << "Acknowledgement test completed successfully" << std::endl;
+}
+
+// Test function to verify many open escalations at once
+void test_many_escalations() {
+    std::cout << "Testing many open escalations..." << std::endl;
+    
+    const int kResidents = 20000;
+    Recorder recorder;
+    EscalationEngine engine(makeOptions(), recorder.tierCallback(), recorder.exhaustedCallback());
+    
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kResidents; i++) {
+        engine.open(i, 1, i % 500);
+    }
+    for (int i = 0; i < kResidents; i += 2) {
+        engine.acknowledge(i, 1);
+    }
+    engine.advance(2000);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    
+    assert(recorder.notified.size() == kResidents + kResidents / 2 && "Wrong number of escalations");
+    assert(engine.getOpenCount() == kResidents / 2 && "Wrong number still open");
+    std::cout << "Opened, answered and escalated " << kResidents << " alerts in " << elapsed << " ms" << std::endl;
+    
+    std::cout << "Many escalations test completed successfully" << std::endl;
+}
+
+// Test function to verify the engine's own thread escalates on time
+void test_engine_thread() {
+    std::cout << "Testing escalation thread..." << std::endl;
+    
+    EscalationEngine::Options options;
+    options.tierTimeoutsMs = {50, 50};
+    options.tickMs = 10;
+    Recorder recorder;
+    EscalationEngine engine(options, recorder.tierCallback(), recorder.exhaustedCallback());
+    engine.start();
+    
+    int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    engine.open(1, 1, nowMs);
+    
+    bool done = false;
+    for (int i = 0; i < 200 && !done; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        std::lock_guard<std::mutex> lock(recorder.mutex);
+        done = !recorder.exhausted.empty();
+    }
+    engine.stop();
+    
+    assert(done && "Escalation thread did not escalate");
+    assert(recorder.notified.size() == 2 && "Not every tier notified");
+    
+    std::cout << "Escalation thread test completed successfully" << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Escalation Engine tests..." << std::endl;
+    
+    try {
+        test_timer_wheel();
+        test_tiers();
+        test_acknowledge_and_empty_tiers();
+        test_many_escalations();
+        test_engine_thread();
+        
+        std::cout << "All Escalation Engine tests completed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,173 @@
+#include "database/event_log.hpp"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <sstream>
+#include <filesystem>
+#include <sqlite3.h>
+
+using namespace hms;
+namespace fs = std::filesystem;
+
+static EventRecord makeEvent(EventType type, int64_t timestampMs, int userId) {
+    EventRecord event;
+    event.type = type;
+    event.timestampMs = timestampMs;
+    event.userId = userId;
+    event.trackId = 3;
+    event.subject = "Fall Detected";
+    return event;
+}
+
+static std::string makeTestDatabasePath() {
+    fs::path path = fs::temp_directory_path() / "hms_event_log_test.db";
+    fs::remove(path);
+    fs::remove(path.string() + "-wal");
+    fs::remove(path.string() + "-shm");
+    return path.string();
+}
+
+// Returns the query plan SQLite picks for a statement
+static std::string explainQueryPlan(const std::string& dbPath, const std::string& sql) {
+    sqlite3* db = nullptr;
+    sqlite3_open(dbPath.c_str(), &db);
+    
+    std::string plan;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, ("EXPLAIN QUERY PLAN " + sql).c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            plan += reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+            plan += "\n";
+        }
+        sqlite3_finalize(stmt);
+    }
+    sqlite3_close(db);
+    return plan;
+}
+
+// Test function to verify batched writes and the user/time range queries
+void test_event_queries() {
+    std::cout << "Testing event log queries..." << std::endl;
+    
+    std::string dbPath = makeTestDatabasePath();
+    
+    EventLog::Options options;
+    options.flushIntervalMs = 50;
+    options.retentionDays = 0;  // Test timestamps are far in the past
+    EventLog eventLog(dbPath, options);
+    bool initialized = eventLog.initialize();
+    assert(initialized && "Event log initialization failed");
+    
+    // User 1: a fall, a send and a response; user 2: an activity alert
+    eventLog.log(makeEvent(EventType::FALL_DETECTED, 1000, 1));
+    
+    EventRecord sent = makeEvent(EventType::NOTIFICATION_SENT, 1500, 1);
+    sent.status = "sent";
+    sent.recipient = "555-0100";
+    eventLog.log(sent);
+    
+    EventRecord alert = makeEvent(EventType::ACTIVITY_ALERT, 2000, 2);
+    alert.cameraIndex = 1;
+    alert.subject = "Night wandering";
+    eventLog.log(alert);
+    
+    EventRecord response = makeEvent(EventType::RESPONSE_RECEIVED, 3000, 1);
+    response.status = "responded";
+    response.detail = "On my way, ETA 10 minutes";
+    eventLog.log(response);
+    
+    eventLog.flush();
+    assert(eventLog.getWrittenCount() == 4 && "Not every event was written");
+    
+    auto userEvents = eventLog.getEventsByUser(1, 0, 10000);
+    assert(userEvents.size() == 3 && "Wrong number of events for user 1");
+    assert(userEvents[0].type == EventType::FALL_DETECTED && "Events not in time order");
+    assert(userEvents[1].recipient == "555-0100" && userEvents[1].status == "sent" && "Send not recorded");
+    assert(userEvents[2].detail == "On my way, ETA 10 minutes" && "Response text not recorded");
+    
+    // Ranges are half-open
+    auto ranged = eventLog.getEventsByUser(1, 1500, 3000);
+    assert(ranged.size() == 1 && ranged[0].type == EventType::NOTIFICATION_SENT && "Time range not applied");
+    
+    auto all = eventLog.getEvents(0, 10000);
+    assert(all.size() == 4 && "Wrong number of events overall");
+    assert(all[2].cameraIndex == 1 && all[2].subject == "Night wandering" && "Activity alert not recorded");
+    
+    // Both query shapes are served by an index ending in the timestamp
+    std::string userPlan = explainQueryPlan(dbPath,
+        "SELECT * FROM events WHERE user_id = 1 AND timestamp_ms >= 0 AND timestamp_ms < 10 "
+        "ORDER BY timestamp_ms, id;");
+    assert(userPlan.find("idx_events_user_time") != std::string::npos && "User query does not use its index");
+    assert(userPlan.find("TEMP B-TREE") == std::string::npos && "User query sorts its results");
+    
+    std::string timePlan = explainQueryPlan(dbPath,
+        "SELECT * FROM events WHERE timestamp_ms >= 0 AND timestamp_ms < 10 ORDER BY timestamp_ms, id;");
+    assert(timePlan.find("idx_events_time") != std::string::npos && "Time query does not use its index");
+    
+    eventLog.shutdown();
+    fs::remove(dbPath);
+    std::cout << "Event log query test completed successfully" << std::endl;
+}
+
+void test_event_persistence() {
+    std::cout << "Testing event log persistence..." << std::endl;
+    
+    std::string dbPath = makeTestDatabasePath();
+    
+    {
+        // A long interval: only the shutdown can have written this
+        EventLog::Options options;
+        options.flushIntervalMs = 60000;
+        options.retentionDays = 0;
+        EventLog eventLog(dbPath, options);
+        bool initialized = eventLog.initialize();
+        assert(initialized && "Event log initialization failed");
+        eventLog.log(makeEvent(EventType::NOTIFICATION_FAILED, 5000, 7));
+    }
+    
+    EventLog eventLog(dbPath);
+    bool reopened = eventLog.initialize();
+    assert(reopened && "Event log reopen failed");
+    auto events = eventLog.getEvents(0, 10000);
+    assert(events.size() == 1 && events[0].userId == 7 && "Event lost on shutdown");
+    assert(events[0].type == EventType::NOTIFICATION_FAILED && "Event type not restored");
+    
+    eventLog.shutdown();
+    fs::remove(dbPath);
+    std::cout << "Event log persistence test completed successfully" << std::endl;
+}
+
+void test_events_csv() {
+    std::cout << "Testing event CSV export..." << std::endl;
+    
+    EventRecord response = makeEvent(EventType::RESPONSE_RECEIVED, 3000, 1);
+    response.id = 4;
+    response.status = "responded";
+    response.detail = "Coming now, \"front\" door";
+    
+    std::ostringstream out;
+    writeEventsCsv(out, {response});
+    
+    std::string expected = "id,timestamp_ms,type,camera,track_id,user_id,status,recipient,subject,detail\n"
+                           "4,3000,response_received,-1,3,1,responded,,Fall Detected,"
+                           "\"Coming now, \"\"front\"\" door\"\n";
+    assert(out.str() == expected && "CSV export does not match");
+    
+    std::cout << "Event CSV export test completed successfully" << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Event Log tests..." << std::endl;
+    
+    try {
+        test_event_queries();
+        test_event_persistence();
+        test_events_csv();
+        
+        std::cout << "All Event Log tests completed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,112 @@
+#include "core/frame_pool.hpp"
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+using namespace hms;
+
+// Test function to verify released buffers are reused rather than reallocated
+void test_buffers_reused() {
+    std::cout << "Testing buffer reuse..." << std::endl;
+    
+    FramePool pool(4);
+    const unsigned char* first = nullptr;
+    for (int i = 0; i < 100; i++) {
+        FramePool::Handle frame = pool.acquire(480, 640, CV_8UC3);
+        assert(frame->rows == 480 && frame->cols == 640 && frame->type() == CV_8UC3 && "Wrong buffer shape");
+        if (!first) {
+            first = frame->data;
+        }
+        assert(frame->data == first && "Buffer not reused");
+        frame->setTo(cv::Scalar(i, i, i));
+    }
+    assert(pool.getAllocationCount() == 1 && "Buffers reallocated");
+    assert(pool.getIdleCount() == 1 && "Buffer not returned");
+    
+    // A new size reallocates the recycled buffer once
+    FramePool::Handle larger = pool.acquire(720, 1280, CV_8UC3);
+    assert(larger->rows == 720 && larger->cols == 1280 && "Buffer not resized");
+    assert(pool.getAllocationCount() == 2 && "Resize not counted");
+    
+    std::cout << "Buffer reuse test completed successfully" << std::endl;
+}
+
+// Test function to verify buffers held by viewers are not handed out again
+void test_held_buffers_not_reused() {
+    std::cout << "Testing held buffers..." << std::endl;
+    
+    FramePool pool(4);
+    FramePool::Handle shown = pool.acquire(240, 320, CV_8UC3);
+    shown->setTo(cv::Scalar(1, 2, 3));
+    FrameHandle viewer = shown;
+    shown.reset();
+    
+    FramePool::Handle next = pool.acquire(240, 320, CV_8UC3);
+    assert(next->data != viewer->data && "Buffer in use handed out");
+    next->setTo(cv::Scalar(9, 9, 9));
+    assert(viewer->at<cv::Vec3b>(0, 0) == cv::Vec3b(1, 2, 3) && "Viewer's frame overwritten");
+    
+    // Pixels still referenced by a plain cv::Mat are left to it
+    cv::Mat copy = *next;
+    const unsigned char* pixels = next->data;
+    next.reset();
+    FramePool::Handle after = pool.acquire(240, 320, CV_8UC3);
+    assert(after->data != pixels && "Pixels shared with a cv::Mat reused");
+    assert(copy.at<cv::Vec3b>(0, 0) == cv::Vec3b(9, 9, 9) && "Shared pixels overwritten");
+    
+    std::cout << "Held buffer test completed successfully" << std::endl;
+}
+
+// Test function to verify the idle limit and handles outliving the pool
+void test_limits_and_lifetime() {
+    std::cout << "Testing idle limit and lifetime..." << std::endl;
+    
+    FrameHandle survivor;
+    {
+        FramePool pool(2);
+        std::vector<FramePool::Handle> frames;
+        for (int i = 0; i < 5; i++) {
+            frames.push_back(pool.acquire(120, 160, CV_8UC3));
+        }
+        survivor = frames[0];
+        frames.clear();
+        assert(pool.getIdleCount() <= 2 && "Idle limit exceeded");
+    }
+    assert(survivor->rows == 120 && "Handle broken by pool destruction");
+    survivor.reset();
+    
+    // Released from other threads, as the GUI does
+    FramePool pool(8);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&pool] {
+            for (int i = 0; i < 1000; i++) {
+                FramePool::Handle frame = pool.acquire(60, 80, CV_8UC3);
+                frame->setTo(cv::Scalar(i % 256));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(pool.getAllocationCount() <= 4 && "Buffers not recycled across threads");
+    
+    std::cout << "Idle limit and lifetime test completed successfully" << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Frame Pool tests..." << std::endl;
+    
+    try {
+        test_buffers_reused();
+        test_held_buffers_not_reused();
+        test_limits_and_lifetime();
+        
+        std::cout << "All Frame Pool tests completed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,214 @@
+#include "ui/frame_renderer.hpp"
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <thread>
+
+using namespace hms;
+
+// Keeps the images a renderer hands over, as the GUI thread would
+class ImageSink {
+public:
+    FrameRenderer::ImageCallback callback() {
+        return [this](size_t cameraIndex, const QImage& image) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_cameras.push_back(cameraIndex);
+                m_images.push_back(image);
+            }
+            m_cv.notify_all();
+        };
+    }
+    
+    // Waits until count images have arrived in all; false on timeout
+    bool waitFor(size_t count, int timeoutMs = 5000) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_cv.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                             [this, count] { return m_images.size() >= count; });
+    }
+    
+    QImage image(size_t index) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_images[index];
+    }
+    
+    size_t camera(size_t index) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_cameras[index];
+    }
+    
+    size_t count() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_images.size();
+    }
+    
+    // Drops the sink's copies, so only the caller's keep their pixels alive
+    void clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& image : m_images) {
+            image = QImage();
+        }
+    }
+    
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<size_t> m_cameras;
+    std::vector<QImage> m_images;
+};
+
+static FrameHandle makeFrame(int rows, int cols, int type) {
+    return std::make_shared<cv::Mat>(rows, cols, type, cv::Scalar::all(128));
+}
+
+// The renderer drops its own copy of an image just after handing it over
+static bool waitForUseCount(const FrameHandle& frame, long count) {
+    for (int i = 0; i < 1000 && frame.use_count() != count; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return frame.use_count() == count;
+}
+
+// Test function to verify images fit the view in device pixels, keeping the frame's shape
+void test_aspect_fit() {
+    std::cout << "Testing aspect-fit sizing..." << std::endl;
+    
+    ImageSink sink;
+    FrameRenderer renderer(sink.callback());
+    renderer.start();
+    
+    // Nothing is rendered until the view has a size
+    renderer.submit(2, makeFrame(480, 640, CV_8UC3));
+    renderer.setTargetSize(QSize(320, 320), 1.0);
+    bool rendered = sink.waitFor(1);
+    assert(rendered && "Frame not rendered");
+    QImage image = sink.image(0);
+    assert(sink.camera(0) == 2 && "Wrong camera reported");
+    assert(image.width() == 320 && image.height() == 240 && "Frame not fitted to the view");
+    assert(image.format() == QImage::Format_BGR888 && "Colour frame not kept in BGR order");
+    
+    // On a high-density screen the image has the view's size in device pixels
+    renderer.setTargetSize(QSize(160, 160), 2.0);
+    rendered = sink.waitFor(2);
+    assert(rendered && "Frame not rendered for the new pixel ratio");
+    image = sink.image(1);
+    assert(image.width() == 320 && image.height() == 240 && image.devicePixelRatio() == 2.0 &&
+           "Frame not fitted in device pixels");
+    
+    // Grayscale frames are wrapped as they are, tall ones fit the height
+    renderer.submit(0, makeFrame(400, 100, CV_8UC1));
+    rendered = sink.waitFor(3);
+    assert(rendered && "Grayscale frame not rendered");
+    image = sink.image(2);
+    assert(image.format() == QImage::Format_Grayscale8 && "Wrong grayscale format");
+    assert(image.width() == 80 && image.height() == 320 && "Tall frame not fitted to the height");
+    
+    renderer.stop();
+    std::cout << "Aspect-fit sizing test completed successfully" << std::endl;
+}
+
+// Test function to verify an image keeps its pixels until Qt drops its last copy
+void test_pixels_released_with_image() {
+    std::cout << "Testing pixel lifetime..." << std::endl;
+    
+    ImageSink sink;
+    FrameRenderer renderer(sink.callback());
+    renderer.setTargetSize(QSize(320, 240), 1.0);
+    renderer.start();
+    
+    // A frame that already fits is shown without a copy
+    FrameHandle frame = makeFrame(240, 320, CV_8UC3);
+    renderer.submit(0, frame);
+    bool rendered = sink.waitFor(1);
+    assert(rendered && "Frame not rendered");
+    QImage shown = sink.image(0);
+    sink.clear();
+    assert(shown.constBits() == frame->data && "Fitting frame copied");
+    
+    // Held here, as the renderer's last frame and by the image
+    bool heldByImage = frame.use_count() == 3;
+    assert(heldByImage && "Image does not hold its frame");
+    shown = QImage();
+    bool released = waitForUseCount(frame, 2);
+    assert(released && "Frame not released with its image");
+    
+    // A scaled image's buffer goes back to the pool once the image is gone,
+    // and only then
+    FrameHandle large = makeFrame(480, 640, CV_8UC3);
+    renderer.submit(0, large);
+    rendered = sink.waitFor(2);
+    assert(rendered && "Large frame not rendered");
+    QImage first = sink.image(1);
+    sink.clear();
+    const uchar* firstPixels = first.constBits();
+    assert(first.width() == 320 && firstPixels != large->data && "Large frame not scaled");
+    
+    renderer.submit(0, large);
+    rendered = sink.waitFor(3);
+    assert(rendered && "Second frame not rendered");
+    QImage second = sink.image(2);
+    sink.clear();
+    const uchar* secondPixels = second.constBits();
+    assert(secondPixels != firstPixels && "Buffer of an image still shown was reused");
+    
+    first = QImage();
+    second = QImage();
+    renderer.submit(0, large);
+    rendered = sink.waitFor(4);
+    assert(rendered && "Third frame not rendered");
+    QImage third = sink.image(3);
+    sink.clear();
+    assert((third.constBits() == firstPixels || third.constBits() == secondPixels) &&
+           "Released buffer not reused");
+    
+    renderer.stop();
+    std::cout << "Pixel lifetime test completed successfully" << std::endl;
+}
+
+// Test function to verify a resize renders the last frame again
+void test_rerender_on_resize() {
+    std::cout << "Testing re-render on resize..." << std::endl;
+    
+    ImageSink sink;
+    FrameRenderer renderer(sink.callback());
+    renderer.setTargetSize(QSize(320, 240), 1.0);
+    renderer.start();
+    
+    renderer.submit(1, makeFrame(480, 640, CV_8UC3));
+    bool rendered = sink.waitFor(1);
+    assert(rendered && "Frame not rendered");
+    
+    renderer.setTargetSize(QSize(160, 160), 1.0);
+    rendered = sink.waitFor(2);
+    assert(rendered && "Frame not rendered again on resize");
+    QImage resized = sink.image(1);
+    assert(sink.camera(1) == 1 && resized.width() == 160 && resized.height() == 120 &&
+           "Frame not rendered at the new size");
+    
+    // The same size again changes nothing
+    renderer.setTargetSize(QSize(160, 160), 1.0);
+    bool renderedAgain = sink.waitFor(3, 100);
+    assert(!renderedAgain && sink.count() == 2 && "Unchanged size rendered again");
+    
+    renderer.stop();
+    std::cout << "Re-render on resize test completed successfully" << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Frame Renderer tests..." << std::endl;
+    
+    try {
+        test_aspect_fit();
+        test_pixels_released_with_image();
+        test_rerender_on_resize();
+        
+        std::cout << "All Frame Renderer tests completed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
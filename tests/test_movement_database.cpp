@@ -0,0 +1,152 @@
+#include "database/movement_database.hpp"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <filesystem>
+#include <sqlite3.h>
+
+using namespace hms;
+namespace fs = std::filesystem;
+
+static MovementSample makeSample(int64_t timestampMs, int trackId, int userId) {
+    MovementSample sample;
+    sample.timestampMs = timestampMs;
+    sample.trackId = trackId;
+    sample.userId = userId;
+    sample.box = cv::Rect(10, 20, 30, 40);
+    return sample;
+}
+
+static std::string makeTestDatabasePath() {
+    fs::path path = fs::temp_directory_path() / "hms_movement_test.db";
+    fs::remove(path);
+    fs::remove(path.string() + "-wal");
+    fs::remove(path.string() + "-shm");
+    return path.string();
+}
+
+// Returns the query plan SQLite picks for a statement
+static std::string explainQueryPlan(const std::string& dbPath, const std::string& sql) {
+    sqlite3* db = nullptr;
+    sqlite3_open(dbPath.c_str(), &db);
+    
+    std::string plan;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, ("EXPLAIN QUERY PLAN " + sql).c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            plan += reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+            plan += "\n";
+        }
+        sqlite3_finalize(stmt);
+    }
+    sqlite3_close(db);
+    return plan;
+}
+
+// Test function to verify batched writes and the query API
+void test_movement_queries() {
+    std::cout << "Testing movement database queries..." << std::endl;
+    
+    std::string dbPath = makeTestDatabasePath();
+    
+    MovementDatabase::Options options;
+    options.flushIntervalMs = 50;
+    options.retentionDays = 0;  // Test timestamps are far in the past
+    MovementDatabase db(dbPath, options);
+    bool initialized = db.initialize();
+    assert(initialized && "Movement database initialization failed");
+    
+    // Camera 0: track 1 (unknown user), track 2 (user 5); camera 1: track 3 (user 5)
+    std::vector<MovementSample> camera0;
+    std::vector<MovementSample> camera1;
+    for (int i = 0; i < 100; i++) {
+        camera0.push_back(makeSample(1000 + i * 10, 1, -1));
+        camera0.push_back(makeSample(1000 + i * 10, 2, 5));
+        camera1.push_back(makeSample(1000 + i * 10, 3, 5));
+    }
+    bool queued = db.addSamples(0, camera0) && db.addSamples(1, camera1);
+    assert(queued && "Failed to queue samples");
+    
+    db.flush();
+    assert(db.getWrittenCount() == 300 && "Not every sample was written");
+    
+    auto byCamera = db.getMovementsByCamera(0, 1000, 1500);
+    assert(byCamera.size() == 100 && "Camera query returned wrong rows");
+    for (size_t i = 1; i < byCamera.size(); i++) {
+        assert(byCamera[i - 1].sample.timestampMs <= byCamera[i].sample.timestampMs &&
+               "Camera query not ordered by time");
+    }
+    
+    auto byTrack = db.getMovementsByTrack(0, 2, 0, 10000);
+    assert(byTrack.size() == 100 && byTrack.front().sample.userId == 5 && "Track query returned wrong rows");
+    assert(byTrack.front().sample.box == cv::Rect(10, 20, 30, 40) && "Box not stored");
+    
+    auto byUser = db.getMovementsByUser(5, 1000, 1100);
+    assert(byUser.size() == 20 && "User query returned wrong rows");
+    bool sawCamera1 = false;
+    for (const auto& record : byUser) {
+        sawCamera1 = sawCamera1 || record.cameraIndex == 1;
+    }
+    assert(sawCamera1 && "User query should span cameras");
+    
+    db.shutdown();
+    
+    // Each query shape is served by an index
+    assert(explainQueryPlan(dbPath, "SELECT * FROM movement_samples WHERE camera = 0 AND "
+                                    "timestamp_ms >= 0 AND timestamp_ms < 1 ORDER BY timestamp_ms")
+               .find("idx_movement_camera_time") != std::string::npos && "Camera query not indexed");
+    assert(explainQueryPlan(dbPath, "SELECT * FROM movement_samples WHERE camera = 0 AND track_id = 1 AND "
+                                    "timestamp_ms >= 0 AND timestamp_ms < 1 ORDER BY timestamp_ms")
+               .find("idx_movement_track_time") != std::string::npos && "Track query not indexed");
+    assert(explainQueryPlan(dbPath, "SELECT * FROM movement_samples WHERE user_id = 5 AND "
+                                    "timestamp_ms >= 0 AND timestamp_ms < 1 ORDER BY timestamp_ms")
+               .find("idx_movement_user_time") != std::string::npos && "User query not indexed");
+    assert(explainQueryPlan(dbPath, "SELECT * FROM movement_samples WHERE timestamp_ms >= 0 "
+                                    "ORDER BY timestamp_ms")
+               .find("idx_movement_time") != std::string::npos && "Reload query not indexed");
+    
+    std::cout << "Movement database query test completed successfully" << std::endl;
+}
+
+// Test function to verify queued samples survive a shutdown and restart
+void test_movement_persistence() {
+    std::cout << "Testing movement database persistence..." << std::endl;
+    
+    std::string dbPath = makeTestDatabasePath();
+    
+    {
+        // A long interval: only the shutdown can have written these
+        MovementDatabase::Options options;
+        options.flushIntervalMs = 60000;
+        options.retentionDays = 0;
+        MovementDatabase db(dbPath, options);
+        bool initialized = db.initialize();
+        assert(initialized && "Movement database initialization failed");
+        db.addSamples(2, {makeSample(5000, 9, -1), makeSample(6000, 9, -1)});
+    }
+    
+    MovementDatabase db(dbPath);
+    bool reopened = db.initialize();
+    assert(reopened && "Movement database reopen failed");
+    auto records = db.getMovementsSince(0);
+    assert(records.size() == 2 && records[0].cameraIndex == 2 && "Samples lost on shutdown");
+    
+    db.shutdown();
+    fs::remove(dbPath);
+    std::cout << "Movement database persistence test completed successfully" << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Movement Database tests..." << std::endl;
+    
+    try {
+        test_movement_queries();
+        test_movement_persistence();
+        
+        std::cout << "All Movement Database tests completed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,91 @@
+#include "analytics/movement_store.hpp"
+#include <iostream>
+#include <cassert>
+#include <opencv2/opencv.hpp>
+
+using namespace hms;
+
+static MovementSample makeSample(int64_t timestampMs, int trackId, int x, int y) {
+    MovementSample sample;
+    sample.timestampMs = timestampMs;
+    sample.trackId = trackId;
+    sample.userId = -1;
+    sample.box = cv::Rect(x, y, 80, 200);
+    return sample;
+}
+
+// Test function to verify samples survive chunk encoding unchanged
+void test_round_trip() {
+    std::cout << "Testing movement store round trip..." << std::endl;
+    
+    MovementStore::Options options;
+    options.chunkDurationMs = 1000;
+    options.maxChunkSamples = 16;
+    MovementStore store(options);
+    
+    // Boxes move back and forth so deltas are both positive and negative
+    for (int i = 0; i < 200; i++) {
+        int x = 300 + ((i % 20) < 10 ? i % 20 : 20 - i % 20) * 7;
+        store.append(0, makeSample(1700000000000LL + i * 33, i % 3, x, 150 - i % 5));
+    }
+    
+    auto samples = store.query(0, 0, INT64_MAX);
+    assert(samples.size() == 200 && "Samples were lost");
+    for (int i = 0; i < 200; i++) {
+        int x = 300 + ((i % 20) < 10 ? i % 20 : 20 - i % 20) * 7;
+        assert(samples[i].timestampMs == 1700000000000LL + i * 33 && "Timestamp changed");
+        assert(samples[i].trackId == i % 3 && "Track ID changed");
+        assert(samples[i].userId == -1 && "User ID changed");
+        assert(samples[i].box == cv::Rect(x, 150 - i % 5, 80, 200) && "Box changed");
+    }
+    
+    auto track = store.queryTrack(0, 1, 1700000000000LL, 1700000000000LL + 990);
+    assert(track.size() == 10 && "Track query returned wrong samples");
+    
+    assert(store.query(1, 0, INT64_MAX).empty() && "Unknown camera should be empty");
+    
+    std::cout << "Movement store round trip test completed successfully" << std::endl;
+}
+
+// Test function to verify expiry drops whole chunks only
+void test_expiry() {
+    std::cout << "Testing movement store expiry..." << std::endl;
+    
+    MovementStore::Options options;
+    options.chunkDurationMs = 1000;
+    MovementStore store(options);
+    
+    for (int i = 0; i < 100; i++) {
+        store.append(0, makeSample(i * 100, 1, i, i));
+        store.append(1, makeSample(i * 100, 2, i, i));
+    }
+    assert(store.getChunkCount() == 20 && "Expected one chunk per second per camera");
+    
+    // 4500 falls inside the fifth chunk, which must be kept whole
+    store.expireBefore(4500);
+    assert(store.getChunkCount() == 12 && "Wrong chunks expired");
+    assert(store.getSampleCount() == 120 && "Sample count not updated");
+    
+    auto samples = store.query(0, 0, INT64_MAX);
+    assert(samples.size() == 60 && samples.front().timestampMs == 4000 && "Wrong samples kept");
+    
+    store.expireBefore(100000);
+    assert(store.getSampleCount() == 0 && store.getChunkCount() == 0 && "Store should be empty");
+    
+    std::cout << "Movement store expiry test completed successfully" << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Movement Store tests..." << std::endl;
+    
+    try {
+        test_round_trip();
+        test_expiry();
+        
+        std::cout << "All Movement Store tests completed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -5,6 +5,13 @@
 #include <string>
 #include <nlohmann/json.hpp>
 #include <memory>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <sqlite3.h>
 
 using namespace hms;
 using json = nlohmann::json;
@@ -33,6 +40,55 @@ private:
     json m_config;
 };
 
+// An SMS channel that takes a while over each send, one at a time
+class SlowChannel : public NotificationChannel {
+public:
+    explicit SlowChannel(int sendMs)
+        : NotificationChannel("sms", 1), m_sendMs(sendMs) {
+    }
+    
+    ~SlowChannel() override {
+        join();
+    }
+    
+    std::map<std::string, int> getSendsByRecipient() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_sends;
+    }
+    
+    void join() {
+        std::vector<std::thread> workers;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            workers.swap(m_workers);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    
+protected:
+    void deliver(const ChannelMessage& message, Callback done) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_workers.emplace_back([this, recipient = message.recipient, done] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(m_sendMs));
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_sends[recipient]++;
+            }
+            TransportResult result;
+            result.success = true;
+            done(result);
+        });
+    }
+    
+private:
+    int m_sendMs;
+    std::mutex m_mutex;
+    std::map<std::string, int> m_sends;
+    std::vector<std::thread> m_workers;
+};
+
 // Test function to verify notification manager initialization
 void test_notification_manager_init() {
     std::cout << "Testing NotificationManager initialization..." << std::endl;
@@ -210,6 +266,245 @@ void test_fall_event_notification() {
     }
 }
 
+// Test function to verify replies match open alerts only
+void test_reply_matching() {
+    std::cout << "Testing reply matching..." << std::endl;
+    
+    const std::string outboxPath = "test_reply_matching_outbox.db";
+    std::remove(outboxPath.c_str());
+    
+    UserDatabase db(":memory:");
+    bool initialized = db.initialize();
+    assert(initialized && "Database initialization failed");
+    User ann;
+    ann.name = "Ann";
+    EmergencyContact nurse;
+    nurse.name = "Nurse";
+    nurse.phone = "+15550100";
+    ann.emergencyContacts.push_back(nurse);
+    User ben = ann;
+    ben.name = "Ben";
+    ben.emergencyContacts[0].phone = "+15550111";
+    bool added = db.addUser(ann) && db.addUser(ben);
+    assert(added && "Failed to add users");
+    
+    // Ben has nobody past his primary contact, so his alert runs out after one tier
+    EscalationEngine::Options escalation;
+    escalation.tierTimeoutsMs = {200, 200, 200};
+    escalation.tickMs = 10;
+    auto sms = std::make_shared<CaptureChannel>("sms");
+    {
+        NotificationManager manager(&db, outboxPath, NotificationOutbox::Options(), NotificationCoalescer::Options(),
+                                    escalation);
+        manager.setChannel(OutboxChannel::SMS, sms);
+        manager.setChannel(OutboxChannel::EMAIL, nullptr);
+        manager.initialize();
+        
+        hms::FallEvent fallEvent;
+        fallEvent.personId = 1;
+        manager.notifyFallEvent(fallEvent, ann.id);
+        manager.notifyFallEvent(fallEvent, ben.id);
+        for (int i = 0; i < 100 && sms->getMessages().size() < 2; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        assert(sms->getMessages().size() == 2 && "Alerts not sent");
+        
+        // Once answered, the number matches nothing more
+        bool matched = manager.recordSmsReply("+1 555 0100", "On my way");
+        assert(matched && manager.hasResponse(ann.id, 1) && "Reply not matched to its alert");
+        bool matchedAgain = manager.recordSmsReply("+15550100", "Still on my way");
+        assert(!matchedAgain && "Answered alert still matched");
+        
+        // An unanswered alert matches until its escalation has run out
+        bool reported = manager.recordDeliveryReport("+15550111", "delivered");
+        assert(reported && "Delivery report not matched to its alert");
+        std::this_thread::sleep_for(std::chrono::milliseconds(600));
+        bool reportedLate = manager.recordDeliveryReport("+15550111", "delivered");
+        assert(!reportedLate && "Closed alert still matched");
+        
+        manager.shutdown();
+    }
+    
+    std::remove(outboxPath.c_str());
+    std::cout << "Reply matching test completed successfully" << std::endl;
+}
+
+// Test function to verify a later tier that reaches nobody does not fail a sent alert
+void test_escalation_keeps_sent_status() {
+    std::cout << "Testing status across escalation tiers..." << std::endl;
+    
+    const std::string outboxPath = "test_escalation_status_outbox.db";
+    std::remove(outboxPath.c_str());
+    
+    UserDatabase db(":memory:");
+    bool initialized = db.initialize();
+    assert(initialized && "Database initialization failed");
+    User ann;
+    ann.name = "Ann";
+    EmergencyContact nurse;
+    nurse.name = "Nurse";
+    nurse.phone = "+15550100";
+    ann.emergencyContacts.push_back(nurse);
+    ann.familyDoctor.name = "Dr Smith";
+    ann.familyDoctor.phone = "+15550199";
+    bool added = db.addUser(ann);
+    assert(added && "Failed to add user");
+    
+    // Ann has nobody in the secondary tier, so the doctor follows the nurse
+    EscalationEngine::Options escalation;
+    escalation.tierTimeoutsMs = {100, 100, 1000};
+    escalation.tickMs = 10;
+    auto sms = std::make_shared<CaptureChannel>("sms");
+    {
+        NotificationManager manager(&db, outboxPath, NotificationOutbox::Options(), NotificationCoalescer::Options(),
+                                    escalation);
+        manager.setChannel(OutboxChannel::SMS, sms);
+        manager.setChannel(OutboxChannel::EMAIL, nullptr);
+        manager.initialize();
+        
+        hms::FallEvent fallEvent;
+        fallEvent.personId = 1;
+        manager.notifyFallEvent(fallEvent, ann.id);
+        for (int i = 0; i < 100 && manager.getLatestResponse(ann.id, 1).status != NotificationStatus::SENT; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        bool delivered = manager.recordDeliveryReport("+15550100", "delivered");
+        assert(delivered && "Delivery report not matched to its alert");
+        
+        // The doctor's send does not count as reaching a contact
+        for (int i = 0; i < 100 && sms->getMessages().size() < 2; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        std::vector<ChannelMessage> messages = sms->getMessages();
+        assert(messages.size() == 2 && messages[1].recipient == "+15550199" && "Doctor not alerted");
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        
+        NotificationStatus status = manager.getLatestResponse(ann.id, 1).status;
+        assert(status == NotificationStatus::DELIVERED && "Doctor tier overwrote the delivered status");
+        
+        manager.shutdown();
+    }
+    
+    std::remove(outboxPath.c_str());
+    std::cout << "Status across escalation tiers test completed successfully" << std::endl;
+}
+
+// Test function to verify an alert the outbox could not store is stored later and sent
+void test_outbox_write_retried() {
+    std::cout << "Testing outbox write retry..." << std::endl;
+    
+    const std::string outboxPath = "test_outbox_retry_outbox.db";
+    std::remove(outboxPath.c_str());
+    
+    UserDatabase db(":memory:");
+    bool initialized = db.initialize();
+    assert(initialized && "Database initialization failed");
+    User ann;
+    ann.name = "Ann";
+    EmergencyContact nurse;
+    nurse.name = "Nurse";
+    nurse.phone = "+15550100";
+    ann.emergencyContacts.push_back(nurse);
+    bool added = db.addUser(ann);
+    assert(added && "Failed to add user");
+    
+    auto sms = std::make_shared<CaptureChannel>("sms");
+    {
+        NotificationManager manager(&db, outboxPath);
+        manager.setChannel(OutboxChannel::SMS, sms);
+        manager.setChannel(OutboxChannel::EMAIL, nullptr);
+        manager.initialize();
+        
+        // Another connection holds the write lock, so storing the alert fails
+        sqlite3* blocker = nullptr;
+        int rc = sqlite3_open(outboxPath.c_str(), &blocker);
+        assert(rc == SQLITE_OK && "Cannot open outbox");
+        rc = sqlite3_exec(blocker, "BEGIN EXCLUSIVE;", nullptr, nullptr, nullptr);
+        assert(rc == SQLITE_OK && "Cannot lock outbox");
+        
+        hms::FallEvent fallEvent;
+        fallEvent.personId = 1;
+        manager.notifyFallEvent(fallEvent, ann.id);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+        assert(sms->getMessages().empty() && "Alert sent without being stored");
+        
+        sqlite3_exec(blocker, "ROLLBACK;", nullptr, nullptr, nullptr);
+        sqlite3_close(blocker);
+        for (int i = 0; i < 300 && sms->getMessages().empty(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        std::vector<ChannelMessage> messages = sms->getMessages();
+        assert(messages.size() == 1 && messages[0].recipient == "+15550100" && "Alert lost to a failed write");
+        
+        manager.shutdown();
+    }
+    
+    std::remove(outboxPath.c_str());
+    std::cout << "Outbox write retry test completed successfully" << std::endl;
+}
+
+// Test function to verify a slow channel's backlog is not sent twice
+void test_slow_channel() {
+    std::cout << "Testing slow channel..." << std::endl;
+    
+    const std::string outboxPath = "test_slow_channel_outbox.db";
+    std::remove(outboxPath.c_str());
+    
+    const int kResidents = 10;
+    UserDatabase db(":memory:");
+    bool initialized = db.initialize();
+    assert(initialized && "Database initialization failed");
+    std::vector<int> userIds;
+    for (int i = 0; i < kResidents; i++) {
+        User user;
+        user.name = "Resident " + std::to_string(i);
+        EmergencyContact contact;
+        contact.name = "Contact " + std::to_string(i);
+        contact.phone = "+1555010" + std::to_string(i);
+        user.emergencyContacts.push_back(contact);
+        bool added = db.addUser(user);
+        assert(added && "Failed to add user");
+        userIds.push_back(user.id);
+    }
+    
+    // Sending every alert takes three times the lease, so a send claimed
+    // long before the channel could start it would be claimed again
+    NotificationOutbox::Options outbox;
+    outbox.leaseMs = 300;
+    auto sms = std::make_shared<SlowChannel>(90);
+    {
+        NotificationManager manager(&db, outboxPath, outbox);
+        manager.setChannel(OutboxChannel::SMS, sms);
+        manager.setChannel(OutboxChannel::EMAIL, nullptr);
+        manager.initialize();
+        
+        hms::FallEvent fallEvent;
+        fallEvent.personId = 1;
+        for (int userId : userIds) {
+            manager.notifyFallEvent(fallEvent, userId);
+        }
+        for (int i = 0; i < 300 && sms->getSendsByRecipient().size() < kResidents; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(400));
+        
+        std::map<std::string, int> sends = sms->getSendsByRecipient();
+        assert(sends.size() == kResidents && "Alerts not sent");
+        for (const auto& recipient : sends) {
+            assert(recipient.second == 1 && "Alert sent more than once");
+        }
+        // Nor claimed again while it waited, only to be held as its own repeat
+        NotificationCoalescer::Stats stats = manager.getDeliveryStats();
+        assert(stats.sends == kResidents && stats.suppressed == 0 && "Queued send claimed again");
+        
+        manager.shutdown();
+        sms->join();
+    }
+    
+    std::remove(outboxPath.c_str());
+    std::cout << "Slow channel test completed successfully" << std::endl;
+}
+
 int main() {
     std::cout << "Starting Notification Manager tests..." << std::endl;
     
@@ -218,6 +513,10 @@ int main() {
         test_sms_notification();
         test_email_notification();
         test_fall_event_notification();
+        test_reply_matching();
+        test_escalation_keeps_sent_status();
+        test_outbox_write_retried();
+        test_slow_channel();
         
         std::cout << "All Notification Manager tests completed!" << std::endl;
         return 0;
@@ -0,0 +1,274 @@
+#include "network/notification_channel.hpp"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <sstream>
+
+using namespace hms;
+
+// A channel whose sends stay in flight until the test completes them
+class ManualChannel : public NotificationChannel {
+public:
+    ManualChannel(const std::string& name, size_t maxConcurrent)
+        : NotificationChannel(name, maxConcurrent) {
+    }
+    
+    size_t getStartedCount() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_started.size();
+    }
+    
+    std::string getRecipient(size_t index) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_started[index].first;
+    }
+    
+    // Finishes the send started index-th
+    void complete(size_t index, bool success) {
+        Callback done;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            done = m_started[index].second;
+        }
+        TransportResult result;
+        result.success = success;
+        done(result);
+    }
+    
+protected:
+    void deliver(const ChannelMessage& message, Callback done) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_started.emplace_back(message.recipient, std::move(done));
+    }
+    
+private:
+    std::mutex m_mutex;
+    std::vector<std::pair<std::string, Callback>> m_started;
+};
+
+static ChannelMessage makeMessage(const std::string& recipient) {
+    return ChannelMessage{recipient, "Fall Alert", "Fall detected for John", {}};
+}
+
+// Test function to verify the capture channel keeps messages and fails on demand
+void test_capture_channel() {
+    std::cout << "Testing capture channel..." << std::endl;
+    
+    CaptureChannel channel("sms");
+    int succeeded = 0;
+    int failed = 0;
+    auto count = [&](const TransportResult& result) {
+        if (result.success) {
+            succeeded++;
+        } else {
+            failed++;
+        }
+    };
+    
+    channel.send(makeMessage("+15550100"), count);
+    channel.send(makeMessage("+15550101"), count);
+    channel.setFailing(true);
+    channel.send(makeMessage("+15550102"), count);
+    
+    assert(succeeded == 2 && failed == 1 && "Results not reported");
+    std::vector<ChannelMessage> messages = channel.getMessages();
+    assert(messages.size() == 2 && "Failed send was captured");
+    assert(messages[0].recipient == "+15550100" && messages[0].subject == "Fall Alert" &&
+           messages[0].body == "Fall detected for John" && "Message not captured as sent");
+    
+    ChannelMetrics metrics = channel.getMetrics();
+    assert(metrics.name == "sms" && metrics.sent == 2 && metrics.failed == 1 && "Wrong metrics");
+    assert(metrics.inFlight == 0 && metrics.queued == 0 && "Capture left sends in flight");
+    
+    channel.clear();
+    assert(channel.getMessages().empty() && "Messages not cleared");
+    
+    std::cout << "Capture channel test completed successfully" << std::endl;
+}
+
+// Test function to verify sends beyond the limit wait for a slot, in order
+void test_concurrency_limit() {
+    std::cout << "Testing concurrency limit..." << std::endl;
+    
+    ManualChannel channel("email", 2);
+    std::vector<std::string> finished;
+    for (int i = 0; i < 5; i++) {
+        std::string recipient = "contact" + std::to_string(i) + "@example.com";
+        channel.send(makeMessage(recipient), [&finished, recipient](const TransportResult&) {
+            finished.push_back(recipient);
+        });
+    }
+    
+    assert(channel.getStartedCount() == 2 && "Limit not applied");
+    ChannelMetrics metrics = channel.getMetrics();
+    assert(metrics.inFlight == 2 && metrics.queued == 3 && "Wrong in-flight metrics");
+    
+    // Each finished send hands its slot to the oldest waiting one
+    channel.complete(1, true);
+    assert(channel.getStartedCount() == 3 && channel.getRecipient(2) == "contact2@example.com" &&
+           "Slot not passed on in order");
+    channel.complete(0, false);
+    channel.complete(2, true);
+    assert(channel.getStartedCount() == 5 && "Queued sends not started");
+    metrics = channel.getMetrics();
+    assert(metrics.inFlight == 2 && metrics.queued == 0 && "Wrong metrics after hand-over");
+    
+    channel.complete(3, true);
+    channel.complete(4, true);
+    metrics = channel.getMetrics();
+    assert(metrics.inFlight == 0 && metrics.sent == 4 && metrics.failed == 1 && "Wrong final metrics");
+    assert(metrics.maxLatencyMs >= metrics.averageLatencyMs && "Latency not recorded");
+    assert(finished.size() == 5 && finished[0] == "contact1@example.com" && "Callbacks not run");
+    
+    std::cout << "Concurrency limit test completed successfully" << std::endl;
+}
+
+// Test function to verify a stuck channel does not hold up another one
+void test_channels_independent() {
+    std::cout << "Testing channel independence..." << std::endl;
+    
+    ManualChannel email("email", 1);
+    CaptureChannel sms("sms", 1);
+    
+    for (int i = 0; i < 10; i++) {
+        email.send(makeMessage("contact@example.com"), nullptr);
+        sms.send(makeMessage("+15550100"), nullptr);
+    }
+    
+    assert(email.getMetrics().queued == 9 && "Email not backed up");
+    assert(sms.getMessages().size() == 10 && sms.getMetrics().queued == 0 && "SMS held up by email");
+    
+    std::cout << "Channel independence test completed successfully" << std::endl;
+}
+
+// Test function to verify channels are built from configuration
+void test_create_channel() {
+    std::cout << "Testing channel creation..." << std::endl;
+    
+    NotificationTransport transport;
+    ChannelConfig config;
+    config.type = "capture";
+    config.maxConcurrent = 3;
+    std::unique_ptr<NotificationChannel> channel = createNotificationChannel("sms", config, transport);
+    assert(channel && dynamic_cast<CaptureChannel*>(channel.get()) && "Capture channel not created");
+    assert(channel->getName() == "sms" && "Name not kept");
+    
+    config.type = "smtp";
+    config.url = "smtp://mail.example.com:587";
+    channel = createNotificationChannel("email", config, transport);
+    assert(dynamic_cast<SmtpChannel*>(channel.get()) && "SMTP channel not created");
+    
+    config.type = "webhook";
+    channel = createNotificationChannel("sms", config, transport);
+    assert(dynamic_cast<WebhookChannel*>(channel.get()) && "Webhook channel not created");
+    
+    config.type = "twilio";
+    config.url.clear();
+    channel = createNotificationChannel("sms", config, transport);
+    assert(!channel && "Twilio channel created without credentials");
+    config.username = "AC123";
+    config.password = "token";
+    config.from = "+15559999";
+    channel = createNotificationChannel("sms", config, transport);
+    assert(dynamic_cast<SmsHttpChannel*>(channel.get()) && "Twilio channel not created");
+    
+    config.type = "sms_http";
+    channel = createNotificationChannel("sms", config, transport);
+    assert(!channel && "HTTP channel created without a URL");
+    
+    config.type = "pigeon";
+    channel = createNotificationChannel("sms", config, transport);
+    assert(!channel && "Unknown type accepted");
+    
+    std::cout << "Channel creation test completed successfully" << std::endl;
+}
+
+// Decodes base64 lines until the MIME boundary
+static std::vector<unsigned char> base64Decode(const std::string& text) {
+    static const std::string kAlphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::vector<unsigned char> data;
+    uint32_t bits = 0;
+    int count = 0;
+    for (char c : text) {
+        size_t value = kAlphabet.find(c);
+        if (value == std::string::npos) {
+            continue;
+        }
+        bits = (bits << 6) | static_cast<uint32_t>(value);
+        count += 6;
+        if (count >= 8) {
+            count -= 8;
+            data.push_back(static_cast<unsigned char>((bits >> count) & 0xFF));
+        }
+    }
+    return data;
+}
+
+// Test function to verify emails carry attachments as multipart MIME
+void test_mail_payload() {
+    std::cout << "Testing mail payload..." << std::endl;
+    
+    ChannelMessage message = makeMessage("contact@example.com");
+    std::string plain = buildMailPayload("alerts@example.com", message);
+    assert(plain.find("Subject: Fall Alert\r\n\r\nFall detected for John\r\n") != std::string::npos &&
+           "Plain message malformed");
+    assert(plain.find("MIME-Version") == std::string::npos && "Plain message made multipart");
+    
+    auto attachment = std::make_shared<MessageAttachment>();
+    attachment->filename = "snapshot_7.jpg";
+    attachment->contentType = "image/jpeg";
+    for (int i = 0; i < 1000; i++) {
+        attachment->data.push_back(static_cast<unsigned char>(i * 37));
+    }
+    message.attachments.push_back(attachment);
+    std::string payload = buildMailPayload("alerts@example.com", message);
+    
+    const std::string boundary = "--hms-alert-boundary-0b7d2c";
+    assert(payload.find("Content-Type: multipart/mixed; boundary=\"hms-alert-boundary-0b7d2c\"") != std::string::npos &&
+           "Not multipart");
+    assert(payload.find("\r\n\r\nFall detected for John\r\n" + boundary + "\r\n") != std::string::npos &&
+           "Text part missing");
+    assert(payload.find("Content-Disposition: attachment; filename=\"snapshot_7.jpg\"") != std::string::npos &&
+           "Attachment part missing");
+    assert(payload.size() >= boundary.size() + 4 &&
+           payload.compare(payload.size() - boundary.size() - 4, std::string::npos, boundary + "--\r\n") == 0 &&
+           "Closing boundary missing");
+    
+    // Every line fits SMTP's limits, and the attachment comes back intact
+    std::istringstream lines(payload);
+    std::string line;
+    while (std::getline(lines, line)) {
+        assert(line.size() <= 78 && "Line too long");
+    }
+    size_t start = payload.find("\r\n\r\n", payload.find("Content-Disposition")) + 4;
+    size_t end = payload.find(boundary + "--");
+    assert(base64Decode(payload.substr(start, end - start)) == attachment->data && "Attachment corrupted");
+    
+    // Channels keep attachments with the message
+    CaptureChannel channel("email");
+    channel.send(message, nullptr);
+    assert(channel.getMessages()[0].attachments.size() == 1 &&
+           channel.getMessages()[0].attachments[0] == attachment && "Attachment not passed on");
+    
+    std::cout << "Mail payload test completed successfully" << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Notification Channel tests..." << std::endl;
+    
+    try {
+        test_capture_channel();
+        test_concurrency_limit();
+        test_channels_independent();
+        test_create_channel();
+        test_mail_payload();
+        
+        std::cout << "All Notification Channel tests completed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,182 @@
+#include "network/notification_coalescer.hpp"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+
+using namespace hms;
+
+static OutboxEntry makeEntry(int64_t id, int userId, OutboxChannel channel, const std::string& recipient,
+                             const std::string& message) {
+    OutboxEntry entry;
+    entry.id = id;
+    entry.userId = userId;
+    entry.personId = 3;
+    entry.channel = channel;
+    entry.recipient = recipient;
+    entry.subject = "Fall Detected";
+    entry.message = message;
+    return entry;
+}
+
+// Test function to verify the token bucket's burst and refill
+void test_token_bucket() {
+    std::cout << "Testing token bucket..." << std::endl;
+    
+    TokenBucket bucket(60, 3);  // One a second, three at once
+    for (int i = 0; i < 3; i++) {
+        bool taken = bucket.tryTake(0);
+        assert(taken && "Burst not available");
+    }
+    assert(!bucket.tryTake(0) && "Bucket allowed more than its burst");
+    assert(bucket.nextTokenMs(0) == 1000 && "Wrong time for the next token");
+    assert(bucket.nextTokenMs(0, 2) == 3000 && "Wrong time for a token with others waiting");
+    
+    assert(!bucket.tryTake(999) && "Token available early");
+    assert(bucket.tryTake(1000) && "Token not refilled");
+    
+    // Refill stops at the burst size
+    for (int i = 0; i < 3; i++) {
+        bool taken = bucket.tryTake(60000);
+        assert(taken && "Burst not refilled");
+    }
+    assert(!bucket.tryTake(60000) && "Refilled past the burst size");
+    
+    TokenBucket unlimited(0, 1);
+    for (int i = 0; i < 100; i++) {
+        bool taken = unlimited.tryTake(0);
+        assert(taken && "Zero rate should mean no limit");
+    }
+    
+    std::cout << "Token bucket test completed successfully" << std::endl;
+}
+
+// Test function to verify a contact shared by several residents gets one message per event
+void test_merge_shared_contact() {
+    std::cout << "Testing merging for a shared contact..." << std::endl;
+    
+    NotificationCoalescer coalescer;
+    
+    // One fall alerts three residents' contacts; the nurse is on all three
+    std::vector<OutboxEntry> due = {
+        makeEntry(1, 1, OutboxChannel::SMS, "+15550100", "Alice has fallen"),
+        makeEntry(2, 1, OutboxChannel::SMS, "+15550111", "Alice has fallen"),
+        makeEntry(3, 2, OutboxChannel::SMS, "+15550100", "Bob has fallen"),
+        makeEntry(4, 3, OutboxChannel::SMS, "+15550100", "Carol has fallen"),
+        makeEntry(5, 3, OutboxChannel::EMAIL, "+15550100", "Carol has fallen")
+    };
+    auto plan = coalescer.plan(due, 1000);
+    
+    assert(plan.sends.size() == 3 && plan.suppressed.empty() && plan.deferred.empty() &&
+           "Expected one send per recipient and channel");
+    const auto& nurse = plan.sends[0];
+    assert(nurse.parts.size() == 3 && nurse.message.id == 1 && "Nurse's alerts not merged");
+    assert(nurse.message.message.find("3 alerts:") == 0 && "Merged message has no summary");
+    assert(nurse.message.message.find("Bob has fallen") != std::string::npos &&
+           nurse.message.message.find("Carol has fallen") != std::string::npos && "Merged message lost an alert");
+    assert(nurse.message.subject == "Fall Detected (+2 more)" && "Merged subject wrong");
+    assert(plan.sends[1].parts.size() == 1 && plan.sends[1].message.message == "Alice has fallen" &&
+           "Single alert altered");
+    assert(plan.sends[2].message.channel == OutboxChannel::EMAIL && "Channels merged together");
+    
+    auto stats = coalescer.getStats();
+    assert(stats.sends == 3 && stats.merged == 2 && stats.suppressed == 0 && "Wrong counters");
+    
+    std::cout << "Shared contact merge test completed successfully" << std::endl;
+}
+
+// Test function to verify new alerts are never held and duplicates wait for the send they repeat
+void test_window_and_duplicates() {
+    std::cout << "Testing duplicate suppression..." << std::endl;
+    
+    NotificationCoalescer::Options options;
+    options.windowMs = 30000;
+    NotificationCoalescer coalescer(options);
+    
+    OutboxEntry first = makeEntry(1, 1, OutboxChannel::SMS, "+15550100", "Alice has fallen");
+    auto plan = coalescer.plan({first}, 1000);
+    assert(plan.sends.size() == 1 && "First alert not sent");
+    
+    // A repeat of a message still being sent is neither sent nor settled
+    plan = coalescer.plan({makeEntry(2, 1, OutboxChannel::SMS, "+15550100", "Alice has fallen")}, 2000);
+    assert(plan.sends.empty() && plan.suppressed.empty() && plan.deferred.empty() &&
+           "Repeat of an unconfirmed send settled");
+    auto held = coalescer.complete(first, true);
+    assert(held.size() == 1 && held[0].id == 2 && "Held repeat not released with its send");
+    
+    // Within the window: new content goes out at once, repeats of a
+    // delivered message are suppressed, and repeats within the batch wait
+    plan = coalescer.plan({
+        makeEntry(3, 1, OutboxChannel::SMS, "+15550100", "Alice has fallen"),
+        makeEntry(4, 2, OutboxChannel::SMS, "+15550100", "Bob has fallen"),
+        makeEntry(5, 2, OutboxChannel::SMS, "+15550100", "Bob has fallen")
+    }, 5000);
+    assert(plan.sends.size() == 1 && plan.sends[0].parts.size() == 1 && plan.sends[0].message.id == 4 &&
+           "New alert not sent at once");
+    assert(plan.suppressed.size() == 1 && plan.suppressed[0].id == 3 && "Repeat of a delivered message not suppressed");
+    
+    // A failed send hands its repeats back, and its retry is not a duplicate
+    OutboxEntry bob = plan.sends[0].parts[0];
+    held = coalescer.complete(bob, false);
+    assert(held.size() == 1 && held[0].id == 5 && "Repeat held for a failed send lost");
+    plan = coalescer.plan({bob, held[0]}, 6000);
+    assert(plan.sends.size() == 1 && plan.sends[0].message.id == 4 && plan.suppressed.empty() &&
+           "Retry of a failed send suppressed");
+    held = coalescer.complete(bob, true);
+    assert(held.size() == 1 && held[0].id == 5 && "Repeat not settled by the retry");
+    
+    // Once the window has passed, the same text is a new alert
+    plan = coalescer.plan({makeEntry(6, 1, OutboxChannel::SMS, "+15550100", "Alice has fallen")}, 70000);
+    assert(plan.sends.size() == 1 && plan.suppressed.empty() && "Old message still suppressed");
+    
+    auto stats = coalescer.getStats();
+    assert(stats.sends == 4 && stats.suppressed == 3 && "Wrong counters");
+    
+    std::cout << "Duplicate suppression test completed successfully" << std::endl;
+}
+
+// Test function to verify per-channel rate limits defer sends instead of dropping them
+void test_rate_limits() {
+    std::cout << "Testing rate limits..." << std::endl;
+    
+    NotificationCoalescer::Options options;
+    options.smsPerMinute = 60;
+    options.smsBurst = 2;
+    NotificationCoalescer coalescer(options);
+    
+    std::vector<OutboxEntry> due;
+    for (int i = 0; i < 5; i++) {
+        due.push_back(makeEntry(i + 1, i, OutboxChannel::SMS, "+1555010" + std::to_string(i), "Fall"));
+    }
+    due.push_back(makeEntry(10, 9, OutboxChannel::EMAIL, "nurse@example.com", "Fall"));
+    
+    auto plan = coalescer.plan(due, 0);
+    assert(plan.sends.size() == 3 && "Burst or email not sent");
+    assert(plan.deferred.size() == 3 && "Rate-limited sends not deferred");
+    assert(plan.deferred[0].nextAttemptMs == 1000 && plan.deferred[1].nextAttemptMs == 2000 &&
+           plan.deferred[2].nextAttemptMs == 3000 && "Deferred sends not spaced by the rate");
+    assert(coalescer.getStats().rateLimited == 3 && "Rate-limited counter wrong");
+    
+    // The first deferred one goes out when its token is due
+    plan = coalescer.plan({plan.deferred[0]}, 1000);
+    assert(plan.sends.size() == 1 && "Deferred send not sent when due");
+    
+    std::cout << "Rate limit test completed successfully" << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Notification Coalescer tests..." << std::endl;
+    
+    try {
+        test_token_bucket();
+        test_merge_shared_contact();
+        test_window_and_duplicates();
+        test_rate_limits();
+        
+        std::cout << "All Notification Coalescer tests completed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
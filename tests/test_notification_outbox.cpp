@@ -0,0 +1,285 @@
+#include "database/notification_outbox.hpp"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+
+using namespace hms;
+namespace fs = std::filesystem;
+
+static OutboxEntry makeEntry(int userId, OutboxChannel channel, const std::string& recipient) {
+    OutboxEntry entry;
+    entry.userId = userId;
+    entry.personId = 3;
+    entry.channel = channel;
+    entry.recipient = recipient;
+    entry.subject = "Fall Detected";
+    entry.message = "EMERGENCY ALERT: Resident has fallen";
+    return entry;
+}
+
+static std::string makeTestDatabasePath() {
+    fs::path path = fs::temp_directory_path() / "hms_outbox_test.db";
+    fs::remove(path);
+    fs::remove(path.string() + "-wal");
+    fs::remove(path.string() + "-shm");
+    return path.string();
+}
+
+// Test function to verify entries are claimed once, leased and settled by their results
+void test_claim_and_results() {
+    std::cout << "Testing outbox claims and results..." << std::endl;
+    
+    std::string dbPath = makeTestDatabasePath();
+    NotificationOutbox::Options options;
+    options.maxAttempts = 2;
+    NotificationOutbox outbox(dbPath, options);
+    bool initialized = outbox.initialize();
+    assert(initialized && "Outbox initialization failed");
+    
+    std::vector<OutboxEntry> entries = {
+        makeEntry(1, OutboxChannel::SMS, "+15550100"),
+        makeEntry(1, OutboxChannel::EMAIL, "daughter@example.com"),
+        makeEntry(2, OutboxChannel::SMS, "+15550200")
+    };
+    bool added = outbox.add(entries, 1000);
+    assert(added && entries[0].id > 0 && entries[2].id > entries[0].id && "Entries not given ids");
+    assert(outbox.getPendingCount() == 3 && "Entries not stored");
+    
+    auto claimed = outbox.claimDue(1000, 2);
+    assert(claimed.size() == 2 && claimed[0].id == entries[0].id && "Due entries not claimed oldest first");
+    assert(claimed[1].channel == OutboxChannel::EMAIL && claimed[1].recipient == "daughter@example.com" &&
+           "Entry not restored");
+    
+    // Leased entries are not handed out again
+    auto rest = outbox.claimDue(1000, 10);
+    assert(rest.size() == 1 && rest[0].id == entries[2].id && "Leased entry claimed twice");
+    bool claimedAgain = !outbox.claimDue(1000, 10).empty();
+    assert(!claimedAgain && "Leased entries claimed again");
+    
+    // Sent: gone. Failed once: retried later. Failed at the last attempt: kept as failed.
+    auto outcomes = outbox.recordResults({
+        {claimed[0].id, claimed[0].attempts, true, ""},
+        {claimed[1].id, claimed[1].attempts, false, "Connection refused"}
+    }, 2000);
+    assert(outcomes.size() == 2 && outcomes[0] == OutboxOutcome::SENT && outcomes[1] == OutboxOutcome::RETRY &&
+           "Wrong outcomes");
+    assert(outbox.getPendingCount() == 2 && "Sent entry not removed");
+    
+    int64_t retryAt = outbox.getNextDueMs();
+    assert(retryAt >= 2000 + options.baseBackoffMs / 2 && retryAt <= 2000 + options.baseBackoffMs &&
+           "Retry not backed off");
+    bool retriedEarly = !outbox.claimDue(retryAt - 1, 10).empty();
+    assert(!retriedEarly && "Entry retried before its backoff");
+    
+    auto retried = outbox.claimDue(retryAt, 10);
+    assert(retried.size() == 1 && retried[0].attempts == 1 && "Retry not claimed with its attempt count");
+    
+    outcomes = outbox.recordResults({{retried[0].id, retried[0].attempts, false, "Mailbox full"}}, retryAt);
+    assert(outcomes.size() == 1 && outcomes[0] == OutboxOutcome::GAVE_UP && "Entry retried past max attempts");
+    assert(outbox.getFailedCount() == 1 && outbox.getPendingCount() == 1 && "Failed entry not kept");
+    
+    outbox.shutdown();
+    fs::remove(dbPath);
+    std::cout << "Outbox claim and result test completed successfully" << std::endl;
+}
+
+// Test function to verify unsent and leased entries are replayed after a restart
+void test_replay_on_restart() {
+    std::cout << "Testing outbox replay..." << std::endl;
+    
+    std::string dbPath = makeTestDatabasePath();
+    int64_t backedOffId;
+    int64_t leasedId;
+    
+    {
+        NotificationOutbox outbox(dbPath);
+        bool initialized = outbox.initialize();
+        assert(initialized && "Outbox initialization failed");
+        
+        std::vector<OutboxEntry> entries = {
+            makeEntry(1, OutboxChannel::SMS, "+15550100"),
+            makeEntry(1, OutboxChannel::EMAIL, "son@example.com"),
+            makeEntry(1, OutboxChannel::SMS, "+15550300")
+        };
+        bool added = outbox.add(entries, 1000);
+        assert(added && "Entries not added");
+        
+        // One backing off, one in flight when the process "dies", one never claimed
+        auto claimed = outbox.claimDue(1000, 2);
+        backedOffId = claimed[0].id;
+        leasedId = claimed[1].id;
+        outbox.recordResults({{backedOffId, 0, false, "Gateway timeout"}}, 1000);
+    }
+    
+    NotificationOutbox outbox(dbPath);
+    bool reopened = outbox.initialize();
+    assert(reopened && "Outbox reopen failed");
+    
+    auto replayed = outbox.claimDue(1000, 10);
+    assert(replayed.size() == 3 && "Unsent entries not replayed");
+    bool foundBackedOff = false;
+    bool foundLeased = false;
+    for (const auto& entry : replayed) {
+        foundBackedOff |= entry.id == backedOffId && entry.attempts == 1;
+        foundLeased |= entry.id == leasedId;
+    }
+    assert(foundBackedOff && foundLeased && "Backed-off or leased entry lost");
+    
+    outbox.shutdown();
+    fs::remove(dbPath);
+    std::cout << "Outbox replay test completed successfully" << std::endl;
+}
+
+// Test function to verify entries held back by coalescing or rate limits wait without using an attempt
+void test_deferred_entries() {
+    std::cout << "Testing deferred outbox entries..." << std::endl;
+    
+    NotificationOutbox outbox(":memory:");
+    bool initialized = outbox.initialize();
+    assert(initialized && "Outbox initialization failed");
+    
+    std::vector<OutboxEntry> entries = {
+        makeEntry(1, OutboxChannel::SMS, "+15550100"),
+        makeEntry(2, OutboxChannel::SMS, "+15550200")
+    };
+    entries[1].nextAttemptMs = 31000;
+    bool added = outbox.add(entries, 1000);
+    assert(added && "Entries not added");
+    
+    auto claimed = outbox.claimDue(1000, 10);
+    assert(claimed.size() == 1 && claimed[0].id == entries[0].id && "Held entry claimed early");
+    
+    claimed[0].nextAttemptMs = 2000;
+    bool rescheduled = outbox.reschedule(claimed);
+    assert(rescheduled && outbox.getNextDueMs() == 2000 && "Entry not rescheduled");
+    
+    claimed = outbox.claimDue(31000, 10);
+    assert(claimed.size() == 2 && claimed[0].attempts == 0 && claimed[1].attempts == 0 &&
+           "Deferral counted as an attempt");
+    
+    outbox.shutdown();
+    std::cout << "Deferred outbox entries test completed successfully" << std::endl;
+}
+
+// Test function to verify one channel's entries are claimed without the other's
+void test_claim_by_channel() {
+    std::cout << "Testing outbox claims by channel..." << std::endl;
+    
+    NotificationOutbox outbox(":memory:");
+    bool initialized = outbox.initialize();
+    assert(initialized && "Outbox initialization failed");
+    
+    std::vector<OutboxEntry> entries = {
+        makeEntry(1, OutboxChannel::EMAIL, "daughter@example.com"),
+        makeEntry(1, OutboxChannel::SMS, "+15550100"),
+        makeEntry(2, OutboxChannel::SMS, "+15550200")
+    };
+    entries[0].nextAttemptMs = 5000;
+    bool added = outbox.add(entries, 1000);
+    assert(added && "Entries not added");
+    assert(outbox.getNextDueMs(OutboxChannel::SMS) == 1000 && outbox.getNextDueMs(OutboxChannel::EMAIL) == 5000 &&
+           "Wrong due time per channel");
+    
+    auto claimed = outbox.claimDue(5000, 1, OutboxChannel::SMS);
+    assert(claimed.size() == 1 && claimed[0].id == entries[1].id && "Wrong entry claimed");
+    claimed = outbox.claimDue(5000, 10, OutboxChannel::EMAIL);
+    assert(claimed.size() == 1 && claimed[0].id == entries[0].id && "Email entry not claimed on its own");
+    claimed = outbox.claimDue(5000, 10, OutboxChannel::SMS);
+    assert(claimed.size() == 1 && claimed[0].id == entries[2].id && "Rest of the channel not claimed");
+    
+    outbox.shutdown();
+    std::cout << "Outbox claims by channel test completed successfully" << std::endl;
+}
+
+// Test function to verify backoff doubles up to its cap, with jitter
+void test_backoff() {
+    std::cout << "Testing outbox backoff..." << std::endl;
+    
+    NotificationOutbox::Options options;
+    options.baseBackoffMs = 1000;
+    options.maxBackoffMs = 30000;
+    NotificationOutbox outbox(":memory:", options);
+    
+    bool jittered = false;
+    for (int attempts = 1; attempts <= 8; attempts++) {
+        int64_t expected = std::min<int64_t>(1000LL << (attempts - 1), 30000);
+        int64_t first = outbox.backoffMs(attempts);
+        for (int i = 0; i < 50; i++) {
+            int64_t delay = outbox.backoffMs(attempts);
+            assert(delay >= expected / 2 && delay <= expected && "Backoff out of range");
+            jittered |= delay != first;
+        }
+    }
+    assert(jittered && "Backoff has no jitter");
+    
+    std::cout << "Outbox backoff test completed successfully" << std::endl;
+}
+
+// Test function to verify a burst of alerts is stored and claimed in batches
+void test_burst() {
+    std::cout << "Testing outbox burst..." << std::endl;
+    
+    std::string dbPath = makeTestDatabasePath();
+    NotificationOutbox outbox(dbPath);
+    bool initialized = outbox.initialize();
+    assert(initialized && "Outbox initialization failed");
+    
+    // 500 alerts, each to three recipients, arriving in batches of 50
+    const int kAlerts = 500;
+    auto start = std::chrono::steady_clock::now();
+    for (int batch = 0; batch < kAlerts / 50; batch++) {
+        std::vector<OutboxEntry> entries;
+        for (int i = 0; i < 50; i++) {
+            int userId = batch * 50 + i;
+            entries.push_back(makeEntry(userId, OutboxChannel::SMS, "+1555" + std::to_string(userId)));
+            entries.push_back(makeEntry(userId, OutboxChannel::EMAIL, std::to_string(userId) + "@example.com"));
+            entries.push_back(makeEntry(userId, OutboxChannel::SMS, "+1666" + std::to_string(userId)));
+        }
+        bool added = outbox.add(entries, 1000);
+        assert(added && "Burst batch not added");
+    }
+    double addMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    size_t claimedCount = 0;
+    std::vector<OutboxEntry> claimed;
+    while (!(claimed = outbox.claimDue(1000, 512)).empty()) {
+        std::vector<OutboxResult> results;
+        for (const auto& entry : claimed) {
+            results.push_back({entry.id, entry.attempts, true, ""});
+        }
+        outbox.recordResults(results, 1000);
+        claimedCount += claimed.size();
+    }
+    double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "  " << kAlerts * 3 << " sends stored in " << addMs << " ms, claimed and settled in "
+              << totalMs - addMs << " ms" << std::endl;
+    assert(claimedCount == kAlerts * 3 && outbox.getPendingCount() == 0 && "Burst not fully delivered");
+    
+    outbox.shutdown();
+    fs::remove(dbPath);
+    std::cout << "Outbox burst test completed successfully" << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Notification Outbox tests..." << std::endl;
+    
+    try {
+        test_claim_and_results();
+        test_replay_on_restart();
+        test_deferred_entries();
+        test_claim_by_channel();
+        test_backoff();
+        test_burst();
+        
+        std::cout << "All Notification Outbox tests completed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,326 @@
+#include "network/notification_transport.hpp"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cstdlib>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+
+using namespace hms;
+
+// A loopback TCP server that runs a handler on its own thread per connection
+class StandInServer {
+public:
+    using Handler = std::function<void(int fd)>;
+    
+    StandInServer(Handler handler)
+        : m_handler(std::move(handler)), m_running(true), m_connectionCount(0) {
+        m_listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+        bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        listen(m_listenFd, 128);
+        
+        socklen_t length = sizeof(address);
+        getsockname(m_listenFd, reinterpret_cast<sockaddr*>(&address), &length);
+        m_port = ntohs(address.sin_port);
+        
+        m_acceptThread = std::thread(&StandInServer::acceptLoop, this);
+    }
+    
+    ~StandInServer() {
+        m_running = false;
+        m_acceptThread.join();
+        close(m_listenFd);
+        
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (int fd : m_clientFds) {
+            shutdown(fd, SHUT_RDWR);
+        }
+        for (auto& thread : m_handlerThreads) {
+            thread.join();
+        }
+        for (int fd : m_clientFds) {
+            close(fd);
+        }
+    }
+    
+    int getPort() const { return m_port; }
+    int getConnectionCount() const { return m_connectionCount; }
+    
+private:
+    Handler m_handler;
+    std::atomic<bool> m_running;
+    std::atomic<int> m_connectionCount;
+    int m_listenFd;
+    int m_port;
+    std::thread m_acceptThread;
+    std::mutex m_mutex;
+    std::vector<int> m_clientFds;
+    std::vector<std::thread> m_handlerThreads;
+    
+    void acceptLoop() {
+        while (m_running) {
+            pollfd pfd{m_listenFd, POLLIN, 0};
+            if (poll(&pfd, 1, 50) <= 0) {
+                continue;
+            }
+            int fd = accept(m_listenFd, nullptr, nullptr);
+            if (fd < 0) {
+                continue;
+            }
+            m_connectionCount++;
+            
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_clientFds.push_back(fd);
+            m_handlerThreads.emplace_back(m_handler, fd);
+        }
+    }
+};
+
+static void sendAll(int fd, const std::string& data) {
+    send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+}
+
+// Reads up to and including the delimiter; false once the peer has gone
+static bool readUntil(int fd, std::string& buffer, const std::string& delimiter, std::string& out) {
+    size_t position;
+    while ((position = buffer.find(delimiter)) == std::string::npos) {
+        char chunk[4096];
+        ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+        if (received <= 0) {
+            return false;
+        }
+        buffer.append(chunk, received);
+    }
+    out = buffer.substr(0, position + delimiter.size());
+    buffer.erase(0, position + delimiter.size());
+    return true;
+}
+
+// Answers every request on a keep-alive connection after a delay
+static StandInServer::Handler httpHandler(int delayMs, int status, std::atomic<int>& requestCount) {
+    return [delayMs, status, &requestCount](int fd) {
+        std::string buffer;
+        std::string headers;
+        while (readUntil(fd, buffer, "\r\n\r\n", headers)) {
+            size_t lengthPos = headers.find("Content-Length: ");
+            size_t contentLength = lengthPos == std::string::npos
+                ? 0 : std::strtoul(headers.c_str() + lengthPos + 16, nullptr, 10);
+            while (buffer.size() < contentLength) {
+                char chunk[4096];
+                ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+                if (received <= 0) {
+                    return;
+                }
+                buffer.append(chunk, received);
+            }
+            buffer.erase(0, contentLength);
+            
+            std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+            requestCount++;
+            sendAll(fd, "HTTP/1.1 " + std::to_string(status) + " Status\r\n"
+                        "Content-Length: 2\r\nConnection: keep-alive\r\n\r\nok");
+        }
+    };
+}
+
+// Enough of SMTP for curl: no STARTTLS, no AUTH, messages accepted after a delay
+static StandInServer::Handler smtpHandler(int delayMs, std::atomic<int>& messageCount) {
+    return [delayMs, &messageCount](int fd) {
+        sendAll(fd, "220 localhost stand-in ESMTP\r\n");
+        
+        std::string buffer;
+        std::string line;
+        while (readUntil(fd, buffer, "\r\n", line)) {
+            std::string command = line.substr(0, 4);
+            std::transform(command.begin(), command.end(), command.begin(), ::toupper);
+            
+            if (command == "EHLO" || command == "HELO") {
+                sendAll(fd, "250-localhost\r\n250 8BITMIME\r\n");
+            } else if (command == "DATA") {
+                sendAll(fd, "354 End data with <CR><LF>.<CR><LF>\r\n");
+                std::string message;
+                if (!readUntil(fd, buffer, "\r\n.\r\n", message)) {
+                    return;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+                messageCount++;
+                sendAll(fd, "250 OK queued\r\n");
+            } else if (command == "QUIT") {
+                sendAll(fd, "221 Bye\r\n");
+                return;
+            } else {
+                sendAll(fd, "250 OK\r\n");
+            }
+        }
+    };
+}
+
+static double elapsedMsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static const int kRecipients = 50;
+static const int kServerDelayMs = 100;
+
+// Per-host connection limit across all workers with the default options
+static const int kMaxHostConnections = NotificationTransport::Options().workerCount *
+                                       NotificationTransport::Options().maxConnectionsPerHost;
+
+// Test function to verify SMS requests to 50 recipients run concurrently over reused connections
+void test_http_fan_out() {
+    std::cout << "Testing HTTP fan-out..." << std::endl;
+    
+    std::atomic<int> requestCount(0);
+    StandInServer server(httpHandler(kServerDelayMs, 200, requestCount));
+    
+    NotificationTransport transport;
+    bool started = transport.start();
+    assert(started && "Transport failed to start");
+    
+    std::string url = "http://127.0.0.1:" + std::to_string(server.getPort()) + "/sms";
+    std::atomic<int> succeeded(0);
+    std::mutex latencyMutex;
+    std::vector<double> latencies;
+    
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRecipients; i++) {
+        transport.postForm(url, "to=%2B1555000" + std::to_string(i) + "&message=Fall%20detected",
+                           [&](const TransportResult& result) {
+                               if (result.success && result.responseCode == 200) {
+                                   succeeded++;
+                               }
+                               std::lock_guard<std::mutex> lock(latencyMutex);
+                               latencies.push_back(result.elapsedMs);
+                           });
+    }
+    transport.waitIdle();
+    double totalMs = elapsedMsSince(start);
+    
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << "  " << kRecipients << " SMS requests in " << totalMs << " ms (one at a time: at least "
+              << kRecipients * kServerDelayMs << " ms), slowest " << latencies.back() << " ms, over "
+              << server.getConnectionCount() << " connections" << std::endl;
+    
+    assert(succeeded == kRecipients && requestCount == kRecipients && "Not every SMS request succeeded");
+    assert(totalMs < kRecipients * kServerDelayMs / 4 && "Requests did not run concurrently");
+    assert(server.getConnectionCount() <= kMaxHostConnections && "Connections were not reused");
+    
+    std::cout << "HTTP fan-out test completed successfully" << std::endl;
+}
+
+// Test function to verify emails to 50 recipients run concurrently over reused SMTP sessions
+void test_smtp_fan_out() {
+    std::cout << "Testing SMTP fan-out..." << std::endl;
+    
+    std::atomic<int> messageCount(0);
+    StandInServer server(smtpHandler(kServerDelayMs, messageCount));
+    
+    NotificationTransport::Options options;
+    options.requireTls = false;  // The stand-in has no STARTTLS
+    NotificationTransport transport(options);
+    bool started = transport.start();
+    assert(started && "Transport failed to start");
+    
+    std::string url = "smtp://127.0.0.1:" + std::to_string(server.getPort());
+    std::atomic<int> succeeded(0);
+    std::atomic<int> failed(0);
+    
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRecipients; i++) {
+        std::string to = "contact" + std::to_string(i) + "@example.com";
+        std::string payload = "To: " + to + "\r\nFrom: alerts@example.com\r\n"
+                              "Subject: EMERGENCY ALERT: Fall Detected\r\n\r\nPlease respond.\r\n";
+        transport.sendMail(url, "", "", "alerts@example.com", to, payload,
+                           [&](const TransportResult& result) {
+                               if (result.success) {
+                                   succeeded++;
+                               } else {
+                                   std::cerr << "  Email failed: " << result.error << std::endl;
+                                   failed++;
+                               }
+                           });
+    }
+    transport.waitIdle();
+    double totalMs = elapsedMsSince(start);
+    
+    std::cout << "  " << kRecipients << " emails in " << totalMs << " ms (one at a time: at least "
+              << kRecipients * kServerDelayMs << " ms), over " << server.getConnectionCount()
+              << " connections" << std::endl;
+    
+    assert(succeeded == kRecipients && messageCount == kRecipients && "Not every email was accepted");
+    assert(totalMs < kRecipients * kServerDelayMs / 4 && "Emails were not sent concurrently");
+    assert(server.getConnectionCount() <= kMaxHostConnections && "SMTP sessions were not reused");
+    
+    std::cout << "SMTP fan-out test completed successfully" << std::endl;
+}
+
+// Test function to verify per-request timeouts and HTTP error statuses
+void test_failures() {
+    std::cout << "Testing transport failures..." << std::endl;
+    
+    std::atomic<int> slowCount(0);
+    std::atomic<int> errorCount(0);
+    StandInServer slowServer(httpHandler(1000, 200, slowCount));
+    StandInServer errorServer(httpHandler(0, 500, errorCount));
+    
+    NotificationTransport transport;
+    bool started = transport.start();
+    assert(started && "Transport failed to start");
+    
+    TransportResult timedOut;
+    TransportResult rejected;
+    transport.postForm("http://127.0.0.1:" + std::to_string(slowServer.getPort()) + "/sms", "to=1",
+                       [&](const TransportResult& result) { timedOut = result; }, 200);
+    transport.postForm("http://127.0.0.1:" + std::to_string(errorServer.getPort()) + "/sms", "to=2",
+                       [&](const TransportResult& result) { rejected = result; });
+    transport.waitIdle();
+    
+    assert(!timedOut.success && !timedOut.error.empty() && "Slow request did not time out");
+    assert(timedOut.elapsedMs < 900 && "Timeout not applied per request");
+    assert(!rejected.success && rejected.responseCode == 500 && "HTTP 500 reported as success");
+    
+    // Requests after stop() fail at once rather than hanging
+    transport.stop();
+    TransportResult afterStop;
+    afterStop.success = true;
+    transport.postForm("http://127.0.0.1:1/sms", "to=3", [&](const TransportResult& result) { afterStop = result; });
+    assert(!afterStop.success && "Request accepted after stop");
+    
+    std::cout << "Transport failures test completed successfully" << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Notification Transport tests..." << std::endl;
+    
+    curl_global_init(CURL_GLOBAL_ALL);
+    
+    try {
+        test_http_fan_out();
+        test_smtp_fan_out();
+        test_failures();
+        
+        curl_global_cleanup();
+        std::cout << "All Notification Transport tests completed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
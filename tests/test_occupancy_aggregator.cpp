@@ -0,0 +1,226 @@
+#include "analytics/occupancy_aggregator.hpp"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <opencv2/opencv.hpp>
+
+using namespace hms;
+
+static const int64_t kMinuteMs = 60 * 1000;
+static const int64_t kHourMs = 60 * kMinuteMs;
+static const int64_t kDayMs = 24 * kHourMs;
+
+// Midnight, so bucket boundaries are easy to reason about
+static const int64_t kDayStart = 20000 * kDayMs;
+
+static const cv::Size kFrameSize(640, 480);
+
+static MovementSample makeSample(int64_t timestampMs, int trackId, int userId, const cv::Point& centre) {
+    MovementSample sample;
+    sample.timestampMs = timestampMs;
+    sample.trackId = trackId;
+    sample.userId = userId;
+    sample.box = cv::Rect(centre.x - 40, centre.y - 100, 80, 200);
+    return sample;
+}
+
+static ZoneMap makeZones() {
+    ZoneMap zones(8);
+    zones.addZone(0, "bed", {cv::Point(0, 0), cv::Point(320, 0), cv::Point(320, 240), cv::Point(0, 240)});
+    zones.addZone(0, "chair", {cv::Point(400, 300), cv::Point(500, 300), cv::Point(450, 400)});
+    zones.addZone(0, "room", {cv::Point(0, 0), cv::Point(639, 0), cv::Point(639, 479), cv::Point(0, 479)});
+    return zones;
+}
+
+// Test function to verify polygons are rasterized into zone masks
+void test_zone_map() {
+    std::cout << "Testing zone map..." << std::endl;
+    
+    ZoneMap zones = makeZones();
+    assert(zones.getZoneCount() == 3 && "Zones not added");
+    
+    int bed = zones.getZoneId("bed");
+    int chair = zones.getZoneId("chair");
+    int room = zones.getZoneId("room");
+    assert(zones.getZoneName(chair) == "chair" && "Zone name lookup failed");
+    
+    assert(zones.lookup(0, cv::Point(100, 100)) == ((1u << bed) | (1u << room)) && "Overlapping zones not both set");
+    assert(zones.lookup(0, cv::Point(450, 330)) == ((1u << chair) | (1u << room)) && "Triangle not rasterized");
+    assert(zones.lookup(0, cv::Point(410, 390)) == (1u << room) && "Point outside the triangle matched it");
+    assert(zones.lookup(0, cv::Point(5000, 100)) == 0 && "Point outside every zone matched");
+    assert(zones.lookup(1, cv::Point(100, 100)) == 0 && "Zones leaked to another camera");
+    
+    int lineZone = zones.addZone(0, "line", {cv::Point(0, 0), cv::Point(10, 10)});
+    assert(lineZone == -1 && "Degenerate polygon accepted");
+    
+    std::cout << "Zone map test completed successfully" << std::endl;
+}
+
+// Test function to verify dwell time is attributed to zones and users
+void test_dwell_time() {
+    std::cout << "Testing dwell time aggregation..." << std::endl;
+    
+    ZoneMap zones = makeZones();
+    OccupancyAggregator::Options options;
+    options.maxGapMs = 2000;
+    OccupancyAggregator aggregator(zones, options);
+    
+    int bed = zones.getZoneId("bed");
+    int chair = zones.getZoneId("chair");
+    int room = zones.getZoneId("room");
+    
+    // User 3: 90 minutes in bed from 10:30, then 30 minutes in the chair, at 10 fps
+    int64_t t = kDayStart + 10 * kHourMs + 30 * kMinuteMs;
+    for (int i = 0; i < 90 * 600; i++, t += 100) {
+        aggregator.addObservation(0, makeSample(t, 1, 3, cv::Point(100, 100)), kFrameSize);
+    }
+    for (int i = 0; i < 30 * 600; i++, t += 100) {
+        aggregator.addObservation(0, makeSample(t, 1, 3, cv::Point(450, 330)), kFrameSize);
+    }
+    
+    int64_t day = kDayStart;
+    int64_t bedMs = aggregator.getDwellMs(3, bed, day, day + kDayMs);
+    int64_t chairMs = aggregator.getDwellMs(3, chair, day, day + kDayMs);
+    assert(std::abs(bedMs - 90 * kMinuteMs) <= 100 && "Wrong time in bed");
+    assert(std::abs(chairMs - 30 * kMinuteMs) <= 100 && "Wrong time in chair");
+    assert(aggregator.getDwellMs(3, room, day, day + kDayMs) == bedMs + chairMs && "Overlapping zone not credited");
+    assert(aggregator.getDwellMs(OccupancyAggregator::ALL_USERS, bed, day, day + kDayMs) == bedMs &&
+           "Dwell not aggregated across users");
+    assert(aggregator.getDwellMs(4, bed, day, day + kDayMs) == 0 && "Dwell credited to another user");
+    
+    // Partial ranges combine hour and minute buckets: 11:00-11:45 is 45 min in bed
+    int64_t partialMs = aggregator.getDwellMs(3, bed, day + 11 * kHourMs, day + 11 * kHourMs + 45 * kMinuteMs);
+    assert(std::abs(partialMs - 45 * kMinuteMs) <= 100 && "Partial range summed wrong buckets");
+    
+    // A track that disappears for longer than maxGapMs is not counted as present
+    t = kDayStart + 20 * kHourMs;
+    aggregator.addObservation(0, makeSample(t, 2, 5, cv::Point(100, 100)), kFrameSize);
+    aggregator.addObservation(0, makeSample(t + 60 * 1000, 2, 5, cv::Point(100, 100)), kFrameSize);
+    assert(aggregator.getDwellMs(5, bed, day, day + kDayMs) == 0 && "Gap counted as dwell");
+    
+    // Queries read rollups, not samples
+    auto start = std::chrono::steady_clock::now();
+    const int queries = 10000;
+    int64_t total = 0;
+    for (int i = 0; i < queries; i++) {
+        total += aggregator.getDwellMs(3, bed, day + (i % 60) * kMinuteMs, day + kDayMs);
+    }
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    assert(total > 0 && "Dwell queries returned nothing");
+    std::cout << "Dwell query latency: " << us / queries << " us" << std::endl;
+    
+    std::cout << "Dwell time aggregation test completed successfully" << std::endl;
+}
+
+// Test function to verify a day of many residents does not wrap the counters
+void test_dwell_overflow() {
+    std::cout << "Testing dwell counter overflow..." << std::endl;
+    
+    ZoneMap zones = makeZones();
+    OccupancyAggregator::Options options;
+    OccupancyAggregator aggregator(zones, options);
+    int bed = zones.getZoneId("bed");
+    
+    // 60 residents seen in bed every maxGapMs for 23 hours: about 57
+    // person-days, past 2^32 ms
+    const int residents = 60;
+    const int64_t stayMs = 23 * kHourMs;
+    for (int64_t offset = 0; offset <= stayMs; offset += options.maxGapMs) {
+        for (int i = 0; i < residents; i++) {
+            aggregator.addObservation(0, makeSample(kDayStart + offset, 100 + i, i, cv::Point(100, 100)),
+                                      kFrameSize);
+        }
+    }
+    
+    int64_t expectedMs = residents * stayMs;
+    assert(expectedMs > static_cast<int64_t>(UINT32_MAX) && "Test does not reach the 32-bit limit");
+    int64_t dayMs = aggregator.getDwellMs(OccupancyAggregator::ALL_USERS, bed, kDayStart, kDayStart + kDayMs);
+    assert(dayMs == expectedMs && "Day bucket wrapped");
+    for (int hour = 0; hour < 24; hour++) {
+        int64_t from = kDayStart + hour * kHourMs;
+        int64_t hourMs = aggregator.getDwellMs(OccupancyAggregator::ALL_USERS, bed, from, from + kHourMs);
+        assert(hourMs == (hour < 23 ? residents * kHourMs : 0) && "Hour holds more than an hour per resident");
+    }
+    int64_t userMs = aggregator.getDwellMs(7, bed, kDayStart, kDayStart + kDayMs);
+    assert(userMs == stayMs && "Per-user dwell wrong");
+    
+    std::cout << "Dwell counter overflow test completed successfully" << std::endl;
+}
+
+// Test function to verify time between sightings is split across bucket boundaries
+void test_dwell_split_across_buckets() {
+    std::cout << "Testing dwell split across buckets..." << std::endl;
+    
+    ZoneMap zones = makeZones();
+    OccupancyAggregator::Options options;
+    options.maxGapMs = 2 * kMinuteMs;
+    OccupancyAggregator aggregator(zones, options);
+    int bed = zones.getZoneId("bed");
+    
+    // A minute in bed, half before the hour and half after it
+    int64_t t = kDayStart + kHourMs - 30 * 1000;
+    aggregator.addObservation(0, makeSample(t, 1, 3, cv::Point(100, 100)), kFrameSize);
+    aggregator.addObservation(0, makeSample(t + kMinuteMs, 1, 3, cv::Point(100, 100)), kFrameSize);
+    
+    int64_t firstHour = aggregator.getDwellMs(3, bed, kDayStart, kDayStart + kHourMs);
+    int64_t secondHour = aggregator.getDwellMs(3, bed, kDayStart + kHourMs, kDayStart + 2 * kHourMs);
+    int64_t lastMinute = aggregator.getDwellMs(3, bed, kDayStart + kHourMs - kMinuteMs, kDayStart + kHourMs);
+    assert(firstHour == 30 * 1000 && secondHour == 30 * 1000 && "Interval not split at the hour");
+    assert(lastMinute == 30 * 1000 && "Interval not split at the minute");
+    
+    std::cout << "Dwell split across buckets test completed successfully" << std::endl;
+}
+
+// Test function to verify the heatmap grid and its rollups
+void test_heatmap() {
+    std::cout << "Testing occupancy heatmap..." << std::endl;
+    
+    ZoneMap zones = makeZones();
+    OccupancyAggregator::Options options;
+    options.gridCols = 32;
+    options.gridRows = 24;
+    OccupancyAggregator aggregator(zones, options);
+    
+    // Ten minutes standing at (100, 100) over two days
+    int64_t t = kDayStart + 23 * kHourMs + 55 * kMinuteMs;
+    for (int i = 0; i < 10 * 60; i++, t += 1000) {
+        aggregator.addObservation(0, makeSample(t, 1, -1, cv::Point(100, 100)), kFrameSize);
+    }
+    
+    cv::Mat heatmap = aggregator.getHeatmap(0, kDayStart, kDayStart + 2 * kDayMs);
+    assert(heatmap.rows == 24 && heatmap.cols == 32 && "Heatmap has wrong grid size");
+    
+    int col = 100 * 32 / 640;
+    int row = 100 * 24 / 480;
+    assert(std::abs(heatmap.at<float>(row, col) - 599.0f) < 0.01f && "Time not credited to the cell");
+    assert(cv::sum(heatmap)[0] == heatmap.at<float>(row, col) && "Time credited to other cells");
+    
+    // Split across the day boundary: 5 minutes on each side, last one
+    // still waiting for the next sighting
+    cv::Mat firstDay = aggregator.getHeatmap(0, kDayStart, kDayStart + kDayMs);
+    assert(std::abs(firstDay.at<float>(row, col) - 300.0f) < 0.01f && "Day rollup wrong");
+    
+    assert(cv::sum(aggregator.getHeatmap(1, kDayStart, kDayStart + kDayMs))[0] == 0 &&
+           "Heatmap leaked to another camera");
+    
+    std::cout << "Occupancy heatmap test completed successfully" << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Occupancy Aggregator tests..." << std::endl;
+    
+    try {
+        test_zone_map();
+        test_dwell_time();
+        test_dwell_overflow();
+        test_dwell_split_across_buckets();
+        test_heatmap();
+        
+        std::cout << "All Occupancy Aggregator tests completed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
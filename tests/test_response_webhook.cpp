@@ -0,0 +1,238 @@
+#include "network/response_webhook.hpp"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <curl/curl.h>
+
+using namespace hms;
+
+// What the webhook handed over
+struct Received {
+    std::mutex mutex;
+    std::vector<SmsReply> replies;
+    std::vector<SmsStatusReport> reports;
+};
+
+static ResponseWebhook makeWebhook(Received& received, const ResponseWebhook::Options& options) {
+    return ResponseWebhook(options,
+                           [&received](const SmsReply& reply) {
+                               std::lock_guard<std::mutex> lock(received.mutex);
+                               received.replies.push_back(reply);
+                           },
+                           [&received](const SmsStatusReport& report) {
+                               std::lock_guard<std::mutex> lock(received.mutex);
+                               received.reports.push_back(report);
+                           });
+}
+
+static size_t discardBody(char*, size_t size, size_t count, void*) {
+    return size * count;
+}
+
+// Posts a body the way a provider would; returns the HTTP status, 0 on a
+// connection failure
+static long post(CURL* curl, const std::string& url, const std::string& body,
+                 const std::string& contentType = "application/x-www-form-urlencoded",
+                 const std::string& token = "") {
+    struct curl_slist* headers = nullptr;
+    headers = curl_slist_append(headers, ("Content-Type: " + contentType).c_str());
+    if (!token.empty()) {
+        headers = curl_slist_append(headers, ("X-Webhook-Token: " + token).c_str());
+    }
+    
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.size()));
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discardBody);
+    
+    long status = 0;
+    if (curl_easy_perform(curl) == CURLE_OK) {
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, nullptr);
+    curl_slist_free_all(headers);
+    return status;
+}
+
+static std::string baseUrl(const ResponseWebhook& webhook) {
+    return "http://127.0.0.1:" + std::to_string(webhook.getPort());
+}
+
+// Test function to verify form-encoded replies and status reports reach the handlers
+void test_form_callbacks() {
+    std::cout << "Testing form-encoded callbacks..." << std::endl;
+    
+    ResponseWebhook::Options options;
+    options.port = 0;
+    Received received;
+    ResponseWebhook webhook = makeWebhook(received, options);
+    bool started = webhook.start();
+    assert(started && "Webhook did not start");
+    
+    CURL* curl = curl_easy_init();
+    auto start = std::chrono::steady_clock::now();
+    long status = post(curl, baseUrl(webhook) + "/sms/reply",
+                       "From=%2B15550100&To=%2B15559999&Body=On+my+way%2C+10+min&MessageSid=SM1");
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    assert(status == 200 && "Reply not accepted");
+    
+    // The handler has run by the time the provider gets its answer
+    {
+        std::lock_guard<std::mutex> lock(received.mutex);
+        assert(received.replies.size() == 1 && "Reply not handed over");
+        assert(received.replies[0].from == "+15550100" && received.replies[0].to == "+15559999" &&
+               "Numbers not decoded");
+        assert(received.replies[0].text == "On my way, 10 min" && "Text not decoded");
+        assert(received.replies[0].messageId == "SM1" && "Message id lost");
+    }
+    std::cout << "Reply handled in " << elapsedMs << " ms" << std::endl;
+    
+    status = post(curl, baseUrl(webhook) + "/sms/status",
+                  "To=%2B15550100&MessageStatus=Delivered&MessageSid=SM2");
+    assert(status == 200 && "Status report not accepted");
+    status = post(curl, baseUrl(webhook) + "/sms/status",
+                  "To=%2B15550101&MessageStatus=undelivered&ErrorCode=30003");
+    assert(status == 200 && "Failure report not accepted");
+    
+    // All three went over one kept-alive connection
+    long connects = -1;
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+    assert(connects == 0 && "Connection not kept alive");
+    
+    {
+        std::lock_guard<std::mutex> lock(received.mutex);
+        assert(received.reports.size() == 2 && "Reports not handed over");
+        assert(received.reports[0].status == "delivered" && received.reports[0].to == "+15550100" &&
+               "Status not normalized");
+        assert(received.reports[1].status == "undelivered" && received.reports[1].error == "30003" &&
+               "Error code lost");
+    }
+    
+    curl_easy_cleanup(curl);
+    webhook.stop();
+    
+    ResponseWebhook::Stats stats = webhook.getStats();
+    assert(stats.replies == 1 && stats.statusReports == 2 && stats.rejected == 0 && "Wrong counters");
+    
+    std::cout << "Form-encoded callback test completed successfully" << std::endl;
+}
+
+// Test function to verify JSON payloads are accepted too
+void test_json_callbacks() {
+    std::cout << "Testing JSON callbacks..." << std::endl;
+    
+    ResponseWebhook::Options options;
+    options.port = 0;
+    Received received;
+    ResponseWebhook webhook = makeWebhook(received, options);
+    webhook.start();
+    
+    CURL* curl = curl_easy_init();
+    long status = post(curl, baseUrl(webhook) + "/sms/reply",
+                       "{\"from\": \"+15550100\", \"text\": \"Calling an ambulance\", \"message_id\": 42}",
+                       "application/json; charset=utf-8");
+    assert(status == 200 && "JSON reply not accepted");
+    status = post(curl, baseUrl(webhook) + "/sms/status", "{\"to\": \"+15550100\", \"status\": \"READ\"}",
+                  "application/json");
+    assert(status == 200 && "JSON status not accepted");
+    
+    {
+        std::lock_guard<std::mutex> lock(received.mutex);
+        assert(received.replies.size() == 1 && received.replies[0].text == "Calling an ambulance" &&
+               received.replies[0].messageId == "42" && "JSON reply fields lost");
+        assert(received.reports.size() == 1 && received.reports[0].status == "read" && "JSON status lost");
+    }
+    
+    curl_easy_cleanup(curl);
+    std::cout << "JSON callback test completed successfully" << std::endl;
+}
+
+// Test function to verify bad requests are turned away without reaching the handlers
+void test_rejected_requests() {
+    std::cout << "Testing rejected requests..." << std::endl;
+    
+    ResponseWebhook::Options options;
+    options.port = 0;
+    options.token = "s3cret";
+    options.maxBodyBytes = 256;
+    Received received;
+    ResponseWebhook webhook = makeWebhook(received, options);
+    webhook.start();
+    std::string url = baseUrl(webhook);
+    
+    CURL* curl = curl_easy_init();
+    const std::string reply = "From=%2B15550100&Body=ok";
+    long status = post(curl, url + "/sms/reply", reply);
+    assert(status == 401 && "Missing token accepted");
+    status = post(curl, url + "/sms/reply", reply, "application/x-www-form-urlencoded", "wrong!");
+    assert(status == 401 && "Wrong token accepted");
+    status = post(curl, url + "/sms/reply", reply, "application/x-www-form-urlencoded", "s3cret");
+    assert(status == 200 && "Token header refused");
+    status = post(curl, url + "/sms/reply?token=s3cret", reply);
+    assert(status == 200 && "Token parameter refused");
+    
+    status = post(curl, url + "/sms/other?token=s3cret", reply);
+    assert(status == 404 && "Unknown path accepted");
+    status = post(curl, url + "/sms/reply?token=s3cret", "Body=no+sender");
+    assert(status == 400 && "Reply without sender accepted");
+    status = post(curl, url + "/sms/status?token=s3cret", "To=%2B15550100");
+    assert(status == 400 && "Status without state accepted");
+    status = post(curl, url + "/sms/reply?token=s3cret", "{not json", "application/json");
+    assert(status == 400 && "Malformed JSON accepted");
+    status = post(curl, url + "/sms/reply?token=s3cret", "From=1&Body=" + std::string(1024, 'x'));
+    assert(status == 413 && "Oversized body accepted");
+    
+    // Only POST is taken
+    curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+    curl_easy_setopt(curl, CURLOPT_URL, (url + "/sms/reply?token=s3cret").c_str());
+    status = 0;
+    if (curl_easy_perform(curl) == CURLE_OK) {
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    }
+    assert(status == 405 && "GET accepted");
+    curl_easy_cleanup(curl);
+    
+    {
+        std::lock_guard<std::mutex> lock(received.mutex);
+        assert(received.replies.size() == 2 && received.reports.empty() && "Rejected request handed over");
+    }
+    assert(webhook.getStats().rejected == 8 && "Wrong rejected count");
+    
+    // Reachable from other machines, a token is required
+    ResponseWebhook::Options open;
+    open.address = "0.0.0.0";
+    open.port = 0;
+    ResponseWebhook exposed = makeWebhook(received, open);
+    bool exposedStarted = exposed.start();
+    assert(!exposedStarted && "Webhook without a token listened on every interface");
+    open.token = "s3cret";
+    ResponseWebhook guarded = makeWebhook(received, open);
+    bool guardedStarted = guarded.start();
+    assert(guardedStarted && "Webhook with a token refused to start");
+    guarded.stop();
+    
+    std::cout << "Rejected request test completed successfully" << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Response Webhook tests..." << std::endl;
+    
+    curl_global_init(CURL_GLOBAL_ALL);
+    try {
+        test_form_callbacks();
+        test_json_callbacks();
+        test_rejected_requests();
+        
+        std::cout << "All Response Webhook tests completed!" << std::endl;
+        curl_global_cleanup();
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        curl_global_cleanup();
+        return 1;
+    }
+}
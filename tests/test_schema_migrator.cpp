@@ -0,0 +1,201 @@
+#include "database/schema_migrator.hpp"
+#include "database/user_database.hpp"
+#include <iostream>
+#include <cassert>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstdio>
+
+using namespace hms;
+
+// Directory holding the fixture databases; set from the command line
+static std::string g_fixtureDir = "fixtures";
+
+static void removeDatabaseFiles(const std::string& path) {
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+}
+
+static bool tableExists(sqlite3* db, const std::string& type, const std::string& name) {
+    std::string sql = "SELECT 1 FROM sqlite_master WHERE type = '" + type + "' AND name = '" + name + "';";
+    bool found = false;
+    sqlite3_exec(db, sql.c_str(), [](void* out, int, char**, char**) {
+        *static_cast<bool*>(out) = true;
+        return 0;
+    }, &found, nullptr);
+    return found;
+}
+
+// Builds a database file from a fixture SQL script
+static bool loadFixture(const std::string& fixture, const std::string& path) {
+    std::ifstream file(g_fixtureDir + "/" + fixture);
+    if (!file.is_open()) {
+        std::cerr << "Missing fixture: " << g_fixtureDir << "/" << fixture << std::endl;
+        return false;
+    }
+    std::stringstream script;
+    script << file.rdbuf();
+    
+    removeDatabaseFiles(path);
+    sqlite3* db = nullptr;
+    sqlite3_open(path.c_str(), &db);
+    int rc = sqlite3_exec(db, script.str().c_str(), nullptr, nullptr, nullptr);
+    sqlite3_close(db);
+    return rc == SQLITE_OK;
+}
+
+// Test function to verify migrations run in order, once
+void test_migration_order() {
+    std::cout << "Testing migration order..." << std::endl;
+    
+    SchemaMigrator migrator("test");
+    bool skipped = migrator.addMigration(2, "skips a version", "SELECT 1;");
+    assert(!skipped && "Out of order migration accepted");
+    bool first = migrator.addMigration(1, "create", "CREATE TABLE a (x INTEGER);");
+    assert(first && "Migration 1 rejected");
+    bool second = migrator.addMigration(2, "fill", "INSERT INTO a VALUES (1);");
+    assert(second && "Migration 2 rejected");
+    assert(migrator.getLatestVersion() == 2 && "Wrong latest version");
+    
+    sqlite3* db = nullptr;
+    sqlite3_open(":memory:", &db);
+    assert(SchemaMigrator::getVersion(db) == 0 && "New database not at version 0");
+    bool migrated = migrator.migrate(db);
+    assert(migrated && SchemaMigrator::getVersion(db) == 2 && "Migrations not applied");
+    
+    // Running again is a no-op: the INSERT must not repeat
+    migrated = migrator.migrate(db);
+    assert(migrated && "Second run failed");
+    int rows = 0;
+    sqlite3_exec(db, "SELECT COUNT(*) FROM a;", [](void* out, int, char** values, char**) {
+        *static_cast<int*>(out) = std::atoi(values[0]);
+        return 0;
+    }, &rows, nullptr);
+    assert(rows == 1 && "Migration applied twice");
+    sqlite3_close(db);
+    
+    std::cout << "Migration order test completed successfully" << std::endl;
+}
+
+// Test function to verify a failing step leaves the previous version intact
+void test_failed_migration() {
+    std::cout << "Testing failed migration..." << std::endl;
+    
+    sqlite3* db = nullptr;
+    sqlite3_open(":memory:", &db);
+    
+    SchemaMigrator broken("test");
+    broken.addMigration(1, "create", "CREATE TABLE a (x INTEGER);");
+    broken.addMigration(2, "half done", "CREATE TABLE b (y INTEGER); INSERT INTO missing VALUES (1);");
+    assert(!broken.migrate(db) && "Broken migration reported success");
+    assert(SchemaMigrator::getVersion(db) == 1 && "Version moved past the failed step");
+    assert(tableExists(db, "table", "a") && !tableExists(db, "table", "b") && "Failed step not rolled back");
+    
+    // A fixed build resumes from version 1
+    SchemaMigrator fixed("test");
+    fixed.addMigration(1, "create", "CREATE TABLE a (x INTEGER);");
+    fixed.addMigration(2, "fixed", "CREATE TABLE b (y INTEGER);");
+    bool migrated = fixed.migrate(db);
+    assert(migrated && SchemaMigrator::getVersion(db) == 2 && tableExists(db, "table", "b") && "Upgrade did not resume");
+    
+    // A database from a newer build is left alone
+    sqlite3_exec(db, "PRAGMA user_version = 7;", nullptr, nullptr, nullptr);
+    assert(!fixed.migrate(db) && "Newer database accepted");
+    assert(SchemaMigrator::getVersion(db) == 7 && "Newer database downgraded");
+    sqlite3_close(db);
+    
+    std::cout << "Failed migration test completed successfully" << std::endl;
+}
+
+// Test function to verify older user databases upgrade with their data
+void test_user_database_upgrades() {
+    std::cout << "Testing user database upgrades..." << std::endl;
+    
+    const std::string path = "test_schema_upgrade.db";
+    const char* fixtures[] = {"user_database_v0.sql", "user_database_v1.sql"};
+    int latest = -1;
+    
+    for (const char* fixture : fixtures) {
+        bool loaded = loadFixture(fixture, path);
+        assert(loaded && "Fixture could not be loaded");
+        
+        {
+            UserDatabase db(path);
+            bool initialized = db.initialize();
+            assert(initialized && "Upgrade failed");
+            
+            std::vector<User> users = db.getAllUsers();
+            assert(users.size() == 3 && "Users lost in upgrade");
+            assert(users[0].name == "Margaret Hill" && users[0].imageReference == "images/margaret.jpg" &&
+                   "User fields lost in upgrade");
+            assert(users[0].emergencyContacts.size() == 2 && users[0].emergencyContacts[1].id == 5 &&
+                   "Contacts lost in upgrade");
+            assert(users[0].familyDoctor.specialization == "Geriatrics" && "Doctor lost in upgrade");
+            assert(users[2].id == 4 && "User IDs changed in upgrade");
+            
+            // Existing residents are added to the search index
+            std::vector<User> found = db.searchUsers("pate", 10);
+            assert(found.size() == 1 && found[0].id == 1 && "Existing users not indexed in upgrade");
+            
+            // New rows continue after the existing IDs
+            User user;
+            user.name = "New Resident";
+            bool added = db.addUser(user);
+            assert(added && user.id == 5 && "Insert after upgrade failed");
+        }
+        
+        sqlite3* raw = nullptr;
+        sqlite3_open(path.c_str(), &raw);
+        int version = SchemaMigrator::getVersion(raw);
+        assert(version >= 2 && "Schema version not bumped");
+        assert((latest < 0 || version == latest) && "Fixtures upgraded to different versions");
+        latest = version;
+        assert(tableExists(raw, "index", "idx_emergency_contacts_user") &&
+               tableExists(raw, "index", "idx_doctors_user") && "Indexes not created by upgrade");
+        sqlite3_close(raw);
+    }
+    
+    // A new database starts at the same version as an upgraded one
+    removeDatabaseFiles(path);
+    {
+        UserDatabase db(path);
+        bool initialized = db.initialize();
+        assert(initialized && "New database failed to initialize");
+    }
+    sqlite3* raw = nullptr;
+    sqlite3_open(path.c_str(), &raw);
+    assert(SchemaMigrator::getVersion(raw) == latest && "New and upgraded databases differ in version");
+    
+    // And one from a newer build is refused
+    sqlite3_exec(raw, "PRAGMA user_version = 1000;", nullptr, nullptr, nullptr);
+    sqlite3_close(raw);
+    {
+        UserDatabase db(path);
+        assert(!db.initialize() && "Database from a newer build opened");
+    }
+    
+    removeDatabaseFiles(path);
+    std::cout << "User database upgrades test completed successfully" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::cout << "Starting Schema Migrator tests..." << std::endl;
+    
+    if (argc > 1) {
+        g_fixtureDir = argv[1];
+    }
+    
+    try {
+        test_migration_order();
+        test_failed_migration();
+        test_user_database_upgrades();
+        
+        std::cout << "All Schema Migrator tests completed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,88 @@
+#include "network/snapshot_encoder.hpp"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace hms;
+
+// Test function to verify a full frame is scaled down and compressed under the limits
+void test_frame_fits_limits() {
+    std::cout << "Testing frame compression..." << std::endl;
+    
+    // Noise compresses badly, so the size limit is what decides
+    cv::Mat frame(1080, 1920, CV_8UC3);
+    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+    
+    SnapshotEncoder encoder;
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<const MessageAttachment> attachment = encoder.encode(frame, "snapshot_1.jpg");
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    assert(attachment && "Frame not encoded");
+    assert(attachment->filename == "snapshot_1.jpg" && attachment->contentType == "image/jpeg" &&
+           "Wrong attachment details");
+    assert(attachment->data.size() <= encoder.getOptions().maxBytes && "Snapshot over the size limit");
+    
+    cv::Mat decoded = cv::imdecode(attachment->data, cv::IMREAD_COLOR);
+    assert(!decoded.empty() && "Snapshot is not a valid JPEG");
+    assert(std::max(decoded.cols, decoded.rows) <= encoder.getOptions().maxDimension && "Snapshot not scaled down");
+    assert(std::abs(decoded.cols * 1080 / 1920 - decoded.rows) <= 1 && "Aspect ratio not kept");
+    
+    std::cout << "Encoded " << attachment->data.size() << " bytes in " << elapsedMs << " ms" << std::endl;
+    std::cout << "Frame compression test completed successfully" << std::endl;
+}
+
+// Test function to verify a small, smooth crop is sent at its own size
+void test_small_crop_kept() {
+    std::cout << "Testing small crop..." << std::endl;
+    
+    cv::Mat crop(240, 120, CV_8UC3, cv::Scalar(40, 90, 160));
+    cv::rectangle(crop, cv::Rect(20, 40, 60, 120), cv::Scalar(200, 200, 200), cv::FILLED);
+    
+    SnapshotEncoder encoder;
+    std::shared_ptr<const MessageAttachment> attachment = encoder.encode(crop, "snapshot_2.jpg");
+    assert(attachment && "Crop not encoded");
+    
+    cv::Mat decoded = cv::imdecode(attachment->data, cv::IMREAD_COLOR);
+    assert(decoded.cols == 120 && decoded.rows == 240 && "Small crop resized");
+    
+    std::cout << "Small crop test completed successfully" << std::endl;
+}
+
+// Test function to verify what cannot be encoded is refused
+void test_refused_images() {
+    std::cout << "Testing refused images..." << std::endl;
+    
+    SnapshotEncoder encoder;
+    std::shared_ptr<const MessageAttachment> attachment = encoder.encode(cv::Mat(), "empty.jpg");
+    assert(!attachment && "Empty image encoded");
+    
+    // Smaller than any JPEG could be
+    SnapshotEncoder::Options options;
+    options.maxBytes = 64;
+    SnapshotEncoder tiny(options);
+    cv::Mat frame(480, 640, CV_8UC3);
+    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+    attachment = tiny.encode(frame, "snapshot_3.jpg");
+    assert(!attachment && "Impossible size limit met");
+    
+    std::cout << "Refused image test completed successfully" << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Snapshot Encoder tests..." << std::endl;
+    
+    try {
+        test_frame_fits_limits();
+        test_small_crop_kept();
+        test_refused_images();
+        
+        std::cout << "All Snapshot Encoder tests completed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
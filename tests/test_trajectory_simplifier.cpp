@@ -0,0 +1,161 @@
+#include "analytics/trajectory_simplifier.hpp"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+
+using namespace hms;
+
+static MovementSample makeSample(int64_t timestampMs, int x, int y) {
+    MovementSample sample;
+    sample.timestampMs = timestampMs;
+    sample.trackId = 7;
+    sample.userId = -1;
+    sample.box = cv::Rect(x, y, 80, 200);
+    return sample;
+}
+
+// 30 fps: walk right for 10 s, stand still for 20 s, walk back for 10 s
+static std::vector<MovementSample> makeTrack() {
+    std::vector<MovementSample> track;
+    int64_t t = 0;
+    for (int i = 0; i < 300; i++, t += 33) {
+        track.push_back(makeSample(t, 100 + i * 2, 200 + static_cast<int>(10 * std::sin(i / 15.0))));
+    }
+    for (int i = 0; i < 600; i++, t += 33) {
+        track.push_back(makeSample(t, 700, 200));
+    }
+    for (int i = 0; i < 300; i++, t += 33) {
+        track.push_back(makeSample(t, 700 - i * 2, 200));
+    }
+    return track;
+}
+
+// Test function to verify Douglas-Peucker keeps only what the error allows
+void test_compaction() {
+    std::cout << "Testing trajectory compaction..." << std::endl;
+    
+    // Constant velocity: every inner point is exactly on the interpolated track
+    std::vector<MovementSample> line;
+    for (int i = 0; i < 50; i++) {
+        line.push_back(makeSample(i * 100, i * 3, 100));
+    }
+    auto compacted = TrajectorySimplifier::compact(line, 1.0);
+    assert(compacted.size() == 2 && "Straight track should reduce to its endpoints");
+    
+    // A stop halfway through cannot be interpolated away
+    std::vector<MovementSample> stop;
+    for (int i = 0; i < 25; i++) {
+        stop.push_back(makeSample(i * 100, i * 3, 100));
+    }
+    stop.push_back(makeSample(7400, 72, 100));
+    for (int i = 25; i < 50; i++) {
+        stop.push_back(makeSample(5000 + i * 100, i * 3, 100));
+    }
+    compacted = TrajectorySimplifier::compact(stop, 1.0);
+    assert(compacted.size() > 2 && "Pause in the track was dropped");
+    
+    std::cout << "Trajectory compaction test completed successfully" << std::endl;
+}
+
+// Test function to verify the storage reduction and reconstruction error
+void test_simplifier() {
+    std::cout << "Testing trajectory simplifier..." << std::endl;
+    
+    TrajectorySimplifier::Options options;
+    options.minDisplacementPx = 8.0;
+    options.maxIntervalMs = 5000;
+    options.epsilonPx = 4.0;
+    options.trackTimeoutMs = 2000;
+    options.maxPendingSamples = 4096;   // Hold the whole track until it closes
+    
+    std::vector<MovementSample> stored;
+    TrajectorySimplifier simplifier(options,
+        [&stored](size_t cameraIndex, const std::vector<MovementSample>& samples) {
+            assert(cameraIndex == 0 && "Wrong camera");
+            stored.insert(stored.end(), samples.begin(), samples.end());
+        });
+    
+    auto track = makeTrack();
+    for (const auto& sample : track) {
+        simplifier.addSample(0, sample);
+    }
+    
+    // Still open: nothing is written until the track closes
+    simplifier.closeIdleTracks(track.back().timestampMs + 1000);
+    assert(stored.empty() && "Track closed before its timeout");
+    
+    simplifier.closeIdleTracks(track.back().timestampMs + 2000);
+    assert(!stored.empty() && "Track was not closed after its timeout");
+    assert(stored.front().timestampMs == track.front().timestampMs && "Track start lost");
+    assert(stored.back().timestampMs == track.back().timestampMs && "Track end lost");
+    
+    // Reconstruct every original sample by interpolating the stored ones
+    double maxError = 0.0;
+    size_t segment = 0;
+    for (const auto& sample : track) {
+        while (segment + 2 < stored.size() && stored[segment + 1].timestampMs < sample.timestampMs) {
+            segment++;
+        }
+        double error = TrajectorySimplifier::synchronizedDistance(sample, stored[segment], stored[segment + 1]);
+        maxError = std::max(maxError, error);
+    }
+    
+    TrajectorySimplifier::Stats stats = simplifier.getStats();
+    std::cout << "Input samples: " << stats.inputSamples
+              << ", after threshold: " << stats.thresholdSamples
+              << ", stored: " << stats.storedSamples
+              << " (" << stats.getReductionRatio() << "x)"
+              << ", reconstruction error: " << maxError << " px" << std::endl;
+    
+    assert(stats.inputSamples == track.size() && "Input not counted");
+    assert(stats.storedSamples == stored.size() && "Stored samples not counted");
+    assert(stats.getReductionRatio() >= 10.0 && "Expected at least 10x fewer samples");
+    assert(std::abs(stats.maxErrorPx - maxError) < 1e-9 && "Reported error is not the reconstruction error");
+    
+    std::cout << "Trajectory simplifier test completed successfully" << std::endl;
+}
+
+// Test function to verify long tracks are flushed before they close
+void test_pending_flush() {
+    std::cout << "Testing trajectory pending flush..." << std::endl;
+    
+    TrajectorySimplifier::Options options;
+    options.maxPendingSamples = 16;
+    
+    std::vector<MovementSample> stored;
+    TrajectorySimplifier simplifier(options,
+        [&stored](size_t, const std::vector<MovementSample>& samples) {
+            stored.insert(stored.end(), samples.begin(), samples.end());
+        });
+    
+    // Zig-zag so every sample passes the threshold and survives compaction
+    for (int i = 0; i < 100; i++) {
+        simplifier.addSample(0, makeSample(i * 100, i * 20, (i % 2) * 40));
+    }
+    assert(stored.size() >= 90 && "Long track was not flushed while open");
+    
+    simplifier.closeAllTracks();
+    assert(stored.size() == 100 && "Samples lost or duplicated across flushes");
+    for (size_t i = 1; i < stored.size(); i++) {
+        assert(stored[i].timestampMs > stored[i - 1].timestampMs && "Samples out of order");
+    }
+    
+    std::cout << "Trajectory pending flush test completed successfully" << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Trajectory Simplifier tests..." << std::endl;
+    
+    try {
+        test_compaction();
+        test_simplifier();
+        test_pending_flush();
+        
+        std::cout << "All Trajectory Simplifier tests completed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,251 @@
+#include "database/user_database.hpp"
+#include "database/user_directory.hpp"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+
+using namespace hms;
+
+static void removeDatabaseFiles(const std::string& path) {
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+}
+
+static User makeUser(const std::string& name, int contacts) {
+    User user;
+    user.id = -1;
+    user.name = name;
+    for (int c = 0; c < contacts; c++) {
+        EmergencyContact contact;
+        contact.name = name + " contact " + std::to_string(c);
+        contact.phone = "555-010" + std::to_string(c);
+        user.emergencyContacts.push_back(contact);
+    }
+    user.familyDoctor.name = "Dr. " + name;
+    user.familyDoctor.phone = "555-0199";
+    return user;
+}
+
+// True if the directory holds exactly what the database does
+static bool matchesDatabase(UserDatabase& db) {
+    std::vector<User> stored = db.getAllUsers();
+    auto snapshot = db.getDirectory().getSnapshot();
+    if (stored.size() != snapshot->users.size()) {
+        return false;
+    }
+    
+    for (const auto& user : stored) {
+        auto cached = snapshot->find(user.id);
+        if (!cached || cached->name != user.name || cached->notes != user.notes ||
+            cached->familyDoctor.name != user.familyDoctor.name ||
+            cached->emergencyContacts.size() != user.emergencyContacts.size()) {
+            return false;
+        }
+        for (size_t c = 0; c < user.emergencyContacts.size(); c++) {
+            if (cached->emergencyContacts[c].name != user.emergencyContacts[c].name ||
+                cached->emergencyContacts[c].phone != user.emergencyContacts[c].phone) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Test function to verify the directory is loaded at startup
+void test_load() {
+    std::cout << "Testing directory load..." << std::endl;
+    
+    const std::string path = "test_user_directory.db";
+    removeDatabaseFiles(path);
+    
+    {
+        UserDatabase db(path);
+        bool initialized = db.initialize();
+        assert(initialized && "Database initialization failed");
+        std::vector<User> users = {makeUser("Ann", 2), makeUser("Ben", 1), makeUser("Cy", 0)};
+        bool added = db.addUsers(users);
+        assert(added && "Failed to add users");
+    }
+    
+    UserDatabase db(path);
+    bool initialized = db.initialize();
+    assert(initialized && "Database initialization failed");
+    assert(db.getDirectory().getSnapshot()->users.size() == 3 && "Directory not loaded");
+    assert(matchesDatabase(db) && "Loaded directory differs from the database");
+    
+    removeDatabaseFiles(path);
+    std::cout << "Directory load test completed successfully" << std::endl;
+}
+
+// Test function to verify writes update the directory incrementally
+void test_incremental_updates() {
+    std::cout << "Testing incremental updates..." << std::endl;
+    
+    UserDatabase db(":memory:");
+    bool initialized = db.initialize();
+    assert(initialized && "Database initialization failed");
+    UserDirectory& directory = db.getDirectory();
+    
+    std::vector<uint64_t> versions;
+    directory.registerChangeCallback([&versions](uint64_t version) {
+        versions.push_back(version);
+    });
+    
+    User ann = makeUser("Ann", 2);
+    User ben = makeUser("Ben", 1);
+    bool added = db.addUser(ann) && db.addUser(ben);
+    assert(added && "Failed to add users");
+    assert(versions.size() == 2 && "One change notification per committed write expected");
+    assert(matchesDatabase(db) && "Added users missing from the directory");
+    
+    auto before = directory.getSnapshot();
+    
+    ann.notes = "Room 4";
+    bool updated = db.updateUser(ann);
+    assert(updated && "Failed to update user");
+    EmergencyContact extra;
+    extra.name = "Neighbour";
+    extra.phone = "555-0110";
+    bool contactAdded = db.addEmergencyContact(ann.id, extra);
+    assert(contactAdded && "Failed to add contact");
+    extra.phone = "555-0111";
+    bool contactUpdated = db.updateEmergencyContact(ann.id, 2, extra);
+    assert(contactUpdated && "Failed to update contact");
+    bool contactDeleted = db.deleteEmergencyContact(ann.id, 0);
+    assert(contactDeleted && "Failed to delete contact");
+    Doctor doctor;
+    doctor.name = "Dr. New";
+    doctor.phone = "555-0120";
+    bool doctorSet = db.setFamilyDoctor(ann.id, doctor);
+    assert(doctorSet && "Failed to set doctor");
+    assert(matchesDatabase(db) && "Directory missed an update");
+    
+    // Snapshots already handed out never change, and untouched users are shared
+    assert(before->find(ann.id)->notes.empty() && before->find(ann.id)->emergencyContacts.size() == 2 &&
+           "Published snapshot was modified");
+    assert(before->find(ben.id) == directory.findUser(ben.id) && "Unchanged user was copied");
+    
+    bool deleted = db.deleteUser(ben.id);
+    assert(deleted && "Failed to delete user");
+    assert(!directory.findUser(ben.id) && "Deleted user still in the directory");
+    assert(before->find(ben.id) && "Deleted user vanished from an old snapshot");
+    assert(matchesDatabase(db) && "Directory differs after delete");
+    
+    // Failed writes publish nothing
+    uint64_t version = directory.getSnapshot()->version;
+    bool outOfRangeUpdated = db.updateEmergencyContact(ann.id, 10, extra);
+    assert(!outOfRangeUpdated && "Out of range contact updated");
+    assert(directory.getSnapshot()->version == version && "Failed write changed the directory");
+    
+    // Lookups never reach SQLite
+    uint64_t statements = db.getStatementCount();
+    for (int i = 0; i < 1000; i++) {
+        assert(directory.findUser(ann.id) && "User not found");
+    }
+    assert(db.getStatementCount() == statements && "Directory lookup ran SQL");
+    
+    std::cout << "Incremental updates test completed successfully" << std::endl;
+}
+
+// Test function to verify rolled back batches leave the directory alone
+void test_rollback() {
+    std::cout << "Testing rollback..." << std::endl;
+    
+    const std::string path = "test_user_directory_rollback.db";
+    removeDatabaseFiles(path);
+    
+    {
+        UserDatabase db(path);
+        bool initialized = db.initialize();
+        assert(initialized && "Database initialization failed");
+        
+        sqlite3* other = nullptr;
+        sqlite3_open(path.c_str(), &other);
+        sqlite3_exec(other, "CREATE TRIGGER reject_contact BEFORE INSERT ON emergency_contacts "
+                     "WHEN NEW.name = 'Rejected' BEGIN SELECT RAISE(ABORT, 'rejected'); END;",
+                     nullptr, nullptr, nullptr);
+        sqlite3_close(other);
+        
+        std::vector<User> batch = {makeUser("Dee", 1), makeUser("Eve", 1)};
+        batch[1].emergencyContacts[0].name = "Rejected";
+        bool failingAdded = db.addUsers(batch);
+        assert(!failingAdded && "Failing batch committed");
+        assert(db.getDirectory().getSnapshot()->users.empty() && "Rolled back users in the directory");
+        
+        batch[1].emergencyContacts[0].name = "Accepted";
+        bool batchAdded = db.addUsers(batch);
+        assert(batchAdded && "Failed to add batch");
+        assert(matchesDatabase(db) && "Directory differs after batch");
+    }
+    
+    removeDatabaseFiles(path);
+    std::cout << "Rollback test completed successfully" << std::endl;
+}
+
+// Test function to verify readers run alongside writers
+void test_concurrent_readers() {
+    std::cout << "Testing concurrent readers..." << std::endl;
+    
+    UserDatabase db(":memory:");
+    bool initialized = db.initialize();
+    assert(initialized && "Database initialization failed");
+    User ann = makeUser("Ann", 2);
+    bool added = db.addUser(ann);
+    assert(added && "Failed to add user");
+    
+    std::atomic<bool> done(false);
+    std::atomic<int> failures(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&db, &done, &failures, &ann] {
+            while (!done) {
+                auto snapshot = db.getDirectory().getSnapshot();
+                auto user = snapshot->find(ann.id);
+                // Every snapshot is internally consistent
+                if (!user || user->emergencyContacts.size() < 2 || snapshot->users.size() < 1) {
+                    failures++;
+                }
+            }
+        });
+    }
+    
+    for (int i = 0; i < 200; i++) {
+        User extra = makeUser("Extra " + std::to_string(i), 1);
+        db.addUser(extra);
+        EmergencyContact contact;
+        contact.name = "More " + std::to_string(i);
+        contact.phone = "555-0130";
+        db.addEmergencyContact(ann.id, contact);
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    
+    assert(failures == 0 && "Reader saw an inconsistent snapshot");
+    assert(db.getDirectory().findUser(ann.id)->emergencyContacts.size() == 202 && "Contacts lost");
+    assert(matchesDatabase(db) && "Directory differs after concurrent writes");
+    
+    std::cout << "Concurrent readers test completed successfully" << std::endl;
+}
+
+int main() {
+    std::cout << "Starting User Directory tests..." << std::endl;
+    
+    try {
+        test_load();
+        test_incremental_updates();
+        test_rollback();
+        test_concurrent_readers();
+        
+        std::cout << "All User Directory tests completed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,274 @@
+#include "core/video_recorder.hpp"
+#include "core/recording_catalog.hpp"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <filesystem>
+#include <fstream>
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <opencv2/opencv.hpp>
+
+using namespace hms;
+namespace fs = std::filesystem;
+
+// Frames the muxer may still hold in its own userspace buffer when a sync
+// happens. Noise frames are larger than that buffer, so this stays small.
+static const int kMuxerSlackFrames = 2;
+
+static VideoRecorder::Options makeTestOptions() {
+    VideoRecorder::Options options;
+    options.container = VideoRecorder::Container::MPEG_TS;
+    options.fourcc = cv::VideoWriter::fourcc('m', 'p', '4', 'v');
+    options.fps = 30.0;
+    options.frameSize = cv::Size(320, 240);
+    options.fsyncIntervalMs = 100;
+    options.writeBufferBytes = 256 * 1024;
+    return options;
+}
+
+static cv::Mat makeNoiseFrame() {
+    cv::Mat frame(240, 320, CV_8UC3);
+    cv::randu(frame, 0, 255);
+    return frame;
+}
+
+static int countDecodableFrames(const std::string& path) {
+    cv::VideoCapture capture(path, cv::CAP_FFMPEG);
+    if (!capture.isOpened()) {
+        return 0;
+    }
+    
+    int count = 0;
+    cv::Mat frame;
+    while (capture.read(frame)) {
+        count++;
+    }
+    return count;
+}
+
+static fs::path makeTestDirectory(const std::string& name) {
+    fs::path dir = fs::temp_directory_path() / name;
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    return dir;
+}
+
+// Test function to verify a cleanly released recording is complete
+void test_clean_release() {
+    std::cout << "Testing clean recording release..." << std::endl;
+    
+    fs::path dir = makeTestDirectory("hms_recorder_clean");
+    
+    VideoRecorder recorder(makeTestOptions());
+    if (!recorder.open((dir / "clean").string())) {
+        std::cout << "Skipping: FFmpeg video backend not available" << std::endl;
+        return;
+    }
+    
+    for (int i = 0; i < 30; i++) {
+        recorder.write(makeNoiseFrame());
+    }
+    recorder.release();
+    
+    assert(recorder.getSyncedBytes() == fs::file_size(recorder.getFilePath()) &&
+           "Final sync did not cover the whole file");
+    
+    int frames = countDecodableFrames(recorder.getFilePath());
+    assert(frames == 30 && "Released recording is missing frames");
+    
+    // The FIFO used to feed the writer thread must not be left behind
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        assert(entry.is_regular_file() && "Recording FIFO not removed");
+    }
+    
+    fs::remove_all(dir);
+    std::cout << "Clean recording release test completed successfully" << std::endl;
+}
+
+// Test function to verify footage survives kill -9 up to the last sync
+void test_crash_recovery() {
+    std::cout << "Testing recording recovery after kill -9..." << std::endl;
+    
+    fs::path dir = makeTestDirectory("hms_recorder_crash");
+    std::string basePath = (dir / "crash").string();
+    
+    int fds[2];
+    bool piped = pipe(fds) == 0;
+    assert(piped && "Failed to create pipe");
+    
+    pid_t pid = fork();
+    assert(pid >= 0 && "Failed to fork recorder process");
+    
+    if (pid == 0) {
+        // Child: record until killed, reporting how many frames were submitted
+        // before the previous sync each time the synced size advances. Those
+        // frames had a full sync interval to reach the file before this sync.
+        close(fds[0]);
+        
+        VideoRecorder recorder(makeTestOptions());
+        if (!recorder.open(basePath)) {
+            int failed = -1;
+            ssize_t sent = write(fds[1], &failed, sizeof(failed));
+            _exit(sent == sizeof(failed) ? 1 : 2);
+        }
+        
+        uint64_t lastSynced = 0;
+        int framesAtLastSync = 0;
+        for (int i = 0;; i++) {
+            recorder.write(makeNoiseFrame());
+            
+            uint64_t synced = recorder.getSyncedBytes();
+            if (synced != lastSynced) {
+                int durable = framesAtLastSync;
+                if (write(fds[1], &durable, sizeof(durable)) != sizeof(durable)) {
+                    _exit(1);
+                }
+                lastSynced = synced;
+                framesAtLastSync = i + 1;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    
+    close(fds[1]);
+    
+    int durableFrames = 0;
+    int reports = 0;
+    while (reports < 5) {
+        int value;
+        if (read(fds[0], &value, sizeof(value)) != sizeof(value)) {
+            break;
+        }
+        if (value < 0) {
+            break;
+        }
+        durableFrames = value;
+        reports++;
+    }
+    
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+    close(fds[0]);
+    
+    if (reports == 0) {
+        std::cout << "Skipping: FFmpeg video backend not available" << std::endl;
+        fs::remove_all(dir);
+        return;
+    }
+    
+    std::string filePath = basePath + VideoRecorder::getExtension(VideoRecorder::Container::MPEG_TS);
+    int recovered = countDecodableFrames(filePath);
+    
+    std::cout << "Frames durable at last sync: " << durableFrames
+              << ", frames recovered: " << recovered << std::endl;
+    assert(recovered > 0 && "Recording is unreadable after crash");
+    assert(recovered >= durableFrames - kMuxerSlackFrames && "Synced footage was lost");
+    
+    // Reopening in the same place must cope with the FIFO left by the crash
+    VideoRecorder recorder(makeTestOptions());
+    bool reopened = recorder.open(basePath);
+    assert(reopened && "Failed to reopen after crash");
+    recorder.release();
+    
+    fs::remove_all(dir);
+    std::cout << "Recording recovery test completed successfully" << std::endl;
+}
+
+static RecordingEntry makeEntry(const fs::path& dir, const std::string& name,
+                                const std::string& rendition, int64_t startTimeMs) {
+    std::ofstream(dir / name) << "segment";
+    
+    RecordingEntry entry;
+    entry.cameraIndex = 0;
+    entry.rendition = rendition;
+    entry.path = (dir / name).string();
+    entry.startTimeMs = startTimeMs;
+    entry.endTimeMs = 0;
+    entry.width = 320;
+    entry.height = 180;
+    entry.fps = 5.0;
+    return entry;
+}
+
+// Test function to verify the catalog survives a restart and prefers proxies
+void test_recording_catalog() {
+    std::cout << "Testing recording catalog..." << std::endl;
+    
+    fs::path dir = makeTestDirectory("hms_recording_catalog");
+    
+    {
+        RecordingCatalog catalog(dir.string());
+        bool loaded = catalog.load();
+        assert(loaded && "Failed to load empty catalog");
+        
+        catalog.addSegment(makeEntry(dir, "a.ts", RecordingCatalog::MAIN_RENDITION, 1000));
+        catalog.addSegment(makeEntry(dir, "a_proxy.ts", RecordingCatalog::PROXY_RENDITION, 1000));
+        catalog.addSegment(makeEntry(dir, "b.ts", RecordingCatalog::MAIN_RENDITION, 5000));
+        catalog.closeSegment((dir / "a.ts").string(), 5000);
+        catalog.closeSegment((dir / "a_proxy.ts").string(), 5000);
+        
+        // Deleted by retention while running
+        fs::remove(dir / "b.ts");
+        catalog.removeSegment((dir / "b.ts").string());
+        
+        // Still being written when the crash hits
+        RecordingEntry first = makeEntry(dir, "c.ts", RecordingCatalog::MAIN_RENDITION, 1000);
+        first.cameraIndex = 1;
+        catalog.addSegment(first);
+        RecordingEntry second = makeEntry(dir, "d.ts", RecordingCatalog::MAIN_RENDITION, 8000);
+        second.cameraIndex = 1;
+        catalog.addSegment(second);
+    }
+    
+    // Simulate a crash in the middle of an append
+    std::ofstream(dir / "catalog.jsonl", std::ios::app) << "{\"op\": \"ad";
+    
+    RecordingCatalog catalog(dir.string());
+    bool reloaded = catalog.load();
+    assert(reloaded && "Failed to reload catalog");
+    
+    auto segments = catalog.getSegments(0, 0, 10000);
+    assert(segments.size() == 2 && "Catalog replay returned wrong segments");
+    for (const auto& segment : segments) {
+        assert(segment.endTimeMs == 5000 && "Segment close was not replayed");
+    }
+    
+    auto scrub = catalog.findScrubbingSegment(0, 2000);
+    assert(scrub && scrub->rendition == RecordingCatalog::PROXY_RENDITION &&
+           "Scrubbing should use the proxy rendition");
+    assert(!catalog.findScrubbingSegment(0, 6000) && "Removed segment still listed");
+    
+    // Open segments end where the next one starts, or when their file was
+    // last written, rather than covering all later times
+    auto crashed = catalog.getSegments(1, 0, 8000);
+    assert(crashed.size() == 1 && crashed[0].endTimeMs == 8000 && "Open segment not closed at the next one");
+    auto last = catalog.findScrubbingSegment(1, 9000);
+    assert(last && last->path == (dir / "d.ts").string() && last->endTimeMs > 9000 &&
+           "Last open segment not closed at its modification time");
+    int64_t tomorrowMs = last->endTimeMs + 24 * 3600 * 1000LL;
+    assert(!catalog.findScrubbingSegment(1, tomorrowMs) && "Crashed segment covers future times");
+    assert(catalog.getSegments(1, tomorrowMs, tomorrowMs + 1000).empty() && "Crashed segment in future ranges");
+    
+    fs::remove_all(dir);
+    std::cout << "Recording catalog test completed successfully" << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Video Recorder tests..." << std::endl;
+    
+    try {
+        test_clean_release();
+        test_crash_recovery();
+        test_recording_catalog();
+        
+        std::cout << "All Video Recorder tests completed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}